@@ -0,0 +1,471 @@
+/*
+  Micro-benchmarks des fonctions chaudes du firmware, compilées pour le PC
+  - Mêmes en-têtes que la carte : status_json.h, ranging.h, calibration.h,
+    control.h, sensor_health.h, anomaly.h, oled_view.h
+  - Par cas : nombre d'itérations calibré pour durer --min-time, puis
+    --repetitions mesures, entrelacées entre les cas ; médiane, min et
+    mesures brutes (ns/itération) dans le rapport
+  - Rapport JSON (-o) au format de Google Benchmark ("benchmarks": name,
+    iterations, real_time, cpu_time, time_unit) : comparé entre deux
+    commits par bench_compare.py (code de sortie 1 si régression)
+
+  Les temps sont ceux du PC : seuls les rapports entre deux mesures sur la
+  même machine ont un sens (la carte est ~20 à 50x plus lente).
+
+  Usage : ./bench [--filter sous-chaîne] [--min-time s] [--repetitions n]
+                  [--label texte] [-o resultats.json] [--list]
+*/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "status_json.h"
+#include "ranging.h"
+#include "calibration.h"
+#include "control.h"
+#include "sensor_health.h"
+#include "anomaly.h"
+#include "oled_view.h"
+#include "byte_codec.h"
+
+// ===================== Harnais =====================
+// Empêche le compilateur d'éliminer un résultat non utilisé
+template<class T>
+inline void keep(T const& v) { asm volatile("" : : "r,m"(v) : "memory"); }
+inline void clobber() { asm volatile("" : : : "memory"); }
+
+typedef std::function<void(uint64_t)> BenchBody;   // exécute n itérations
+
+struct Case {
+  std::string name;
+  BenchBody body;
+};
+
+struct Result {
+  std::string name;
+  uint64_t iterations;
+  int repetitions;
+  double realNs, cpuNs;   // médianes, par itération
+  double minNs, stddevNs;
+  std::vector<double> samplesNs;   // temps réel de chaque répétition
+};
+
+static double cpuSeconds() {
+  timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double wallSeconds() {
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static double median(std::vector<double> v) {
+  std::sort(v.begin(), v.end());
+  size_t n = v.size();
+  return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+// Nombre d'itérations doublé jusqu'à durer minTime (au moins une itération)
+static uint64_t calibrate(const Case& c, double minTime) {
+  uint64_t n = 1;
+  for (;;) {
+    double t0 = wallSeconds();
+    c.body(n);
+    double dt = wallSeconds() - t0;
+    if (dt >= minTime || n >= (1ULL << 40)) return n;
+    double grow = dt > 0 ? minTime / dt * 1.2 : 10.0;
+    n = (uint64_t)(n * std::min(std::max(grow, 2.0), 10.0));
+  }
+}
+
+// Une répétition : ns par itération, temps réel et CPU
+static void measure(const Case& c, uint64_t n, std::vector<double>& real, std::vector<double>& cpu) {
+  double w0 = wallSeconds(), c0 = cpuSeconds();
+  c.body(n);
+  double c1 = cpuSeconds(), w1 = wallSeconds();
+  real.push_back((w1 - w0) * 1e9 / n);
+  cpu.push_back((c1 - c0) * 1e9 / n);
+}
+
+static Result summarize(const std::string& name, uint64_t n, const std::vector<double>& real,
+                        const std::vector<double>& cpu) {
+  double mean = 0, var = 0;
+  for (double x : real) mean += x;
+  mean /= real.size();
+  for (double x : real) var += (x - mean) * (x - mean);
+  Result res;
+  res.name = name;
+  res.iterations = n;
+  res.repetitions = (int)real.size();
+  res.realNs = median(real);
+  res.cpuNs = median(cpu);
+  res.minNs = *std::min_element(real.begin(), real.end());
+  res.stddevNs = real.size() > 1 ? std::sqrt(var / (real.size() - 1)) : 0;
+  res.samplesNs = real;
+  return res;
+}
+
+// Générateur reproductible (entrées synthétiques identiques d'un commit à l'autre)
+struct Lcg {
+  uint32_t s;
+  explicit Lcg(uint32_t seed) : s(seed) {}
+  uint32_t next() { s = s * 1664525u + 1013904223u; return s >> 8; }
+  float uniform(float lo, float hi) { return lo + (hi - lo) * (next() & 0xFFFF) / 65535.0f; }
+};
+
+// ===================== Écran en mémoire =====================
+// Interface Adafruit_GFX utilisée par renderOled(), tampon au format SSD1306
+// (pages de 8 lignes, 1 octet = 8 pixels verticaux). Même coût par pixel que
+// la bibliothèque : drawPixel par bit allumé, carré de size x size pour le texte.
+// Glyphes 5x7 de remplacement (motif dérivé du code du caractère) : la police
+// glcdfont n'est pas reprise, seul le nombre d'écritures de pixels compte ici.
+class MemGfx {
+public:
+  static const int W = 128, H = 64;
+
+  int width() const { return W; }
+  int height() const { return H; }
+  const uint8_t* buffer() const { return _buf; }
+  uint8_t* getBuffer() { return _buf; }
+
+  void clearDisplay() { memset(_buf, 0, sizeof(_buf)); }
+
+  void drawPixel(int x, int y, uint16_t color) {
+    if (x < 0 || x >= W || y < 0 || y >= H) return;
+    uint8_t bit = 1 << (y & 7);
+    if (color) _buf[x + (y / 8) * W] |= bit;
+    else _buf[x + (y / 8) * W] &= ~bit;
+  }
+
+  void fillRect(int x, int y, int w, int h, uint16_t color) {
+    for (int j = y; j < y + h; j++)
+      for (int i = x; i < x + w; i++) drawPixel(i, j, color);
+  }
+
+  void drawBitmap(int x, int y, const uint8_t* bitmap, int w, int h, uint16_t color) {
+    int byteWidth = (w + 7) / 8;
+    uint8_t b = 0;
+    for (int j = 0; j < h; j++) {
+      for (int i = 0; i < w; i++) {
+        if (i & 7) b <<= 1;
+        else b = bitmap[j * byteWidth + i / 8];
+        if (b & 0x80) drawPixel(x + i, y + j, color);
+      }
+    }
+  }
+
+  void setTextSize(uint8_t s) { _size = s ? s : 1; }
+  void setCursor(int x, int y) { _cx = x; _cy = y; }
+
+  void print(const char* s) {
+    for (; *s; s++) {
+      drawChar(_cx, _cy, (uint8_t)*s);
+      _cx += 6 * _size;
+    }
+  }
+
+private:
+  void drawChar(int x, int y, uint8_t c) {
+    for (int i = 0; i < 5; i++) {
+      uint8_t line = c == ' ' ? 0 : (uint8_t)((c * 0x9E3779B1u) >> (i * 5)) & 0x7F;
+      for (int j = 0; j < 8; j++, line >>= 1) {
+        if (!(line & 1)) continue;
+        if (_size == 1) drawPixel(x + i, y + j, OLED_WHITE);
+        else fillRect(x + i * _size, y + j * _size, _size, _size, OLED_WHITE);
+      }
+    }
+  }
+
+  uint8_t _buf[W * H / 8];
+  int _cx = 0, _cy = 0;
+  uint8_t _size = 1;
+};
+
+// ===================== Bassin simulé (valeurs de main.cpp) =====================
+static const float OFFSET_CM = 2.0f, HEIGHT_CM = 9.1f, CAPACITY_L = 4.0f;
+static const uint32_t LOGIC_INTERVAL_MS = 50;
+static const SensorHealthParams US_HEALTH = { 20, 0.5f, 1.5f, 60000, 5000 };
+static const AnomalyParams ANOMALY = { 600, 10, 60, 900, 0.02f, 0.10f, 0.10f, 0.10f };
+
+static ControlParams defaultParams(const CalibrationTable& calib) {
+  ControlParams p = { 90, 85, 25, 10, 5, 0, 0, 0, 0, 0, 3000, 5UL * 24UL * 3600UL, 30000, 600000 };
+  controlUpdateThresholds(p, calib);
+  return p;
+}
+
+// Table à 12 points (bassin évasé) : pire cas de la recherche dichotomique
+static void taperedTable(CalibrationTable& t) {
+  t.clear();
+  for (int i = 0; i < CAL_MAX_POINTS; i++) {
+    float d = OFFSET_CM + HEIGHT_CM * i / (CAL_MAX_POINTS - 1);
+    float x = 1.0f - (float)i / (CAL_MAX_POINTS - 1);
+    t.add(d, CAPACITY_L * x * (0.6f + 0.4f * x));
+  }
+}
+
+// Un tick de runLogic() sans les E/S : échos -> distance -> santé -> litres
+// -> controlStep -> détection de fuite (comme host/replay), plus l'évolution
+// du bassin selon les actionneurs (modèle SIMULATION de main.cpp)
+struct Fountain {
+  CalibrationTable calib;
+  ControlParams p;
+  ControlState st = {};
+  SensorHealthState health = {};
+  AnomalyDetector anomaly{ANOMALY};
+  float distanceCm = OFFSET_CM + HEIGHT_CM / 2, levelPct = 50, tempC = 21.5f;
+  uint32_t ms = 0, epoch = 1750000000;
+  Lcg rng{12345};
+
+  explicit Fountain(FountainMode mode) {
+    calib.setPrismatic(OFFSET_CM, HEIGHT_CM, CAPACITY_L);
+    p = defaultParams(calib);
+    controlSetMode(st, mode, epoch);
+  }
+
+  int tick() {
+    ms += LOGIC_INTERVAL_MS;
+    if (ms % 1000 == 0) epoch++;
+    bool pir = (ms / 1000) % 40 < 5;   // passages de 5 s toutes les 40 s
+
+    uint32_t echoUs[ECHO_MAX_SAMPLES];
+    float cm = OFFSET_CM + HEIGHT_CM * (1.0f - levelPct / 100.0f);
+    for (int i = 0; i < ECHO_MAX_SAMPLES; i++)
+      echoUs[i] = rng.next() % 64 == 0 ? 0 : cmToEchoUs(cm + rng.uniform(-0.2f, 0.2f), tempC);
+
+    int valid = 0;
+    distanceCm = rangeFromEchoes(echoUs, ECHO_MAX_SAMPLES, tempC, OFFSET_CM, HEIGHT_CM, distanceCm, &valid);
+    healthUpdate(health, US_HEALTH, ms, valid, ECHO_MAX_SAMPLES, distanceCm);
+    float levelL = calib.litresAt(distanceCm);
+    int pct = calib.percentRounded(distanceCm);
+    ControlInputs in = { ms, epoch, pir, levelL, healthTrusted(health) };
+    uint8_t fx = controlStep(st, p, in);
+    uint8_t raised = anomaly.update(ms, levelL, st.valveOn, st.pumpOn, st.voutOn);
+
+    float dt = LOGIC_INTERVAL_MS / 1000.0f;
+    if (st.valveOn) levelPct += 2.0f * dt;
+    if (st.pumpOn)  levelPct -= 5.0f * dt;
+    if (st.voutOn)  levelPct -= 10.0f * dt;
+    levelPct -= 0.001f * dt;
+    levelPct = std::min(100.0f, std::max(0.0f, levelPct));
+    return pct + fx + raised;
+  }
+};
+
+// ===================== Cas mesurés =====================
+static std::vector<Case> buildCases() {
+  std::vector<Case> cases;
+
+  // ---- /status et SSE (toutes les 3 s par client, et à chaque envoi Sheets) ----
+  cases.push_back({"status_json", [](uint64_t n) {
+    ChannelStatus channels[] = {
+      { "EV1", "latched", true, false, 12 }, { "EV2", "latched", false, false, 3 },
+      { "pump", "relay", true, false, 41 }, { "EV_out", "relay", false, false, 2 }
+    };
+    char buf[1536];
+    for (uint64_t i = 0; i < n; i++) {
+      StatusSnapshot snap = {
+        (int)(i % 101), 5.43f, 2.17f, 4.0f, true,
+        21.5f, 48.0f,
+        true, false, true,
+        "00:00:12", "01:02:03", "00:10:00", "12:34:56",
+        2, true, 5, "days", "71:59:59", false,
+        "leak", -0.12f, false,
+        "degraded", "00:00:04",
+        "\"today\":{\"fillL\":3.20,\"drainL\":2.95,\"fillLPerDay\":6.40,\"valveS\":410,\"valveN\":9,\"pumpS\":21600,"
+        "\"pumpN\":4,\"kWh\":0.036,\"drainS\":1800,\"drainN\":4,\"periodS\":43200},"
+        "\"open\":{\"fillL\":96.10,\"fillLPerDay\":7.02,\"kWh\":0.410,\"periodS\":1182600},"
+        "\"closed\":{\"fillL\":4.00,\"fillLPerDay\":0.31,\"kWh\":1.820,\"periodS\":1108800},"
+        "\"eco\":{\"fillL\":22.50,\"fillLPerDay\":1.95,\"kWh\":1.480,\"periodS\":997200}",
+        channels, 4
+      };
+      keep(formatStatusJson(buf, sizeof(buf), snap));
+      clobber();
+    }
+  }});
+
+  // ---- Filtrage des échos ultrason (chaque tick de 50 ms) ----
+  // Jeux d'échantillons variés (ordre aléatoire) ; la copie dans le tampon
+  // de travail fait partie de la mesure, comme dans medianFilter()
+  static float sets[64][ECHO_MAX_SAMPLES];
+  Lcg rng(42);
+  for (auto& s : sets)
+    for (float& v : s) v = rng.uniform(2.0f, 11.1f);
+
+  cases.push_back({"sort_float/5", [](uint64_t n) {
+    float work[ECHO_MAX_SAMPLES];
+    for (uint64_t i = 0; i < n; i++) {
+      memcpy(work, sets[i & 63], sizeof(work));
+      sortFloat(work, ECHO_MAX_SAMPLES);
+      keep(work[0]);
+    }
+  }});
+  for (int count : {3, 5}) {
+    cases.push_back({"median_filter/" + std::to_string(count), [count](uint64_t n) {
+      for (uint64_t i = 0; i < n; i++) keep(medianFilter(sets[i & 63], count));
+    }});
+  }
+  cases.push_back({"range_from_echoes/5", [](uint64_t n) {
+    static uint32_t echoes[64][ECHO_MAX_SAMPLES];
+    Lcg r(7);
+    for (auto& e : echoes)
+      for (uint32_t& us : e) us = r.next() % 16 == 0 ? 0 : cmToEchoUs(r.uniform(2.0f, 11.1f), 21.5f);
+    float last = 6.0f;
+    int valid = 0;
+    for (uint64_t i = 0; i < n; i++) {
+      last = rangeFromEchoes(echoes[i & 63], ECHO_MAX_SAMPLES, 21.5f, OFFSET_CM, HEIGHT_CM, last, &valid);
+      keep(last);
+    }
+  }});
+
+  // ---- cmToPercent() : table prismatique (défaut) et table de 12 points ----
+  for (int points : {2, CAL_MAX_POINTS}) {
+    cases.push_back({"cm_to_percent/" + std::to_string(points) + "pts", [points](uint64_t n) {
+      CalibrationTable t;
+      if (points == 2) t.setPrismatic(OFFSET_CM, HEIGHT_CM, CAPACITY_L);
+      else taperedTable(t);
+      float cm = OFFSET_CM;
+      for (uint64_t i = 0; i < n; i++) {
+        keep(t.percentRounded(cm));
+        cm += 0.37f;
+        if (cm > OFFSET_CM + HEIGHT_CM * 1.1f) cm = OFFSET_CM * 0.9f;
+      }
+    }});
+  }
+
+  // ---- Tick complet de la logique, par mode (5 min simulées par lot de 6000) ----
+  static const struct { const char* name; FountainMode mode; } modes[] = {
+    { "open", MODE_OPEN_CYCLE }, { "closed", MODE_CLOSED_CYCLE }, { "eco", MODE_ECO_HYBRID }
+  };
+  for (const auto& m : modes) {
+    FountainMode mode = m.mode;
+    cases.push_back({std::string("run_logic/") + m.name, [mode](uint64_t n) {
+      Fountain f(mode);
+      int acc = 0;
+      for (uint64_t i = 0; i < n; i++) {
+        acc += f.tick();
+        if (i % 6000 == 5999) f = Fountain(mode);   // état borné (fuite, arrêt de sécurité...)
+      }
+      keep(acc);
+    }});
+  }
+
+  // ---- Rendu OLED + empreinte de trame (drawOLED() sans l'envoi I2C) ----
+  static const struct { const char* name; OledView view; } screens[] = {
+    { "open",  { true, -58, nullptr, MODE_OPEN_CYCLE, false, 73.0f } },
+    { "eco",   { true, -71, nullptr, MODE_ECO_HYBRID, true, 100.0f } },
+    { "alert", { false, -100, "FUITE", MODE_CLOSED_CYCLE, false, 8.0f } }
+  };
+  for (const auto& s : screens) {
+    OledView view = s.view;
+    cases.push_back({std::string("draw_oled/") + s.name, [view](uint64_t n) {
+      MemGfx gfx;
+      for (uint64_t i = 0; i < n; i++) {
+        renderOled(gfx, view);
+        keep(fnv1a(gfx.buffer(), MemGfx::W * MemGfx::H / 8));   // comme sendOLED()
+      }
+    }});
+  }
+  return cases;
+}
+
+// ===================== Rapport =====================
+static void writeJson(FILE* f, const std::vector<Result>& results, const char* label,
+                      double minTime, int repetitions) {
+  char date[32];
+  time_t now = time(nullptr);
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&now));
+  fprintf(f, "{\n  \"context\": {\n");
+  fprintf(f, "    \"date\": \"%s\",\n", date);
+  fprintf(f, "    \"executable\": \"bench\",\n");
+  fprintf(f, "    \"label\": \"");
+  for (const char* c = label; *c; c++) {
+    if (*c == '"' || *c == '\\') fputc('\\', f);
+    if ((uint8_t)*c >= 0x20) fputc(*c, f);
+  }
+  fprintf(f, "\",\n");
+  fprintf(f, "    \"compiler\": \"%s\",\n", __VERSION__);
+  fprintf(f, "    \"min_time\": %.3f,\n", minTime);
+  fprintf(f, "    \"repetitions\": %d\n  },\n", repetitions);
+  fprintf(f, "  \"benchmarks\": [\n");
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result& r = results[i];
+    fprintf(f, "    {\"name\": \"%s\", \"iterations\": %llu, \"repetitions\": %d, "
+               "\"real_time\": %.3f, \"cpu_time\": %.3f, \"min_time\": %.3f, \"stddev\": %.3f, "
+               "\"samples\": [",
+            r.name.c_str(), (unsigned long long)r.iterations, r.repetitions,
+            r.realNs, r.cpuNs, r.minNs, r.stddevNs);
+    for (size_t k = 0; k < r.samplesNs.size(); k++) fprintf(f, "%s%.3f", k ? ", " : "", r.samplesNs[k]);
+    fprintf(f, "], \"time_unit\": \"ns\"}%s\n", i + 1 < results.size() ? "," : "");
+  }
+  fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+  const char* filter = "";
+  const char* outPath = nullptr;
+  const char* label = "";
+  double minTime = 0.2;
+  int repetitions = 5;
+  bool list = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+    else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) minTime = atof(argv[++i]);
+    else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) repetitions = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--label") == 0 && i + 1 < argc) label = argv[++i];
+    else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) outPath = argv[++i];
+    else if (strcmp(argv[i], "--list") == 0) list = true;
+    else {
+      fprintf(stderr, "usage : %s [--filter sous-chaîne] [--min-time s] [--repetitions n]\n"
+                      "          [--label texte] [-o resultats.json] [--list]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (minTime <= 0 || repetitions < 1) {
+    fprintf(stderr, "--min-time et --repetitions doivent être positifs\n");
+    return 2;
+  }
+
+  std::vector<Case> cases;
+  for (Case& c : buildCases()) {
+    if (!strstr(c.name.c_str(), filter)) continue;
+    if (list) printf("%s\n", c.name.c_str());
+    else cases.push_back(std::move(c));
+  }
+  if (list) return 0;
+
+  // Répétitions entrelacées (tour à tour sur tous les cas) : une période
+  // lente de la machine touche une répétition de plusieurs cas, pas toutes
+  // celles d'un même cas -> le min et la dispersion restent représentatifs
+  std::vector<uint64_t> iters;
+  for (const Case& c : cases) iters.push_back(calibrate(c, minTime));
+  std::vector<std::vector<double>> real(cases.size()), cpu(cases.size());
+  for (int r = 0; r < repetitions; r++) {
+    for (size_t i = 0; i < cases.size(); i++) measure(cases[i], iters[i], real[i], cpu[i]);
+  }
+
+  std::vector<Result> results;
+  fprintf(stderr, "%-24s %12s %12s %10s %12s\n", "cas", "ns/iter", "min", "écart %", "itérations");
+  for (size_t i = 0; i < cases.size(); i++) {
+    Result r = summarize(cases[i].name, iters[i], real[i], cpu[i]);
+    fprintf(stderr, "%-24s %12.1f %12.1f %10.1f %12llu\n", r.name.c_str(), r.realNs, r.minNs,
+            r.realNs > 0 ? 100.0 * r.stddevNs / r.realNs : 0.0, (unsigned long long)r.iterations);
+    results.push_back(r);
+  }
+
+  if (outPath) {
+    FILE* f = fopen(outPath, "w");
+    if (!f) { perror(outPath); return 2; }
+    writeJson(f, results, label, minTime, repetitions);
+    fclose(f);
+  }
+  return 0;
+}
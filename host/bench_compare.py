@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""
+Compare deux rapports de host/bench (ou de Google Benchmark) : référence et candidat.
+
+Une ligne par cas : temps médian A et B, meilleure répétition (min) A et B.
+Régression = min de B plus lent que min de A de plus de --threshold %, ET
+écart des min au-delà de --sigma écarts-types combinés des deux rapports
+(sqrt(sA² + sB²)) : le min est l'estimateur le moins bruité (le bruit ne
+fait que ralentir), la marge absorbe la dispersion propre à chaque cas.
+host/bench entrelace les répétitions des cas : une période lente de la
+machine n'en touche qu'une par cas, au lieu de décaler tout un rapport.
+Code de sortie 1 s'il y a au moins une régression : utilisable tel quel en CI.
+
+  ./bench --label main -o base.json            # sur le commit de référence
+  ./bench --label pr -o pr.json                # sur le commit à tester
+  ./bench_compare.py base.json pr.json --threshold 10
+
+Uniquement la bibliothèque standard Python (3.8+).
+"""
+import argparse
+import json
+import math
+import statistics
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        report = json.load(f)
+    cases = {}
+    runs = {}   # Google Benchmark : répétitions brutes par cas
+    for b in report.get("benchmarks", []):
+        scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}[b.get("time_unit", "ns")]
+        if b.get("run_type") == "aggregate":
+            continue   # recalculés depuis les répétitions
+        name = b.get("run_name", b["name"])
+        if "min_time" in b or "stddev" in b:   # host/bench : une entrée résumée par cas
+            cases[name] = {
+                "real_time": b["real_time"] * scale,
+                "cpu_time": b["cpu_time"] * scale,
+                "min_time": b.get("min_time", b["real_time"]) * scale,
+                "stddev": b.get("stddev", 0.0) * scale,
+            }
+        else:
+            runs.setdefault(name, []).append((b["real_time"] * scale, b["cpu_time"] * scale))
+    for name, r in runs.items():
+        real = [x[0] for x in r]
+        cases[name] = {
+            "real_time": statistics.median(real),
+            "cpu_time": statistics.median(x[1] for x in r),
+            "min_time": min(real),
+            "stddev": statistics.stdev(real) if len(real) > 1 else 0.0,
+        }
+    return report.get("context", {}), cases
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("base", help="rapport de référence")
+    ap.add_argument("candidate", help="rapport à comparer")
+    ap.add_argument("--threshold", type=float, default=10.0, help="ralentissement toléré en %% (10)")
+    ap.add_argument("--sigma", type=float, default=3.0,
+                    help="marge de bruit en écarts-types combinés (3)")
+    ap.add_argument("--filter", default="", help="seulement les cas contenant cette sous-chaîne")
+    args = ap.parse_args()
+
+    ctx_a, a = load(args.base)
+    ctx_b, b = load(args.candidate)
+    print(f"A = {ctx_a.get('label') or args.base}  B = {ctx_b.get('label') or args.candidate}  (ns)")
+    print(f"{'cas':<24} {'médiane A':>12} {'médiane B':>12} {'min A':>12} {'min B':>12} {'variation':>10}")
+
+    regressions = []
+    for name in sorted(set(a) | set(b)):
+        if args.filter not in name:
+            continue
+        if name not in a or name not in b:
+            print(f"{name:<24} {'absent de ' + ('A' if name not in a else 'B'):>36}")
+            continue
+        ca, cb = a[name], b[name]
+        ma, mb = ca["min_time"], cb["min_time"]
+        delta = (mb / ma - 1.0) * 100.0 if ma > 0 else 0.0
+        margin = args.sigma * math.hypot(ca["stddev"], cb["stddev"])
+        flag = ""
+        if delta > args.threshold and mb - ma > margin:
+            flag = "  RÉGRESSION"
+            regressions.append(name)
+        elif delta < -args.threshold and ma - mb > margin:
+            flag = "  gain"
+        print(f"{name:<24} {ca['real_time']:>12.1f} {cb['real_time']:>12.1f} {ma:>12.1f} {mb:>12.1f} "
+              f"{delta:>+9.1f}%{flag}")
+
+    if regressions:
+        print(f"{len(regressions)} régression(s) au-delà de {args.threshold:g} % : {', '.join(regressions)}",
+              file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
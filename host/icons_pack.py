@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""
+Compresse les ressources de l'interface pour la flash : icônes de l'OLED et page web.
+
+  src/icons.h    (source, format drawBitmap)  ->  src/icons_rle.h
+  src/web_page.h (index_html)                 ->  src/web_page_gz.h
+
+Icônes : transposées au format de page SSD1306 (1 octet = 8 pixels
+verticaux, bandes de 8 lignes), puis codées par plages d'octets :
+  0nnnnnnn          n+1 octets littéraux suivent
+  10nnnnnn          n+1 octets nuls (pixels éteints : sautés au décodage)
+  11nnnnnn v        n+2 fois l'octet v
+Décodage : rleBlit() (src/rle_blit.h), directement dans le tampon de
+l'afficheur, sans tampon intermédiaire.
+Page web : gzip (niveau 9, horodatage nul : sortie reproductible), servie
+telle quelle avec Content-Encoding: gzip.
+
+Imprime le bilan flash / RAM par ressource. À relancer après toute
+modification de icons.h ou web_page.h ; --check (CI) : code de sortie 1 si
+les en-têtes générés ne sont plus à jour.
+
+  ./icons_pack.py              # régénère les deux en-têtes
+  ./icons_pack.py --check      # vérifie seulement
+
+Uniquement la bibliothèque standard Python (3.8+).
+"""
+import argparse
+import gzip
+import os
+import re
+import sys
+
+SRC = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src")
+OLED_BUFFER = 128 * 64 // 8   # tampon de l'afficheur (Adafruit_SSD1306), déjà alloué
+
+
+def parse_icons(path):
+    """[(nom, largeur, hauteur, octets)] dans l'ordre du fichier"""
+    text = open(path, encoding="utf-8").read()
+    pattern = re.compile(
+        r"//\s*'(\w+)',\s*(\d+)x(\d+)px\s*\n\s*const unsigned char\s+(\w+)\s*\[\]\s*PROGMEM\s*=\s*\{(.*?)\};",
+        re.S)
+    icons = []
+    for m in pattern.finditer(text):
+        name, w, h, data = m.group(4), int(m.group(2)), int(m.group(3)), m.group(5)
+        raw = bytes(int(v, 16) for v in re.findall(r"0x[0-9a-fA-F]+", data))
+        if len(raw) != (w + 7) // 8 * h:
+            sys.exit("%s : %d octets, attendu %d (%dx%d)" % (name, len(raw), (w + 7) // 8 * h, w, h))
+        icons.append((name, w, h, raw))
+    if not icons:
+        sys.exit("aucune icône trouvée dans " + path)
+    return icons
+
+
+def to_pages(w, h, raw):
+    """Format drawBitmap (lignes, MSB à gauche) -> colonnes de 8 pixels par bande"""
+    stride = (w + 7) // 8
+    out = bytearray()
+    for band in range((h + 7) // 8):
+        for x in range(w):
+            b = 0
+            for k in range(8):
+                y = band * 8 + k
+                if y < h and raw[y * stride + x // 8] & (0x80 >> (x & 7)):
+                    b |= 1 << k
+            out.append(b)
+    return bytes(out)
+
+
+def rle_encode(data):
+    """Les octets nuls de fin ne sont pas codés : rien à dessiner"""
+    data = data.rstrip(b"\0")
+    out = bytearray()
+    literal = bytearray()
+
+    def flush():
+        while literal:
+            chunk = literal[:128]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+            del literal[:128]
+
+    i = 0
+    while i < len(data):
+        j = i
+        while j < len(data) and data[j] == data[i]:
+            j += 1
+        run = j - i
+        if data[i] == 0:
+            flush()
+            while run > 0:
+                n = min(run, 64)
+                out.append(0x80 | (n - 1))
+                run -= n
+        elif run >= 3:   # 2 octets codés pour 3 et plus ; une paire reste littérale
+            flush()
+            while run >= 2:
+                n = min(run, 65)
+                out.extend((0xC0 | (n - 2), data[i]))
+                run -= n
+            literal.extend(data[j - run:j])
+        else:
+            literal.extend(data[i:j])
+        i = j
+    flush()
+    return bytes(out)
+
+
+def rle_decode(data, size):
+    """Contrôle aller-retour (même lecture que rleBlit)"""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        c = data[i]
+        i += 1
+        if c < 0x80:
+            out.extend(data[i:i + c + 1])
+            i += c + 1
+        elif c < 0xC0:
+            out.extend(b"\0" * ((c & 0x3F) + 1))
+        else:
+            out.extend(bytes([data[i]]) * ((c & 0x3F) + 2))
+            i += 1
+    return bytes(out) + b"\0" * (size - len(out)) if len(out) <= size else None
+
+
+def parse_page(path):
+    text = open(path, encoding="utf-8").read()
+    m = re.search(r'index_html\[\]\s*PROGMEM\s*=\s*R"HTML\((.*?)\)HTML"', text, re.S)
+    if not m:
+        sys.exit("index_html introuvable dans " + path)
+    return m.group(1).encode("utf-8")
+
+
+def c_array(data, indent="  ", per_line=16):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append(indent + ",".join("0x%02x" % b for b in data[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def icons_header(packed, report):
+    out = ["#pragma once",
+           "// Généré par host/icons_pack.py depuis icons.h : ne pas modifier à la main",
+           "// Icônes au format de page SSD1306, codées par plages (décodage : rle_blit.h)",
+           "//"]
+    out += ["// " + line for line in report]
+    out += ['#include "rle_blit.h"', ""]
+    for name, w, h, _raw, rle in packed:
+        out.append("// '%s', %dx%dpx : %d octets" % (name, w, h, len(rle)))
+        out.append("const uint8_t %s_rle [] PROGMEM = {" % name)
+        out.append(c_array(rle))
+        out.append("};")
+        out.append("const RleIcon %s = { %d, %d, sizeof(%s_rle), %s_rle };" % (name, w, h, name, name))
+        out.append("")
+    return "\n".join(out)
+
+
+def page_header(gz, raw_len):
+    return "\n".join([
+        "#pragma once",
+        "// Généré par host/icons_pack.py depuis web_page.h : ne pas modifier à la main",
+        "// index_html compressé (gzip), à servir avec l'en-tête Content-Encoding: gzip",
+        "// %d octets (page brute : %d)" % (len(gz), raw_len),
+        "#include <stdint.h>",
+        "#include <stddef.h>",
+        "#ifdef ARDUINO",
+        "#include <Arduino.h>",
+        "#elif !defined(PROGMEM)",
+        "#define PROGMEM",
+        "#endif",
+        "",
+        "static const uint8_t index_html_gz[] PROGMEM = {",
+        c_array(gz),
+        "};",
+        "static const size_t index_html_gz_len = sizeof(index_html_gz);",
+        "",
+    ])
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Compression des icônes OLED et de la page web")
+    ap.add_argument("--src", default=SRC, help="répertoire des sources (défaut : ../src)")
+    ap.add_argument("--check", action="store_true", help="vérifie seulement (1 si à régénérer)")
+    args = ap.parse_args()
+
+    packed = []
+    for name, w, h, raw in parse_icons(os.path.join(args.src, "icons.h")):
+        pages = to_pages(w, h, raw)
+        rle = rle_encode(pages)
+        if rle_decode(rle, len(pages)) != pages:
+            sys.exit("%s : aller-retour RLE incorrect" % name)
+        packed.append((name, w, h, raw, rle))
+
+    page = parse_page(os.path.join(args.src, "web_page.h"))
+    gz = gzip.compress(page, compresslevel=9, mtime=0)
+
+    # Bilan : flash avant / après (descripteur RleIcon compris), RAM du décodage
+    desc = 8   # RleIcon : w, h, size, pointeur (ESP32, 32 bits)
+    rows = [("ressource", "brut", "compressé", "gain")]
+    raw_total = packed_total = 0
+    for name, w, h, raw, rle in packed:
+        rows.append(("%s %dx%d" % (name, w, h), len(raw), len(rle) + desc))
+        raw_total += len(raw)
+        packed_total += len(rle) + desc
+    rows.append(("icônes", raw_total, packed_total))
+    rows.append(("index_html (gzip)", len(page) + 1, len(gz)))
+    rows.append(("total flash", raw_total + len(page) + 1, packed_total + len(gz)))
+    report = []
+    for r in rows:
+        if r[0] == "ressource":
+            report.append("%-22s %8s %10s %7s" % r)
+            continue
+        gain = "%.0f %%" % (100.0 * (1 - r[2] / r[1])) if r[1] else "-"
+        report.append("%-22s %8d %10d %7s" % (r[0], r[1], r[2], gain))
+    report.append("RAM : 0 octet de plus (décodage dans le tampon de %d octets de l'afficheur)" % OLED_BUFFER)
+
+    outputs = {
+        "icons_rle.h": icons_header(packed, report),
+        "web_page_gz.h": page_header(gz, len(page) + 1),
+    }
+    stale = []
+    for fname, content in outputs.items():
+        path = os.path.join(args.src, fname)
+        current = open(path, encoding="utf-8").read() if os.path.exists(path) else None
+        if current == content:
+            continue
+        stale.append(fname)
+        if not args.check:
+            with open(path, "w", encoding="utf-8") as f:
+                f.write(content)
+
+    print("\n".join(report))
+    if args.check:
+        for fname in stale:
+            print("à régénérer : src/" + fname, file=sys.stderr)
+        return 1 if stale else 0
+    for fname in stale:
+        print("écrit : src/" + fname, file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,296 @@
+#!/usr/bin/env python3
+"""
+Générateur de charge pour le serveur web de la Fontaine (ESP32 ou host/standin).
+
+Par palier : N clients SSE sur /events + R requêtes/s réparties sur / et /status,
+pendant que /metrics est relevé chaque seconde (courbe du tas).
+Rapport JSON comparable entre versions de firmware.
+
+  ./loadtest.py --target 127.0.0.1:8080 --sse 0,2,4,8 --rate 2,5,10 --label v1.3 -o v1.3.json
+  ./loadtest.py --compare v1.2.json v1.3.json
+
+Uniquement la bibliothèque standard Python (3.8+).
+"""
+import argparse
+import asyncio
+import itertools
+import json
+import sys
+import time
+
+PATHS = [("/", 1), ("/status", 3)]   # (chemin, poids) : le tableau de bord sonde /status
+TIMEOUT_S = 5.0
+
+
+def percentile(values, p):
+    if not values:
+        return None
+    s = sorted(values)
+    k = (len(s) - 1) * p / 100.0
+    lo, hi = int(k), min(int(k) + 1, len(s) - 1)
+    return s[lo] + (s[hi] - s[lo]) * (k - lo)
+
+
+async def http_get(host, port, path):
+    """GET simple, une connexion par requête (comme le navigateur vers l'ESP32)."""
+    t0 = time.perf_counter()
+    reader, writer = await asyncio.wait_for(asyncio.open_connection(host, port), TIMEOUT_S)
+    try:
+        writer.write(f"GET {path} HTTP/1.1\r\nHost: {host}\r\nConnection: close\r\n\r\n".encode())
+        await writer.drain()
+        status_line = await asyncio.wait_for(reader.readline(), TIMEOUT_S)
+        rest = await asyncio.wait_for(reader.read(), TIMEOUT_S)
+    finally:
+        writer.close()
+    parts = status_line.split()
+    code = int(parts[1]) if len(parts) > 1 else 0
+    body = rest.split(b"\r\n\r\n", 1)[-1]
+    return code, (time.perf_counter() - t0) * 1000.0, body
+
+
+class Stage:
+    def __init__(self, sse, rate):
+        self.sse = sse
+        self.rate = rate
+        self.lat = {p: [] for p, _ in PATHS}
+        self.err = {p: 0 for p, _ in PATHS}
+        self.sent = {p: 0 for p, _ in PATHS}
+        self.sse_ok = 0
+        self.sse_rejected = 0
+        self.sse_errors = 0
+        self.sse_events = 0
+        self.sse_gaps = []
+        self.heap = []        # (t_s, free, maxBlock, sseClients)
+
+    def report(self):
+        endpoints = {}
+        for p, _ in PATHS:
+            lat = self.lat[p]
+            n = self.sent[p]
+            endpoints[p] = {
+                "requests": n,
+                "errors": self.err[p],
+                "errorRate": round(self.err[p] / n, 4) if n else 0.0,
+                "p50Ms": _r(percentile(lat, 50)),
+                "p90Ms": _r(percentile(lat, 90)),
+                "p99Ms": _r(percentile(lat, 99)),
+                "maxMs": _r(max(lat) if lat else None),
+            }
+        frees = [h[1] for h in self.heap if h[1] is not None]
+        blocks = [h[2] for h in self.heap if h[2] is not None]
+        return {
+            "sseClients": self.sse,
+            "ratePerS": self.rate,
+            "endpoints": endpoints,
+            "sse": {
+                "connected": self.sse_ok,
+                "rejected": self.sse_rejected,
+                "errors": self.sse_errors,
+                "events": self.sse_events,
+                "gapP50Ms": _r(percentile(self.sse_gaps, 50)),
+                "gapP99Ms": _r(percentile(self.sse_gaps, 99)),
+            },
+            "heap": {
+                "minFree": min(frees) if frees else None,
+                "minMaxBlock": min(blocks) if blocks else None,
+                "maxBlockDrift": (blocks[-1] - blocks[0]) if len(blocks) > 1 else None,
+                "curve": self.heap,
+            },
+        }
+
+
+def _r(v):
+    return None if v is None else round(v, 2)
+
+
+async def sse_client(host, port, stage, stop):
+    try:
+        reader, writer = await asyncio.wait_for(asyncio.open_connection(host, port), TIMEOUT_S)
+    except (OSError, asyncio.TimeoutError):
+        stage.sse_errors += 1
+        return
+    try:
+        writer.write(f"GET /events HTTP/1.1\r\nHost: {host}\r\nAccept: text/event-stream\r\n\r\n".encode())
+        await writer.drain()
+        status_line = await asyncio.wait_for(reader.readline(), TIMEOUT_S)
+        parts = status_line.split()
+        if len(parts) < 2 or parts[1] != b"200":
+            if len(parts) > 1 and parts[1] == b"503":
+                stage.sse_rejected += 1
+            else:
+                stage.sse_errors += 1
+            return
+        stage.sse_ok += 1
+        last = None
+        while not stop.is_set():
+            line = await asyncio.wait_for(reader.readline(), 30.0)
+            if not line:
+                stage.sse_errors += 1   # fermé par l'appareil
+                return
+            if line.startswith(b"data:"):
+                now = time.perf_counter()
+                if last is not None:
+                    stage.sse_gaps.append((now - last) * 1000.0)
+                last = now
+                stage.sse_events += 1
+    except (OSError, asyncio.TimeoutError):
+        if not stop.is_set():
+            stage.sse_errors += 1
+    finally:
+        writer.close()
+
+
+async def one_request(host, port, path, stage, sem):
+    async with sem:
+        stage.sent[path] += 1
+        try:
+            code, ms, _ = await http_get(host, port, path)
+            if code == 200:
+                stage.lat[path].append(ms)
+            else:
+                stage.err[path] += 1
+        except (OSError, asyncio.TimeoutError, ValueError):
+            stage.err[path] += 1
+
+
+async def request_driver(host, port, stage, stop):
+    if stage.rate <= 0:
+        return
+    sem = asyncio.Semaphore(64)
+    weighted = list(itertools.chain.from_iterable([p] * w for p, w in PATHS))
+    period = 1.0 / stage.rate
+    tasks = []
+    nxt = time.perf_counter()
+    for path in itertools.cycle(weighted):
+        if stop.is_set():
+            break
+        tasks.append(asyncio.ensure_future(one_request(host, port, path, stage, sem)))
+        nxt += period                       # boucle ouverte : pas de ralentissement coordonné
+        await asyncio.sleep(max(0.0, nxt - time.perf_counter()))
+    await asyncio.gather(*tasks, return_exceptions=True)
+
+
+async def heap_poller(host, port, stage, stop, t0):
+    while not stop.is_set():
+        free = block = clients = None
+        try:
+            code, _, body = await http_get(host, port, "/metrics")
+            if code == 200:
+                m = json.loads(body.decode(errors="replace"))
+                free = m.get("heap", {}).get("free")
+                block = m.get("heap", {}).get("maxBlock")
+                clients = m.get("sse", {}).get("clients")
+        except (OSError, asyncio.TimeoutError, ValueError):
+            pass
+        stage.heap.append((round(time.perf_counter() - t0, 2), free, block, clients))
+        try:
+            await asyncio.wait_for(stop.wait(), 1.0)
+        except asyncio.TimeoutError:
+            pass
+
+
+async def run_stage(host, port, sse, rate, seconds, t0):
+    stage = Stage(sse, rate)
+    stop = asyncio.Event()
+    tasks = [asyncio.ensure_future(sse_client(host, port, stage, stop)) for _ in range(sse)]
+    tasks.append(asyncio.ensure_future(request_driver(host, port, stage, stop)))
+    tasks.append(asyncio.ensure_future(heap_poller(host, port, stage, stop, t0)))
+    await asyncio.sleep(seconds)
+    stop.set()
+    await asyncio.wait(tasks, timeout=TIMEOUT_S + 1)
+    for t in tasks:
+        t.cancel()
+    return stage
+
+
+def print_table(stages):
+    print(f"{'sse':>4} {'req/s':>6} | {'status p50':>10} {'p99':>8} {'err%':>6} | "
+          f"{'page p99':>8} | {'sse ok/rej':>10} {'gap p99':>8} | {'tas min':>8} {'bloc min':>8}")
+    for s in stages:
+        st = s["endpoints"]["/status"]
+        pg = s["endpoints"]["/"]
+        print(f"{s['sseClients']:>4} {s['ratePerS']:>6} | {_f(st['p50Ms']):>10} {_f(st['p99Ms']):>8} "
+              f"{100 * st['errorRate']:>6.1f} | {_f(pg['p99Ms']):>8} | "
+              f"{s['sse']['connected']:>4}/{s['sse']['rejected']:<5} {_f(s['sse']['gapP99Ms']):>8} | "
+              f"{_f(s['heap']['minFree']):>8} {_f(s['heap']['minMaxBlock']):>8}")
+
+
+def _f(v):
+    return "-" if v is None else (f"{v:.1f}" if isinstance(v, float) else str(v))
+
+
+def compare(a_path, b_path):
+    with open(a_path) as fa, open(b_path) as fb:
+        a, b = json.load(fa), json.load(fb)
+    print(f"A = {a['meta'].get('label')}  B = {b['meta'].get('label')}")
+    print(f"{'sse':>4} {'req/s':>6} | {'status p99 A':>12} {'B':>8} | {'err% A':>7} {'B':>6} | "
+          f"{'tas min A':>9} {'B':>8}")
+    for sa, sb in zip(a["stages"], b["stages"]):
+        xa, xb = sa["endpoints"]["/status"], sb["endpoints"]["/status"]
+        print(f"{sa['sseClients']:>4} {sa['ratePerS']:>6} | {_f(xa['p99Ms']):>12} {_f(xb['p99Ms']):>8} | "
+              f"{100 * xa['errorRate']:>7.1f} {100 * xb['errorRate']:>6.1f} | "
+              f"{_f(sa['heap']['minFree']):>9} {_f(sb['heap']['minFree']):>8}")
+    if len(a["stages"]) != len(b["stages"]):
+        print(f"(paliers différents : {len(a['stages'])} vs {len(b['stages'])})")
+
+
+async def main_async(args):
+    host, _, port = args.target.partition(":")
+    port = int(port or 80)
+    sse_steps = [int(x) for x in args.sse.split(",")]
+    rate_steps = [float(x) for x in args.rate.split(",")]
+    n = max(len(sse_steps), len(rate_steps))
+    sse_steps += [sse_steps[-1]] * (n - len(sse_steps))
+    rate_steps += [rate_steps[-1]] * (n - len(rate_steps))
+
+    t0 = time.perf_counter()
+    stages = []
+    failed_at = None
+    for sse, rate in zip(sse_steps, rate_steps):
+        print(f"palier : {sse} clients SSE, {rate} req/s, {args.stage_seconds} s", file=sys.stderr)
+        stage = (await run_stage(host, port, sse, rate, args.stage_seconds, t0)).report()
+        stages.append(stage)
+        st = stage["endpoints"]["/status"]
+        unreachable = stage["heap"]["minFree"] is None
+        if unreachable or (st["requests"] and st["errorRate"] > args.max_error_rate):
+            failed_at = {"sseClients": sse, "ratePerS": rate}
+            print("appareil saturé ou injoignable : arrêt de la rampe", file=sys.stderr)
+            break
+
+    return {
+        "meta": {
+            "label": args.label,
+            "target": args.target,
+            "date": time.strftime("%Y-%m-%dT%H:%M:%S"),
+            "stageSeconds": args.stage_seconds,
+            "failedAt": failed_at,
+        },
+        "stages": stages,
+    }
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--target", default="127.0.0.1:8080", help="hôte:port (ESP32 ou standin)")
+    ap.add_argument("--sse", default="0,1,2,4,8", help="clients SSE par palier")
+    ap.add_argument("--rate", default="2,2,5,5,10", help="requêtes/s par palier (/ et /status)")
+    ap.add_argument("--stage-seconds", type=float, default=20.0)
+    ap.add_argument("--max-error-rate", type=float, default=0.5)
+    ap.add_argument("--label", default="", help="version du firmware (pour --compare)")
+    ap.add_argument("-o", "--output", help="rapport JSON")
+    ap.add_argument("--compare", nargs=2, metavar=("A.json", "B.json"))
+    args = ap.parse_args()
+
+    if args.compare:
+        compare(*args.compare)
+        return
+
+    report = asyncio.run(main_async(args))
+    print_table(report["stages"])
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(report, f, indent=1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,289 @@
+/*
+  Rejeu déterministe d'une trace capteurs (/recording) à travers la logique de contrôle
+  - Même chaîne que le firmware : ranging.h -> calibration.h -> control.h
+  - Une ligne CSV par tick : niveau calculé et décisions des actionneurs
+  - --verify : compare l'état rejoué aux images clés enregistrées par la carte
+  - --diff   : compare les décisions de deux rejeux (deux versions du firmware)
+
+  Usage : ./replay fontaine.trc [-o decisions.csv] [--verify]
+          ./replay --diff avant.csv apres.csv
+*/
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "control.h"
+#include "ranging.h"
+#include "sensor_trace.h"
+
+// ===================== État rejoué =====================
+struct Replay {
+  ControlState st;
+  ControlParams p;
+  CalibrationTable calib, draft;
+  SensorHealthState health;
+  SensorHealthParams healthParams;
+  float distanceCm = 0, tempC = 0, humPct = 0;
+  float offsetCm = 0, heightCm = 0, capacityL = 0;   // géométrie (table par défaut)
+};
+
+static void loadKey(Replay& r, const TraceKeyframe& k) {
+  r.st = k.state;
+  r.p = k.params;
+  r.calib = k.calib;
+  r.draft = k.draft;
+  r.health = k.health;
+  r.healthParams = k.healthParams;
+  r.distanceCm = k.distanceCm;
+  r.tempC = k.tempC;
+  r.humPct = k.humPct;
+}
+
+// Miroir de applyCommand() (main.cpp) sans les E/S : EEPROM, relais, messages
+static void applyCommand(Replay& r, const TraceCommand& c) {
+  switch (c.type) {
+    case CMD_SET_MODE:
+      controlSetMode(r.st, (FountainMode)c.value, c.epoch);
+      break;
+    case CMD_SET_INTERVAL:
+      r.p.ecoDrainIntervalSec = drainIntervalSec(c.value, c.unit == 1);  // 1 = DRAIN_HOURS
+      break;
+    case CMD_DRAIN_START:
+      r.st.manualDrainActive = true;
+      break;
+    case CMD_DRAIN_STOP:
+      r.st.manualDrainActive = false;
+      break;
+    case CMD_CAL_CAPTURE:
+      r.draft.add(r.distanceCm, c.value / 100.0f);
+      break;
+    case CMD_CAL_SAVE:
+      if (!r.draft.valid()) break;
+      r.calib = r.draft;
+      controlUpdateThresholds(r.p, r.calib);
+      break;
+    case CMD_CAL_CLEAR:
+      r.draft.clear();
+      break;
+    case CMD_CAL_DEFAULT:
+      r.calib.setPrismatic(r.offsetCm, r.heightCm, r.capacityL);
+      controlUpdateThresholds(r.p, r.calib);
+      break;
+    case CMD_SCHED_EVENT:
+      controlScheduledEvent(r.st, (uint8_t)c.value);
+      break;
+    case CMD_SCHED_ADD:
+    case CMD_SCHED_DELETE:
+    case CMD_SCHED_ENABLE:
+      // Règles : sans effet direct, leurs échéances sont enregistrées (CMD_SCHED_EVENT)
+      break;
+    case CMD_SAFE_STOP:
+      r.st.safeStop = true;
+      break;
+    case CMD_ALERT_ACK:
+      r.st.safeStop = false;
+      break;
+    case CMD_PREFILL:
+      controlPrefill(r.st, c.epoch, c.value);
+      break;
+    default:
+      fprintf(stderr, "commande inconnue %u ignorée\n", c.type);
+  }
+}
+
+// Écarts entre l'état rejoué et une image clé de la carte (0 = identiques)
+static int compareKey(const Replay& r, const TraceKeyframe& k) {
+  const ControlState& a = r.st;
+  const ControlState& b = k.state;
+  int n = 0;
+  auto check = [&](const char* name, double x, double y) {
+    if (x == y) return;
+    if (n++ < 8) fprintf(stderr, "  t=%u ms %s : rejoué %.6g, carte %.6g\n", k.ms, name, x, y);
+  };
+  check("mode", a.mode, b.mode);
+  check("valve", a.valveOn, b.valveOn);
+  check("pump", a.pumpOn, b.pumpOn);
+  check("vout", a.voutOn, b.voutOn);
+  check("ecoInClosedPhase", a.ecoInClosedPhase, b.ecoInClosedPhase);
+  check("manualDrain", a.manualDrainActive, b.manualDrainActive);
+  check("drainDue", a.drainDue, b.drainDue);
+  check("refillActive", a.refillActive, b.refillActive);
+  check("quiet", a.quiet, b.quiet);
+  check("safeStop", a.safeStop, b.safeStop);
+  check("degraded", a.degraded, b.degraded);
+  check("health.level", r.health.level, k.health.level);
+  check("lastEV1OnTimestamp", a.lastEV1OnTimestamp, b.lastEV1OnTimestamp);
+  check("fillAllowedUntilMs", a.fillAllowedUntilMs, b.fillAllowedUntilMs);
+  check("prefillUntilEpoch", a.prefillUntilEpoch, b.prefillUntilEpoch);
+  check("distanceCm", r.distanceCm, k.distanceCm);
+  check("fillTargetL", r.p.fillTargetL, k.params.fillTargetL);
+  check("ecoDrainIntervalSec", r.p.ecoDrainIntervalSec, k.params.ecoDrainIntervalSec);
+  check("calib.count", r.calib.count(), k.calib.count());
+  return n;
+}
+
+static bool readFile(const char* path, std::vector<uint8_t>& out) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.insert(out.end(), buf, buf + n);
+  fclose(f);
+  return true;
+}
+
+static int replay(const char* tracePath, const char* outPath, bool verify) {
+  std::vector<uint8_t> data;
+  if (!readFile(tracePath, data)) { perror(tracePath); return 2; }
+  TraceReader reader;
+  if (!reader.open(data.data(), data.size())) {
+    fprintf(stderr, "%s : en-tête de trace invalide (version %d attendue)\n", tracePath, TRACE_VERSION);
+    return 2;
+  }
+  FILE* out = outPath ? fopen(outPath, "w") : stdout;
+  if (!out) { perror(outPath); return 2; }
+
+  Replay r;
+  r.offsetCm = reader.offsetCm;
+  r.heightCm = reader.heightCm;
+  r.capacityL = reader.capacityL;
+
+  fprintf(out, "ms,epoch,pir,distanceCm,litres,mode,valve,pump,vout,ecoClosed,manualDrain,drainDue,refill,quiet,sensor\n");
+  bool started = false;
+  uint32_t ticks = 0, commands = 0, gaps = 0, keys = 0, mismatches = 0;
+  uint32_t firstMs = 0, lastMs = 0;
+  uint32_t switches[3] = {0, 0, 0};   // vanne, pompe, vidange
+  char kind;
+  while ((kind = reader.next()) != 0) {
+    if (kind == '!') {
+      fprintf(stderr, "trace corrompue après %u ticks : arrêt\n", ticks);
+      break;
+    }
+    if (kind == TRACE_REC_KEY) {
+      keys++;
+      if (!started || reader.key.gap) {
+        if (started) {
+          gaps++;
+          fprintf(stderr, "rupture de trace à t=%u ms : état rechargé\n", reader.key.ms);
+        }
+        loadKey(r, reader.key);
+        started = true;
+      } else if (verify) {
+        int n = compareKey(r, reader.key);
+        if (n) mismatches++;
+      }
+      continue;
+    }
+    if (!started) continue;
+
+    if (kind == TRACE_REC_CMD) {
+      applyCommand(r, reader.cmd);
+      commands++;
+      continue;
+    }
+
+    // Tick : mêmes conversions que runLogic()
+    const TraceTick& t = reader.tick;
+    r.tempC = t.tempC;
+    r.humPct = t.humPct;
+    int valid = 0;
+    r.distanceCm = rangeFromEchoes(t.echoUs, t.nEcho, r.tempC, r.offsetCm, r.heightCm, r.distanceCm, &valid);
+    healthUpdate(r.health, r.healthParams, t.ms, valid, t.nEcho, r.distanceCm);
+    float levelL = r.calib.litresAt(r.distanceCm);
+    ControlState prev = r.st;
+    ControlInputs in = { t.ms, t.epoch, t.pir, levelL, healthTrusted(r.health) };
+    controlStep(r.st, r.p, in);
+    switches[0] += r.st.valveOn != prev.valveOn;
+    switches[1] += r.st.pumpOn != prev.pumpOn;
+    switches[2] += r.st.voutOn != prev.voutOn;
+
+    if (ticks == 0) firstMs = t.ms;
+    lastMs = t.ms;
+    ticks++;
+    fprintf(out, "%u,%u,%d,%.3f,%.3f,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n",
+            t.ms, t.epoch, t.pir ? 1 : 0, r.distanceCm, levelL, (int)r.st.mode,
+            r.st.valveOn, r.st.pumpOn, r.st.voutOn, r.st.ecoInClosedPhase, r.st.manualDrainActive,
+            r.st.drainDue, r.st.refillActive, r.st.quiet, r.health.level);
+  }
+  if (out != stdout) fclose(out);
+
+  fprintf(stderr, "%u ticks, %u commandes, %.1f s, %u blocs, %u ruptures\n",
+          ticks, commands, (lastMs - firstMs) / 1000.0, keys, gaps);
+  fprintf(stderr, "commutations : vanne %u, pompe %u, vidange %u\n", switches[0], switches[1], switches[2]);
+  if (verify) {
+    fprintf(stderr, "vérification : %u image(s) clé divergente(s) sur %u\n", mismatches, keys - gaps - (started ? 1 : 0));
+    return mismatches ? 1 : 0;
+  }
+  return 0;
+}
+
+// ===================== Comparaison de deux rejeux =====================
+struct Row {
+  std::string ms;
+  std::string decisions;   // colonnes mode..quiet
+  std::string line;
+};
+
+static bool readRows(const char* path, std::vector<Row>& rows) {
+  FILE* f = fopen(path, "r");
+  if (!f) { perror(path); return false; }
+  char line[256];
+  bool header = true;
+  while (fgets(line, sizeof(line), f)) {
+    if (header) { header = false; continue; }
+    line[strcspn(line, "\r\n")] = '\0';
+    // ms,epoch,pir,distanceCm,litres | mode,...
+    const char* p = line;
+    for (int i = 0; i < 5 && p; i++) { p = strchr(p, ','); if (p) p++; }
+    if (!p) continue;
+    rows.push_back({ std::string(line, strcspn(line, ",")), p, line });
+  }
+  fclose(f);
+  return true;
+}
+
+static int diff(const char* a, const char* b) {
+  std::vector<Row> ra, rb;
+  if (!readRows(a, ra) || !readRows(b, rb)) return 2;
+  size_t n = ra.size() < rb.size() ? ra.size() : rb.size();
+  size_t differ = 0, shown = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (ra[i].ms != rb[i].ms) {
+      fprintf(stderr, "ligne %zu : horodatages différents (%s / %s), traces différentes ?\n",
+              i + 2, ra[i].ms.c_str(), rb[i].ms.c_str());
+      return 2;
+    }
+    if (ra[i].decisions == rb[i].decisions) continue;
+    if (differ++ == 0) printf("# ms,epoch,pir,distanceCm,litres,mode,valve,pump,vout,ecoClosed,manualDrain,drainDue,refill,quiet,sensor\n");
+    if (shown < 20) {
+      printf("- %s\n+ %s\n", ra[i].line.c_str(), rb[i].line.c_str());
+      shown++;
+    }
+  }
+  if (ra.size() != rb.size()) printf("# longueurs différentes : %zu / %zu ticks\n", ra.size(), rb.size());
+  printf("# %zu tick(s) sur %zu avec des décisions différentes\n", differ, n);
+  return differ || ra.size() != rb.size() ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc == 4 && strcmp(argv[1], "--diff") == 0) return diff(argv[2], argv[3]);
+
+  const char* trace = nullptr;
+  const char* outPath = nullptr;
+  bool verify = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) outPath = argv[++i];
+    else if (strcmp(argv[i], "--verify") == 0) verify = true;
+    else if (!trace && argv[i][0] != '-') trace = argv[i];
+    else { trace = nullptr; break; }
+  }
+  if (!trace) {
+    fprintf(stderr, "usage : %s trace.trc [-o decisions.csv] [--verify]\n"
+                    "        %s --diff avant.csv apres.csv\n", argv[0], argv[0]);
+    return 2;
+  }
+  return replay(trace, outPath, verify);
+}
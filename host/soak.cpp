@@ -0,0 +1,352 @@
+/*
+  Endurance mémoire (soak) des chemins de réponse du firmware, sur le PC
+  - Allocateur instrumenté : malloc / calloc / realloc / free (et donc
+    new / delete) servis par un tas simulé de SOAK_HEAP octets, premier bloc
+    libre qui convient, voisins libres fusionnés à la libération -> la
+    fragmentation se lit comme sur l'ESP32 (ESP.getMaxAllocHeap())
+  - Chaque tour : un tick des modules (paramètres de module_params.h :
+    consommation, visites, usure, santé des capteurs, anomalies, écran,
+    vitesse de pompe, file MQTT, tâches), puis les réponses du firmware par
+    les mêmes fonctions : /status (buildStatusJson, status_view.h), /usage,
+    /visits, /wear, /pump, /jobs, /metrics (appendModuleMetrics) ; /status
+    publié en SSE (SseQueue, sse_queue.h) vers trois clients simulés :
+    rapide, lent (abandons), reconnecté toutes les 10 s
+  - Plus grand bloc libre et octets alloués relevés après une minute simulée
+    (tampons de stdio, statiques, trames SSE recyclées), puis comparés à
+    chaque tour : toute variation = échec (code de sortie 1), avec le tour
+    et les valeurs
+
+  Usage : ./soak [--iterations n]
+*/
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#include "fixed_string.h"
+#include "module_params.h"
+#include "status_view.h"
+#include "sse_queue.h"
+#include "control.h"
+#include "schedule.h"
+#include "anomaly.h"
+#include "sensor_health.h"
+#include "display_power.h"
+#include "consumption.h"
+#include "visit_model.h"
+#include "wear.h"
+#include "pump_control.h"
+#include "edf_scheduler.h"
+#include "mqtt_telemetry.h"
+
+// ===================== Tas simulé =====================
+// Blocs contigus : en-tête (taille utile, libre) puis données, alignés sur 16
+#define SOAK_HEAP   (2u << 20)   // large : runtime C++ et stdio y sont aussi servis
+#define SOAK_ALIGN  16
+
+struct HeapBlock {
+  size_t size;   // octets utiles, multiple de SOAK_ALIGN
+  size_t used;
+};
+
+alignas(SOAK_ALIGN) static uint8_t heapArena[SOAK_HEAP];
+static bool heapReady = false;
+static size_t heapUsed = 0;
+static uint32_t heapAllocs = 0;
+
+static HeapBlock* blockAt(size_t off) { return (HeapBlock*)(heapArena + off); }
+static size_t blockEnd(size_t off) { return off + sizeof(HeapBlock) + blockAt(off)->size; }
+
+static void heapInit() {
+  blockAt(0)->size = SOAK_HEAP - sizeof(HeapBlock);
+  blockAt(0)->used = 0;
+  heapReady = true;
+}
+
+static void heapFail(const char* msg) {
+  ssize_t w = write(2, msg, strlen(msg));
+  (void)w;
+  abort();
+}
+
+static bool inArena(const void* p) {
+  return (const uint8_t*)p >= heapArena + sizeof(HeapBlock) && (const uint8_t*)p < heapArena + SOAK_HEAP;
+}
+
+// Fusionne chaque bloc libre avec les libres qui le suivent
+static void heapCoalesce() {
+  for (size_t off = 0; off < SOAK_HEAP; off = blockEnd(off)) {
+    HeapBlock* b = blockAt(off);
+    if (b->used) continue;
+    while (blockEnd(off) < SOAK_HEAP && !blockAt(blockEnd(off))->used)
+      b->size += sizeof(HeapBlock) + blockAt(blockEnd(off))->size;
+  }
+}
+
+static size_t heapLargestFree() {
+  size_t best = 0;
+  for (size_t off = 0; off < SOAK_HEAP; off = blockEnd(off)) {
+    if (!blockAt(off)->used && blockAt(off)->size > best) best = blockAt(off)->size;
+  }
+  return best;
+}
+
+extern "C" {
+
+void* malloc(size_t n) {
+  if (!heapReady) heapInit();
+  size_t need = (n + SOAK_ALIGN - 1) / SOAK_ALIGN * SOAK_ALIGN;
+  if (need == 0) need = SOAK_ALIGN;
+  for (size_t off = 0; off < SOAK_HEAP; off = blockEnd(off)) {
+    HeapBlock* b = blockAt(off);
+    if (b->used || b->size < need) continue;
+    if (b->size >= need + sizeof(HeapBlock) + SOAK_ALIGN) {   // reste découpé en bloc libre
+      HeapBlock* rest = blockAt(off + sizeof(HeapBlock) + need);
+      rest->size = b->size - need - sizeof(HeapBlock);
+      rest->used = 0;
+      b->size = need;
+    }
+    b->used = 1;
+    heapUsed += b->size;
+    heapAllocs++;
+    return b + 1;
+  }
+  errno = ENOMEM;
+  return nullptr;
+}
+
+void free(void* p) {
+  if (!p || !inArena(p)) return;   // chargeur dynamique : pas dans le tas simulé
+  HeapBlock* b = (HeapBlock*)p - 1;
+  if (!b->used) heapFail("soak : double libération\n");
+  b->used = 0;
+  heapUsed -= b->size;
+  heapCoalesce();
+}
+
+void* calloc(size_t count, size_t size) {
+  if (size && count > (size_t)-1 / size) { errno = ENOMEM; return nullptr; }
+  void* p = malloc(count * size);
+  if (p) memset(p, 0, count * size);
+  return p;
+}
+
+void* realloc(void* p, size_t n) {
+  if (!p) return malloc(n);
+  if (n == 0) { free(p); return nullptr; }
+  size_t old = ((HeapBlock*)p - 1)->size;
+  if (old >= n) return p;
+  void* q = malloc(n);
+  if (!q) return nullptr;
+  memcpy(q, p, old);
+  free(p);
+  return q;
+}
+
+size_t malloc_usable_size(void* p) { return p && inArena(p) ? ((HeapBlock*)p - 1)->size : 0; }
+
+// Alignements au-delà de SOAK_ALIGN : jamais demandés par ce programme
+int posix_memalign(void** out, size_t align, size_t n) {
+  if (align > SOAK_ALIGN) heapFail("soak : alignement non pris en charge\n");
+  *out = malloc(n);
+  return *out ? 0 : ENOMEM;
+}
+void* aligned_alloc(size_t align, size_t n) {
+  if (align > SOAK_ALIGN) heapFail("soak : alignement non pris en charge\n");
+  return malloc(n);
+}
+void* memalign(size_t align, size_t n) { return aligned_alloc(align, n); }
+
+}  // extern "C"
+
+// ===================== Modules (paramètres de module_params.h) =====================
+static const uint32_t TICK_MS = 50;
+static const uint32_t EPOCH0 = 1790000000;   // 2026, heure valide
+static const uint32_t WARMUP = 1200;         // tours (1 min simulée) : files SSE et trames à leur maximum
+
+static uint32_t simMs = 0;
+static uint32_t simClock() { return simMs; }
+static uint32_t jobRuns = 0;
+static void countJob(const JobRun&) { jobRuns++; }
+
+static ControlState ctl = {};
+static Scheduler scheduler;
+static AnomalyDetector anomaly(ANOMALY_PARAMS);
+static SensorHealthState usHealth = {}, ahtHealth = {};
+static DisplayPower displayPower(DISPLAY_POWER);
+static ConsumptionMeter usage(PUMP_POWER_W);
+static VisitModel visits(VISIT_PARAMS);
+static WearCounter valveWear, pumpWear;
+static PumpSpeedController pumpSpeed(PUMP_SPEED, PUMP_HOLD_DEFAULT, PUMP_HOLD_SETPOINT);
+static EdfScheduler<10> jobs(simClock);
+static MqttOutbox<48> outbox;
+
+// ===================== Clients SSE =====================
+// Socket simulé : fenêtre d'envoi rouverte à chaque tour (ACK du client)
+struct SoakClient {
+  size_t window;       // octets acquittés par tour
+  size_t room;
+  size_t bytes;
+  size_t space() const { return room; }
+  size_t add(const char*, size_t n) { room -= n; bytes += n; return n; }
+  bool send() { return true; }
+  bool connected() const { return true; }
+};
+
+static SseQueue<SSE_MAX_CLIENTS, SSE_CLIENT_QUEUE, SSE_FRAME_BYTES, SoakClient> events;
+// Rapide, lent (abandons drop-oldest), et un tableau de bord qui se reconnecte
+static SoakClient sseClients[] = { { 5744, 0, 0 }, { 256, 0, 0 }, { 5744, 0, 0 } };
+static int sseSlots[3];
+
+// ===================== Réponses (status_view.h, comme main.cpp) =====================
+static StatusBuffer statusJson(uint32_t epoch, float levelPct, float litres) {
+  ChannelStatus channels[] = {
+    { "EV1", "latched", ctl.valveOn, false, valveWear.cycles() }, { "EV2", "latched", false, false, 0 },
+    { "pump", "pwm", ctl.pumpOn, false, pumpWear.cycles() }, { "EV_out", "relay", false, false, 0 }
+  };
+  StatusReadings r = {
+    simMs, epoch,
+    levelPct, 30.0f - levelPct / 5, litres, 12.0f, true,
+    21.5f, 48.0f,
+    3, "days"
+  };
+  return buildStatusJson(r, ctl, scheduler, anomaly, usHealth, usage, channels, 4);
+}
+
+static MetricsBuffer metricsJson() {
+  MetricsBuffer out;
+  out.appendf("{\"uptimeMs\":%u,\"heap\":{\"free\":%u,\"maxBlock\":%u},", (unsigned)simMs,
+              (unsigned)(SOAK_HEAP - heapUsed), (unsigned)heapLargestFree());
+  out.setLength(out.length() + events.printStats(out.data() + out.length(), out.remaining() + 1, simMs));
+  out.append(',');
+  appendModuleMetrics(out, simMs, anomaly, usHealth, ahtHealth, displayPower);
+  out.append(",\"mqtt\":{");
+  out.setLength(out.length() + outbox.printStats(out.data() + out.length(), out.remaining() + 1));
+  out.append("}}");
+  return out;
+}
+
+// Un tick de 50 ms, puis toutes les réponses ; somme des longueurs (gardée)
+static size_t step(uint32_t it) {
+  simMs = it * TICK_MS;
+  uint32_t epoch = EPOCH0 + simMs / 1000;
+  float phase = (it % 2400) / 2400.0f;
+  float levelPct = 40.0f + 30.0f * sinf(phase * 6.2831853f);
+  float litres = levelPct * 0.12f;
+  bool valve = levelPct < 35.0f;
+  bool pump = levelPct > 45.0f;
+  bool pir = (it / 400) % 2 == 0;
+
+  // État de contrôle : mode alterné toutes les 10 min (prochaine vidange : scheduler)
+  ctl.mode = (it / 12000) % 2 ? MODE_ECO_HYBRID : MODE_OPEN_CYCLE;
+  if (valve && !ctl.valveOn) ctl.lastValveOnMs = simMs;
+  if (pump && !ctl.pumpOn) ctl.lastPumpOnMs = simMs;
+  if (pir) ctl.lastPirDetectMs = simMs;
+  ctl.valveOn = valve;
+  ctl.pumpOn = pump;
+  ctl.pirState = pir;
+  if (it % 72000 == 0) scheduler.setIntervalDrain(epoch + 3600);
+
+  anomaly.update(simMs, litres, valve, pump, false);
+  healthUpdate(usHealth, ULTRASONIC_HEALTH, simMs, it % 7 ? 5 : 3, 5, 30.0f - levelPct / 5);
+  healthUpdate(ahtHealth, AHT_HEALTH, simMs, 1, 1, 21.5f + (it % 20) * 0.01f);
+  displayPower.update(simMs, pir, false);
+  float duty = pumpSpeed.update(pump, levelPct, litres, valve ? 0.8f : 0.0f, TICK_MS / 1000.0f);
+  usage.update(epoch, ctl.mode, valve, pump, duty, false, litres, true, TICK_MS);
+  if (pir && it % 400 == 0) visits.onDetect(epoch);
+  visits.update(epoch);
+  if (valveWear.check(valve, simMs) == WEAR_OK) valveWear.record(valve, simMs);
+  if (pumpWear.check(pump, simMs) == WEAR_OK) pumpWear.record(pump, simMs);
+  jobs.run();
+
+  FixedString<MQTT_PAYLOAD_MAX> payload;
+  payload.appendf("%.1f", levelPct);
+  outbox.push(it % 5, payload.c_str(), true, simMs);
+  MqttMessage m;
+  if (outbox.peek(m)) outbox.ack(m.seq, simMs + 3);
+
+  StatusBuffer status = statusJson(epoch, levelPct, litres);
+  size_t total = status.length();
+  // SSE : publication de /status, reconnexion périodique, fenêtres rouvertes puis remplies
+  events.publish("message", status.c_str(), simMs, simMs);
+  if (it % 200 == 100) {
+    events.detach(&sseClients[2]);
+    sseSlots[2] = events.reserve();
+    if (sseSlots[2] >= 0) events.attach((uint8_t)sseSlots[2], &sseClients[2]);
+  }
+  for (uint8_t c = 0; c < 3; c++) sseClients[c].room = sseClients[c].window;
+  for (uint8_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+    if (events.pending(i)) events.pump(i, simMs);
+  }
+
+  FixedString<2560> usageOut;
+  usage.printJson(usageOut);
+  total += usageOut.length();
+  FixedString<1792> visitsOut;
+  visitsOut.setLength(visits.printJson(visitsOut.data(), visitsOut.remaining() + 1));
+  total += visitsOut.length();
+  FixedString<1280> wearOut;
+  wearOut.append('[');
+  wearOut.setLength(wearOut.length() + valveWear.printJson(wearOut.data() + wearOut.length(), wearOut.remaining() + 1, "EV1", epoch));
+  wearOut.append(',');
+  wearOut.setLength(wearOut.length() + pumpWear.printJson(wearOut.data() + wearOut.length(), wearOut.remaining() + 1, "pump", epoch));
+  wearOut.append(']');
+  total += wearOut.length();
+  FixedString<256> pumpOut;
+  pumpOut.setLength(pumpSpeed.printJson(pumpOut.data(), pumpOut.remaining() + 1));
+  total += pumpOut.length();
+  FixedString<1536> jobsOut;
+  jobsOut.setLength(jobs.printJson(jobsOut.data(), jobsOut.remaining() + 1));
+  total += jobsOut.length();
+  total += metricsJson().length();
+  return total;
+}
+
+int main(int argc, char** argv) {
+  uint32_t iterations = 200000;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) iterations = (uint32_t)atol(argv[++i]);
+    else {
+      fprintf(stderr, "usage : %s [--iterations n]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (iterations < WARMUP + 1) iterations = WARMUP + 1;
+
+  valveWear.configure(VALVE_WEAR);
+  pumpWear.configure(PUMP_WEAR);
+  scheduler.start(EPOCH0);
+  jobs.every("logic", 50, OVERRUN_CATCH_UP, countJob, 0);
+  jobs.every("display", 200, OVERRUN_SKIP, countJob, 0);
+  jobs.every("publish", 1000, OVERRUN_COALESCE, countJob, 0);
+  for (uint8_t c = 0; c < 3; c++) {
+    sseSlots[c] = events.reserve();
+    events.attach((uint8_t)sseSlots[c], &sseClients[c]);
+  }
+  printf("soak : %u tours (%.1f h simulées), tas simulé de %u octets\n", (unsigned)iterations,
+         iterations * (double)TICK_MS / 3.6e6, (unsigned)SOAK_HEAP);
+  fflush(stdout);
+
+  // Chauffe : allocations uniques (stdio, statiques locales, trames SSE recyclées)
+  size_t bytes = 0;
+  for (uint32_t it = 0; it < WARMUP; it++) bytes += step(it);
+  const size_t refBlock = heapLargestFree(), refUsed = heapUsed;
+  const uint32_t refAllocs = heapAllocs;
+  for (uint32_t it = WARMUP; it < iterations; it++) {
+    bytes += step(it);
+    if (heapLargestFree() != refBlock || heapUsed != refUsed) {
+      fprintf(stderr, "ÉCHEC au tour %u : plus grand bloc libre %zu -> %zu, alloués %zu -> %zu\n",
+              (unsigned)it, refBlock, heapLargestFree(), refUsed, heapUsed);
+      return 1;
+    }
+  }
+  size_t sseBytes = 0;
+  for (uint8_t c = 0; c < 3; c++) sseBytes += sseClients[c].bytes;
+  printf("ok : plus grand bloc libre %zu octets, %zu alloués, stables sur %u tours\n",
+         refBlock, refUsed, (unsigned)(iterations - WARMUP));
+  printf("     %u allocations pendant la boucle, %.1f Mo de JSON produits, %.1f Mo remis aux clients SSE, %u tâches exécutées\n",
+         (unsigned)(heapAllocs - refAllocs), bytes / 1e6, sseBytes / 1e6, (unsigned)jobRuns);
+  return 0;
+}
@@ -0,0 +1,321 @@
+/*
+  Stand-in natif du serveur web de la Fontaine (pour host/loadtest.py)
+  - Même page (web_page.h) et même JSON (status_json.h) que le firmware
+  - Boucle poll() mono-tâche, comme la tâche async_tcp de l'ESP32
+  - /events : clients bornés, file drop-oldest par client (cf. sse_fanout.h)
+  - /metrics : tas "équivalent ESP32" = budget - octets alloués - coût par socket
+
+  Usage : ./standin [--port 8080] [--max-sse 4] [--queue 4] [--heap 180000] [--conn-cost 1600]
+*/
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "web_page.h"
+#include "status_json.h"
+#include "fixed_string.h"
+
+// ===================== Comptage du tas =====================
+static std::atomic<long> heapLive{0};
+
+void* operator new(size_t n) {
+  size_t* p = (size_t*)malloc(n + sizeof(size_t));
+  if (!p) throw std::bad_alloc();
+  *p = n;
+  heapLive += (long)n;
+  return p + 1;
+}
+void operator delete(void* q) noexcept {
+  if (!q) return;
+  size_t* p = (size_t*)q - 1;
+  heapLive -= (long)*p;
+  free(p);
+}
+void operator delete(void* q, size_t) noexcept { operator delete(q); }
+
+// ===================== Configuration =====================
+static int  cfgPort = 8080;
+static int  cfgMaxSse = 4;
+static int  cfgQueue = 4;
+static long cfgHeap = 180000;     // tas libre typique après WiFi + serveur
+static long cfgConnCost = 1600;   // pcb lwIP + AsyncClient + requête, par socket
+
+const uint32_t LOGIC_INTERVAL_MS = 50;
+const uint32_t SSE_INTERVAL_MS   = 3000;
+
+static uint32_t nowMs() {
+  using namespace std::chrono;
+  static const auto t0 = steady_clock::now();
+  return (uint32_t)duration_cast<milliseconds>(steady_clock::now() - t0).count();
+}
+
+// ===================== Appareil simulé =====================
+static float levelPct = 50.0f;
+static bool  pumpOn = true;
+static uint32_t publishedId = 0;
+
+static std::string statusJson() {
+  HmsString uptime = fmtHMS(nowMs() / 1000);
+  HmsString since = fmtHMS((nowMs() / 1000) % 97);
+  ChannelStatus channels[] = {
+    { "EV1", "latched", false, false, 0 }, { "EV2", "latched", false, false, 0 },
+    { "pump", "relay", pumpOn, false, 1 }, { "EV_out", "relay", false, false, 0 }
+  };
+  StatusSnapshot snap = {
+    (int)lroundf(levelPct), 2.0f + 9.1f * (1.0f - levelPct / 100.0f), 4.0f * levelPct / 100.0f, 4.0f, false,
+    21.5f, 48.0f,
+    false, false, pumpOn,
+    since.c_str(), "--:--:--", since.c_str(), uptime.c_str(),
+    1, false, 5, "days", "--:--:--", false,
+    "", 0.0f, false,
+    "ok", "00:00:00",
+    "\"today\":{\"fillL\":3.20,\"drainL\":2.95,\"fillLPerDay\":6.40,\"valveS\":410,\"valveN\":9,\"pumpS\":21600,"
+    "\"pumpN\":4,\"kWh\":0.036,\"drainS\":1800,\"drainN\":4,\"periodS\":43200},"
+    "\"open\":{\"fillL\":96.10,\"fillLPerDay\":7.02,\"kWh\":0.410,\"periodS\":1182600},"
+    "\"closed\":{\"fillL\":4.00,\"fillLPerDay\":0.31,\"kWh\":1.820,\"periodS\":1108800},"
+    "\"eco\":{\"fillL\":22.50,\"fillLPerDay\":1.95,\"kWh\":1.480,\"periodS\":997200}",
+    channels, 4
+  };
+  char buf[1536];
+  formatStatusJson(buf, sizeof(buf), snap);
+  return std::string(buf);
+}
+
+static void simTick(uint32_t t) {
+  levelPct = 50.0f + 40.0f * sinf(t / 60000.0f);
+}
+
+// ===================== Connexions =====================
+struct Conn {
+  int fd;
+  std::string in;
+  std::string out;       // réponse HTTP ordinaire
+  size_t outOff = 0;
+  bool sse = false;
+  std::deque<std::shared_ptr<const std::string>> frames;  // trames SSE partagées
+  size_t frameOff = 0;
+  uint32_t dropped = 0, sent = 0;
+  bool closeAfter = false;
+};
+
+static std::vector<std::unique_ptr<Conn>> conns;
+static std::shared_ptr<const std::string> latestFrame;
+static uint32_t sseRejected = 0, heapRejected = 0, requests = 0;
+static long heapMin = 1L << 30;
+
+static long heapFree() {
+  long f = cfgHeap - heapLive.load() - cfgConnCost * (long)conns.size();
+  return f > 0 ? f : 0;
+}
+
+static int sseCount() {
+  int n = 0;
+  for (auto& c : conns) if (c->sse) n++;
+  return n;
+}
+
+static std::string metricsJson() {
+  long freeB = heapFree();
+  if (freeB < heapMin) heapMin = freeB;   // min >= free dans la même réponse
+  char buf[512];
+  snprintf(buf, sizeof(buf),
+    "{\"uptimeMs\":%u,\"heap\":{\"free\":%ld,\"min\":%ld,\"maxBlock\":%ld},"
+    "\"sse\":{\"clients\":%d,\"max\":%d,\"queue\":%d,\"published\":%u,\"rejected\":%u},"
+    "\"http\":{\"requests\":%u,\"heapRejected\":%u,\"conns\":%zu}}",
+    nowMs(), freeB, heapMin, freeB, sseCount(), cfgMaxSse, cfgQueue, publishedId,
+    sseRejected, requests, heapRejected, conns.size());
+  return std::string(buf);
+}
+
+static void respond(Conn& c, int code, const char* type, const std::string& body) {
+  const char* reason = code == 200 ? "OK" : code == 404 ? "Not Found" : "Service Unavailable";
+  char head[256];
+  snprintf(head, sizeof(head),
+    "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+    code, reason, type, body.size());
+  c.out = std::string(head) + body;
+  c.closeAfter = true;
+}
+
+static void route(Conn& c) {
+  requests++;
+  size_t sp1 = c.in.find(' ');
+  size_t sp2 = c.in.find(' ', sp1 + 1);
+  std::string path = (sp1 == std::string::npos || sp2 == std::string::npos) ? "/" : c.in.substr(sp1 + 1, sp2 - sp1 - 1);
+  size_t q = path.find('?');
+  if (q != std::string::npos) path.resize(q);
+
+  if (path == "/") {
+    respond(c, 200, "text/html; charset=utf-8", index_html);
+  } else if (path == "/status") {
+    respond(c, 200, "application/json", statusJson());
+  } else if (path == "/metrics") {
+    respond(c, 200, "application/json", metricsJson());
+  } else if (path == "/events") {
+    if (sseCount() >= cfgMaxSse) {
+      sseRejected++;
+      respond(c, 503, "text/plain", "Trop de clients");
+      return;
+    }
+    c.sse = true;
+    c.out = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\nConnection: keep-alive\r\n\r\n";
+    if (latestFrame) c.frames.push_back(latestFrame);
+  } else {
+    respond(c, 404, "text/plain", "Not found");
+  }
+}
+
+static void publish() {
+  std::string json = statusJson();
+  char head[64];
+  snprintf(head, sizeof(head), "id: %u\nevent: message\ndata: ", nowMs());
+  latestFrame = std::make_shared<const std::string>(std::string(head) + json + "\n\n");
+  publishedId++;
+  for (auto& c : conns) {
+    if (!c->sse) continue;
+    if ((int)c->frames.size() >= cfgQueue) {
+      // drop-oldest, sauf la trame en cours d'envoi
+      auto victim = (c->frameOff > 0) ? c->frames.begin() + 1 : c->frames.begin();
+      if (victim == c->frames.begin()) c->frameOff = 0;
+      c->frames.erase(victim);
+      c->dropped++;
+    }
+    c->frames.push_back(latestFrame);
+  }
+}
+
+// Retourne false si la connexion doit être fermée
+static bool flush(Conn& c) {
+  while (c.outOff < c.out.size()) {
+    ssize_t w = send(c.fd, c.out.data() + c.outOff, c.out.size() - c.outOff, MSG_NOSIGNAL);
+    if (w < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+    c.outOff += (size_t)w;
+  }
+  if (c.closeAfter) return false;
+  while (!c.frames.empty()) {
+    const std::string& f = *c.frames.front();
+    ssize_t w = send(c.fd, f.data() + c.frameOff, f.size() - c.frameOff, MSG_NOSIGNAL);
+    if (w < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+    c.frameOff += (size_t)w;
+    if (c.frameOff < f.size()) break;
+    c.frames.pop_front();
+    c.frameOff = 0;
+    c.sent++;
+  }
+  return true;
+}
+
+static bool wantsWrite(const Conn& c) {
+  return c.outOff < c.out.size() || !c.frames.empty();
+}
+
+static void parseArgs(int argc, char** argv) {
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string k = argv[i];
+    long v = strtol(argv[i + 1], nullptr, 10);
+    if (k == "--port") cfgPort = (int)v;
+    else if (k == "--max-sse") cfgMaxSse = (int)v;
+    else if (k == "--queue") cfgQueue = (int)v;
+    else if (k == "--heap") cfgHeap = v;
+    else if (k == "--conn-cost") cfgConnCost = v;
+    else { fprintf(stderr, "option inconnue : %s\n", k.c_str()); exit(2); }
+  }
+}
+
+int main(int argc, char** argv) {
+  parseArgs(argc, argv);
+  signal(SIGPIPE, SIG_IGN);
+
+  int lfd = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons((uint16_t)cfgPort);
+  if (bind(lfd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(lfd, 64) < 0) {
+    perror("bind/listen");
+    return 1;
+  }
+  fcntl(lfd, F_SETFL, O_NONBLOCK);
+  printf("stand-in Fontaine sur http://127.0.0.1:%d (sse max %d, file %d, tas %ld)\n",
+         cfgPort, cfgMaxSse, cfgQueue, cfgHeap);
+  fflush(stdout);
+
+  uint32_t lastLogic = nowMs(), lastSse = nowMs();
+  std::vector<pollfd> pfds;
+  while (true) {
+    pfds.clear();
+    pfds.push_back({lfd, POLLIN, 0});
+    for (auto& c : conns) pfds.push_back({c->fd, (short)(POLLIN | (wantsWrite(*c) ? POLLOUT : 0)), 0});
+    poll(pfds.data(), pfds.size(), (int)LOGIC_INTERVAL_MS);
+
+    if (pfds[0].revents & POLLIN) {
+      int fd;
+      while ((fd = accept(lfd, nullptr, nullptr)) >= 0) {
+        if (heapFree() < cfgConnCost) {  // tas épuisé : l'ESP32 refuserait le pcb
+          heapRejected++;
+          close(fd);
+          continue;
+        }
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        auto c = std::make_unique<Conn>();
+        c->fd = fd;
+        conns.push_back(std::move(c));
+      }
+    }
+
+    for (size_t i = 1; i < pfds.size(); i++) {
+      Conn& c = *conns[i - 1];
+      bool keep = true;
+      if (pfds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+        char buf[1024];
+        ssize_t r = recv(c.fd, buf, sizeof(buf), 0);
+        if (r <= 0) keep = false;
+        else if (!c.sse && c.out.empty()) {
+          c.in.append(buf, (size_t)r);
+          if (c.in.find("\r\n\r\n") != std::string::npos) route(c);
+          else if (c.in.size() > 4096) keep = false;
+        }
+      }
+      if (keep) keep = flush(c);
+      if (!keep) {
+        close(c.fd);
+        c.fd = -1;
+      }
+    }
+    conns.erase(std::remove_if(conns.begin(), conns.end(),
+                               [](const std::unique_ptr<Conn>& c) { return c->fd < 0; }),
+                conns.end());
+
+    uint32_t now = nowMs();
+    if (now - lastLogic >= LOGIC_INTERVAL_MS) {
+      lastLogic = now;
+      simTick(now);
+    }
+    if (now - lastSse >= SSE_INTERVAL_MS) {
+      lastSse = now;
+      publish();
+      for (auto& c : conns) if (c->sse) flush(*c);
+    }
+    long f = heapFree();
+    if (f < heapMin) heapMin = f;
+  }
+}
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""
+Serveur HTTPS minimal pour les mesures TLS de la carte ([env:esp32bench], src/bench_main.cpp).
+
+Répond 200 à tout POST puis ferme la connexion : chaque envoi de la carte
+refait une poignée de main, complète (nouvelle instance) ou reprise (session
+gardée par TlsUploader). Tickets de session activés (défaut d'OpenSSL).
+Certificat auto-signé ECDSA P-256 (comme les serveurs Google) créé au premier
+lancement avec la commande openssl.
+
+  ./tls_standin.py --port 8443          # puis BENCH_TLS_URL="https://<ip du PC>:8443/bench"
+
+Uniquement la bibliothèque standard Python (3.8+) et la commande openssl.
+"""
+import argparse
+import os
+import socket
+import ssl
+import subprocess
+import sys
+import threading
+import time
+
+
+def ensure_cert(cert, key):
+    if os.path.exists(cert) and os.path.exists(key):
+        return
+    subprocess.run(["openssl", "req", "-x509", "-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:prime256v1",
+                    "-nodes", "-keyout", key, "-out", cert, "-days", "3650", "-subj", "/CN=fontaine-bench"],
+                   check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+
+def read_request(conn):
+    """En-têtes puis corps (Content-Length) ; None si la connexion se ferme avant."""
+    data = b""
+    while b"\r\n\r\n" not in data:
+        chunk = conn.recv(1024)
+        if not chunk:
+            return None
+        data += chunk
+    head, body = data.split(b"\r\n\r\n", 1)
+    length = 0
+    for line in head.split(b"\r\n")[1:]:
+        name, _, value = line.partition(b":")
+        if name.strip().lower() == b"content-length":
+            length = int(value)
+    while len(body) < length:
+        chunk = conn.recv(1024)
+        if not chunk:
+            return None
+        body += chunk
+    return head.split(b"\r\n", 1)[0], body
+
+
+def serve(conn, addr, stats):
+    t0 = time.perf_counter()
+    try:
+        req = read_request(conn)
+        if req is None:
+            return
+        reused = conn.session_reused
+        conn.sendall(b"HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 2\r\n"
+                     b"Connection: close\r\n\r\nok")
+        stats["resumed" if reused else "full"] += 1
+        print(f"{addr[0]} {req[0].decode(errors='replace')} {len(req[1])} o, "
+              f"{'reprise' if reused else 'complète'}, {conn.version()} {conn.cipher()[0]}, "
+              f"{(time.perf_counter() - t0) * 1000:.1f} ms", flush=True)
+    except (OSError, ssl.SSLError) as e:
+        print(f"{addr[0]} erreur : {e}", file=sys.stderr, flush=True)
+    finally:
+        try:
+            conn.unwrap()
+        except (OSError, ssl.SSLError):
+            pass
+        conn.close()
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--port", type=int, default=8443)
+    ap.add_argument("--cert", default="tls_standin.crt")
+    ap.add_argument("--key", default="tls_standin.key")
+    ap.add_argument("--tls12", action="store_true", help="limiter à TLS 1.2 (mbedTLS 2.x de la carte)")
+    args = ap.parse_args()
+
+    ensure_cert(args.cert, args.key)
+    ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    ctx.load_cert_chain(args.cert, args.key)
+    if args.tls12:
+        ctx.maximum_version = ssl.TLSVersion.TLSv1_2
+
+    stats = {"full": 0, "resumed": 0}
+    with socket.create_server(("0.0.0.0", args.port), reuse_port=False) as srv:
+        print(f"HTTPS sur le port {args.port} (Ctrl-C pour arrêter)", file=sys.stderr)
+        try:
+            while True:
+                raw, addr = srv.accept()
+                raw.settimeout(10)
+                try:
+                    conn = ctx.wrap_socket(raw, server_side=True)
+                except (OSError, ssl.SSLError) as e:
+                    print(f"{addr[0]} poignée de main refusée : {e}", file=sys.stderr, flush=True)
+                    raw.close()
+                    continue
+                threading.Thread(target=serve, args=(conn, addr, stats), daemon=True).start()
+        except KeyboardInterrupt:
+            print(f"\n{stats['full']} poignée(s) de main complète(s), {stats['resumed']} reprise(s)", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
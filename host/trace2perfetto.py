@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""
+Convertit la chronologie d'exécution de la carte (GET /trace, src/perf_trace.h)
+en JSON « Chrome trace » : ouvrir dans https://ui.perfetto.dev ou chrome://tracing.
+
+  curl -o fontaine.ptr http://192.168.1.40/trace
+  ./trace2perfetto.py fontaine.ptr -o fontaine.json
+
+Une piste par cœur et par groupe (boucle, réseau), les impulsions de vanne en
+intervalles asynchrones. Cycles -> µs par les repères (cycles, µs esp_timer,
+MHz) écrits chaque seconde sur chaque cœur ; les deux cœurs partagent donc la
+même horloge. Résumé sur la sortie d'erreur : durée max et moyenne par étape.
+
+Uniquement la bibliothèque standard Python (3.8+).
+"""
+import argparse
+import json
+import struct
+import sys
+
+PH_BEGIN, PH_END, PH_INSTANT, PH_ASYNC_BEGIN, PH_ASYNC_END = range(5)
+SYNC, SYNC_US = 0, 1
+GROUPS = {"L": "boucle", "N": "réseau", "A": "actionneurs"}
+RECORD = struct.Struct("<IBBH")
+
+
+def parse(data):
+    if data[:4] != b"PTR1":
+        raise ValueError("pas une trace /trace (en-tête PTR1 attendu)")
+    version, cores, rec_size, name_count = data[4:8]
+    if version != 1 or rec_size != RECORD.size:
+        raise ValueError(f"version {version} / enregistrement de {rec_size} octets non pris en charge")
+    pos = 8
+    names = []
+    for _ in range(name_count):
+        end = data.index(b"\0", pos + 1)
+        names.append((chr(data[pos]), data[pos + 1:end].decode("utf-8", "replace")))
+        pos = end + 1
+    per_core = []
+    for _ in range(cores):
+        (count,) = struct.unpack_from("<I", data, pos)
+        pos += 4
+        if len(data) < pos + count * RECORD.size:
+            raise ValueError("trace tronquée")
+        recs = [RECORD.unpack_from(data, pos + i * RECORD.size) for i in range(count)]
+        pos += count * RECORD.size
+        per_core.append(recs)
+    return names, per_core
+
+
+def timestamps(recs):
+    """µs (esp_timer) de chaque enregistrement, None avant tout repère."""
+    syncs = []   # (indice, cycles, µs déroulés, MHz)
+    wraps = 0
+    last_us = None
+    for i in range(len(recs) - 1):
+        cyc, ident, _, mhz = recs[i]
+        if ident != SYNC or recs[i + 1][1] != SYNC_US or mhz == 0:
+            continue
+        us = recs[i + 1][0]
+        if last_us is not None and us < last_us:
+            wraps += 1   # µs sur 32 bits : 71 min
+        last_us = us
+        syncs.append((i, cyc, us + (wraps << 32), mhz))
+    if not syncs:
+        return [None] * len(recs)
+    out = []
+    k = 0
+    for i, (cyc, _, _, _) in enumerate(recs):
+        while k + 1 < len(syncs) and syncs[k + 1][0] <= i:
+            k += 1
+        _, scyc, sus, mhz = syncs[k]
+        if i >= syncs[k][0]:
+            delta = (cyc - scyc) & 0xFFFFFFFF
+        else:   # avant le premier repère : compté à rebours
+            delta = -((scyc - cyc) & 0xFFFFFFFF)
+        out.append(sus + delta / mhz)
+    return out
+
+
+def convert(names, per_core):
+    events = []
+    tids = {}
+    stats = {}
+    t0 = None
+    timed = []
+    for core, recs in enumerate(per_core):
+        ts = timestamps(recs)
+        timed.append(list(zip(ts, recs)))
+        for t in ts:
+            if t is not None and (t0 is None or t < t0):
+                t0 = t
+    for core, rows in enumerate(timed):
+        open_scopes = {}
+        for t, (_, ident, phase, arg) in rows:
+            if t is None or ident in (SYNC, SYNC_US) or ident >= len(names):
+                continue
+            group, name = names[ident]
+            if group not in GROUPS:
+                continue
+            key = (core, group)
+            if key not in tids:
+                tids[key] = len(tids) + 1
+                events.append({"ph": "M", "pid": 1, "tid": tids[key], "name": "thread_name",
+                               "args": {"name": f"cœur {core} {GROUPS[group]}"}})
+            tid = tids[key]
+            ev = {"name": name, "pid": 1, "tid": tid, "ts": round(t - t0, 3)}
+            if phase == PH_BEGIN:
+                ev["ph"] = "B"
+                open_scopes.setdefault(tid, []).append((ident, t))
+            elif phase == PH_END:
+                stack = open_scopes.get(tid)
+                if not stack or stack[-1][0] != ident:
+                    continue   # début perdu (anneau recouvert)
+                _, start = stack.pop()
+                s = stats.setdefault(name, [0, 0.0, 0.0])
+                s[0] += 1
+                s[1] += t - start
+                s[2] = max(s[2], t - start)
+                ev["ph"] = "E"
+            elif phase == PH_INSTANT:
+                ev.update(ph="i", s="t")
+            elif phase in (PH_ASYNC_BEGIN, PH_ASYNC_END):
+                ev.update(ph="b" if phase == PH_ASYNC_BEGIN else "e", cat=GROUPS[group], id=arg)
+            else:
+                continue
+            if arg:
+                ev["args"] = {"arg": arg}
+            events.append(ev)
+    events.insert(0, {"ph": "M", "pid": 1, "name": "process_name", "args": {"name": "Fontaine"}})
+    return events, stats
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("trace", help="fichier de GET /trace")
+    ap.add_argument("-o", "--output", help="JSON (défaut : sortie standard)")
+    args = ap.parse_args()
+
+    with open(args.trace, "rb") as f:
+        try:
+            names, per_core = parse(f.read())
+        except (ValueError, struct.error) as e:
+            sys.exit(f"{args.trace} : {e}")
+    events, stats = convert(names, per_core)
+
+    doc = {"traceEvents": events, "displayTimeUnit": "ms"}
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(doc, f)
+    else:
+        json.dump(doc, sys.stdout)
+
+    for core, recs in enumerate(per_core):
+        print(f"cœur {core} : {len(recs)} enregistrements", file=sys.stderr)
+    print(f"{'étape':<16}{'n':>7}{'moy µs':>10}{'max µs':>10}", file=sys.stderr)
+    for name, (n, total, worst) in sorted(stats.items(), key=lambda kv: -kv[1][2]):
+        print(f"{name:<16}{n:>7}{total / n:>10.0f}{worst:>10.0f}", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,395 @@
+/*
+  Réglage des seuils de contrôle par balayage de paramètres
+  - Même décision que runLogic() : controlStep() de control.h, seuils en
+    litres par controlUpdateThresholds() (table prismatique de main.cpp)
+  - Bassin simulé : débits de remplissage et de rejet (pompe + EV_out),
+    évaporation, bruit de mesure, retard de fermeture de la vanne
+  - Visiteurs : arrivées aléatoires selon un profil horaire, PIR actif
+    pendant toute la visite ; la même suite de visites (et de bruit) pour
+    toutes les combinaisons, les écarts viennent donc des seuils seuls
+  - Score par combinaison : eau consommée (L/jour), cycles de relais
+    (passages à ON de EV1, pompe, EV_out par jour), marge avant débordement
+    (L libres au plus haut), attente des visiteurs (s avant que la
+    fontaine coule, la visite entière si elle ne coule pas)
+  - Combinaisons réparties sur tous les cœurs ; sortie : front de Pareto
+    (aucune autre combinaison meilleure ou égale sur tous les critères,
+    plus la plus longue période sans eau neuve qui départage l'éco)
+
+  Usage : ./tuner [--mode open|eco] [--days n] [--visits n/jour] [--seed n]
+                  [--threads n] [--tick-ms n] [--fill a:b:pas] [--on a:b:pas]
+                  [--off a:b:pas] [--hold a:b:pas] [--drain-hours a:b:pas]
+                  [--fill-lpm x] [--pump-lpm x] [-o front.csv] [--all tout.csv]
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "control.h"
+
+// ===================== Bassin et visiteurs =====================
+// Géométrie et réglages actuels de main.cpp
+static const float OFFSET_CM = 2.0f, HEIGHT_CM = 9.1f, CAPACITY_L = 4.0f;
+static const ControlParams FIRMWARE = { 90, 85, 25, 10, 5, 0, 0, 0, 0, 0, 3000, 5UL * 24UL * 3600UL, 30000, 600000 };
+static const uint32_t EPOCH0 = 1750032000;   // minuit UTC : le profil horaire part de 0 h
+
+struct Model {
+  float fillLpm = 2.0f;        // EV1 ouverte
+  float pumpLpm = 3.0f;        // pompe + EV_out (rejet du cycle ouvert, vidange)
+  float evapLPerDay = 0.05f;
+  float noiseL = 0.03f;        // bruit de mesure (± litres)
+  uint32_t valveLagMs = 300;   // fermeture effective de EV1 après la décision
+  uint32_t tickMs = 250;
+};
+
+// Visite : PIR actif de start à start + dur (secondes depuis le début)
+struct Visit {
+  uint32_t start, dur;
+};
+
+// Générateur reproductible (même suite pour toutes les combinaisons)
+struct Lcg {
+  uint32_t s;
+  explicit Lcg(uint32_t seed) : s(seed) {}
+  uint32_t next() { s = s * 1664525u + 1013904223u; return s >> 8; }
+  float uniform(float lo, float hi) { return lo + (hi - lo) * (next() & 0xFFFF) / 65535.0f; }
+};
+
+// Poids relatifs des arrivées par heure : matin et fin de journée chargés, nuit calme
+static const float HOURLY[24] = {
+  0.05f, 0.05f, 0.05f, 0.05f, 0.05f, 0.2f, 0.6f, 1.5f, 2.0f, 1.2f, 0.8f, 0.8f,
+  1.0f, 0.8f, 0.6f, 0.6f, 0.8f, 1.5f, 2.0f, 1.8f, 1.2f, 0.6f, 0.2f, 0.1f
+};
+
+static std::vector<Visit> buildVisits(int days, float perDay, uint32_t seed) {
+  float total = 0;
+  for (float w : HOURLY) total += w;
+  Lcg rng(seed);
+  std::vector<Visit> visits;
+  uint32_t busyUntil = 0;
+  for (int d = 0; d < days; d++) {
+    for (int h = 0; h < 24; h++) {
+      // Bernoulli par seconde : taux horaire perDay * poids / total
+      float p = perDay * HOURLY[h] / total / 3600.0f;
+      for (uint32_t s = 0; s < 3600; s++) {
+        uint32_t t = (d * 24 + h) * 3600u + s;
+        if (t < busyUntil || rng.uniform(0, 1) >= p) continue;
+        uint32_t dur = 10 + rng.next() % 81;   // 10 à 90 s
+        visits.push_back({ t, dur });
+        busyUntil = t + dur + 5;
+      }
+    }
+  }
+  return visits;
+}
+
+// ===================== Simulation =====================
+struct Candidate {
+  uint8_t fillPct, onPct, offPct;
+  uint16_t holdS;
+  uint16_t drainH;   // éco : heures de cycle fermé avant vidange
+};
+
+struct Score {
+  float waterLPerDay;
+  float cyclesPerDay;
+  float marginL;     // litres libres au plus haut niveau atteint
+  float overflowL;   // litres perdus par débordement
+  float waitS;       // attente moyenne par visite
+  float missedPct;   // visites terminées sans que la fontaine coule
+  float staleH;      // plus longue période sans eau neuve (éco : intervalle réel)
+};
+
+struct Setup {
+  FountainMode mode;
+  int days;
+  Model model;
+  uint32_t seed;
+  const std::vector<Visit>* visits;
+  CalibrationTable calib;
+};
+
+static ControlParams paramsFor(const Candidate& c, const Setup& su) {
+  ControlParams p = FIRMWARE;
+  p.fillTargetPct = c.fillPct;
+  p.pumpOnAbovePct = c.onPct;
+  p.pumpOffBelowPct = c.offPct;
+  p.motionHoldMs = c.holdS * 1000UL;
+  p.ecoDrainIntervalSec = c.drainH * 3600UL;
+  controlUpdateThresholds(p, su.calib);
+  return p;
+}
+
+static Score simulate(const Candidate& c, const Setup& su) {
+  const Model& m = su.model;
+  const ControlParams p = paramsFor(c, su);
+  const float dtMin = m.tickMs / 60000.0f;
+  const uint32_t lagTicks = std::min<uint32_t>(31, m.valveLagMs / m.tickMs);
+  const uint64_t ticks = (uint64_t)su.days * 86400000ULL / m.tickMs;
+  const std::vector<Visit>& visits = *su.visits;
+
+  ControlState st = {};
+  controlSetMode(st, su.mode, EPOCH0);
+  Lcg rng(su.seed ^ 0x9E3779B9u);
+  float level = CAPACITY_L * p.pumpOffBelowPct / 100.0f;
+  float maxLevel = level, waterL = 0, overflowL = 0;
+  uint32_t valveHist = 0, cycles = 0;
+  double waitS = 0;
+  uint32_t missed = 0;
+  uint64_t lastFreshMs = 0, staleMs = 0;
+  size_t next = 0, seen = SIZE_MAX;
+  int64_t pendingSinceMs = -1;   // visite en cours sans fontaine
+
+  for (uint64_t i = 1; i <= ticks; i++) {
+    uint64_t ms = i * m.tickMs;
+    uint32_t sec = (uint32_t)(ms / 1000);
+    uint32_t epoch = EPOCH0 + sec;
+    while (next < visits.size() && visits[next].start + visits[next].dur <= sec) {
+      if (pendingSinceMs >= 0) {   // partie sans avoir vu la fontaine couler
+        waitS += visits[next].dur;
+        missed++;
+      }
+      pendingSinceMs = -1;
+      next++;
+    }
+    bool pir = next < visits.size() && visits[next].start <= sec;
+    if (pir && seen != next) {
+      seen = next;
+      pendingSinceMs = ms;
+    }
+
+    // Programmation de l'intervalle éco (rearmIntervalDrain de main.cpp)
+    if (st.mode == MODE_ECO_HYBRID && st.ecoInClosedPhase && !st.drainDue &&
+        epoch - st.lastEV1OnTimestamp >= p.ecoDrainIntervalSec) {
+      controlScheduledEvent(st, SCHED_EV_DRAIN);
+    }
+
+    bool prevValve = st.valveOn, prevPump = st.pumpOn, prevVout = st.voutOn;
+    ControlInputs in = { (uint32_t)ms, epoch, pir, level + rng.uniform(-m.noiseL, m.noiseL), true };
+    controlStep(st, p, in);
+    cycles += (st.valveOn && !prevValve) + (st.pumpOn && !prevPump) + (st.voutOn && !prevVout);
+
+    if (pendingSinceMs >= 0 && st.pumpOn) {
+      waitS += (ms - pendingSinceMs) / 1000.0;
+      pendingSinceMs = -1;   // servie
+    }
+
+    // Bassin : la vanne suit la décision avec lagTicks de retard
+    valveHist = (valveHist << 1) | st.valveOn;
+    if ((valveHist >> lagTicks) & 1) {
+      lastFreshMs = ms;
+      level += m.fillLpm * dtMin;
+      waterL += m.fillLpm * dtMin;
+    }
+    if (st.pumpOn && st.voutOn) level -= m.pumpLpm * dtMin;
+    level -= m.evapLPerDay * dtMin / 1440.0f;
+    if (level > CAPACITY_L) {
+      overflowL += level - CAPACITY_L;
+      level = CAPACITY_L;
+    }
+    if (level < 0) level = 0;
+    maxLevel = std::max(maxLevel, level);
+    staleMs = std::max(staleMs, ms - lastFreshMs);
+  }
+
+  Score s;
+  s.waterLPerDay = waterL / su.days;
+  s.cyclesPerDay = (float)cycles / su.days;
+  s.marginL = CAPACITY_L - maxLevel;
+  s.overflowL = overflowL;
+  s.waitS = next ? waitS / next : 0;
+  s.missedPct = next ? 100.0f * missed / next : 0;
+  s.staleH = staleMs / 3600000.0f;
+  return s;
+}
+
+// ===================== Front de Pareto =====================
+// Critères à minimiser : eau, cycles, -marge, attente, eau stagnante. Le dernier
+// équilibre l'éco (sinon l'intervalle le plus long gagne toujours) ; en cycle
+// ouvert il suit les visites et départage rarement.
+static bool dominates(const Score& a, const Score& b) {
+  const float av[] = { a.waterLPerDay, a.cyclesPerDay, -a.marginL, a.waitS, a.staleH };
+  const float bv[] = { b.waterLPerDay, b.cyclesPerDay, -b.marginL, b.waitS, b.staleH };
+  bool better = false;
+  for (int k = 0; k < 5; k++) {
+    if (av[k] > bv[k]) return false;
+    if (av[k] < bv[k]) better = true;
+  }
+  return better;
+}
+
+static std::vector<bool> paretoFront(const std::vector<Score>& scores) {
+  std::vector<bool> front(scores.size(), true);
+  for (size_t i = 0; i < scores.size(); i++) {
+    for (size_t j = 0; j < scores.size() && front[i]; j++) {
+      if (j != i && dominates(scores[j], scores[i])) front[i] = false;
+    }
+  }
+  return front;
+}
+
+// ===================== Balayage =====================
+struct Range {
+  int from, to, step;
+};
+
+static bool parseRange(const char* s, Range& r) {
+  int n = sscanf(s, "%d:%d:%d", &r.from, &r.to, &r.step);
+  if (n == 1) { r.to = r.from; r.step = 1; }
+  else if (n == 2) r.step = 1;
+  else if (n != 3) return false;
+  return r.step > 0 && r.from <= r.to && r.from >= 0;
+}
+
+static std::vector<Candidate> buildCandidates(FountainMode mode, const Range& fill, const Range& on,
+                                              const Range& off, const Range& hold, const Range& drainH) {
+  std::vector<Candidate> out;
+  for (int f = fill.from; f <= fill.to && f <= 100; f += fill.step) {
+    if (mode == MODE_ECO_HYBRID) {   // éco : seuls l'objectif et l'intervalle comptent
+      for (int d = drainH.from; d <= drainH.to; d += drainH.step) {
+        if (d > 0) out.push_back({ (uint8_t)f, FIRMWARE.pumpOnAbovePct, FIRMWARE.pumpOffBelowPct, 3, (uint16_t)d });
+      }
+      continue;
+    }
+    for (int a = on.from; a <= on.to && a <= f; a += on.step) {       // pompe : démarre sous l'objectif
+      for (int b = off.from; b <= off.to && b < a; b += off.step) {
+        for (int h = hold.from; h <= hold.to; h += hold.step) {
+          out.push_back({ (uint8_t)f, (uint8_t)a, (uint8_t)b, (uint16_t)h, 120 });
+        }
+      }
+    }
+  }
+  return out;
+}
+
+static void writeCsv(FILE* f, const std::vector<Candidate>& cands, const std::vector<Score>& scores,
+                     const std::vector<bool>& front, bool frontOnly) {
+  fprintf(f, "fill_pct,pump_on_pct,pump_off_pct,hold_s,drain_h,water_l_day,relay_cycles_day,"
+             "margin_l,overflow_l,wait_mean_s,missed_pct,stale_h,pareto\n");
+  for (size_t i = 0; i < cands.size(); i++) {
+    if (frontOnly && !front[i]) continue;
+    const Candidate& c = cands[i];
+    const Score& s = scores[i];
+    fprintf(f, "%u,%u,%u,%u,%u,%.3f,%.1f,%.3f,%.3f,%.1f,%.1f,%.1f,%d\n", c.fillPct, c.onPct, c.offPct,
+            c.holdS, c.drainH, s.waterLPerDay, s.cyclesPerDay, s.marginL, s.overflowL, s.waitS,
+            s.missedPct, s.staleH, front[i] ? 1 : 0);
+  }
+}
+
+static void printRow(const char* tag, const Candidate& c, const Score& s) {
+  printf("%-8s %4u %4u %4u %5u %6u %9.2f %9.1f %8.3f %8.1f %7.1f %7.1f\n", tag, c.fillPct, c.onPct, c.offPct,
+         c.holdS, c.drainH, s.waterLPerDay, s.cyclesPerDay, s.marginL, s.waitS, s.missedPct, s.staleH);
+}
+
+int main(int argc, char** argv) {
+  Setup su;
+  su.mode = MODE_OPEN_CYCLE;
+  su.days = 7;
+  su.seed = 1;
+  float perDay = 40;
+  unsigned threads = std::thread::hardware_concurrency();
+  Range fill = { 70, 95, 5 }, on = { 50, 95, 5 }, off = { 10, 60, 5 }, hold = { 1, 31, 5 }, drainH = { 24, 240, 24 };
+  const char* outPath = nullptr;
+  const char* allPath = nullptr;
+  bool ok = true;
+  for (int i = 1; i < argc && ok; i++) {
+    const char* a = argv[i];
+    const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!v) ok = false;
+    else if (strcmp(a, "--mode") == 0) {
+      if (strcmp(v, "open") == 0) su.mode = MODE_OPEN_CYCLE;
+      else if (strcmp(v, "eco") == 0) su.mode = MODE_ECO_HYBRID;
+      else ok = false;
+    }
+    else if (strcmp(a, "--days") == 0) ok = (su.days = atoi(v)) > 0 && su.days <= 45;   // ms sur 32 bits
+    else if (strcmp(a, "--visits") == 0) ok = (perDay = atof(v)) >= 0;
+    else if (strcmp(a, "--seed") == 0) su.seed = strtoul(v, nullptr, 0);
+    else if (strcmp(a, "--threads") == 0) ok = (threads = atoi(v)) > 0;
+    else if (strcmp(a, "--tick-ms") == 0) ok = (su.model.tickMs = atoi(v)) >= 10;
+    else if (strcmp(a, "--fill-lpm") == 0) ok = (su.model.fillLpm = atof(v)) > 0;
+    else if (strcmp(a, "--pump-lpm") == 0) ok = (su.model.pumpLpm = atof(v)) > 0;
+    else if (strcmp(a, "--fill") == 0) ok = parseRange(v, fill);
+    else if (strcmp(a, "--on") == 0) ok = parseRange(v, on);
+    else if (strcmp(a, "--off") == 0) ok = parseRange(v, off);
+    else if (strcmp(a, "--hold") == 0) ok = parseRange(v, hold);
+    else if (strcmp(a, "--drain-hours") == 0) ok = parseRange(v, drainH);
+    else if (strcmp(a, "-o") == 0) outPath = v;
+    else if (strcmp(a, "--all") == 0) allPath = v;
+    else ok = false;
+    i++;
+  }
+  if (!ok) {
+    fprintf(stderr, "usage : %s [--mode open|eco] [--days n] [--visits n/jour] [--seed n]\n"
+                    "          [--threads n] [--tick-ms n] [--fill a:b:pas] [--on a:b:pas]\n"
+                    "          [--off a:b:pas] [--hold a:b:pas] [--drain-hours a:b:pas]\n"
+                    "          [--fill-lpm x] [--pump-lpm x] [-o front.csv] [--all tout.csv]\n", argv[0]);
+    return 2;
+  }
+  if (threads == 0) threads = 1;
+
+  su.calib.setPrismatic(OFFSET_CM, HEIGHT_CM, CAPACITY_L);
+  std::vector<Visit> visits = buildVisits(su.days, perDay, su.seed);
+  su.visits = &visits;
+
+  // Référence : réglages actuels du firmware, évalués en tête de liste
+  std::vector<Candidate> cands;
+  cands.push_back({ FIRMWARE.fillTargetPct, FIRMWARE.pumpOnAbovePct, FIRMWARE.pumpOffBelowPct,
+                    (uint16_t)(FIRMWARE.motionHoldMs / 1000), (uint16_t)(FIRMWARE.ecoDrainIntervalSec / 3600) });
+  std::vector<Candidate> grid = buildCandidates(su.mode, fill, on, off, hold, drainH);
+  cands.insert(cands.end(), grid.begin(), grid.end());
+  if (cands.size() == 1) {
+    fprintf(stderr, "aucune combinaison valide (pompe ON <= objectif, pompe OFF < pompe ON)\n");
+    return 2;
+  }
+  threads = std::min<unsigned>(threads, cands.size());
+
+  // Répartition dynamique : chaque fil prend la combinaison suivante
+  std::vector<Score> scores(cands.size());
+  std::atomic<size_t> nextCand{0};
+  auto t0 = std::chrono::steady_clock::now();
+  std::vector<std::thread> pool;
+  for (unsigned t = 0; t < threads; t++) {
+    pool.emplace_back([&] {
+      for (size_t i; (i = nextCand.fetch_add(1)) < cands.size();) scores[i] = simulate(cands[i], su);
+    });
+  }
+  for (std::thread& th : pool) th.join();
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  std::vector<bool> front = paretoFront(scores);
+  std::vector<size_t> order;
+  for (size_t i = 1; i < cands.size(); i++) {
+    if (front[i]) order.push_back(i);
+  }
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return scores[a].waterLPerDay < scores[b].waterLPerDay; });
+
+  fprintf(stderr, "%zu combinaisons x %d jours, %zu visites, %u fils : %.1f s\n",
+          cands.size(), su.days, visits.size(), threads, wall);
+  printf("%-8s %4s %4s %4s %5s %6s %9s %9s %8s %8s %7s %7s\n", "", "fill", "on", "off", "hold", "drainH",
+         "eau L/j", "cycles/j", "marge L", "att. s", "rate %", "stag. h");
+  printRow(front[0] ? "actuel*" : "actuel", cands[0], scores[0]);
+  for (size_t i : order) printRow("pareto", cands[i], scores[i]);
+  size_t better = 0;
+  for (size_t i : order) better += dominates(scores[i], scores[0]);
+  fprintf(stderr, "front : %zu combinaisons, dont %zu meilleures que les réglages actuels sur tous les critères\n",
+          order.size(), better);
+
+  if (outPath) {
+    FILE* f = fopen(outPath, "w");
+    if (!f) { perror(outPath); return 2; }
+    writeCsv(f, cands, scores, front, true);
+    fclose(f);
+  }
+  if (allPath) {
+    FILE* f = fopen(allPath, "w");
+    if (!f) { perror(allPath); return 2; }
+    writeCsv(f, cands, scores, front, false);
+    fclose(f);
+  }
+  return 0;
+}
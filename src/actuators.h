@@ -0,0 +1,238 @@
+#pragma once
+/*
+  Couche actionneurs : une classe par famille, brochage en paramètres de template
+  - LatchedValve : électrovanne bistable sur pont en H (TB6612 : IN1/IN2 + PWM),
+    impulsion NON bloquante (update() la termine), position mémorisée
+  - Relay : relais tout-ou-rien, polarité (ACTIVE_LOW) fixée à la compilation
+  - PwmOutput : sortie LEDC, set(true) = plein rapport cyclique, rampe de
+    démarrage optionnelle (RAMP_MS) menée par update()
+  - Guarded<Ch> : voie avec compteur d'usure (wear.h), durées minimales et
+    commutations par heure appliquées aux décisions de la logique (request())
+  - ActuatorBank<Ch...> : N voies dans un tuple, parcourues par dépliage de
+    pack -> ni appel virtuel ni table de broches en RAM, chaque écriture de
+    broche est résolue à la compilation
+  Interface commune des voies : begin(), set(on, nowMs), update(nowMs), on(),
+  busy() (impulsion ou rampe en cours), switches() (commutations depuis le démarrage)
+  Impulsions tracées en asynchrone (perf_trace.h, arg = broche IN1)
+*/
+#include <Arduino.h>
+#include <tuple>
+#include <utility>
+#include "perf_trace.h"
+#include "wear.h"
+
+template<int IN1, int IN2, int EN, uint16_t PULSE_MS>
+class LatchedValve {
+public:
+  static const char* kind() { return "latched"; }
+
+  // Broches au repos puis impulsion de fermeture complète (position inconnue au démarrage)
+  void begin() {
+    pinMode(IN1, OUTPUT);
+    pinMode(IN2, OUTPUT);
+    pinMode(EN, OUTPUT);
+    idle();
+    set(false, millis());
+    finish();
+  }
+
+  // Toujours une impulsion, même sans changement : refermer une vanne
+  // restée ouverte mécaniquement (arrêt de sécurité)
+  void set(bool open, uint32_t nowMs) {
+    if (_pulsing) PERF_ASYNC_END(PERF_VALVE_PULSE, IN1);
+    digitalWrite(EN, LOW);   // changement de sens pendant une impulsion : pont coupé d'abord
+    digitalWrite(IN1, open ? HIGH : LOW);
+    digitalWrite(IN2, open ? LOW : HIGH);
+    digitalWrite(EN, HIGH);
+    _pulseStartMs = nowMs;
+    _pulsing = true;
+    PERF_ASYNC_BEGIN(PERF_VALVE_PULSE, IN1);
+    if (_known && open != _on) _switches++;
+    _on = open;
+    _known = true;
+  }
+
+  void update(uint32_t nowMs) {
+    if (_pulsing && nowMs - _pulseStartMs >= PULSE_MS) idle();
+  }
+
+  // Termine l'impulsion en cours (bloquant, PULSE_MS au plus) : avant un redémarrage
+  void finish() {
+    while (_pulsing) {
+      delay(1);
+      update(millis());
+    }
+  }
+
+  bool on() const { return _on; }
+  bool busy() const { return _pulsing; }
+  uint32_t switches() const { return _switches; }
+
+private:
+  void idle() {
+    digitalWrite(EN, LOW);
+    digitalWrite(IN1, LOW);
+    digitalWrite(IN2, LOW);
+    if (_pulsing) PERF_ASYNC_END(PERF_VALVE_PULSE, IN1);
+    _pulsing = false;
+  }
+
+  bool _on = false, _known = false;
+  volatile bool _pulsing = false;
+  uint32_t _pulseStartMs = 0;
+  uint32_t _switches = 0;
+};
+
+template<int PIN, bool ACTIVE_LOW>
+class Relay {
+public:
+  static const char* kind() { return "relay"; }
+
+  void begin() {
+    pinMode(PIN, OUTPUT);
+    write(false);
+  }
+
+  void set(bool on, uint32_t) {
+    if (on != _on) _switches++;
+    _on = on;
+    write(on);
+  }
+
+  void update(uint32_t) {}
+  void finish() {}
+  bool on() const { return _on; }
+  bool busy() const { return false; }
+  uint32_t switches() const { return _switches; }
+
+private:
+  static void write(bool on) { digitalWrite(PIN, on != ACTIVE_LOW ? HIGH : LOW); }
+
+  bool _on = false;
+  uint32_t _switches = 0;
+};
+
+// RAMP_MS : durée d'une rampe 0 -> plein rapport cyclique (démarrage progressif,
+// changements de vitesse lissés par update()) ; l'arrêt est immédiat
+template<int PIN, uint8_t CHANNEL, uint32_t FREQ_HZ, uint8_t BITS, uint16_t RAMP_MS = 0>
+class PwmOutput {
+public:
+  static const uint32_t DUTY_MAX = (1UL << BITS) - 1;
+  static const char* kind() { return "pwm"; }
+
+  void begin() {
+    ledcSetup(CHANNEL, FREQ_HZ, BITS);
+    ledcAttachPin(PIN, CHANNEL);
+    ledcWrite(CHANNEL, 0);
+  }
+
+  void set(bool on, uint32_t nowMs) { setDuty(on ? DUTY_MAX : 0, nowMs); }
+
+  void setDuty(uint32_t duty, uint32_t nowMs) {
+    if (duty > DUTY_MAX) duty = DUTY_MAX;
+    if ((duty > 0) != (_target > 0)) _switches++;
+    _target = duty;
+    _rampMs = nowMs;
+    if (RAMP_MS == 0 || duty == 0) write(duty);
+  }
+
+  void update(uint32_t nowMs) {
+    if (_duty == _target) return;
+    uint32_t step = (uint32_t)((uint64_t)DUTY_MAX * (nowMs - _rampMs) / (RAMP_MS ? RAMP_MS : 1));
+    if (step == 0) return;
+    _rampMs = nowMs;
+    if (_duty < _target) write(_target - _duty > step ? _duty + step : _target);
+    else write(_duty - _target > step ? _duty - step : _target);
+  }
+
+  // Rapport cyclique visé appliqué sans rampe : avant un redémarrage
+  void finish() { write(_target); }
+  bool on() const { return _target > 0; }
+  bool busy() const { return _duty != _target; }   // rampe en cours
+  uint32_t duty() const { return _duty; }
+  uint32_t switches() const { return _switches; }
+
+private:
+  void write(uint32_t duty) {
+    _duty = duty;
+    ledcWrite(CHANNEL, duty);
+  }
+
+  uint32_t _duty = 0, _target = 0;
+  uint32_t _rampMs = 0;
+  uint32_t _switches = 0;
+};
+
+// Voie Ch sous surveillance d'usure (wear.h) : cycles comptés à chaque
+// commutation, request() applique la décision de la logique si les durées
+// minimales et le nombre de commutations par heure le permettent. set()
+// reste inconditionnel (arrêt, changement de mode, avant redémarrage).
+template<class Ch>
+class Guarded : public Ch {
+public:
+  void set(bool on, uint32_t nowMs) {
+    bool was = Ch::on();
+    Ch::set(on, nowMs);
+    if (on != was) _wear.record(on, nowMs);
+  }
+
+  // Décision de la logique, à redemander à chaque tick : false si différée.
+  // force (arrêt de sécurité) : commutation immédiate
+  bool request(bool on, uint32_t nowMs, uint32_t epoch, bool force = false) {
+    _wear.stamp(epoch);
+    if (on == Ch::on()) {
+      _wear.settle();
+      return true;
+    }
+    if (!force && _wear.check(on, nowMs) != WEAR_OK) return false;
+    set(on, nowMs);
+    return true;
+  }
+
+  WearCounter& wear() { return _wear; }
+  const WearCounter& wear() const { return _wear; }
+
+private:
+  WearCounter _wear;
+};
+
+template<class... Ch>
+class ActuatorBank {
+public:
+  static constexpr size_t COUNT = sizeof...(Ch);
+
+  explicit ActuatorBank(const char* const (&names)[COUNT]) {
+    for (size_t i = 0; i < COUNT; i++) _names[i] = names[i];
+  }
+
+  // Voie I (index connu à la compilation)
+  template<size_t I> auto& channel() { return std::get<I>(_ch); }
+  template<size_t I> const auto& channel() const { return std::get<I>(_ch); }
+
+  void begin() { each([](auto& c) { c.begin(); }); }
+  void update(uint32_t nowMs) { each([&](auto& c) { c.update(nowMs); }); }
+  void finish() { each([](auto& c) { c.finish(); }); }
+
+  // Tout au repos (changement de mode, arrêt, avant redémarrage)
+  void allOff(uint32_t nowMs) { each([&](auto& c) { c.set(false, nowMs); }); }
+
+  // fn(index, nom, voie) pour chaque voie (état, /status)
+  template<class F>
+  void forEach(F fn) const { forEachImpl(fn, std::index_sequence_for<Ch...>()); }
+  template<class F>
+  void forEach(F fn) { forEachImpl(fn, std::index_sequence_for<Ch...>()); }
+
+  const char* name(size_t i) const { return i < COUNT ? _names[i] : "?"; }
+
+private:
+  template<class F>
+  void each(F fn) { std::apply([&](auto&... c) { (fn(c), ...); }, _ch); }
+
+  template<class F, size_t... I>
+  void forEachImpl(F& fn, std::index_sequence<I...>) const { (fn(I, _names[I], std::get<I>(_ch)), ...); }
+  template<class F, size_t... I>
+  void forEachImpl(F& fn, std::index_sequence<I...>) { (fn(I, _names[I], std::get<I>(_ch)), ...); }
+
+  std::tuple<Ch...> _ch;
+  const char* _names[COUNT];
+};
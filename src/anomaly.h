@@ -0,0 +1,139 @@
+#pragma once
+/*
+  Détection en ligne de fuite / d'arrivée d'eau parasite sur le niveau
+  - Jugé seulement quand aucune entrée ni sortie d'eau n'est commandée
+    (EV1 et EV_out fermées) : le niveau ne doit alors baisser que par
+    évaporation. Tout changement d'actionneur ouvre un nouveau segment
+    (délai de stabilisation : remous, eau dans les tuyaux de la pompe)
+  - Pente : régression linéaire à oubli exponentiel (moyennes et covariance
+    glissantes), O(1) par échantillon et stable en float sur des jours
+  - CUSUM sur les variations seconde par seconde du niveau lissé : litres
+    perdus (ou gagnés) au-delà de l'évaporation tolérée -> fuites franches
+    détectées en minutes, la pente attrapant les lentes
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+enum : uint8_t {
+  ANOM_LEAK   = 1 << 0,  // baisse plus rapide que l'évaporation
+  ANOM_INFLOW = 1 << 1   // montée vanne fermée (EV1 bloquée ouverte, fuite de vanne)
+};
+
+struct AnomalyParams {
+  float windowSec;     // constante de temps de la régression
+  float smoothSec;     // lissage du niveau avant CUSUM
+  float settleSec;     // ignoré après un changement d'actionneur
+  float warmupSec;     // âge minimal du segment avant de juger la pente
+  float evapMaxLph;    // évaporation tolérée (L/h)
+  float leakLph;       // pente de fuite, au-delà de l'évaporation (L/h)
+  float inflowLph;     // pente de montée anormale (L/h)
+  float cusumLimitL;   // litres cumulés hors tolérance avant alerte
+};
+
+inline const char* anomalyNames(uint8_t alerts) {
+  static const char* names[] = { "", "leak", "inflow", "leak,inflow" };
+  return names[alerts & 3];
+}
+
+class AnomalyDetector {
+public:
+  explicit AnomalyDetector(const AnomalyParams& p) : _p(p) {}
+
+  // Un échantillon par tick ; retourne les alertes NOUVELLEMENT levées
+  uint8_t update(uint32_t nowMs, float levelL, bool valveOn, bool pumpOn, bool voutOn) {
+    uint8_t act = (valveOn ? 1 : 0) | (pumpOn ? 2 : 0) | (voutOn ? 4 : 0);
+    if (act != _act || !_started) {
+      _act = act;
+      _segStartMs = nowMs;
+      _started = true;
+      _n = 0;
+    }
+    // Entrée ou sortie d'eau commandée : rien à juger
+    if (valveOn || voutOn) return 0;
+    uint32_t ageMs = nowMs - _segStartMs;
+    if (ageMs < (uint32_t)(_p.settleSec * 1000)) return 0;
+
+    if (_n++ == 0) {
+      _lag = 0; _my = levelL; _vt = 0; _cty = 0; _span = 0;
+      _smooth = _lastSecLevel = levelL;
+      _secAcc = 0;
+      _cusumLeak = _cusumInflow = 0;
+      _lastMs = nowMs;
+      return 0;
+    }
+    // Pas de temps en entier (ms) : pas de temps absolu en float, précis sur des semaines
+    float dt = (nowMs - _lastMs) / 1000.0f;
+    _lastMs = nowMs;
+    if (dt <= 0) return 0;
+
+    // Régression pondérée exponentiellement (Welford) ; _lag = t - moyenne(t).
+    // Démarrage en moyenne cumulative (poids égaux) tant que le segment est
+    // plus court que la fenêtre : pas de biais du premier échantillon.
+    _span = fminf(_span + dt, _p.windowSec);
+    float a = dt / _span;
+    _lag += dt;
+    float dx = _lag, dy = levelL - _my;
+    _lag -= a * dx;
+    _my += a * dy;
+    _vt = (1 - a) * (_vt + a * dx * dx);
+    _cty = (1 - a) * (_cty + a * dx * dy);
+
+    // CUSUM une fois par seconde sur le niveau lissé
+    _smooth += dt / (_p.smoothSec + dt) * (levelL - _smooth);
+    uint8_t raised = 0;
+    _secAcc += dt;
+    if (_secAcc >= 1.0f) {
+      float dv = _smooth - _lastSecLevel;
+      float allowance = _p.evapMaxLph / 3600.0f * _secAcc;
+      _cusumLeak = fmaxf(0, _cusumLeak - dv - allowance);
+      _cusumInflow = fmaxf(0, _cusumInflow + dv - allowance);
+      _lastSecLevel = _smooth;
+      _secAcc = 0;
+      if (_cusumLeak > _p.cusumLimitL) raised |= ANOM_LEAK;
+      if (_cusumInflow > _p.cusumLimitL) raised |= ANOM_INFLOW;
+    }
+    if (ageMs >= (uint32_t)((_p.settleSec + _p.warmupSec) * 1000)) {
+      float s = slopeLph();
+      if (s < -(_p.evapMaxLph + _p.leakLph)) raised |= ANOM_LEAK;
+      if (s > _p.inflowLph) raised |= ANOM_INFLOW;
+    }
+    raised &= ~_alerts;
+    _alerts |= raised;
+    if (raised) _raisedCount++;
+    return raised;
+  }
+
+  // Acquittement : alertes effacées, nouveau segment
+  void clear() {
+    _alerts = 0;
+    _started = false;
+  }
+
+  uint8_t alerts() const { return _alerts; }
+  bool judging() const { return _n > 1; }
+  float slopeLph() const { return judging() && _vt > 1e-6f ? _cty / _vt * 3600.0f : 0.0f; }
+
+  // "anomaly":{...} pour /metrics
+  size_t printStats(char* buf, size_t size) const {
+    int w = snprintf(buf, size,
+      "\"anomaly\":{\"alerts\":\"%s\",\"judging\":%s,\"slopeLph\":%.3f,\"leakL\":%.3f,\"inflowL\":%.3f,\"raised\":%u}",
+      anomalyNames(_alerts), judging() ? "true" : "false", slopeLph(), _cusumLeak, _cusumInflow,
+      (unsigned)_raisedCount);
+    if (w < 0) return 0;
+    return (size_t)w < size ? (size_t)w : size - 1;
+  }
+
+private:
+  AnomalyParams _p;
+  bool _started = false;
+  uint8_t _act = 0;
+  uint8_t _alerts = 0;
+  uint32_t _raisedCount = 0;
+  uint32_t _segStartMs = 0;
+  uint32_t _n = 0, _lastMs = 0;
+  float _lag = 0, _my = 0, _vt = 0, _cty = 0, _span = 0;
+  float _smooth = 0, _lastSecLevel = 0, _secAcc = 0;
+  float _cusumLeak = 0, _cusumInflow = 0;
+};
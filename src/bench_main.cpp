@@ -0,0 +1,266 @@
+/*
+  Micro-benchmarks sur la carte : cycles CPU des fonctions chaudes à 80, 160 et 240 MHz
+  - Firmware séparé : [env:esp32bench] (platformio.ini) compile ce fichier à la
+    place de main.cpp ->  pio run -e esp32bench -t upload -t monitor
+  - Même code que le firmware (en-têtes de src/) ; par cas, médiane de
+    plusieurs mesures du compteur de cycles du cœur (ESP.getCycleCount(),
+    CCOUNT 32 bits), divisée par le nombre d'opérations de la mesure
+  - Tableau sur le port série (cycles et µs par fréquence, rapport 80/240 MHz) ;
+    'r' relance la série
+  - Flash : écritures NVS dans l'espace "bench" (jamais celui de l'EEPROM du
+    firmware) ; TLS : POST vers BENCH_TLS_URL (host/tls_standin.py), sauté
+    sans Wi-Fi configuré
+  Les µs incluent les attentes (flash, I2C, réseau) : à 80 MHz, seul le calcul
+  ralentit ; le reste ne dépend pas de l'horloge CPU.
+*/
+#include <Arduino.h>
+#include <Wire.h>
+#include <WiFi.h>
+#include <Adafruit_SSD1306.h>
+#include <nvs.h>
+#include <nvs_flash.h>
+#include "status_json.h"
+#include "ranging.h"
+#include "calibration.h"
+#include "oled_view.h"
+#include "tls_uploader.h"
+
+// ---- Configuration (build_flags de [env:esp32bench]) ----
+#ifndef BENCH_WIFI_SSID
+#define BENCH_WIFI_SSID ""            // vide : pas de mesure TLS
+#endif
+#ifndef BENCH_WIFI_PASS
+#define BENCH_WIFI_PASS ""
+#endif
+#ifndef BENCH_TLS_URL
+#define BENCH_TLS_URL "https://192.168.1.10:8443/bench"   // host/tls_standin.py sur le PC
+#endif
+
+#define BENCH_MAX_REPS  15   // mesures par cas au plus (médiane)
+#define BENCH_MAX_CASES 16
+const uint32_t BENCH_FREQS_MHZ[] = { 80, 160, 240 };
+const uint8_t  BENCH_FREQ_COUNT = sizeof(BENCH_FREQS_MHZ) / sizeof(BENCH_FREQS_MHZ[0]);
+
+// Valeurs du firmware (main.cpp)
+const float TANK_HEIGHT_CM = 9.1, SENSOR_OFFSET_CM = 2.0, TANK_CAPACITY_L = 4.0;
+#define EEPROM_SIZE 128
+#define OLED_ADDR   0x3C
+
+Adafruit_SSD1306 display(128, 64, &Wire, -1, 400000, 400000);
+bool oledBuffer = false, oledPresent = false;
+nvs_handle_t benchNvs = 0;
+bool wifiOk = false;
+uint32_t tlsFailures = 0;       // POST sans réponse 2xx (mesure faussée)
+volatile uint32_t benchSink;   // résultats consommés : le compilateur ne supprime rien
+
+// ===================== Entrées =====================
+// Reproductibles d'une série à l'autre (même graine)
+float echoSets[64][ECHO_MAX_SAMPLES];
+uint32_t echoUs[64][ECHO_MAX_SAMPLES];
+CalibrationTable calib12;
+
+uint32_t lcgState;
+uint32_t lcg() { lcgState = lcgState * 1664525u + 1013904223u; return lcgState >> 8; }
+float lcgUniform(float lo, float hi) { return lo + (hi - lo) * (lcg() & 0xFFFF) / 65535.0f; }
+
+void prepareInputs() {
+  lcgState = 42;
+  for (auto& s : echoSets)
+    for (float& v : s) v = lcgUniform(SENSOR_OFFSET_CM, SENSOR_OFFSET_CM + TANK_HEIGHT_CM);
+  for (auto& e : echoUs)
+    for (uint32_t& us : e) us = lcg() % 16 == 0 ? 0 : cmToEchoUs(lcgUniform(2.0f, 11.1f), 21.5f);
+  // Bassin évasé, 12 points : pire cas de la recherche dichotomique
+  for (int i = 0; i < CAL_MAX_POINTS; i++) {
+    float x = 1.0f - (float)i / (CAL_MAX_POINTS - 1);
+    calib12.add(SENSOR_OFFSET_CM + TANK_HEIGHT_CM * i / (CAL_MAX_POINTS - 1), TANK_CAPACITY_L * x * (0.6f + 0.4f * x));
+  }
+}
+
+const OledView OLED_VIEWS[] = {
+  { true, -58, nullptr, MODE_OPEN_CYCLE, false, 73.0f },
+  { true, -71, nullptr, MODE_ECO_HYBRID, true, 100.0f },
+  { false, -100, "FUITE", MODE_CLOSED_CYCLE, false, 8.0f }
+};
+
+// ===================== Cas mesurés =====================
+struct BenchCase {
+  const char* name;
+  uint8_t reps;              // mesures (impair, <= BENCH_MAX_REPS)
+  uint16_t ops;              // opérations par mesure (cycles divisés)
+  bool (*ready)();           // nullptr : toujours mesurable
+  void (*op)(uint32_t i);
+};
+
+int formatSnapshot(uint32_t i) {
+  static const ChannelStatus channels[] = {
+    { "EV1", "latched", true, false, 12 }, { "EV2", "latched", false, false, 3 },
+    { "pump", "relay", true, false, 41 }, { "EV_out", "relay", false, false, 2 }
+  };
+  StatusSnapshot snap = {
+    (int)(i % 101), 5.43f, 2.17f, 4.0f, true,
+    21.5f, 48.0f,
+    true, false, true,
+    "00:00:12", "01:02:03", "00:10:00", "12:34:56",
+    2, true, 5, "days", "71:59:59", false,
+    "leak", -0.12f, false,
+    "degraded", "00:00:04",
+    "\"today\":{\"fillL\":3.20,\"drainL\":2.95,\"fillLPerDay\":6.40,\"valveS\":410,\"valveN\":9,\"pumpS\":21600,"
+    "\"pumpN\":4,\"kWh\":0.036,\"drainS\":1800,\"drainN\":4,\"periodS\":43200},"
+    "\"open\":{\"fillL\":96.10,\"fillLPerDay\":7.02,\"kWh\":0.410,\"periodS\":1182600},"
+    "\"closed\":{\"fillL\":4.00,\"fillLPerDay\":0.31,\"kWh\":1.820,\"periodS\":1108800},"
+    "\"eco\":{\"fillL\":22.50,\"fillLPerDay\":1.95,\"kWh\":1.480,\"periodS\":997200}",
+    channels, 4
+  };
+  static char buf[1536];
+  return formatStatusJson(buf, sizeof(buf), snap);
+}
+
+// Une écriture EEPROM du firmware : blob de EEPROM_SIZE octets + commit NVS
+void nvsCommit(uint32_t i) {
+  static uint8_t blob[EEPROM_SIZE];
+  blob[i % EEPROM_SIZE] = (uint8_t)i;
+  nvs_set_blob(benchNvs, "blob", blob, sizeof(blob));
+  benchSink = nvs_commit(benchNvs);
+}
+
+// POST complet : nouvelle instance -> poignée de main complète
+void tlsFull(uint32_t i) {
+  TlsUploader up(0);
+  char body[16];
+  int n = snprintf(body, sizeof(body), "{\"i\":%u}", (unsigned)i);
+  int code = up.post(BENCH_TLS_URL, "application/json", (const uint8_t*)body, n);
+  if (code < 200 || code >= 300) tlsFailures++;
+}
+
+// POST sur instance gardée : le serveur ferme après chaque réponse,
+// la reconnexion reprend la session TLS (poignée de main abrégée)
+TlsUploader* tlsKept = nullptr;
+void tlsResumed(uint32_t i) {
+  char body[16];
+  int n = snprintf(body, sizeof(body), "{\"i\":%u}", (unsigned)i);
+  int code = tlsKept->post(BENCH_TLS_URL, "application/json", (const uint8_t*)body, n);
+  if (code < 200 || code >= 300) tlsFailures++;
+}
+
+const BenchCase CASES[] = {
+  { "echo_to_cm",          15, 64, nullptr, [](uint32_t i) { benchSink = (uint32_t)echoToCm(echoUs[i & 63][0], 21.5f); } },
+  { "sort_float/5",        15, 64, nullptr, [](uint32_t i) {
+      float w[ECHO_MAX_SAMPLES];
+      memcpy(w, echoSets[i & 63], sizeof(w));
+      sortFloat(w, ECHO_MAX_SAMPLES);
+      benchSink = (uint32_t)w[0];
+    } },
+  { "median_filter/5",     15, 64, nullptr, [](uint32_t i) { benchSink = (uint32_t)medianFilter(echoSets[i & 63], 5); } },
+  { "range_from_echoes/5", 15, 64, nullptr, [](uint32_t i) {
+      benchSink = (uint32_t)rangeFromEchoes(echoUs[i & 63], ECHO_MAX_SAMPLES, 21.5f, SENSOR_OFFSET_CM, TANK_HEIGHT_CM, 6.0f);
+    } },
+  { "cm_to_percent/12pts", 15, 64, nullptr, [](uint32_t i) { benchSink = calib12.percentRounded(echoSets[i & 63][1]); } },
+  { "status_json",          15, 8, nullptr, [](uint32_t i) { benchSink = formatSnapshot(i); } },
+  { "oled_render",          15, 4, [] { return oledBuffer; }, [](uint32_t i) {
+      renderOled(display, OLED_VIEWS[i % 3]);
+      benchSink = display.getBuffer()[i & 1023];
+    } },
+  { "oled_send_i2c",         9, 1, [] { return oledPresent; }, [](uint32_t) { display.display(); } },
+  { "nvs_commit",            5, 1, [] { return benchNvs != 0; }, nvsCommit },
+  { "tls_post_full",         3, 1, [] { return wifiOk; }, tlsFull },
+  { "tls_post_resumed",      5, 1, [] { return wifiOk && tlsKept != nullptr; }, tlsResumed },
+};
+const uint8_t CASE_COUNT = sizeof(CASES) / sizeof(CASES[0]);
+static_assert(sizeof(CASES) / sizeof(CASES[0]) <= BENCH_MAX_CASES, "BENCH_MAX_CASES");
+
+// Cycles par opération, médiane de c.reps mesures (0 : non mesurable)
+uint32_t measure(const BenchCase& c) {
+  if (c.ready && !c.ready()) return 0;
+  const uint8_t reps = c.reps < BENCH_MAX_REPS ? c.reps : BENCH_MAX_REPS;
+  uint32_t samples[BENCH_MAX_REPS];
+  uint32_t i = 0;
+  c.op(i++);   // mise en cache (flash -> cache d'instructions)
+  for (uint8_t r = 0; r < reps; r++) {
+    uint32_t t0 = ESP.getCycleCount();
+    for (uint16_t k = 0; k < c.ops; k++) c.op(i++);
+    samples[r] = (ESP.getCycleCount() - t0) / c.ops;
+  }
+  for (uint8_t a = 1; a < reps; a++) {   // tri par insertion
+    uint32_t v = samples[a];
+    int b = a - 1;
+    while (b >= 0 && samples[b] > v) { samples[b + 1] = samples[b]; b--; }
+    samples[b + 1] = v;
+  }
+  return samples[reps / 2];
+}
+
+// ===================== Série complète =====================
+uint32_t results[BENCH_MAX_CASES][BENCH_FREQ_COUNT];
+
+void runSuite() {
+  uint32_t initialMhz = getCpuFrequencyMhz();
+  tlsFailures = 0;
+  for (uint8_t f = 0; f < BENCH_FREQ_COUNT; f++) {
+    Serial.flush();
+    setCpuFrequencyMhz(BENCH_FREQS_MHZ[f]);
+    Serial.printf("%u MHz...\n", (unsigned)getCpuFrequencyMhz());
+    if (wifiOk && tlsKept == nullptr) {
+      tlsKept = new TlsUploader(0);
+      tlsResumed(0);   // première connexion : poignée de main complète, session gardée
+    }
+    for (uint8_t c = 0; c < CASE_COUNT; c++) {
+      results[c][f] = measure(CASES[c]);
+      delay(1);   // laisse tourner les autres tâches (Wi-Fi, chien de garde)
+    }
+  }
+  Serial.flush();
+  setCpuFrequencyMhz(initialMhz);
+
+  Serial.printf("\n%-22s", "cas");
+  for (uint8_t f = 0; f < BENCH_FREQ_COUNT; f++) Serial.printf(" %12u MHz %9s", (unsigned)BENCH_FREQS_MHZ[f], "");
+  Serial.printf(" %9s\n%-22s", "80/240", "");
+  for (uint8_t f = 0; f < BENCH_FREQ_COUNT; f++) Serial.printf(" %12s %12s", "cycles", "us");
+  Serial.println();
+  for (uint8_t c = 0; c < CASE_COUNT; c++) {
+    Serial.printf("%-22s", CASES[c].name);
+    if (results[c][0] == 0) {
+      Serial.println(" (non mesuré : matériel ou réseau absent)");
+      continue;
+    }
+    for (uint8_t f = 0; f < BENCH_FREQ_COUNT; f++)
+      Serial.printf(" %12u %12.2f", (unsigned)results[c][f], results[c][f] / (float)BENCH_FREQS_MHZ[f]);
+    float us80 = results[c][0] / 80.0f;
+    float us240 = results[c][BENCH_FREQ_COUNT - 1] / 240.0f;
+    Serial.printf(" %8.2fx\n", us240 > 0 ? us80 / us240 : 0.0f);
+  }
+  if (wifiOk) Serial.printf("POST TLS en échec : %u (serveur joignable ? réponse 2xx ?)\n", (unsigned)tlsFailures);
+  Serial.printf("heap libre %u, plus grand bloc %u\n", (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMaxAllocHeap());
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(500);
+  Serial.println("\n=== Fontaine : micro-benchmarks sur la carte ===");
+  prepareInputs();
+
+  Wire.begin(21, 22, 400000);
+  oledBuffer = display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDR);   // alloue le tampon même sans écran
+  Wire.beginTransmission(OLED_ADDR);
+  oledPresent = oledBuffer && Wire.endTransmission() == 0;
+
+  nvs_flash_init();
+  if (nvs_open("bench", NVS_READWRITE, &benchNvs) != ESP_OK) benchNvs = 0;
+
+  if (strlen(BENCH_WIFI_SSID) > 0) {
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(BENCH_WIFI_SSID, BENCH_WIFI_PASS);
+    uint32_t t0 = millis();
+    while (WiFi.status() != WL_CONNECTED && millis() - t0 < 15000) delay(100);
+    wifiOk = WiFi.status() == WL_CONNECTED;
+    Serial.printf("Wi-Fi : %s, cible TLS %s\n", wifiOk ? "connecté" : "échec", BENCH_TLS_URL);
+  }
+  Serial.printf("OLED : %s\n", oledPresent ? "présent" : (oledBuffer ? "absent (rendu seul)" : "tampon indisponible"));
+
+  runSuite();
+  Serial.println("'r' : relancer");
+}
+
+void loop() {
+  if (Serial.available() && Serial.read() == 'r') runSuite();
+  delay(50);
+}
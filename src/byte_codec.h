@@ -0,0 +1,43 @@
+#pragma once
+/*
+  Codage des images persistantes et des enregistrements : entiers
+  petit-boutistes sur 1 à 4 octets, flottants par leur motif binaire,
+  somme de contrôle FNV-1a (32 bits)
+  - Indépendant de l'alignement et du boutisme de la machine : une image
+    écrite par la carte se relit dans host/
+  - lePut / leGet à une adresse ; leAppend* écrivent à out + n et avancent n
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define FNV1A_INIT  2166136261u
+#define FNV1A_PRIME 16777619u
+
+inline void lePut(uint8_t* p, uint32_t v, uint8_t bytes = 4) {
+  for (uint8_t i = 0; i < bytes; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+inline uint32_t leGet(const uint8_t* p, uint8_t bytes = 4) {
+  uint32_t v = 0;
+  for (uint8_t i = 0; i < bytes; i++) v |= (uint32_t)p[i] << (8 * i);
+  return v;
+}
+
+inline void lePutF(uint8_t* p, float f) { uint32_t v; memcpy(&v, &f, 4); lePut(p, v); }
+inline float leGetF(const uint8_t* p) { uint32_t v = leGet(p); float f; memcpy(&f, &v, 4); return f; }
+
+inline void leAppend(uint8_t* out, size_t& n, uint32_t v, uint8_t bytes) { lePut(out + n, v, bytes); n += bytes; }
+inline void leAppendF(uint8_t* out, size_t& n, float f) { lePutF(out + n, f); n += 4; }
+
+inline uint32_t fnv1a(const uint8_t* p, size_t n, uint32_t h = FNV1A_INIT) {
+  for (size_t i = 0; i < n; i++) h = (h ^ p[i]) * FNV1A_PRIME;
+  return h;
+}
+
+// Chaîne terminée par un zéro (zéro exclu)
+inline uint32_t fnv1a(const char* s, uint32_t h = FNV1A_INIT) {
+  for (; *s; s++) h = (h ^ (uint8_t)*s) * FNV1A_PRIME;
+  return h;
+}
@@ -0,0 +1,112 @@
+#pragma once
+/*
+  Table de calibration du bassin : distance capteur (cm) -> volume (litres)
+  - Points triés par distance croissante (plein -> vide)
+  - Recherche dichotomique + interpolation linéaire (pentes précalculées)
+  - Hors table : valeur bornée au premier / dernier point
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define CAL_MAX_POINTS 12
+
+struct CalPoint {
+  float distCm;
+  float litres;
+};
+
+class CalibrationTable {
+public:
+  CalibrationTable() { clear(); }
+
+  void clear() { _count = 0; }
+
+  // Cuve prismatique : plein à offsetCm, vide à offsetCm + heightCm
+  void setPrismatic(float offsetCm, float heightCm, float capacityL) {
+    _pts[0] = { offsetCm, capacityL };
+    _pts[1] = { offsetCm + heightCm, 0.0f };
+    _count = 2;
+    prepare();
+  }
+
+  // Ajoute (ou remplace si même distance à 0,5 mm près) un point mesuré
+  bool add(float distCm, float litres) {
+    for (uint8_t i = 0; i < _count; i++) {
+      if (_pts[i].distCm > distCm - 0.05f && _pts[i].distCm < distCm + 0.05f) {
+        _pts[i].litres = litres;
+        prepare();
+        return true;
+      }
+    }
+    if (_count >= CAL_MAX_POINTS) return false;
+    uint8_t i = _count;
+    while (i > 0 && _pts[i - 1].distCm > distCm) { _pts[i] = _pts[i - 1]; i--; }
+    _pts[i] = { distCm, litres };
+    _count++;
+    prepare();
+    return true;
+  }
+
+  // Au moins 2 points, volume décroissant quand la distance augmente
+  bool valid() const {
+    if (_count < 2) return false;
+    for (uint8_t i = 1; i < _count; i++) {
+      if (_pts[i].distCm <= _pts[i - 1].distCm) return false;
+      if (_pts[i].litres > _pts[i - 1].litres) return false;
+    }
+    return _pts[0].litres > _pts[_count - 1].litres;
+  }
+
+  float litresAt(float distCm) const {
+    if (_count == 0) return 0.0f;
+    if (distCm <= _pts[0].distCm) return _pts[0].litres;
+    if (distCm >= _pts[_count - 1].distCm) return _pts[_count - 1].litres;
+    // Segment [lo, lo+1] contenant distCm
+    uint8_t lo = 0, hi = _count - 1;
+    while (hi - lo > 1) {
+      uint8_t mid = (lo + hi) >> 1;
+      if (_pts[mid].distCm <= distCm) lo = mid; else hi = mid;
+    }
+    return _pts[lo].litres + (distCm - _pts[lo].distCm) * _slope[lo];
+  }
+
+  float fullLitres()  const { return _count ? _pts[0].litres : 0.0f; }
+  float emptyLitres() const { return _count ? _pts[_count - 1].litres : 0.0f; }
+
+  // Pourcentage du volume utile (0 = dernier point, 100 = premier point)
+  float percentAt(float distCm) const {
+    float span = fullLitres() - emptyLitres();
+    if (span <= 0.0f) return 0.0f;
+    return (litresAt(distCm) - emptyLitres()) * 100.0f / span;
+  }
+
+  // Pourcentage entier borné à [0, 100] (écran, /status)
+  int percentRounded(float distCm) const {
+    float p = percentAt(distCm);
+    if (p < 0.0f) p = 0.0f;
+    if (p > 100.0f) p = 100.0f;
+    return (int)lroundf(p);
+  }
+
+  // Litres correspondant à un pourcentage du volume utile (seuils)
+  float litresForPercent(float pct) const {
+    return emptyLitres() + (fullLitres() - emptyLitres()) * pct / 100.0f;
+  }
+
+  uint8_t count() const { return _count; }
+  const CalPoint& point(uint8_t i) const { return _pts[i]; }
+
+private:
+  void prepare() {
+    for (uint8_t i = 0; i + 1 < _count; i++) {
+      float dx = _pts[i + 1].distCm - _pts[i].distCm;
+      _slope[i] = dx > 0.0f ? (_pts[i + 1].litres - _pts[i].litres) / dx : 0.0f;
+    }
+  }
+
+  CalPoint _pts[CAL_MAX_POINTS];
+  float _slope[CAL_MAX_POINTS];
+  uint8_t _count;
+};
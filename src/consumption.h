@@ -0,0 +1,274 @@
+#pragma once
+/*
+  Consommation d'eau et d'énergie, par jour et par mode
+  - Par voie : durée ON et mises en marche (vanne de remplissage, pompe,
+    vidange EV_out) ; énergie de la pompe = intégrale de la puissance
+    nominale x rapport cyclique (variateur, pump_control.h)
+  - Litres estimés par le niveau, sur chaque segment d'état des vannes (pas
+    tick par tick : le bruit de mesure s'accumulerait) :
+      remplissage seul -> entrée (et débit de remplissage appris)
+      vidange seule    -> sortie
+      les deux         -> entrée au débit appris, sortie = entrée - variation
+    Segment avec une mesure douteuse (sensor_health.h) : durées seules
+  - Jour en cours + CONSUMPTION_DAYS jours précédents (heure locale), cumul
+    par mode depuis la remise à zéro (eau par jour passé dans le mode)
+  - Image persistante de CONSUMPTION_IMAGE_SIZE octets (save / load)
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include "byte_codec.h"
+#include "control.h"
+
+#define CONSUMPTION_DAYS        7
+#define CONSUMPTION_MODES       3      // FountainMode
+#define CONSUMPTION_MAGIC       0x32534E43u   // "CNS2"
+#define CONSUMPTION_TOTALS_SIZE 34
+#define CONSUMPTION_IMAGE_SIZE  (4 + 4 + (CONSUMPTION_DAYS + 1) * (4 + CONSUMPTION_TOTALS_SIZE) + \
+                                 CONSUMPTION_MODES * CONSUMPTION_TOTALS_SIZE + 4)
+#define CONSUMPTION_MIN_RATE_S  10     // s de remplissage seul avant de mettre à jour le débit
+
+// Clés JSON des modes (ordre de FountainMode)
+inline const char* consumptionModeName(uint8_t m) {
+  return m == MODE_OPEN_CYCLE ? "open" : m == MODE_CLOSED_CYCLE ? "closed" : "eco";
+}
+
+struct ConsumptionTotals {
+  uint32_t valveSec, pumpSec, drainSec;
+  uint32_t pumpFullSec;        // pompe ramenée à pleine puissance (durée x rapport cyclique)
+  uint32_t periodSec;          // durée couverte (jour, ou temps passé dans le mode)
+  uint16_t valveStarts, pumpStarts, drainStarts;
+  float filledL, drainedL;
+
+  float pumpKWh(float watts) const { return pumpFullSec * watts / 3.6e6f; }
+  // Entrée d'eau ramenée à 24 h de la période
+  float filledLPerDay() const { return periodSec ? filledL * 86400.0f / periodSec : 0.0f; }
+};
+
+class ConsumptionMeter {
+public:
+  explicit ConsumptionMeter(float pumpWatts) : _watts(pumpWatts) { clear(); }
+
+  void clear() {
+    memset(_days, 0, sizeof(_days));
+    memset(_dates, 0, sizeof(_dates));
+    memset(_modes, 0, sizeof(_modes));
+    memset(_carryMs, 0, sizeof(_carryMs));
+    _fillRateLps = 0;
+    _dayEnd = 0;
+    _segOpen = false;
+    _dirty = true;
+  }
+
+  void requestClear() { _clearRequested = true; }
+
+  // Un tick, après les décisions : état des voies, rapport cyclique de la
+  // pompe (0..1), volume mesuré, durée du tick
+  void update(uint32_t epoch, uint8_t mode, bool valve, bool pump, float pumpDuty, bool drain,
+              float levelL, bool levelTrusted, uint32_t dtMs) {
+    if (_clearRequested.exchange(false)) clear();
+    if (mode >= CONSUMPTION_MODES) return;
+    rollDay(epoch, levelL);
+
+    // Segment de niveau : clos à chaque changement d'état des vannes
+    if (_segOpen && (valve != _segValve || drain != _segDrain || mode != _segMode)) closeSegment(levelL);
+    if (!_segOpen) {
+      _segOpen = true;
+      _segValve = valve;
+      _segDrain = drain;
+      _segMode = mode;
+      _segStartL = levelL;
+      _segMs = 0;
+      _segTrusted = true;
+    }
+    _segMs += dtMs;
+    _segTrusted = _segTrusted && levelTrusted;
+
+    ConsumptionTotals* t[2] = { &_days[0], &_modes[mode] };
+    if (valve && !_valve) for (auto* x : t) x->valveStarts++;
+    if (pump && !_pump)   for (auto* x : t) x->pumpStarts++;
+    if (drain && !_drain) for (auto* x : t) x->drainStarts++;
+    _valve = valve;
+    _pump = pump;
+    _drain = drain;
+    uint32_t s;
+    if (valve && (s = carry(0, dtMs))) for (auto* x : t) x->valveSec += s;
+    if (pump && (s = carry(1, dtMs)))  for (auto* x : t) x->pumpSec += s;
+    if (pump && (s = carry(4, (uint32_t)(dtMs * pumpDuty + 0.5f)))) for (auto* x : t) x->pumpFullSec += s;
+    if (drain && (s = carry(2, dtMs))) for (auto* x : t) x->drainSec += s;
+    if ((s = carry(3, dtMs)))          for (auto* x : t) x->periodSec += s;
+  }
+
+  const ConsumptionTotals& today() const { return _days[0]; }
+  const ConsumptionTotals& mode(uint8_t m) const { return _modes[m]; }
+  float pumpWatts() const { return _watts; }
+  float fillRateLps() const { return _fillRateLps; }
+  bool dirty() const { return _dirty; }
+
+  // Image : magic, débit appris, jours (date aaaammjj + compteurs), modes, somme
+  size_t save(uint8_t* out) {
+    size_t n = 0;
+    leAppend(out, n, CONSUMPTION_MAGIC, 4);
+    leAppendF(out, n, _fillRateLps);
+    for (uint8_t d = 0; d <= CONSUMPTION_DAYS; d++) {
+      leAppend(out, n, _dates[d], 4);
+      putTotals(out, n, _days[d]);
+    }
+    for (uint8_t m = 0; m < CONSUMPTION_MODES; m++) putTotals(out, n, _modes[m]);
+    leAppend(out, n, fnv1a(out, n), 4);
+    _dirty = false;
+    return n;
+  }
+
+  bool load(const uint8_t* in, size_t len) {
+    if (len != CONSUMPTION_IMAGE_SIZE || leGet(in, 4) != CONSUMPTION_MAGIC) return false;
+    if (leGet(in + len - 4, 4) != fnv1a(in, len - 4)) return false;
+    size_t n = 4;
+    _fillRateLps = leGetF(in + n);
+    n += 4;
+    for (uint8_t d = 0; d <= CONSUMPTION_DAYS; d++) {
+      _dates[d] = leGet(in + n, 4);
+      n += 4;
+      getTotals(in, n, _days[d]);
+    }
+    for (uint8_t m = 0; m < CONSUMPTION_MODES; m++) getTotals(in, n, _modes[m]);
+    _dayEnd = 0;   // jour courant revérifié au premier tick
+    _dirty = false;
+    return true;
+  }
+
+  // Une période en objet JSON : "name":{...} ; brief : eau, énergie et durée seulement (/status)
+  size_t printTotals(char* buf, size_t size, const char* name, const ConsumptionTotals& t, bool brief = false) const {
+    int w = brief ? snprintf(buf, size, "\"%s\":{\"fillL\":%.2f,\"fillLPerDay\":%.2f,\"kWh\":%.3f,\"periodS\":%u}",
+                             name, t.filledL, t.filledLPerDay(), t.pumpKWh(_watts), (unsigned)t.periodSec)
+                  : snprintf(buf, size,
+      "\"%s\":{\"fillL\":%.2f,\"drainL\":%.2f,\"fillLPerDay\":%.2f,\"valveS\":%u,\"valveN\":%u,"
+      "\"pumpS\":%u,\"pumpN\":%u,\"kWh\":%.3f,\"drainS\":%u,\"drainN\":%u,\"periodS\":%u}",
+      name, t.filledL, t.drainedL, t.filledLPerDay(), (unsigned)t.valveSec, (unsigned)t.valveStarts,
+      (unsigned)t.pumpSec, (unsigned)t.pumpStarts, t.pumpKWh(_watts), (unsigned)t.drainSec,
+      (unsigned)t.drainStarts, (unsigned)t.periodSec);
+    if (w < 0) return 0;
+    return (size_t)w < size ? (size_t)w : size - 1;
+  }
+
+  // /usage : jours (du plus récent au plus ancien) et modes, dans une FixedString
+  template<class Out>
+  void printJson(Out& out) const {
+    out.appendf("{\"pumpW\":%.1f,\"fillRateLps\":%.4f,\"days\":{", _watts, _fillRateLps);
+    for (uint8_t d = 0; d <= CONSUMPTION_DAYS; d++) {
+      if (d > 0 && _dates[d] == 0) continue;
+      char date[16] = "today";   // jour en cours avant le NTP
+      if (_dates[d]) snprintf(date, sizeof(date), "%04u-%02u-%02u", (unsigned)(_dates[d] / 10000),
+                              (unsigned)(_dates[d] / 100 % 100), (unsigned)(_dates[d] % 100));
+      if (d) out.append(',');
+      out.setLength(out.length() + printTotals(out.data() + out.length(), out.remaining() + 1, date, _days[d]));
+    }
+    out.append("},\"modes\":{");
+    for (uint8_t m = 0; m < CONSUMPTION_MODES; m++) {
+      if (m) out.append(',');
+      out.setLength(out.length() + printTotals(out.data() + out.length(), out.remaining() + 1, consumptionModeName(m), _modes[m]));
+    }
+    out.append("}}");
+  }
+
+private:
+  // Millisecondes -> secondes entières, reste gardé pour le tick suivant
+  uint32_t carry(uint8_t i, uint32_t dtMs) {
+    _carryMs[i] += dtMs;
+    uint32_t s = _carryMs[i] / 1000;
+    _carryMs[i] -= s * 1000;
+    return s;
+  }
+
+  void closeSegment(float levelL) {
+    _segOpen = false;
+    if (!_segTrusted || (!_segValve && !_segDrain)) return;
+    float dL = levelL - _segStartL;
+    float sec = _segMs / 1000.0f;
+    float in = 0, out = 0;
+    if (_segValve && !_segDrain) {
+      in = dL > 0 ? dL : 0;
+      if (sec >= CONSUMPTION_MIN_RATE_S) {
+        float rate = in / sec;
+        _fillRateLps = _fillRateLps > 0 ? _fillRateLps + 0.25f * (rate - _fillRateLps) : rate;
+      }
+    } else if (_segDrain && !_segValve) {
+      out = dL < 0 ? -dL : 0;
+    } else {
+      in = _fillRateLps * sec;
+      out = in - dL > 0 ? in - dL : 0;
+    }
+    _days[0].filledL += in;
+    _days[0].drainedL += out;
+    _modes[_segMode].filledL += in;
+    _modes[_segMode].drainedL += out;
+    _dirty = true;
+  }
+
+  // Minuit local passé : segment clos sur l'ancien jour, jours décalés
+  void rollDay(uint32_t epoch, float levelL) {
+    if (epoch < EPOCH_VALID_MIN) return;
+    if (_dayEnd && epoch < _dayEnd) return;
+    time_t t = epoch;
+    struct tm tm;
+    localtime_r(&t, &tm);
+    uint32_t date = (tm.tm_year + 1900) * 10000u + (tm.tm_mon + 1) * 100u + tm.tm_mday;
+    tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+    tm.tm_mday++;
+    tm.tm_isdst = -1;
+    _dayEnd = (uint32_t)mktime(&tm);
+    if (_dates[0] == date) return;
+    if (_dates[0] != 0) {   // pas au premier jour daté (compteurs d'avant le NTP gardés)
+      if (_segOpen) closeSegment(levelL);
+      memmove(&_days[1], &_days[0], CONSUMPTION_DAYS * sizeof(_days[0]));
+      memmove(&_dates[1], &_dates[0], CONSUMPTION_DAYS * sizeof(_dates[0]));
+      memset(&_days[0], 0, sizeof(_days[0]));
+    }
+    _dates[0] = date;
+    _dirty = true;
+  }
+
+  static void putTotals(uint8_t* out, size_t& n, const ConsumptionTotals& t) {
+    leAppend(out, n, t.valveSec, 4);
+    leAppend(out, n, t.pumpSec, 4);
+    leAppend(out, n, t.drainSec, 4);
+    leAppend(out, n, t.pumpFullSec, 4);
+    leAppend(out, n, t.periodSec, 4);
+    leAppend(out, n, t.valveStarts, 2);
+    leAppend(out, n, t.pumpStarts, 2);
+    leAppend(out, n, t.drainStarts, 2);
+    leAppendF(out, n, t.filledL);
+    leAppendF(out, n, t.drainedL);
+  }
+  static void getTotals(const uint8_t* in, size_t& n, ConsumptionTotals& t) {
+    t.valveSec = leGet(in + n, 4);
+    t.pumpSec = leGet(in + n + 4, 4);
+    t.drainSec = leGet(in + n + 8, 4);
+    t.pumpFullSec = leGet(in + n + 12, 4);
+    t.periodSec = leGet(in + n + 16, 4);
+    t.valveStarts = leGet(in + n + 20, 2);
+    t.pumpStarts = leGet(in + n + 22, 2);
+    t.drainStarts = leGet(in + n + 24, 2);
+    t.filledL = leGetF(in + n + 26);
+    t.drainedL = leGetF(in + n + 30);
+    n += 34;
+  }
+
+  float _watts;
+  ConsumptionTotals _days[CONSUMPTION_DAYS + 1];   // [0] = jour en cours
+  uint32_t _dates[CONSUMPTION_DAYS + 1];           // aaaammjj, 0 = inconnu
+  ConsumptionTotals _modes[CONSUMPTION_MODES];
+  uint32_t _carryMs[5];   // valve, pump, drain, période, pompe à pleine puissance
+  float _fillRateLps;
+  uint32_t _dayEnd;                                // minuit local suivant (epoch)
+  bool _valve = false, _pump = false, _drain = false;
+  bool _segOpen, _segValve = false, _segDrain = false, _segTrusted = true;
+  uint8_t _segMode = 0;
+  float _segStartL = 0;
+  uint32_t _segMs = 0;
+  bool _dirty;
+  std::atomic<bool> _clearRequested{false};
+};
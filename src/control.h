@@ -0,0 +1,295 @@
+#pragma once
+/*
+  Logique de décision de la fontaine : modes, vidanges, autorisation PIR
+  - controlStep() : entrées mesurées -> état souhaité des actionneurs
+  - Aucune E/S : le firmware lit les capteurs et pilote les relais autour,
+    host/replay rejoue les traces enregistrées avec exactement ce code
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include "calibration.h"
+#include "schedule.h"
+
+// ---- Modes de fonctionnement ----
+enum FountainMode {
+  MODE_OPEN_CYCLE = 0,   // Actuel : remplissage PIR + pompe auto
+  MODE_CLOSED_CYCLE = 1, // Eau réservoir en continu
+  MODE_ECO_HYBRID = 2    // Remplissage puis cycle fermé jusqu'à la vidange programmée
+};
+
+// ---- Commandes (HTTP -> file -> boucle de contrôle), codes enregistrés dans les traces ----
+enum CommandType : uint8_t {
+  CMD_SET_MODE = 0,
+  CMD_SET_INTERVAL,
+  CMD_DRAIN_START,
+  CMD_DRAIN_STOP,
+  CMD_CAL_CAPTURE,   // value = litres x 100 au niveau actuel
+  CMD_CAL_SAVE,
+  CMD_CAL_CLEAR,
+  CMD_CAL_DEFAULT,
+  CMD_SCHED_EVENT,   // value = ScheduleEvent (échéance de la programmation)
+  CMD_SCHED_ADD,     // value = schedulePack(règle)
+  CMD_SCHED_DELETE,  // unit = index de la règle
+  CMD_SCHED_ENABLE,  // unit = index, value = 0/1
+  CMD_SAFE_STOP,     // value = alertes (anomaly.h) ayant déclenché l'arrêt
+  CMD_ALERT_ACK,     // acquittement : alertes effacées, arrêt de sécurité levé
+  CMD_PREFILL        // value = s d'autorisation de remplissage (visite attendue, visit_model.h)
+};
+
+// Heure murale en dessous de laquelle le NTP n'est pas encore synchronisé
+const uint32_t EPOCH_VALID_MIN = 1704067200; // 1er janvier 2024 00:00:00 UTC
+
+struct ControlParams {
+  // Seuils en % du VOLUME utile (configuration)
+  uint8_t fillTargetPct;   // % à atteindre quand remplissage autorisé
+  uint8_t pumpOnAbovePct;  // % déclenche pompe au-dessus
+  uint8_t pumpOffBelowPct; // % arrêt pompe en redescendant
+  uint8_t drainStopPct;    // % fin de vidange éco
+  uint8_t manualFloorPct;  // % arrêt de sécurité de la vidange manuelle
+  // Mêmes seuils en litres (controlUpdateThresholds quand la table change)
+  float fillTargetL, pumpOnAboveL, pumpOffBelowL, drainStopL, manualFloorL;
+  uint32_t motionHoldMs;         // autorisation de remplissage après détection
+  uint32_t ecoDrainIntervalSec;  // éco : durée du cycle fermé avant vidange (programmée par l'appelant)
+  // Niveau douteux (sensor_health.h) : durée ON maximale, ensuite maintenu OFF
+  uint32_t degradedValveMaxMs;
+  uint32_t degradedPumpMaxMs;    // pompe (et EV_out avec elle)
+};
+
+struct ControlState {
+  FountainMode mode;
+  bool valveOn;             // EV1 (remplissage)
+  bool pumpOn;
+  bool voutOn;              // EV_out (vidange)
+  bool ecoInClosedPhase;
+  bool manualDrainActive;
+  bool pirState;            // état instantané du PIR (affichage)
+  bool drainDue;            // vidange programmée (intervalle éco ou règle) en attente / en cours
+  bool refillActive;        // remplissage programmé (ou suite d'une vidange hors éco)
+  bool quiet;               // heures calmes : pompe et vannes au repos
+  bool safeStop;            // arrêt de sécurité (fuite / EV1 bloquée) jusqu'à acquittement
+  bool degraded;            // mesure de niveau douteuse
+  bool valveCapped;         // durée ON plafonnée atteinte pendant la dégradation
+  bool pumpCapped;
+  uint32_t degradedSinceMs;
+  uint32_t lastEV1OnTimestamp;  // epoch du dernier remplissage éco
+  uint32_t fillAllowedUntilMs;  // fenêtre d'autorisation de remplissage
+  uint32_t prefillUntilEpoch;   // pré-remplissage (visite attendue) jusqu'à cet epoch, 0 = aucun
+  uint32_t lastPirDetectMs;     // dernière détection PIR (instant)
+  uint32_t lastValveOnMs;       // dernier passage vanne -> ON
+  uint32_t lastPumpOnMs;        // dernier passage pompe -> ON
+};
+
+struct ControlInputs {
+  uint32_t nowMs;
+  uint32_t epoch;   // time(nullptr)
+  bool pir;
+  float levelL;     // volume mesuré (unité des seuils)
+  bool levelTrusted;  // santé du capteur (sensor_health.h)
+};
+
+// Effets de bord demandés à l'appelant (retour de controlStep)
+enum : uint8_t {
+  CTL_FX_SAVE_EV1_TIMESTAMP = 1 << 0,  // lastEV1OnTimestamp à persister
+  CTL_FX_ECO_DRAIN_DONE     = 1 << 1   // fin de vidange programmée (simulateur)
+};
+
+inline void controlUpdateThresholds(ControlParams& p, const CalibrationTable& t) {
+  p.fillTargetL   = t.litresForPercent(p.fillTargetPct);
+  p.pumpOnAboveL  = t.litresForPercent(p.pumpOnAbovePct);
+  p.pumpOffBelowL = t.litresForPercent(p.pumpOffBelowPct);
+  p.drainStopL    = t.litresForPercent(p.drainStopPct);
+  p.manualFloorL  = t.litresForPercent(p.manualFloorPct);
+}
+
+inline uint32_t drainIntervalSec(uint32_t value, bool hours) {
+  return hours ? value * 3600UL : value * 24UL * 3600UL;
+}
+
+// Changement de mode : état propre (l'appelant coupe les actionneurs et persiste)
+inline void controlSetMode(ControlState& s, FountainMode mode, uint32_t epoch) {
+  s.mode = mode;
+  if (mode == MODE_ECO_HYBRID) {
+    // Réinitialiser le cycle Eco (nouveau départ)
+    s.ecoInClosedPhase = true;
+    s.lastEV1OnTimestamp = epoch;
+  } else {
+    s.ecoInClosedPhase = false;
+  }
+  s.drainDue = false;
+  s.refillActive = false;
+  s.prefillUntilEpoch = 0;
+  s.valveOn = false;
+  s.pumpOn = false;
+  s.voutOn = false;
+}
+
+// Échéance de la programmation (schedule.h), appliquée au tick suivant
+inline void controlScheduledEvent(ControlState& s, uint8_t ev) {
+  switch (ev) {
+    case SCHED_EV_DRAIN:
+      // Cycle ouvert : l'eau est déjà renouvelée ; éco : seulement en cycle fermé
+      if (s.mode == MODE_OPEN_CYCLE) break;
+      if (s.mode == MODE_ECO_HYBRID && !s.ecoInClosedPhase) break;
+      s.drainDue = true;
+      s.refillActive = false;
+      break;
+    case SCHED_EV_REFILL:
+      if (!s.drainDue) s.refillActive = true;
+      break;
+    case SCHED_EV_QUIET_ON:
+      s.quiet = true;
+      break;
+    case SCHED_EV_QUIET_OFF:
+      s.quiet = false;
+      break;
+  }
+}
+
+// Visite attendue (cycle ouvert) : remplissage autorisé sans PIR jusqu'à
+// l'objectif, une fois ; une fenêtre plus longue prolonge la précédente
+inline void controlPrefill(ControlState& s, uint32_t epoch, uint32_t seconds) {
+  if (s.mode != MODE_OPEN_CYCLE) return;
+  s.prefillUntilEpoch = epoch + seconds;
+}
+
+// Un tick de décision. L'appelant compare l'état avant/après pour piloter les relais.
+inline uint8_t controlStep(ControlState& s, const ControlParams& p, const ControlInputs& in) {
+  uint8_t fx = 0;
+  const uint32_t now = in.nowMs;
+  const float levelL = in.levelL;
+  const bool prevValve = s.valveOn;
+  const bool prevPump  = s.pumpOn;
+
+  // 1) PIR
+  s.pirState = in.pir;
+  if (in.pir) {
+    s.fillAllowedUntilMs = now + p.motionHoldMs;
+    s.lastPirDetectMs = now;
+  }
+  bool fillAuthorized = (int32_t)(s.fillAllowedUntilMs - now) > 0;
+
+  // 2) Arrêt de sécurité : tout au repos, y compris la vidange manuelle
+  if (s.safeStop) {
+    s.valveOn = false;
+    s.pumpOn = false;
+    s.voutOn = false;
+    s.manualDrainActive = false;
+  }
+  // Vidange manuelle : priorité sur les modes
+  else if (s.manualDrainActive) {
+    s.valveOn = false;
+    s.pumpOn = true;
+    s.voutOn = true;
+    // Arrêt automatique si niveau très bas
+    if (levelL <= p.manualFloorL) {
+      s.manualDrainActive = false;
+      s.pumpOn = false;
+      s.voutOn = false;
+    }
+  } else if (s.quiet) {
+    // 3a) Heures calmes : tout au repos, vidange / remplissage programmés différés
+    s.valveOn = false;
+    s.pumpOn = false;
+    s.voutOn = false;
+  } else if (s.drainDue) {
+    // 3b) Vidange programmée jusqu'au seuil bas
+    s.valveOn = false;
+    s.pumpOn = true;
+    s.voutOn = true;
+    if (levelL <= p.drainStopL) {
+      s.drainDue = false;
+      s.pumpOn = false;
+      s.voutOn = false;
+      if (s.mode == MODE_ECO_HYBRID) {
+        // Éco : retour en phase de remplissage
+        s.ecoInClosedPhase = false;
+        s.lastEV1OnTimestamp = in.epoch;
+        fx |= CTL_FX_SAVE_EV1_TIMESTAMP;
+      } else {
+        s.refillActive = true;
+      }
+      fx |= CTL_FX_ECO_DRAIN_DONE;
+    }
+  } else if (s.refillActive && s.mode != MODE_ECO_HYBRID) {
+    // 3c) Remplissage programmé (sans PIR) ; en éco la phase 1 s'en charge
+    s.pumpOn = false;
+    s.voutOn = false;
+    s.valveOn = levelL < p.fillTargetL;
+    if (!s.valveOn) s.refillActive = false;
+  } else {
+    s.refillActive = false;
+    // 3) Décisions relais SELON LE MODE
+    switch (s.mode) {
+      case MODE_OPEN_CYCLE: // Mode actuel
+        if (levelL >= p.pumpOnAboveL) {
+          s.pumpOn = true;
+          s.voutOn = true;
+        } else if (levelL <= p.pumpOffBelowL) {
+          s.pumpOn = false;
+          s.voutOn = false;
+        }
+        if (s.prefillUntilEpoch && ((int32_t)(s.prefillUntilEpoch - in.epoch) <= 0 || levelL >= p.fillTargetL)) {
+          s.prefillUntilEpoch = 0;   // fenêtre écoulée ou bassin prêt
+        }
+        s.valveOn = (fillAuthorized || s.prefillUntilEpoch != 0) && levelL < p.fillTargetL;
+        break;
+
+      case MODE_CLOSED_CYCLE: // Fontaine classique
+        s.valveOn = false;
+        s.pumpOn = true;
+        s.voutOn = false;
+        break;
+
+      case MODE_ECO_HYBRID:
+        // Phase 1 : Remplissage automatique jusqu'à 90% (sans PIR)
+        if (!s.ecoInClosedPhase) {
+          if (levelL < p.fillTargetL) {
+            s.valveOn = true;
+          } else {
+            s.valveOn = false;
+            // Basculer en cycle fermé dès que 90% atteint
+            s.ecoInClosedPhase = true;
+            s.lastEV1OnTimestamp = in.epoch;
+            fx |= CTL_FX_SAVE_EV1_TIMESTAMP;
+          }
+          s.pumpOn = false;
+          s.voutOn = false;
+        }
+        // Phase 2 : Cycle fermé ; la vidange arrive par la programmation
+        // (intervalle compté depuis lastEV1OnTimestamp, ou règle calendaire)
+        else {
+          s.valveOn = false;
+          s.pumpOn = true;
+          s.voutOn = false;
+        }
+        break;
+    }
+  }
+
+  // 4) Niveau douteux : les décisions ci-dessus peuvent reposer sur une mesure
+  // figée. Chaque actionneur garde au plus sa durée plafond (comptée depuis
+  // le début de la dégradation), puis reste au repos jusqu'au retour du capteur.
+  if (!in.levelTrusted) {
+    if (!s.degraded) {
+      s.degraded = true;
+      s.degradedSinceMs = now;
+    }
+    uint32_t valveSince = (int32_t)(s.lastValveOnMs - s.degradedSinceMs) > 0 ? s.lastValveOnMs : s.degradedSinceMs;
+    uint32_t pumpSince  = (int32_t)(s.lastPumpOnMs - s.degradedSinceMs) > 0 ? s.lastPumpOnMs : s.degradedSinceMs;
+    if (s.valveOn && prevValve && now - valveSince >= p.degradedValveMaxMs) s.valveCapped = true;
+    if (s.pumpOn && prevPump && now - pumpSince >= p.degradedPumpMaxMs) s.pumpCapped = true;
+  } else {
+    s.degraded = s.valveCapped = s.pumpCapped = false;
+  }
+  if (s.valveCapped) s.valveOn = false;
+  if (s.pumpCapped) {
+    s.pumpOn = false;
+    s.voutOn = false;
+  }
+
+  // 5) Horodatage des passages à ON
+  if (s.valveOn && (!prevValve || s.lastValveOnMs == 0)) s.lastValveOnMs = now;
+  // Pompe déjà ON mais jamais timestampée (démarrage/changement mode)
+  if (s.pumpOn && (!prevPump || s.lastPumpOnMs == 0)) s.lastPumpOnMs = now;
+  return fx;
+}
@@ -0,0 +1,69 @@
+#pragma once
+/*
+  Veille de l'écran OLED selon la présence (PIR)
+  - Allumé tant qu'il y a de l'activité (PIR, ou alerte / OTA à montrer),
+    atténué après dimAfterMs d'inactivité, éteint après offAfterMs
+  - Réveil immédiat sur détection PIR ; l'appelant applique les transitions
+    (commandes SSD1306) et ne redessine plus rien écran éteint : le bus I2C
+    reste libre pour l'AHT20
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+
+enum DisplayState : uint8_t { DISP_ON = 0, DISP_DIM = 1, DISP_OFF = 2 };
+
+struct DisplayPowerParams {
+  uint32_t dimAfterMs;   // 0 : jamais atténué
+  uint32_t offAfterMs;   // 0 : jamais éteint
+};
+
+inline const char* displayStateName(uint8_t s) {
+  return s == DISP_ON ? "on" : s == DISP_DIM ? "dim" : "off";
+}
+
+class DisplayPower {
+public:
+  explicit DisplayPower(const DisplayPowerParams& p) : _p(p) {}
+
+  // pir : présence (niveau) ; hold : information à garder visible.
+  // Retourne true si l'état change (à appliquer par l'appelant).
+  bool update(uint32_t nowMs, bool pir, bool hold) {
+    if (!_started) {
+      _started = true;
+      _lastActivityMs = _sinceMs = nowMs;
+    }
+    if (pir && !_lastPir && _state != DISP_ON) _wakes++;
+    _lastPir = pir;
+    if (pir || hold) _lastActivityMs = nowMs;
+
+    uint32_t idle = nowMs - _lastActivityMs;
+    uint8_t s = DISP_ON;
+    if (_p.offAfterMs && idle >= _p.offAfterMs) s = DISP_OFF;
+    else if (_p.dimAfterMs && idle >= _p.dimAfterMs) s = DISP_DIM;
+    if (s == _state) return false;
+    if (_state != DISP_OFF) _litMs += nowMs - _sinceMs;
+    _sinceMs = nowMs;
+    _state = s;
+    return true;
+  }
+
+  uint8_t state() const { return _state; }
+  bool lit() const { return _state != DISP_OFF; }
+
+  // "display":{...} pour /metrics (litRatio : part du temps écran allumé ou atténué)
+  size_t printStats(char* buf, size_t size, uint32_t nowMs) const {
+    uint32_t lit = _litMs + (_state != DISP_OFF && _started ? nowMs - _sinceMs : 0);
+    int w = snprintf(buf, size, "\"display\":{\"state\":\"%s\",\"wakes\":%u,\"litRatio\":%.3f}",
+                     displayStateName(_state), (unsigned)_wakes, nowMs ? (double)lit / nowMs : 1.0);
+    if (w < 0) return 0;
+    return (size_t)w < size ? (size_t)w : size - 1;
+  }
+
+private:
+  DisplayPowerParams _p;
+  bool _started = false, _lastPir = false;
+  uint8_t _state = DISP_ON;
+  uint32_t _lastActivityMs = 0, _sinceMs = 0;
+  uint32_t _litMs = 0, _wakes = 0;
+};
@@ -0,0 +1,223 @@
+#pragma once
+/*
+  Ordonnanceur coopératif de loop() : échéance la plus proche d'abord (EDF)
+  - Tâches périodiques sur une grille fixe (release += période : pas de
+    dérive) et ponctuelles (after()) ; échéance = release + délai relatif
+    (la période par défaut) ; parmi les tâches prêtes, la plus urgente passe
+  - Au plus une exécution par tâche et par run() : une tâche longue retarde
+    les autres sans les affamer
+  - Débordement (instances échues pendant qu'une autre tâche tournait) :
+    OVERRUN_SKIP      instances dont l'échéance est passée abandonnées,
+                      la plus récente encore valable exécutée
+    OVERRUN_CATCH_UP  chaque instance exécutée, une par run() (au plus
+                      maxCatchUp en retard, les plus anciennes abandonnées)
+    OVERRUN_COALESCE  une seule exécution pour toutes (JobRun.missed,
+                      JobRun.elapsedMs couvre tout l'écart)
+  - Par tâche : exécutions, retard au démarrage (gigue : moyenne, max),
+    durée max, échéances dépassées, instances abandonnées / fusionnées /
+    rattrapées
+  - Une dizaine de tâches : balayage linéaire, aucune allocation
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+
+enum OverrunPolicy : uint8_t {
+  OVERRUN_SKIP = 0,
+  OVERRUN_CATCH_UP,
+  OVERRUN_COALESCE
+};
+
+inline const char* overrunPolicyName(uint8_t p) {
+  static const char* const names[] = { "skip", "catchUp", "coalesce" };
+  return p <= OVERRUN_COALESCE ? names[p] : "?";
+}
+
+struct JobRun {
+  uint32_t nowMs;       // démarrage
+  uint32_t releaseMs;   // instance exécutée
+  uint32_t elapsedMs;   // depuis le démarrage précédent (ou l'enregistrement)
+  uint16_t missed;      // instances fusionnées dans celle-ci (OVERRUN_COALESCE)
+};
+
+typedef void (*JobFn)(const JobRun& run);
+
+template<uint8_t CAPACITY>
+class EdfScheduler {
+  static_assert(CAPACITY < 255, "index 8 bits");
+public:
+  typedef uint8_t Handle;
+  static const Handle NONE = 0xFF;
+  typedef uint32_t (*Clock)();
+
+  explicit EdfScheduler(Clock clock) : _clock(clock) {}
+
+  // Tâche périodique, première instance à firstMs (horloge absolue)
+  Handle every(const char* name, uint32_t periodMs, OverrunPolicy policy, JobFn fn,
+               uint32_t firstMs, uint32_t deadlineMs = 0, uint8_t maxCatchUp = 4) {
+    Handle h = slot();
+    if (h == NONE || periodMs == 0) return NONE;
+    Job& j = _jobs[h];
+    j = Job();
+    j.name = name;
+    j.fn = fn;
+    j.periodMs = periodMs;
+    j.deadlineMs = deadlineMs ? deadlineMs : periodMs;
+    j.releaseMs = firstMs;
+    j.lastStartMs = _clock();
+    j.policy = policy;
+    j.maxCatchUp = maxCatchUp;
+    j.active = true;
+    return h;
+  }
+
+  // Tâche ponctuelle dans delayMs ; échéance : deadlineMs après (défaut : délai)
+  Handle after(const char* name, uint32_t delayMs, JobFn fn, uint32_t deadlineMs = 0) {
+    Handle h = slot();
+    if (h == NONE) return NONE;
+    uint32_t now = _clock();
+    Job& j = _jobs[h];
+    j = Job();
+    j.name = name;
+    j.fn = fn;
+    j.deadlineMs = deadlineMs ? deadlineMs : (delayMs ? delayMs : 1);
+    j.releaseMs = now + delayMs;
+    j.lastStartMs = now;
+    j.active = true;
+    return h;
+  }
+
+  bool cancel(Handle h) {
+    if (h >= CAPACITY || !_jobs[h].active) return false;
+    _jobs[h].active = false;
+    return true;
+  }
+
+  // Exécute les tâches prêtes, la plus urgente d'abord ; nombre exécuté
+  uint8_t run() {
+    bool done[CAPACITY] = {};
+    uint8_t ran = 0;
+    for (;;) {
+      uint32_t now = _clock();
+      int best = -1;
+      uint32_t bestDeadline = 0;
+      for (uint8_t i = 0; i < CAPACITY; i++) {
+        const Job& j = _jobs[i];
+        if (!j.active || done[i] || (int32_t)(now - j.releaseMs) < 0) continue;
+        uint32_t deadline = j.releaseMs + j.deadlineMs;
+        if (best < 0 || (int32_t)(deadline - bestDeadline) < 0) {
+          best = i;
+          bestDeadline = deadline;
+        }
+      }
+      if (best < 0) return ran;
+      done[best] = true;
+      if (dispatch(_jobs[best], now)) ran++;
+    }
+  }
+
+  // ms jusqu'à la prochaine instance (0 : une tâche est prête)
+  uint32_t idleMs() const {
+    uint32_t now = _clock();
+    uint32_t best = UINT32_MAX;
+    for (uint8_t i = 0; i < CAPACITY; i++) {
+      const Job& j = _jobs[i];
+      if (!j.active) continue;
+      int32_t wait = (int32_t)(j.releaseMs - now);
+      if (wait <= 0) return 0;
+      if ((uint32_t)wait < best) best = wait;
+    }
+    return best;
+  }
+
+  // /sched : une entrée par tâche
+  size_t printJson(char* buf, size_t size) const {
+    size_t len = 0;
+    auto put = [&](int w) { if (w > 0) len = (len + w < size) ? len + w : size - 1; };
+    put(snprintf(buf, size, "{\"jobs\":["));
+    bool first = true;
+    for (uint8_t i = 0; i < CAPACITY; i++) {
+      const Job& j = _jobs[i];
+      if (!j.name) continue;
+      put(snprintf(buf + len, size - len,
+        "%s{\"name\":\"%s\",\"active\":%s,\"periodMs\":%u,\"policy\":\"%s\",\"runs\":%u,"
+        "\"lateAvgMs\":%.1f,\"lateMaxMs\":%u,\"execMaxMs\":%u,\"deadlineMiss\":%u,"
+        "\"skipped\":%u,\"coalesced\":%u,\"caughtUp\":%u}",
+        first ? "" : ",", j.name, j.active ? "true" : "false", (unsigned)j.periodMs,
+        overrunPolicyName(j.policy), (unsigned)j.runs, j.runs ? (float)j.lateSumMs / j.runs : 0.0f,
+        (unsigned)j.lateMaxMs, (unsigned)j.execMaxMs, (unsigned)j.deadlineMisses,
+        (unsigned)j.skipped, (unsigned)j.coalesced, (unsigned)j.caughtUp));
+      first = false;
+    }
+    put(snprintf(buf + len, size - len, "]}"));
+    return len;
+  }
+
+private:
+  struct Job {
+    const char* name = nullptr;
+    JobFn fn = nullptr;
+    uint32_t periodMs = 0;     // 0 : ponctuelle
+    uint32_t deadlineMs = 0;   // relative à la release
+    uint32_t releaseMs = 0, lastStartMs = 0;
+    OverrunPolicy policy = OVERRUN_SKIP;
+    uint8_t maxCatchUp = 0;
+    bool active = false;
+    uint32_t runs = 0, lateMaxMs = 0, execMaxMs = 0, deadlineMisses = 0;
+    uint32_t skipped = 0, coalesced = 0, caughtUp = 0;
+    uint64_t lateSumMs = 0;
+  };
+
+  // Emplacement libre (une tâche ponctuelle terminée libère le sien)
+  Handle slot() {
+    for (uint8_t i = 0; i < CAPACITY; i++) {
+      if (!_jobs[i].active) return i;
+    }
+    return NONE;
+  }
+
+  // Politique de débordement, puis exécution ; false si l'instance est abandonnée
+  bool dispatch(Job& j, uint32_t now) {
+    uint32_t behind = j.periodMs ? (now - j.releaseMs) / j.periodMs : 0;   // instances suivantes déjà échues
+    JobRun r = { now, j.releaseMs, now - j.lastStartMs, 0 };
+    if (j.periodMs == 0) {
+      j.active = false;
+    } else if (j.policy == OVERRUN_SKIP) {
+      uint32_t latest = j.releaseMs + behind * j.periodMs;
+      j.skipped += behind;
+      j.releaseMs = latest + j.periodMs;
+      if ((int32_t)(now - (latest + j.deadlineMs)) >= 0) {   // même la plus récente a expiré
+        j.skipped++;
+        return false;
+      }
+      r.releaseMs = latest;
+    } else if (j.policy == OVERRUN_COALESCE) {
+      r.missed = behind > 0xFFFF ? 0xFFFF : behind;
+      j.coalesced += behind;
+      j.releaseMs += (behind + 1) * j.periodMs;
+    } else {
+      if (behind > j.maxCatchUp) {   // trop de retard : seules les maxCatchUp plus récentes
+        uint32_t drop = behind - j.maxCatchUp;
+        j.skipped += drop;
+        j.releaseMs += drop * j.periodMs;
+        r.releaseMs = j.releaseMs;
+      }
+      if (behind) j.caughtUp++;
+      j.releaseMs += j.periodMs;
+    }
+
+    j.lastStartMs = now;
+    j.fn(r);
+    uint32_t end = _clock();
+    uint32_t late = now - r.releaseMs;
+    j.runs++;
+    j.lateSumMs += late;
+    if (late > j.lateMaxMs) j.lateMaxMs = late;
+    if (end - now > j.execMaxMs) j.execMaxMs = end - now;
+    if ((int32_t)(end - (r.releaseMs + j.deadlineMs)) > 0) j.deadlineMisses++;
+    return true;
+  }
+
+  Clock _clock;
+  Job _jobs[CAPACITY];
+};
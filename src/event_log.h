@@ -0,0 +1,77 @@
+#pragma once
+/*
+  Journal d'événements en RAM (anneau, les plus anciens écrasés)
+  - Alertes de fuite, arrêt de sécurité, acquittements, démarrage...
+  - Écrit par la boucle de contrôle (cœur 1) ; /log en fait une copie
+    depuis async_tcp (cœur 0) : numéro de séquence relu après la copie
+    (verrou de séquence) -> une entrée réécrite pendant la copie est ignorée
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+
+enum EventCode : uint8_t {
+  EVT_BOOT = 0,
+  EVT_LEAK,        // value = pente L/h au moment de l'alerte
+  EVT_INFLOW,
+  EVT_SAFE_STOP,   // value = alertes (bits)
+  EVT_ALERT_ACK,
+  EVT_SENSOR_OK,        // capteur ultrason de nouveau fiable
+  EVT_SENSOR_DEGRADED,  // value = causes (sensor_health.h)
+  EVT_SENSOR_FAILED
+};
+
+inline const char* eventCodeName(uint8_t c) {
+  static const char* names[] = { "boot", "leak", "inflow", "safeStop", "ack",
+                                 "sensorOk", "sensorDegraded", "sensorFailed" };
+  return c < sizeof(names) / sizeof(names[0]) ? names[c] : "?";
+}
+
+struct LogEntry {
+  uint32_t seq;     // 1, 2, ... (0 = vide)
+  uint32_t epoch;   // heure murale (0 avant NTP)
+  uint32_t ms;      // millis()
+  uint8_t code;     // EventCode
+  float value;
+};
+
+template<uint8_t N>
+class EventLog {
+public:
+  void add(uint32_t epoch, uint32_t ms, uint8_t code, float value = 0) {
+    uint32_t seq = _total.load(std::memory_order_relaxed) + 1;
+    uint8_t k = (seq - 1) % N;
+    _seq[k].store(0, std::memory_order_relaxed);   // en cours d'écriture
+    std::atomic_thread_fence(std::memory_order_release);
+    LogEntry& e = _entries[k];
+    e.seq = seq;
+    e.epoch = epoch;
+    e.ms = ms;
+    e.code = code;
+    e.value = value;
+    _seq[k].store(seq, std::memory_order_release);
+    _total.store(seq, std::memory_order_release);
+  }
+
+  uint32_t total() const { return _total.load(std::memory_order_acquire); }
+
+  // fn(const LogEntry&) du plus ancien au plus récent
+  template<class F>
+  void forEach(F fn) const {
+    uint32_t total = _total.load(std::memory_order_acquire);
+    uint32_t first = total > N ? total - N : 0;
+    for (uint32_t i = first; i < total; i++) {
+      if (_seq[i % N].load(std::memory_order_acquire) != i + 1) continue;
+      LogEntry e = _entries[i % N];
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (_seq[i % N].load(std::memory_order_relaxed) != i + 1) continue;   // réécrite pendant la copie
+      fn(e);
+    }
+  }
+
+private:
+  LogEntry _entries[N] = {};
+  std::atomic<uint32_t> _seq[N] = {};   // séquence publiée de chaque case (0 = vide ou en écriture)
+  std::atomic<uint32_t> _total{0};
+};
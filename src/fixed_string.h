@@ -0,0 +1,89 @@
+#pragma once
+/*
+  Chaînes à capacité fixe (pile / statique), sans allocation sur le tas
+  - Remplace les String Arduino des chemins périodiques (JSON, SSE, Sheets)
+  - Troncature silencieuse signalée par truncated()
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+template<size_t N>
+class FixedString {
+  static_assert(N >= 2, "capacité trop petite");
+public:
+  FixedString() { clear(); }
+  FixedString(const char* s) { assign(s); }
+
+  void clear() { _len = 0; _buf[0] = '\0'; _truncated = false; }
+
+  FixedString& assign(const char* s) { clear(); return append(s); }
+
+  FixedString& append(const char* s) {
+    if (s == nullptr) return *this;
+    size_t n = strlen(s);
+    if (n > N - 1 - _len) { n = N - 1 - _len; _truncated = true; }
+    memcpy(_buf + _len, s, n);
+    _len += n;
+    _buf[_len] = '\0';
+    return *this;
+  }
+
+  FixedString& append(char c) {
+    if (_len < N - 1) { _buf[_len++] = c; _buf[_len] = '\0'; }
+    else _truncated = true;
+    return *this;
+  }
+
+  __attribute__((format(printf, 2, 3)))
+  FixedString& appendf(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vappendf(fmt, ap);
+    va_end(ap);
+    return *this;
+  }
+
+  FixedString& vappendf(const char* fmt, va_list ap) {
+    int w = vsnprintf(_buf + _len, N - _len, fmt, ap);
+    if (w < 0) return *this;
+    if ((size_t)w >= N - _len) { _len = N - 1; _truncated = true; }
+    else _len += (size_t)w;
+    return *this;
+  }
+
+  // Accès brut pour les fonctions qui écrivent elles-mêmes (snprintf...)
+  char* data() { return _buf; }
+  void setLength(size_t n) { _len = n < N ? n : N - 1; _buf[_len] = '\0'; }
+  size_t remaining() const { return N - 1 - _len; }
+
+  const char* c_str() const { return _buf; }
+  size_t length() const { return _len; }
+  static constexpr size_t capacity() { return N - 1; }
+  bool truncated() const { return _truncated; }
+  bool operator==(const char* s) const { return strcmp(_buf, s) == 0; }
+
+private:
+  char _buf[N];
+  size_t _len;
+  bool _truncated;
+};
+
+// ---- Formats courants ----
+typedef FixedString<12> HmsString;  // "hh:mm:ss" (heures sur 3 chiffres max)
+typedef FixedString<16> IpString;   // "255.255.255.255"
+
+inline HmsString fmtHMS(uint32_t sec) {
+  HmsString out;
+  out.appendf("%02u:%02u:%02u", (unsigned)(sec / 3600), (unsigned)((sec % 3600) / 60), (unsigned)(sec % 60));
+  return out;
+}
+
+inline IpString fmtIPv4(uint32_t addr) {  // ordre des octets lwIP (1er octet en poids faible)
+  IpString out;
+  out.appendf("%u.%u.%u.%u", (unsigned)(addr & 0xFF), (unsigned)((addr >> 8) & 0xFF),
+              (unsigned)((addr >> 16) & 0xFF), (unsigned)(addr >> 24));
+  return out;
+}
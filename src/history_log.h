@@ -0,0 +1,265 @@
+#pragma once
+/*
+  Historique longue durée : mesures périodiques + journal d'événements
+  - Enregistrements fixes de 16 octets, ajoutés dans des segments numérotés
+    (stockage : history_store.h) -> un index (segment, rang) suffit à relire
+  - Export en flux (HistoryExport) : CSV ou NDJSON produit morceau par
+    morceau dans le tampon de la réponse HTTP, filtré par plage d'epoch.
+    Mémoire constante (une ligne + quelques enregistrements), quelle que
+    soit la taille de l'export
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "byte_codec.h"
+#include "event_log.h"
+#include "sensor_health.h"
+
+#define HISTORY_RECORD_SIZE 16
+#define HISTORY_LINE_MAX    192   // ligne CSV / NDJSON la plus longue (+ marge)
+
+enum HistoryKind : uint8_t { HIST_SAMPLES = 0, HIST_EVENTS = 1 };
+enum HistoryFormat : uint8_t { HIST_CSV = 0, HIST_NDJSON = 1 };
+
+// Mesure périodique (une ligne Sheets, en plus fin)
+struct HistorySample {
+  uint32_t epoch;
+  float litres;
+  float distanceCm;
+  float tempC, humPct;
+  uint8_t mode;        // FountainMode
+  bool valve, pump, vout;
+  uint8_t sensor;      // HealthLevel du capteur ultrason
+};
+
+// Entrée du journal (event_log.h) conservée en flash
+struct HistoryEvent {
+  uint32_t epoch, ms;
+  uint8_t code;        // EventCode
+  float value;
+};
+
+// ---- Codage : petit-boutiste, indépendant de l'alignement (byte_codec.h) ----
+// epoch 4 | litres 4 | distance 2 (cm x 100) | temp 2 (°C x 100) | hum 1 | drapeaux 1 | 2 libres
+inline void historyEncode(const HistorySample& s, uint8_t* p) {
+  memset(p, 0, HISTORY_RECORD_SIZE);
+  lePut(p, s.epoch);
+  lePutF(p + 4, s.litres);
+  float d = s.distanceCm * 100.0f + 0.5f;
+  uint16_t dist = d < 0 ? 0 : d > 65535.0f ? 65535 : (uint16_t)d;
+  int16_t temp = (int16_t)(s.tempC * 100.0f + (s.tempC < 0 ? -0.5f : 0.5f));
+  lePut(p + 8, dist, 2);
+  lePut(p + 10, (uint16_t)temp, 2);
+  p[12] = s.humPct < 0 ? 0 : s.humPct > 100 ? 100 : (uint8_t)(s.humPct + 0.5f);
+  p[13] = (s.mode & 3) | s.valve << 2 | s.pump << 3 | s.vout << 4 | (s.sensor & 3) << 5;
+}
+
+inline HistorySample historyDecodeSample(const uint8_t* p) {
+  HistorySample s;
+  s.epoch = leGet(p);
+  s.litres = leGetF(p + 4);
+  s.distanceCm = leGet(p + 8, 2) / 100.0f;
+  s.tempC = (int16_t)leGet(p + 10, 2) / 100.0f;
+  s.humPct = p[12];
+  s.mode = p[13] & 3;
+  s.valve = p[13] & 4;
+  s.pump = p[13] & 8;
+  s.vout = p[13] & 16;
+  s.sensor = (p[13] >> 5) & 3;
+  return s;
+}
+
+// epoch 4 | ms 4 | valeur 4 | code 1 | 3 libres
+inline void historyEncode(const HistoryEvent& e, uint8_t* p) {
+  memset(p, 0, HISTORY_RECORD_SIZE);
+  lePut(p, e.epoch);
+  lePut(p + 4, e.ms);
+  lePutF(p + 8, e.value);
+  p[12] = e.code;
+}
+
+inline HistoryEvent historyDecodeEvent(const uint8_t* p) {
+  HistoryEvent e;
+  e.epoch = leGet(p);
+  e.ms = leGet(p + 4);
+  e.value = leGetF(p + 8);
+  e.code = p[12];
+  return e;
+}
+
+// Les deux formats commencent par l'epoch
+inline uint32_t historyRecordEpoch(const uint8_t* p) { return leGet(p); }
+
+inline const char* historyKindName(uint8_t k) { return k == HIST_EVENTS ? "events" : "samples"; }
+
+// ---- Mise en forme ----
+inline const char* historyModeName(uint8_t m) {
+  return m == 0 ? "open" : m == 1 ? "closed" : m == 2 ? "eco" : "?";
+}
+
+// Heure locale lisible (fuseau de configTime) ; buf : 20 octets
+inline const char* historyFormatTime(uint32_t epoch, char* buf) {
+  time_t t = (time_t)epoch;
+  struct tm tm;
+  localtime_r(&t, &tm);
+  strftime(buf, 20, "%Y-%m-%d %H:%M:%S", &tm);
+  return buf;
+}
+
+// Borne d'export : epoch ("1760000000") ou date locale ("2026-10-18", "2026-10-18T14:30").
+// Date seule en fin de plage : jusqu'à la fin du jour. 0 si vide ou invalide.
+inline uint32_t historyParseTime(const char* s, bool endOfDay) {
+  int y, mo, d, h = 0, mi = 0;
+  int n = sscanf(s, "%d-%d-%d%*[T ]%d:%d", &y, &mo, &d, &h, &mi);
+  if (n >= 3 && y >= 1970) {
+    struct tm tm = {};
+    tm.tm_year = y - 1900;
+    tm.tm_mon = mo - 1;
+    tm.tm_mday = d;
+    tm.tm_hour = h;
+    tm.tm_min = mi;
+    tm.tm_isdst = -1;
+    time_t t = mktime(&tm);
+    if (t == (time_t)-1 || t < 0) return 0;
+    return (uint32_t)t + (n == 3 && endOfDay ? 86399 : n == 5 && endOfDay ? 59 : 0);
+  }
+  char* end;
+  unsigned long v = strtoul(s, &end, 10);
+  return end != s && *end == '\0' ? (uint32_t)v : 0;
+}
+
+// Ligne d'en-tête (CSV seulement), "" en NDJSON
+inline int historyFormatHeader(uint8_t kind, uint8_t format, char* buf, size_t size) {
+  if (format != HIST_CSV) {
+    if (size) buf[0] = '\0';
+    return 0;
+  }
+  if (kind == HIST_EVENTS) return snprintf(buf, size, "epoch,time,ms,event,value\n");
+  return snprintf(buf, size, "epoch,time,litres,distanceCm,tempC,humPct,mode,valve,pump,vout,sensor\n");
+}
+
+// Une ligne terminée par '\n' ; retourne sa longueur (comme snprintf)
+inline int historyFormatRecord(uint8_t kind, uint8_t format, const uint8_t* rec, char* buf, size_t size) {
+  char when[20];
+  if (kind == HIST_EVENTS) {
+    HistoryEvent e = historyDecodeEvent(rec);
+    historyFormatTime(e.epoch, when);
+    if (format == HIST_CSV)
+      return snprintf(buf, size, "%u,%s,%u,%s,%.3f\n", (unsigned)e.epoch, when, (unsigned)e.ms,
+                      eventCodeName(e.code), e.value);
+    return snprintf(buf, size, "{\"epoch\":%u,\"time\":\"%s\",\"ms\":%u,\"event\":\"%s\",\"value\":%.3f}\n",
+                    (unsigned)e.epoch, when, (unsigned)e.ms, eventCodeName(e.code), e.value);
+  }
+  HistorySample s = historyDecodeSample(rec);
+  historyFormatTime(s.epoch, when);
+  if (format == HIST_CSV)
+    return snprintf(buf, size, "%u,%s,%.3f,%.2f,%.2f,%.0f,%s,%d,%d,%d,%s\n",
+                    (unsigned)s.epoch, when, s.litres, s.distanceCm, s.tempC, s.humPct,
+                    historyModeName(s.mode), s.valve, s.pump, s.vout, healthLevelName(s.sensor));
+  return snprintf(buf, size,
+                  "{\"epoch\":%u,\"time\":\"%s\",\"litres\":%.3f,\"distanceCm\":%.2f,\"tempC\":%.2f,"
+                  "\"humPct\":%.0f,\"mode\":\"%s\",\"valve\":%s,\"pump\":%s,\"vout\":%s,\"sensor\":\"%s\"}\n",
+                  (unsigned)s.epoch, when, s.litres, s.distanceCm, s.tempC, s.humPct, historyModeName(s.mode),
+                  s.valve ? "true" : "false", s.pump ? "true" : "false", s.vout ? "true" : "false",
+                  healthLevelName(s.sensor));
+}
+
+// ===================== Export en flux =====================
+// Source : accès en lecture au stockage d'UNE série (samples ou events)
+//   bool range(uint32_t& first, uint32_t& last)   segments présents (false : aucun)
+//   int  read(uint32_t seg, uint32_t index, uint8_t* out, int maxRecords)
+//        -> nombre d'enregistrements lus, 0 = fin du segment (ou segment supprimé)
+// Enregistrements supposés chronologiques (écrits seulement avec une heure NTP) :
+// les segments entièrement antérieurs à from sont sautés sans être lus, la
+// lecture s'arrête au premier enregistrement postérieur à to.
+template<class Source>
+class HistoryExport {
+public:
+  HistoryExport(const Source& src, uint8_t kind, uint8_t format, uint32_t from, uint32_t to)
+    : _src(src), _kind(kind), _format(format), _from(from), _to(to) {}
+
+  Source& source() { return _src; }
+  uint32_t rows() const { return _rows; }
+
+  // Remplit buf (maxLen octets au plus) ; 0 = export terminé
+  size_t read(uint8_t* buf, size_t maxLen) {
+    size_t n = 0;
+    while (n < maxLen) {
+      if (_linePos == _lineLen && !nextLine()) break;
+      size_t k = _lineLen - _linePos;
+      if (k > maxLen - n) k = maxLen - n;
+      memcpy(buf + n, _line + _linePos, k);
+      _linePos += k;
+      n += k;
+    }
+    return n;
+  }
+
+private:
+  enum : uint8_t { S_HEADER, S_SEEK, S_ROWS, S_DONE };
+  static const int BATCH = 8;   // enregistrements lus à la fois
+
+  bool nextLine() {
+    _linePos = _lineLen = 0;
+    for (;;) {
+      switch (_state) {
+        case S_HEADER: {
+          _state = S_SEEK;
+          int w = historyFormatHeader(_kind, _format, _line, sizeof(_line));
+          if (w > 0) { _lineLen = (size_t)w < sizeof(_line) ? w : sizeof(_line) - 1; return true; }
+          break;
+        }
+        case S_SEEK:
+          if (!_src.range(_seg, _lastSeg)) { _state = S_DONE; break; }
+          // Segment suivant commençant avant from : celui-ci est entièrement trop ancien
+          while (_from && _seg != _lastSeg) {
+            uint8_t first[HISTORY_RECORD_SIZE];
+            if (_src.read(_seg + 1, 0, first, 1) == 1 && historyRecordEpoch(first) >= _from) break;
+            _seg++;
+          }
+          _index = 0;
+          _state = S_ROWS;
+          break;
+        case S_ROWS: {
+          if (_batchPos == _batchLen) {
+            _batchPos = 0;
+            _batchLen = _src.read(_seg, _index, _batch, BATCH);
+            if (_batchLen <= 0) {
+              _batchLen = 0;
+              if (_seg == _lastSeg) { _state = S_DONE; break; }
+              _seg++;
+              _index = 0;
+              break;
+            }
+            _index += _batchLen;
+          }
+          const uint8_t* rec = _batch + HISTORY_RECORD_SIZE * _batchPos++;
+          uint32_t epoch = historyRecordEpoch(rec);
+          if (epoch < _from) break;
+          if (_to && epoch > _to) { _state = S_DONE; break; }
+          int w = historyFormatRecord(_kind, _format, rec, _line, sizeof(_line));
+          if (w <= 0) break;
+          _lineLen = (size_t)w < sizeof(_line) ? w : sizeof(_line) - 1;
+          _rows++;
+          return true;
+        }
+        case S_DONE:
+          return false;
+      }
+    }
+  }
+
+  Source _src;
+  uint8_t _kind, _format;
+  uint32_t _from, _to;            // to = 0 : jusqu'au bout
+  uint8_t _state = S_HEADER;
+  uint32_t _seg = 0, _lastSeg = 0, _index = 0;
+  uint8_t _batch[BATCH * HISTORY_RECORD_SIZE];
+  int _batchLen = 0, _batchPos = 0;
+  char _line[HISTORY_LINE_MAX];
+  size_t _lineLen = 0, _linePos = 0;
+  uint32_t _rows = 0;
+};
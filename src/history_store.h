@@ -0,0 +1,153 @@
+#pragma once
+/*
+  Stockage de l'historique (history_log.h) sur LittleFS, partition "spiffs"
+  - Deux séries : /hist/s<n>.bin (mesures) et /hist/e<n>.bin (événements),
+    segments à ajout seul de HISTORY_SEGMENT_RECORDS enregistrements ;
+    le plus ancien segment est supprimé au-delà du quota de la série
+  - Écriture : boucle de contrôle (un enregistrement de 16 octets toutes les
+    quelques minutes) ; lecture : export en flux depuis la tâche async_tcp.
+    LittleFS sérialise les accès ; les bornes de segments sont des mots
+    32 bits (lecture atomique), un segment supprimé pendant un export est
+    simplement sauté
+*/
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "history_log.h"
+
+#define HISTORY_DIR              "/hist"
+#define HISTORY_SEGMENT_RECORDS  1024   // 16 Ko par segment
+
+class HistoryStore {
+public:
+  // maxSegments : quota de chaque série (HIST_SAMPLES, HIST_EVENTS)
+  HistoryStore(uint16_t maxSamplesSegments, uint16_t maxEventsSegments) {
+    _s[HIST_SAMPLES].maxSegments = maxSamplesSegments;
+    _s[HIST_EVENTS].maxSegments = maxEventsSegments;
+  }
+
+  // Monte la partition (formatée si illisible) et retrouve les segments existants
+  bool begin() {
+    _ok = LittleFS.begin(true);
+    if (!_ok) return false;
+    if (!LittleFS.exists(HISTORY_DIR)) LittleFS.mkdir(HISTORY_DIR);
+    File dir = LittleFS.open(HISTORY_DIR);
+    for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+      char prefix;
+      unsigned n;
+      if (sscanf(f.name(), "%c%u.bin", &prefix, &n) != 2) continue;
+      if (prefix != 's' && prefix != 'e') continue;
+      Series& s = _s[prefix == 'e' ? HIST_EVENTS : HIST_SAMPLES];
+      if (!s.any || n < s.first) s.first = n;
+      if (!s.any || n > s.last) {
+        s.last = n;
+        s.lastSize = f.size();
+      }
+      s.any = true;
+    }
+    for (uint8_t k = 0; k < 2; k++) {
+      Series& s = _s[k];
+      // Fin de segment tronquée (coupure pendant une écriture) : on repart d'un segment neuf
+      s.count = s.any && s.lastSize % HISTORY_RECORD_SIZE == 0 ? s.lastSize / HISTORY_RECORD_SIZE
+                                                               : HISTORY_SEGMENT_RECORDS;
+    }
+    return true;
+  }
+
+  bool ok() const { return _ok; }
+
+  // Ajoute un enregistrement (boucle de contrôle)
+  bool append(uint8_t kind, const uint8_t* rec) {
+    if (!_ok) return false;
+    Series& s = _s[kind];
+    if (!s.any || s.count >= HISTORY_SEGMENT_RECORDS) {
+      uint32_t next = s.any ? s.last + 1 : 0;
+      while (s.any && next - s.first >= s.maxSegments) {
+        char path[24];
+        LittleFS.remove(segmentPath(kind, s.first, path));
+        s.first++;
+      }
+      if (!s.any) s.first = next;
+      s.last = next;
+      s.count = 0;
+      s.any = true;
+    }
+    char path[24];
+    File f = LittleFS.open(segmentPath(kind, s.last, path), FILE_APPEND);
+    if (!f) { s.errors++; return false; }
+    bool ok = f.write(rec, HISTORY_RECORD_SIZE) == HISTORY_RECORD_SIZE;
+    f.close();
+    if (!ok) { s.errors++; return false; }
+    s.count++;
+    s.written++;
+    return true;
+  }
+
+  bool append(const HistorySample& v) { uint8_t r[HISTORY_RECORD_SIZE]; historyEncode(v, r); return append(HIST_SAMPLES, r); }
+  bool append(const HistoryEvent& v)  { uint8_t r[HISTORY_RECORD_SIZE]; historyEncode(v, r); return append(HIST_EVENTS, r); }
+
+  static const char* segmentPath(uint8_t kind, uint32_t seg, char* buf) {
+    snprintf(buf, 24, HISTORY_DIR "/%c%u.bin", kind == HIST_EVENTS ? 'e' : 's', (unsigned)seg);
+    return buf;
+  }
+
+  // Source de HistoryExport : garde le segment courant ouvert entre deux morceaux
+  class Source {
+  public:
+    Source(const HistoryStore& store, uint8_t kind) : _store(&store), _kind(kind) {}
+
+    bool range(uint32_t& first, uint32_t& last) const {
+      const Series& s = _store->_s[_kind];
+      if (!_store->_ok || !s.any) return false;
+      first = s.first;
+      last = s.last;
+      return true;
+    }
+
+    int read(uint32_t seg, uint32_t index, uint8_t* out, int maxRecords) {
+      if (!_file || seg != _seg) {
+        if (_file) _file.close();
+        char path[24];
+        _file = LittleFS.open(segmentPath(_kind, seg, path), FILE_READ);
+        _seg = seg;
+        if (!_file) return 0;
+      }
+      if (!_file.seek(index * HISTORY_RECORD_SIZE)) return 0;
+      int n = _file.read(out, maxRecords * HISTORY_RECORD_SIZE);
+      return n > 0 ? n / HISTORY_RECORD_SIZE : 0;
+    }
+
+  private:
+    const HistoryStore* _store;
+    uint8_t _kind;
+    File _file;
+    uint32_t _seg = 0;
+  };
+
+  // "history":{...} pour /metrics
+  size_t printStats(char* buf, size_t size) const {
+    const Series& a = _s[HIST_SAMPLES];
+    const Series& b = _s[HIST_EVENTS];
+    int w = snprintf(buf, size,
+      "\"history\":{\"mounted\":%s,\"usedBytes\":%u,\"totalBytes\":%u,"
+      "\"samples\":{\"segments\":%u,\"written\":%u,\"errors\":%u},"
+      "\"events\":{\"segments\":%u,\"written\":%u,\"errors\":%u}}",
+      _ok ? "true" : "false", _ok ? (unsigned)LittleFS.usedBytes() : 0u, _ok ? (unsigned)LittleFS.totalBytes() : 0u,
+      a.any ? (unsigned)(a.last - a.first + 1) : 0u, (unsigned)a.written, (unsigned)a.errors,
+      b.any ? (unsigned)(b.last - b.first + 1) : 0u, (unsigned)b.written, (unsigned)b.errors);
+    if (w < 0) return 0;
+    return (size_t)w < size ? (size_t)w : size - 1;
+  }
+
+private:
+  struct Series {
+    uint16_t maxSegments = 1;
+    bool any = false;
+    volatile uint32_t first = 0, last = 0;   // segments présents
+    uint32_t lastSize = 0;
+    uint32_t count = 0;                      // enregistrements du dernier segment
+    uint32_t written = 0, errors = 0;
+  };
+
+  bool _ok = false;
+  Series _s[2];
+};
@@ -0,0 +1,102 @@
+#pragma once
+/*
+  Bus I2C partagé (OLED SSD1306 + AHT20)
+  - Horloge rapide (400 kHz par défaut) et délai maximal par transaction
+  - Déblocage : un esclave réinitialisé en pleine trame peut garder SDA à
+    l'état bas ; 9 coups d'horloge sur SCL puis une condition STOP le
+    libèrent, le contrôleur est ensuite réinitialisé
+  - Occupation : durée des transactions mesurée (I2cBus::Scope), taux
+    d'occupation sur une fenêtre glissante d'environ 10 s
+*/
+#include <Arduino.h>
+#include <Wire.h>
+
+#define I2C_TIMEOUT_MS  20   // transaction bloquée -> erreur plutôt qu'attente
+
+class I2cBus {
+public:
+  void begin(int sda, int scl, uint32_t hz) {
+    _sda = sda;
+    _scl = scl;
+    _hz = hz;
+    Wire.begin(sda, scl, hz);
+    Wire.setTimeOut(I2C_TIMEOUT_MS);
+  }
+
+  // Mesure la durée d'une transaction (ou d'une suite) sur le bus
+  class Scope {
+  public:
+    explicit Scope(I2cBus& bus) : _bus(bus), _t0(micros()) {}
+    ~Scope() { _bus._busyUs += micros() - _t0; }
+  private:
+    I2cBus& _bus;
+    uint32_t _t0;
+  };
+
+  // Esclave présent ? (adresse seule, quelques dizaines de µs à 400 kHz)
+  bool probe(uint8_t addr) {
+    Scope s(*this);
+    Wire.beginTransmission(addr);
+    return Wire.endTransmission() == 0;
+  }
+
+  // Transaction en échec : déblocage si SDA est tenue à l'état bas
+  void failed() {
+    _errors++;
+    if (digitalRead(_sda) == LOW) recover();
+  }
+
+  bool recover() {
+    _recoveries++;
+    Wire.end();
+    pinMode(_sda, INPUT_PULLUP);
+    pinMode(_scl, OUTPUT_OPEN_DRAIN);
+    for (uint8_t i = 0; i < 9 && digitalRead(_sda) == LOW; i++) {
+      digitalWrite(_scl, LOW);
+      delayMicroseconds(5);
+      digitalWrite(_scl, HIGH);
+      delayMicroseconds(5);
+    }
+    // STOP : SDA monte pendant que SCL est haut
+    pinMode(_sda, OUTPUT_OPEN_DRAIN);
+    digitalWrite(_sda, LOW);
+    delayMicroseconds(5);
+    digitalWrite(_scl, HIGH);
+    delayMicroseconds(5);
+    digitalWrite(_sda, HIGH);
+    delayMicroseconds(5);
+    bool freed = digitalRead(_sda) == HIGH;
+    Wire.begin(_sda, _scl, _hz);
+    Wire.setTimeOut(I2C_TIMEOUT_MS);
+    return freed;
+  }
+
+  // Une fois par boucle : fenêtre d'occupation (~10 s, moyenne exponentielle par seconde)
+  void tick(uint32_t nowMs) {
+    uint32_t elapsed = nowMs - _windowMs;
+    if (elapsed < 1000) return;
+    float u = (_busyUs - _windowBusyUs) / (elapsed * 1000.0f);
+    _utilization += 0.1f * ((u > 1 ? 1 : u) - _utilization);
+    _windowMs = nowMs;
+    _windowBusyUs = _busyUs;
+  }
+
+  float utilization() const { return _utilization; }
+
+  // "i2c":{...} pour /metrics
+  size_t printStats(char* buf, size_t size) const {
+    int w = snprintf(buf, size,
+      "\"i2c\":{\"hz\":%u,\"utilization\":%.3f,\"busyMs\":%u,\"errors\":%u,\"recoveries\":%u}",
+      (unsigned)_hz, _utilization, (unsigned)(_busyUs / 1000), (unsigned)_errors, (unsigned)_recoveries);
+    if (w < 0) return 0;
+    return (size_t)w < size ? (size_t)w : size - 1;
+  }
+
+private:
+  int _sda = 21, _scl = 22;
+  uint32_t _hz = 100000;
+  uint64_t _busyUs = 0, _windowBusyUs = 0;
+  uint32_t _windowMs = 0;
+  float _utilization = 0;
+  uint32_t _errors = 0, _recoveries = 0;
+};
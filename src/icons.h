@@ -1,5 +1,11 @@
 #pragma once
+// Bitmaps 1 bit/pixel (format drawBitmap d'Adafruit_GFX) ; PROGMEM vide hors carte (host/)
+// Source seulement : le firmware inclut icons_rle.h, généré par host/icons_pack.py
+#ifdef ARDUINO
 #include <Arduino.h>
+#else
+#define PROGMEM
+#endif
 
 // 'wifi_0', 20x15px
 const unsigned char wifi_0 [] PROGMEM = {
@@ -0,0 +1,88 @@
+#pragma once
+// Généré par host/icons_pack.py depuis icons.h : ne pas modifier à la main
+// Icônes au format de page SSD1306, codées par plages (décodage : rle_blit.h)
+//
+// ressource                  brut  compressé    gain
+// wifi_0 20x15                 45         20    56 %
+// wifi_1 20x15                 45         20    56 %
+// wifi_2 20x15                 45         28    38 %
+// wifi_3 20x15                 45         40    11 %
+// wifi_4 20x15                 45         41     9 %
+// wifi_none 20x15              45         47    -4 %
+// robinet 52x52               364        143    61 %
+// bac 52x52                   364        146    60 %
+// icônes                      998        485    51 %
+// index_html (gzip)         11875       3637    69 %
+// total flash               12873       4122    68 %
+// RAM : 0 octet de plus (décodage dans le tampon de 1024 octets de l'afficheur)
+#include "rle_blit.h"
+
+// 'wifi_0', 20x15px : 12 octets
+const uint8_t wifi_0_rle [] PROGMEM = {
+  0x88,0x01,0xb6,0xb6,0x8f,0x05,0x10,0x28,0x45,0x45,0x28,0x10,
+};
+const RleIcon wifi_0 = { 20, 15, sizeof(wifi_0_rle), wifi_0_rle };
+
+// 'wifi_1', 20x15px : 12 octets
+const uint8_t wifi_1_rle [] PROGMEM = {
+  0x88,0x01,0xb6,0xb6,0x8f,0x05,0x10,0x38,0x7d,0x7d,0x38,0x10,
+};
+const RleIcon wifi_1 = { 20, 15, sizeof(wifi_1_rle), wifi_1_rle };
+
+// 'wifi_2', 20x15px : 20 octets
+const uint8_t wifi_2_rle [] PROGMEM = {
+  0x86,0x05,0x80,0x80,0xb6,0xb6,0x80,0x80,0x8b,0x09,0x06,0x07,0x13,0x39,0x7d,0x7d,
+  0x39,0x13,0x07,0x06,
+};
+const RleIcon wifi_2 = { 20, 15, sizeof(wifi_2_rle), wifi_2_rle };
+
+// 'wifi_3', 20x15px : 32 octets
+const uint8_t wifi_3_rle [] PROGMEM = {
+  0x82,0x0d,0x80,0xc0,0xe0,0x70,0xb0,0xb0,0xb6,0xb6,0xb0,0xb0,0x70,0xe0,0xc0,0x80,
+  0x85,0x0d,0x01,0x01,0x06,0x07,0x13,0x39,0x7d,0x7d,0x39,0x13,0x07,0x06,0x01,0x01,
+};
+const RleIcon wifi_3 = { 20, 15, sizeof(wifi_3_rle), wifi_3_rle };
+
+// 'wifi_4', 20x15px : 33 octets
+const uint8_t wifi_4_rle [] PROGMEM = {
+  0x80,0x05,0x60,0x70,0xb8,0xdc,0xee,0x76,0xc4,0xb6,0x05,0x76,0xee,0xdc,0xb8,0x70,
+  0x60,0x83,0x0d,0x01,0x01,0x06,0x07,0x13,0x39,0x7d,0x7d,0x39,0x13,0x07,0x06,0x01,
+  0x01,
+};
+const RleIcon wifi_4 = { 20, 15, sizeof(wifi_4_rle), wifi_4_rle };
+
+// 'wifi_none', 20x15px : 39 octets
+const uint8_t wifi_none_rle [] PROGMEM = {
+  0x13,0x20,0x50,0x88,0x04,0x04,0x02,0x02,0x01,0x81,0xc1,0xe1,0x71,0x39,0x1c,0x0e,
+  0x07,0x03,0x89,0x50,0x20,0x80,0x0f,0x40,0x60,0x71,0x3a,0x1c,0x0e,0x17,0x23,0x41,
+  0x40,0x20,0x10,0x08,0x04,0x02,0x01,
+};
+const RleIcon wifi_none = { 20, 15, sizeof(wifi_none_rle), wifi_none_rle };
+
+// 'robinet', 52x52px : 135 octets
+const uint8_t robinet_rle [] PROGMEM = {
+  0x80,0x01,0xe0,0x20,0xc1,0x10,0x01,0x30,0xe0,0x82,0x07,0x30,0x30,0xb0,0xf0,0xf0,
+  0xb0,0x30,0x30,0xa1,0x00,0xff,0x84,0x00,0xff,0xc9,0x81,0x09,0x83,0x03,0x02,0x06,
+  0x04,0x0c,0x18,0x30,0xe0,0xc0,0x97,0x02,0x07,0xc8,0xc8,0xc1,0x08,0x00,0x07,0x8a,
+  0x03,0x01,0x83,0x47,0x7c,0xc3,0x40,0x03,0x43,0x7f,0x40,0x80,0x8f,0x01,0xc0,0xc0,
+  0x83,0x01,0xff,0xff,0x8f,0x0b,0x01,0xfa,0xfa,0x02,0x02,0xfa,0xfa,0x02,0x02,0xfa,
+  0xfa,0x01,0x8f,0x01,0xff,0xff,0x83,0x01,0xff,0xff,0x81,0xc3,0x18,0x81,0xc5,0x18,
+  0x81,0xc6,0x18,0x81,0xc5,0x18,0x81,0xc3,0x18,0x81,0x01,0xff,0xff,0x83,0x01,0xff,
+  0xff,0x81,0xc3,0x0c,0x81,0xc5,0x0c,0x81,0xc6,0x0c,0x81,0xc5,0x0c,0x81,0xc3,0x0c,
+  0x81,0x01,0xff,0xff,0x83,0xee,0x03,
+};
+const RleIcon robinet = { 52, 52, sizeof(robinet_rle), robinet_rle };
+
+// 'bac', 52x52px : 138 octets
+const uint8_t bac_rle [] PROGMEM = {
+  0x96,0xc5,0x80,0xa4,0x15,0xc0,0x70,0x18,0x0c,0x06,0x02,0x03,0x01,0x01,0xc0,0x70,
+  0x38,0x70,0xc0,0x01,0x01,0x23,0x36,0x3e,0x3c,0x3e,0x3f,0x90,0x01,0xc0,0xc0,0x89,
+  0x02,0x3f,0xe1,0x80,0x83,0x03,0x70,0x8c,0x03,0x01,0x82,0x03,0x01,0x03,0x8c,0x70,
+  0x83,0x02,0xc0,0xe1,0x3f,0x88,0x01,0xc0,0xc0,0x83,0x01,0xff,0xff,0x8a,0x15,0x01,
+  0x03,0x0e,0x1c,0x18,0x30,0x20,0x61,0x63,0x42,0x46,0x44,0x46,0x42,0x63,0x61,0x30,
+  0x30,0x18,0x0c,0x07,0x03,0x8a,0x01,0xff,0xff,0x83,0x01,0xff,0xff,0x81,0xc3,0x18,
+  0x81,0xc5,0x18,0x81,0xc6,0x18,0x81,0xc5,0x18,0x81,0xc3,0x18,0x81,0x01,0xff,0xff,
+  0x83,0x01,0xff,0xff,0x81,0xc3,0x0c,0x81,0xc5,0x0c,0x81,0xc6,0x0c,0x81,0xc5,0x0c,
+  0x81,0xc3,0x0c,0x81,0x01,0xff,0xff,0x83,0xee,0x03,
+};
+const RleIcon bac = { 52, 52, sizeof(bac_rle), bac_rle };
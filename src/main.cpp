@@ -2,9 +2,11 @@
   ESP32 — Niveau d'eau + PIR + Relais (électrovanne/pompe) + OLED + Web en temps réel
   - SIMULATION : capteurs HC-SR04 & SR602 simulés
   - RÉEL       : lecture capteurs
-  - Web        : / (page HTML), /events (SSE), /status (JSON)
+  - Web        : / (page HTML), /events (SSE), /status (JSON), /schedule (programmation),
+                 /log (journal, alertes de fuite), /export (historique CSV/NDJSON), /update (OTA)
+  - MQTT       : un sujet conservé par champ, commandes mode / vidange / intervalle
   - OLED       : RSSI (≤15 px), niveau d'eau (%)
-  Librairies : Wire, Adafruit_SSD1306, WiFi, AsyncTCP, ESPAsyncWebServer
+  Librairies : Wire, Adafruit_SSD1306, WiFi, AsyncTCP, ESPAsyncWebServer, PubSubClient
 */
 #include <Arduino.h>
 #include <Wire.h>
@@ -13,40 +15,59 @@
 #include <WiFi.h>
 #include <AsyncTCP.h>
 #include <ESPAsyncWebServer.h>
-#include <WiFiClientSecure.h>
-#include <HTTPClient.h>
 #include <EEPROM.h>
+#include <LittleFS.h>
 #include <time.h>
-#include "icons.h"
+#include <memory>
+#include "web_page_gz.h"   // index_html compressé (host/icons_pack.py)
+#include "status_json.h"
+#include "fixed_string.h"
+#include "calibration.h"
+#include "control.h"
+#include "schedule.h"
+#include "ranging.h"
+#include "sensor_trace.h"
+#include "sse_fanout.h"
+#include "ota_update.h"
+#include "anomaly.h"
+#include "event_log.h"
+#include "sensor_health.h"
+#include "history_store.h"
+#include "actuators.h"
+#include "i2c_bus.h"
+#include "display_power.h"
+#include "oled_view.h"
+#include "tls_uploader.h"
+#include "perf_trace.h"
+#include "visit_model.h"
+#include "consumption.h"
+#include "pump_control.h"
+#include "edf_scheduler.h"
+#include "mqtt_link.h"
+#include "module_params.h"
+#include "status_view.h"
 
 // ===================== EEPROM =====================
-#define EEPROM_SIZE 64
+#define EEPROM_SIZE 128
 #define EEPROM_MODE_ADDR 0
 #define EEPROM_MAGIC_ADDR 1
 #define EEPROM_MAGIC_VALUE 0xA5
 #define EEPROM_TIMESTAMP_ADDR 2
 #define EEPROM_DRAIN_VALUE    6   // 2 octets pour la valeur (1-720)
 #define EEPROM_DRAIN_UNIT     8   // 1 octet (0=days, 1=hours)
+#define EEPROM_CAL_ADDR      16   // magic, nb points, 12 x (2+2 octets), somme
+#define EEPROM_CAL_MAGIC   0xC1
+#define EEPROM_SCHED_ADDR    72   // magic, 8 x (drapeaux, jours, minute 2 octets, durée 2 octets), somme
+#define EEPROM_SCHED_MAGIC 0x5C
 
 // ===================== Configuration générale =====================
 #define SIMULATION false          // true = simulateur; false = capteurs réels
 
-// ---- Modes de fonctionnement ----
-enum FountainMode {
-  MODE_OPEN_CYCLE = 0,   // Actuel : remplissage PIR + pompe auto
-  MODE_CLOSED_CYCLE = 1, // Eau réservoir en continu
-  MODE_ECO_HYBRID = 2    // Remplissage puis 5j fermé avant vidange
-};
-
-FountainMode currentMode = MODE_CLOSED_CYCLE;
-
-// Pour le mode Eco/Hybride
-uint32_t lastEV1OnTimestamp = 0;  // timestamp epoch (secondes depuis 1970)
-bool ecoInClosedPhase = false;
-uint32_t ecoDrainIntervalSec = 5UL * 24UL * 3600UL; // Modifiable via web
-String ecoDrainUnit = "days"; // "hours" ou "days"
+// ---- Modes de fonctionnement : FountainMode (control.h) ----
+// Mode Eco/Hybride : intervalle de vidange tel que saisi sur la page web
+enum DrainUnit : uint8_t { DRAIN_DAYS = 0, DRAIN_HOURS = 1 }; // = code EEPROM
+DrainUnit ecoDrainUnit = DRAIN_DAYS;
 uint32_t ecoDrainValue = 5;   // Valeur affichée (5 jours ou X heures)
-bool manualDrainActive = false; // Vidange manuelle
 
 
 // ---- WiFi ----
@@ -73,15 +94,34 @@ const char* GSCRIPT_TOKEN = "m4rwE7J8XWax57RNmXNsfDsK7BKpbwZC";
 
 // Cadence d’envoi vers Sheets
 const uint32_t SHEET_INTERVAL_MS = 60UL * 15000UL; // 15 minute (ajuste)
-unsigned long lastSheetMs = 0;
+// Connexion gardée jusqu'à l'envoi suivant ; en pratique Google la coupe
+// avant et idle() la libère aussitôt (seule la session TLS est conservée)
+const uint32_t SHEETS_KEEPALIVE_MS = SHEET_INTERVAL_MS + 60000UL;
+TlsUploader sheets(SHEETS_KEEPALIVE_MS);
+
+// === MQTT (mqtt_link.h) : courtier local, à côté de Sheets ===
+// <base>/<champ> (conservés), <base>/status, <base>/cmd/mode|drain|interval -> <base>/ack
+const MqttConfig MQTT_CONFIG = {
+  "192.168.1.10", 1883,   // courtier (mosquitto) ; "" : désactivé
+  WIFI_HOSTNAME,          // identifiant client
+  "", "",                 // utilisateur, mot de passe ("" : sans)
+  "fontaine",             // préfixe des sujets
+  30,                     // s : keep-alive
+  2000, 60000             // ms : reconnexion, attente doublée jusqu'à 1 min
+};
+const uint32_t MQTT_SAMPLE_MS = 1000;   // champs comparés à la dernière valeur publiée
+const uint8_t  MQTT_QUEUE     = 48;     // messages gardés, courtier injoignable (~1,7 Ko)
 
 // ---- OLED SSD1306 (SDA=21, SCL=22) ----
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
 #define OLED_RESET    -1
 #define OLED_ADDR   0x3C
+const uint32_t I2C_CLOCK_HZ = 400000; // OLED + AHT20 (la plupart des SSD1306 tiennent 800 kHz)
+// DISPLAY_POWER : extinction de l'écran (module_params.h)
 
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+// Même horloge pendant et après les trames (par défaut la librairie repasse à 100 kHz)
+Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET, I2C_CLOCK_HZ, I2C_CLOCK_HZ);
 Adafruit_AHTX0 aht;
 
 // ---- Brochage (adapter selon votre câblage réel) ----
@@ -89,327 +129,229 @@ const int PIN_ECHO  = 12;   // HC-SR04 ECHO (si réel)
 const int PIN_TRIG  = 13;   // HC-SR04 TRIG (si réel)
 const int PIN_PIR   = 14;   // SR602 (si réel)
 const int PIN_VALVE = 18;   // Relais EV_out
-const int PIN_PUMP  = 19;   // Relais pompe + ancienne EV
+const int PIN_PUMP  = 19;   // Pompe : grille du MOSFET (PWM), plus de relais
 const bool ACTIVE_LOW = true; // true si relais actifs à LOW
 const int PIN_EV1_AIN1 = 33; // EV1
 const int PIN_EV1_AIN2 = 32;
 const int PIN_EV1_PWMA = 23;
-/* 
-const int PIN_EV2_BIN1 = 25; //EV2
+const int PIN_EV2_BIN1 = 25; // EV2 (même TB6612, voie B)
 const int PIN_EV2_BIN2 = 26;
-const int PIN_EV2_PWMB = 27; 
-*/
+const int PIN_EV2_PWMB = 27;
 
 const int EV_PULSE_MS = 50; // durée impulsion électrovanne bistable
+const bool EV2_FILL_ZONE = true; // EV2 = 2e arrivée d'eau, suit la décision de remplissage d'EV1
+
+// ---- Actionneurs (actuators.h) : type et brochage de chaque voie à la compilation ----
+typedef LatchedValve<PIN_EV1_AIN1, PIN_EV1_AIN2, PIN_EV1_PWMA, EV_PULSE_MS> ValveEV1;
+typedef LatchedValve<PIN_EV2_BIN1, PIN_EV2_BIN2, PIN_EV2_PWMB, EV_PULSE_MS> ValveEV2;
+typedef PwmOutput<PIN_PUMP, 0, 20000, 10, 1500> PumpDrive;   // LEDC canal 0, 20 kHz (inaudible), 10 bits, rampe 1,5 s
+typedef Relay<PIN_VALVE, ACTIVE_LOW> OutRelay;
+typedef ActuatorBank<Guarded<ValveEV1>, Guarded<ValveEV2>, Guarded<PumpDrive>, Guarded<OutRelay>> Actuators;
+enum : uint8_t { ACT_EV1, ACT_EV2, ACT_PUMP, ACT_OUT };   // ordre des voies ci-dessus
+
+// ---- Usure (wear.h, /wear) : VALVE_WEAR / PUMP_WEAR (module_params.h) ----
+#define WEAR_FILE "/wear.bin"
 
 // ---- Cuve & seuils ----
 const float TANK_HEIGHT_CM   = 9.1; // hauteur utile d'eau
 const float SENSOR_OFFSET_CM = 2.0;  // distance min capteur->surface pleine
+const float TANK_CAPACITY_L  = 4.0;  // volume utile supposé tant que le bassin n'est pas calibré
 
+// Seuils en % du VOLUME utile (table de calibration), convertis en litres
 const int LEVEL_TARGET_FILL  = 90; // % à atteindre quand remplissage autorisé
 const int PUMP_ON_ABOVE      = 85; // % déclenche pompe au-dessus
 const int PUMP_OFF_BELOW     = 25; // % arrêt pompe en redescendant
+const int DRAIN_STOP_LEVEL   = 10; // % fin de vidange (éco / manuelle)
+const int MANUAL_DRAIN_FLOOR = 5;  // % arrêt de sécurité de la vidange manuelle
 const int MOTION_HOLD_SECONDS= 3; // s d'autorisation après détection
 
+// ---- Pré-remplissage appris, consommation, vitesse de la pompe (module_params.h) ----
+#define VISIT_FILE "/visits.bin"
+#define USAGE_FILE "/usage.bin"
+const float PUMP_RECIRC_DUTY     = 0.7f;    // cycle fermé : jet plus calme qu'à plein débit
+
+// Fichiers d'état (visites, consommation) : écrits au plus une fois par heure, et avant une OTA
+const uint32_t STATE_SAVE_MS = 3600000UL;
+
+// ---- Santé des capteurs (sensor_health.h) : ULTRASONIC_HEALTH / AHT_HEALTH (module_params.h) ----
+// Niveau douteux : durée ON maximale avant maintien au repos
+const uint32_t DEGRADED_VALVE_MAX_MS = 30000;   // remplissage à l'aveugle
+const uint32_t DEGRADED_PUMP_MAX_MS  = 600000;  // pompe (et vidange) à l'aveugle
+
 // ---- Simulation ----
 const float SIM_FILL_RATE_PCT_S  = 2.0; // %/s si vanne ouverte
 const float SIM_DRAIN_RATE_PCT_S = 5.0; // %/s si pompe ON
 const float SIM_LEAK_RATE_PCT_S  = 0.001;  // fuite naturelle
 const bool  SIM_FAKE_PIR_BURSTS  = true; // bursts de PIR
 
-// ---- Intervalles non bloquants ----
+// ---- Tâches de loop() (edf_scheduler.h, /sched) ----
 const uint32_t LOGIC_INTERVAL_MS = 50;
 const uint32_t OLED_INTERVAL_MS  = 250;
 const uint32_t SSE_INTERVAL_MS   = 3000;
+const uint8_t  LOOP_JOBS         = 10;   // tâches périodiques + ponctuelles
+
+// ---- SSE : SSE_MAX_CLIENTS / SSE_CLIENT_QUEUE / SSE_FRAME_BYTES (module_params.h) ----
+
+// ---- File de commandes (handlers HTTP -> boucle de contrôle) ----
+const uint8_t CMD_QUEUE_DEPTH = 8; // commandes en attente max (au-delà : 503)
+
+// ---- Trace capteurs (/recording, rejouée par host/replay) ----
+const size_t TRACE_BUFFER_BYTES = 16 * TRACE_BLOCK_SIZE; // 32 Ko : ~5 min à ~5 ticks/s
+
+// ---- Détection de fuite (anomaly.h) ----
+const bool ANOMALY_SAFE_STATE = true; // alerte -> arrêt de sécurité jusqu'à acquittement (/log?ack=1)
+// ANOMALY_PARAMS : seuils de fuite (module_params.h)
+const uint8_t EVENT_LOG_SIZE = 20;  // entrées du journal (/log)
+
+// ---- Historique en flash (/export, history_store.h) ----
+const uint32_t HISTORY_SAMPLE_MS       = 120000UL; // une mesure toutes les 2 min (Sheets : 15 min)
+const uint16_t HISTORY_SAMPLE_SEGMENTS = 64;       // x 16 Ko = 1 Mo : ~91 jours de mesures
+const uint16_t HISTORY_EVENT_SEGMENTS  = 4;        // x 16 Ko : 4096 événements
+const uint8_t  HISTORY_EXPORT_MAX      = 2;        // exports simultanés (au-delà : 503)
+
+// ---- Mise à jour OTA (/update) ----
+const uint32_t OTA_REBOOT_DELAY_MS  = 5000; // laisse le client lire l'état final (/metrics "ota") avant le redémarrage
+
+// ---- Chronologie d'exécution (/trace, perf_trace.h) ----
+const uint16_t PERF_RECORDS_CORE0 = 512;   // 4 Ko : réseau, repères esp_timer
+const uint16_t PERF_RECORDS_CORE1 = 1024;  // 8 Ko : boucle, ~5 s à ~180 événements/s
+const uint32_t PERF_SYNC_MS       = 1000;  // repère cycles <-> µs du cœur de la boucle
 
 
 // ===================== Variables d'état =====================
-unsigned long lastLogicMs = 0, lastOledMs = 0, lastSseMs = 0;
+bool maintenanceMode = false; // BOOT au démarrage : contrôle arrêté, web + OTA actifs
 
 float levelPct = 10.0f; // simulé; en mode réel remplacé par la mesure
 float distanceCm = 0.0f;
+float levelLitres = 0.0f;
 float temperatureC = 0.0f;
 float humidityPct = 0.0f;
 bool ahtOk = false;
+bool oledOk = false;
+I2cBus i2c;
+DisplayPower displayPower(DISPLAY_POWER);
+uint32_t oledFrameHash = 0;            // dernière trame envoyée à l'écran
+uint32_t oledFrames = 0, oledSkipped = 0;
+SensorHealthState usHealth = {};   // capteur ultrason (décide du mode dégradé)
+SensorHealthState ahtHealth = {};  // AHT20 (information)
+
+unsigned long pirSimUntilMs = 0; // fenêtre d'un burst PIR simulé
+
+// ===================== Logique de contrôle (control.h) =====================
+// État des modes / actionneurs et paramètres, partagés avec host/replay
+ControlState ctl = { MODE_CLOSED_CYCLE };
+ControlParams ctlParams = {
+  LEVEL_TARGET_FILL, PUMP_ON_ABOVE, PUMP_OFF_BELOW, DRAIN_STOP_LEVEL, MANUAL_DRAIN_FLOOR,
+  0, 0, 0, 0, 0,                        // litres : controlUpdateThresholds()
+  (uint32_t)MOTION_HOLD_SECONDS * 1000UL,
+  5UL * 24UL * 3600UL,                  // Modifiable via web
+  DEGRADED_VALVE_MAX_MS, DEGRADED_PUMP_MAX_MS
+};
 
-bool valveOn = false;
-bool pumpOn  = false;
-bool VoutOn = false;
-
-unsigned long fillAllowedUntilMs = 0; // fenêtre d'autorisation de remplissage
-unsigned long pirSimUntilMs      = 0; // fenêtre d'un burst PIR simulé
-bool pirState = false;                // état instantané du PIR (affichage)
-
-unsigned long lastPirDetectMs = 0; // dernière détection PIR (instant)
-unsigned long lastValveOnMs   = 0; // dernier passage vanne -> ON
-unsigned long lastPumpOnMs    = 0; // dernier passage pompe -> ON
-
-// ===================== Web server (Async) =====================
-AsyncWebServer server(80);
-AsyncEventSource events("/events");
-
-// Page web minimaliste (SSE) — tout-en-un
-static const char index_html[] PROGMEM = R"HTML(
-<!doctype html><html lang="fr"><meta charset="utf-8">
-<meta name="viewport" content="width=device-width,initial-scale=1">
-<title>Fontaine</title>
-<style>
-  :root{font:14px system-ui,Segoe UI,Roboto,Ubuntu,Arial}
-  body{margin:0;background:#0b1220;color:#e8eefc}
-  header{padding:12px 16px;background:#0f172a;position:sticky;top:0}
-  main{padding:16px;max-width:900px;margin:auto}
-  .grid{display:grid;gap:12px;grid-template-columns:repeat(auto-fit,minmax(220px,1fr))}
-  .card{background:#111827;border:1px solid #1f2937;border-radius:12px;padding:14px}
-  .title{opacity:.8;font-size:12px;margin-bottom:6px}
-  .big{font-size:36px;margin:4px 0 10px}
-  .row{display:flex;gap:8px;align-items:center}
-  .pill{padding:3px 8px;border-radius:999px;background:#1f2937;font-size:12px}
-  progress{width:100%;height:10px}
-  code{background:#0a0f1a;padding:2px 6px;border-radius:6px}
-  .btn{padding:8px 16px;border:none;border-radius:6px;cursor:pointer;font-size:13px;font-weight:500}
-  .btn-primary{background:#3b82f6;color:#fff}
-  .btn-primary:hover{background:#2563eb}
-  .btn-secondary{background:#6b7280;color:#fff}
-  .btn-secondary:hover{background:#4b5563}
-  .btn.active{background:#10b981;color:#000}
-  .btn-danger{background:#dc2626;color:#fff}
-  .btn-danger:hover{background:#b91c1c}
-  .mode-selector{display:flex;gap:8px;margin-top:8px}
-  input[type=number]{background:#1f2937;color:#fff;border:1px solid #374151;padding:6px;border-radius:6px;width:60px}
-</style>
-<header>
-  <div class="row"><strong>Fontaine</strong> (<span id="lastUpdate">--</span>)</div>
-</header>
-<main class="grid">
-  <div class="card">
-    <div class="title">Mode de fonctionnement</div>
-    <div id="currentMode" class="big" style="display:none" >Cycle Ouvert</div>
-    <div class="mode-selector">
-      <button class="btn btn-primary" onclick="setMode(0)">Cycle Ouvert</button>
-      <button class="btn btn-secondary" onclick="setMode(1)">Cycle Fermé</button>
-      <button class="btn btn-secondary" onclick="setMode(2)">Eco/Hybride</button>
-    </div>
-    <div id="ecoInfo" style="margin-top:8px;font-size:11px;opacity:0.7"></div>
-    <div id="ecoConfig" style="display:none;margin-top:12px">
-      <div class="row">
-        <span>Vidange tous les</span>
-        <input type="number" id="ecoValue" min="1" max="720" value="5">
-        <select id="ecoUnit" style="background:#1f2937;color:#fff;border:1px solid #374151;padding:6px;border-radius:6px">
-          <option value="hours">heures</option>
-          <option value="days" selected>jours</option>
-        </select>
-        <button class="btn btn-secondary" onclick="setDrainInterval()">OK</button>
-      </div>
-    </div>
-
-  </div>
-
-  <div class="card">
-    <div class="title">Niveau de remplissage du réservoir</div>
-    <div class="big"><span id="level">–</span>%</div>
-    <progress id="lvlbar" max="100" value="0"></progress>
-    <div class="row"><span>Distance mesurée:</span><code id="dist">–</code><span>cm</span></div>
-  </div>
-  
-  <div class="card">
-    <div class="title">État</div>
-    <div class="row">PIR: <strong id="pir">–</strong></div>
-    <div class="row">Électrovanne: <strong id="valve">–</strong></div>
-    <div class="row">Pompe: <strong id="pump">–</strong></div>
-  </div>
-  
-  <div class="card">
-    <div class="title">Climat</div>
-    <div class="row"><span>Température:</span><code id="temp">–</code><span>°C</span></div>
-    <div class="row"><span>Humidité:</span><code id="hum">–</code><span>%</span></div>
-  </div>
-
-  <div class="card">
-    <div class="title">Historique</div>
-    <div class="row">Depuis dernière détection PIR: <strong id="sincePir">–:–:–</strong></div>
-    <div class="row">Dernier allumage électrovanne: <strong id="lastValveOnAgo">–:–:–</strong></div>
-    <div class="row">Dernier allumage pompe: <strong id="lastPumpOnAgo">–:–:–</strong></div>
-    <div class="row">Prochaine vidange: <strong id="nextDrain">–:–:–</strong></div> 
-  </div>
-  
-  <div class="card">
-    <div class="title">Vidange manuelle</div>
-    <div class="row" style="gap:12px">
-      <button class="btn btn-danger" onclick="startDrain()">Démarrer vidange</button>
-      <button class="btn btn-secondary" onclick="stopDrain()">Arrêter</button>
-    </div>
-    <div id="drainStatus" style="margin-top:8px;font-size:12px"></div>
-  </div>
-</main>
-<script>
-const modeNames = ['Cycle Ouvert', 'Cycle Fermé', 'Eco/Hybride'];
-
-function setMode(m) {
-  fetch('/setmode?mode=' + m)
-    .then(r => r.text())
-    .then(() => {
-      document.querySelectorAll('.mode-selector .btn').forEach((btn, i) => {
-        btn.className = 'btn ' + (i === m ? 'btn-primary active' : 'btn-secondary');
-      });
-    });
-}
+// ===================== Programmation (schedule.h) =====================
+// Règles calendaires + vidange éco à intervalle, armées dès que l'heure NTP est valide
+Scheduler scheduler;
+const char* schedMsg = "";     // résultat de la dernière modification de règle
+
+// ===================== Calibration du bassin =====================
+CalibrationTable calib;        // table active (EEPROM ou prismatique par défaut)
+CalibrationTable calibDraft;   // points capturés par l'assistant web
+bool calibCustom = false;      // true si la table vient de l'assistant
+const char* calibMsg = "";     // résultat de la dernière action de l'assistant
+
+// ===================== File de commandes =====================
+// Les handlers HTTP tournent dans la tâche async_tcp : ils ne font que
+// valider les paramètres et empiler une commande. Les effets (impulsion EV1,
+// relais, commit EEPROM) sont appliqués par la boucle de contrôle.
+// Types de commande : CommandType (control.h, codes repris dans les traces)
+
+struct Command {
+  CommandType type;
+  uint8_t  unit;      // CMD_SET_INTERVAL : DrainUnit
+  uint32_t value;     // mode, valeur d'intervalle, centilitres...
+  uint32_t queuedUs;  // micros() à l'empilement, pour la latence
+};
 
-function setDrainInterval() {
-  const value = document.getElementById('ecoValue').value;
-  const unit = document.getElementById('ecoUnit').value;
-  fetch('/setinterval?value=' + value + '&unit=' + unit)
-    .then(r => r.text())
-    .then(txt => alert(txt === 'OK' ? 'Intervalle modifié' : txt));
+QueueHandle_t cmdQueue = nullptr;
+volatile uint32_t cmdRejected = 0; // file pleine
+volatile uint32_t cmdInvalid  = 0; // paramètres refusés par un handler
+uint32_t cmdProcessed = 0;
+uint32_t cmdLastLatencyUs = 0, cmdMaxLatencyUs = 0;
+uint64_t cmdTotalLatencyUs = 0;
+
+uint32_t heapMinMaxBlock = UINT32_MAX; // plus petit "plus grand bloc libre" observé
+
+// ===================== Trace capteurs =====================
+uint8_t traceMem[TRACE_BUFFER_BYTES];
+SensorTrace sensorTrace;
+
+// ===================== Alertes & journal =====================
+AnomalyDetector anomaly(ANOMALY_PARAMS);
+EventLog<EVENT_LOG_SIZE> eventLog;
+HistoryStore history(HISTORY_SAMPLE_SEGMENTS, HISTORY_EVENT_SEGMENTS);
+typedef HistoryExport<HistoryStore::Source> HistoryExporter;
+std::atomic<uint8_t> exportsActive(0);   // réponses /export en cours
+
+// ===================== Visites apprises =====================
+VisitModel visits(VISIT_PARAMS);
+ConsumptionMeter usage(PUMP_POWER_W);
+PumpSpeedController pumpSpeed(PUMP_SPEED, PUMP_HOLD_DEFAULT, PUMP_HOLD_SETPOINT);
+
+// Journal RAM (/log) + historique flash (/export?kind=events) une fois l'heure valide
+void logEvent(uint32_t epoch, uint8_t code, float value = 0) {
+  uint32_t ms = millis();
+  eventLog.add(epoch, ms, code, value);
+  if (epoch >= EPOCH_VALID_MIN) history.append(HistoryEvent{ epoch, ms, code, value });
 }
 
+// ===================== OTA =====================
+OtaUpdater ota;
 
-function startDrain() {
-  if (confirm('Démarrer la vidange ?')) {
-    fetch('/drain').then(() => alert('Vidange démarrée'));
-  }
-}
-
-function stopDrain() {
-  fetch('/stopdrain').then(() => alert('Vidange arrêtée'));
-}
+// ===================== Chronologie d'exécution =====================
+PerfTrace perf;
 
-const es = new EventSource('/events');
-es.onmessage = e => {
-  try{
-    const d = JSON.parse(e.data);
-    const $ = id => document.getElementById(id);
-    
-    const now = new Date();
-    const timeStr = now.toLocaleTimeString('fr-FR');
-    const dateStr = now.toLocaleDateString('fr-FR');
-    $('lastUpdate').textContent = `${dateStr} ${timeStr}`;
-
-    // Mode
-    const mode = d.mode ?? 0;
-    $('currentMode').textContent = modeNames[mode];
-    document.querySelectorAll('.mode-selector .btn').forEach((btn, i) => {
-      btn.className = 'btn ' + (i === mode ? 'btn-primary active' : 'btn-secondary');
-    });
-    
-    // Config Eco visible uniquement en mode 2
-    const ecoConfig = $('ecoConfig');
-    if (mode === 2) {
-      ecoConfig.style.display = 'block';
-      $('ecoValue').value = d.ecoDrainValue || 5;
-      $('ecoUnit').value = d.ecoDrainUnit || 'days';
-    } else {
-      ecoConfig.style.display = 'none';
-    }
+// ===================== MQTT =====================
+// Un sujet par champ, publié quand il change (écart minimal pour les mesures)
+enum MqttField : uint8_t {
+  MQ_LEVEL, MQ_LITRES, MQ_TEMP, MQ_HUMIDITY, MQ_MODE, MQ_PHASE, MQ_VALVE, MQ_PUMP, MQ_OUT,
+  MQ_DRAIN, MQ_SAFE_STOP, MQ_ALERTS, MQ_SENSOR, MQ_RSSI, MQ_FIELDS
+};
+const char* const MQTT_FIELDS[MQ_FIELDS] = {
+  "level", "litres", "temp", "humidity", "mode", "phase", "valve", "pump", "out",
+  "drain", "safeStop", "alerts", "sensor", "rssi"
+};
+static_assert(MQTT_QUEUE > MQ_FIELDS + 1, "file MQTT : dernier état de chaque champ et acquittements");
+MqttLink<MQTT_QUEUE> mqtt(MQTT_CONFIG, MQTT_FIELDS, MQ_FIELDS);
+MqttChangeFilter<MQ_FIELDS> mqttSent;
 
-    
-    // Info Eco
-    if (mode === 2 && d.ecoInClosedPhase) {
-      $('ecoInfo').textContent = 'Phase fermée active (' + (d.ecoDrainDays || 5) + ' jours)';
-    } else {
-      $('ecoInfo').textContent = '';
-    }
+// ===================== Ordonnanceur de loop() =====================
+uint32_t loopClockMs() { return millis(); }
+EdfScheduler<LOOP_JOBS> loopJobs(loopClockMs);
 
-    // Statut vidange
-    if (d.manualDrain) {
-      $('drainStatus').textContent = '⚠️ Vidange en cours...';
-      $('drainStatus').style.color = '#f59e0b';
-    } else {
-      $('drainStatus').textContent = '';
-    }
-    
-    $('level').textContent = d.level;
-    $('lvlbar').value = d.level;
-    $('dist').textContent = d.distance.toFixed(1);
-    $('temp').textContent = d.temp?.toFixed(1);
-    
-    const temp = d.temp ?? 20;
-    const tempEl = $('temp');
-    if (temp > 30) {
-      tempEl.style.background = '#dc2626';
-      tempEl.style.color = '#fff';
-      tempEl.style.padding = '2px 6px';
-      tempEl.style.borderRadius = '4px';
-      tempEl.style.fontWeight = 'bold';
-    } else if (temp > 25) {
-      tempEl.style.background = '#f59e0b';
-      tempEl.style.color = '#000';
-      tempEl.style.padding = '2px 6px';
-      tempEl.style.borderRadius = '4px';
-      tempEl.style.fontWeight = 'bold';
-    } else if (temp < 15) {
-      tempEl.style.background = '#3b82f6';
-      tempEl.style.color = '#fff';
-      tempEl.style.padding = '2px 6px';
-      tempEl.style.borderRadius = '4px';
-      tempEl.style.fontWeight = 'bold';
-    } else {
-      tempEl.style.background = '';
-      tempEl.style.color = '';
-      tempEl.style.padding = '';
-      tempEl.style.fontWeight = '';
-    }
-    
-    $('hum').textContent = d.humidity?.toFixed(1);
-    $('pir').textContent = d.pir ? 'Détecté' : 'Aucun';
-    $('valve').textContent = d.valve ? 'Ouverte' : 'Fermée';
-    $('pump').textContent = d.pump ? 'Active' : 'Arrêtée';
-    
-    const sincePir = d.sincePir || '--:--:--';
-    $('sincePir').textContent = sincePir;
-    const sincePirEl = $('sincePir');
-    if (sincePir !== '--:--:--') {
-      const [h,m,s] = sincePir.split(':').map(Number);
-      const totalSec = h*3600 + m*60 + s;
-      if (totalSec > 3600) {
-        sincePirEl.style.background = '#dc2626';
-        sincePirEl.style.color = '#fff';
-        sincePirEl.style.padding = '2px 6px';
-        sincePirEl.style.borderRadius = '4px';
-        sincePirEl.style.fontWeight = 'bold';
-      } else {
-        sincePirEl.style.background = '';
-        sincePirEl.style.color = '';
-        sincePirEl.style.padding = '';
-        sincePirEl.style.fontWeight = '';
-      }
-    }
-    
-    $('lastValveOnAgo').textContent = d.lastValveOnAgo || '--:--:--';
-    $('lastPumpOnAgo').textContent  = d.lastPumpOnAgo  || '--:--:--';
-    $('nextDrain').textContent = d.nextDrain || '--:--:--';
-  }catch(_){}
-};
-</script>
-</html>
-)HTML";
+// ===================== Web server (Async) =====================
+AsyncWebServer server(80);
+SseFanout<SSE_MAX_CLIENTS, SSE_CLIENT_QUEUE, SSE_FRAME_BYTES> events("/events");
 
-// ===================== Outils =====================
-// void setRelay(int pin, bool on) {
-//   digitalWrite(pin, (ACTIVE_LOW ? (on ? LOW : HIGH) : (on ? HIGH : LOW)));
-// }
 
-void setPump(bool on) {
-  digitalWrite(PIN_PUMP, (ACTIVE_LOW ? (on ? LOW : HIGH) : (on ? HIGH : LOW)));
-}
+// ===================== Actionneurs =====================
+Actuators actuators({ "EV1", "EV2", "pump", "EV_out" });
 
-void setEV_out(bool on) {
-  digitalWrite(PIN_VALVE, (ACTIVE_LOW ? (on ? LOW : HIGH) : (on ? HIGH : LOW)));
+// open=true : ouvrir | open=false : fermer. Impulsion terminée par actuators.update()
+void setFill(bool open) {
+  actuators.channel<ACT_EV1>().set(open, millis());
+  if (EV2_FILL_ZONE) actuators.channel<ACT_EV2>().set(open, millis());
 }
 
-void pulseEV1(bool open) {
-  // open=true: ouvrir EV1 | open=false: fermer EV1
-  if (open) {
-    digitalWrite(PIN_EV1_AIN1, HIGH);
-    digitalWrite(PIN_EV1_AIN2, LOW);
-  } else {
-    digitalWrite(PIN_EV1_AIN1, LOW);
-    digitalWrite(PIN_EV1_AIN2, HIGH);
-  }
-  digitalWrite(PIN_EV1_PWMA, HIGH);
-  delay(EV_PULSE_MS);
-  digitalWrite(PIN_EV1_PWMA, LOW);
-  digitalWrite(PIN_EV1_AIN1, LOW);
-  digitalWrite(PIN_EV1_AIN2, LOW);
+// Décisions de controlStep -> voies, à chaque tick : une commutation différée
+// par l'usure (durée minimale, commutations par heure) est redemandée jusqu'à
+// être permise. L'arrêt de sécurité passe outre.
+void applyActuators(uint32_t epoch) {
+  uint32_t now = millis();
+  bool force = ctl.safeStop;
+  actuators.channel<ACT_EV1>().request(ctl.valveOn, now, epoch, force);
+  if (EV2_FILL_ZONE) actuators.channel<ACT_EV2>().request(ctl.valveOn, now, epoch, force);
+  actuators.channel<ACT_PUMP>().request(ctl.pumpOn, now, epoch, force);
+  actuators.channel<ACT_OUT>().request(ctl.voutOn, now, epoch, force);
 }
 
 void saveModeToEEPROM(FountainMode mode) {
@@ -459,8 +401,7 @@ void saveDrainIntervalToEEPROM() {
     EEPROM.write(EEPROM_DRAIN_VALUE + 1, ecoDrainValue & 0xFF);
     
     // Sauvegarder l'unité (0=days, 1=hours)
-    uint8_t unitCode = (ecoDrainUnit == "hours") ? 1 : 0;
-    EEPROM.write(EEPROM_DRAIN_UNIT, unitCode);
+    EEPROM.write(EEPROM_DRAIN_UNIT, (uint8_t)ecoDrainUnit);
     
     EEPROM.commit();
 }
@@ -470,8 +411,8 @@ void loadDrainIntervalFromEEPROM() {
     if (EEPROM.read(EEPROM_MAGIC_ADDR) != EEPROM_MAGIC_VALUE) {
         // Valeurs par défaut
         ecoDrainValue = 5;
-        ecoDrainUnit = "days";
-        ecoDrainIntervalSec = 5UL * 24UL * 3600UL;
+        ecoDrainUnit = DRAIN_DAYS;
+        ctlParams.ecoDrainIntervalSec = 5UL * 24UL * 3600UL;
         return;
     }
     
@@ -486,20 +427,103 @@ void loadDrainIntervalFromEEPROM() {
     // Valider et appliquer
     if (unitCode == 1 && value >= 1 && value <= 720) {
         // Heures
-        ecoDrainUnit = "hours";
+        ecoDrainUnit = DRAIN_HOURS;
         ecoDrainValue = value;
-        ecoDrainIntervalSec = (uint32_t)value * 3600UL;
+        ctlParams.ecoDrainIntervalSec = (uint32_t)value * 3600UL;
     } else if (unitCode == 0 && value >= 1 && value <= 30) {
         // Jours
-        ecoDrainUnit = "days";
+        ecoDrainUnit = DRAIN_DAYS;
         ecoDrainValue = value;
-        ecoDrainIntervalSec = (uint32_t)value * 24UL * 3600UL;
+        ctlParams.ecoDrainIntervalSec = (uint32_t)value * 24UL * 3600UL;
     } else {
         // Valeur corrompue, défaut
         ecoDrainValue = 5;
-        ecoDrainUnit = "days";
-        ecoDrainIntervalSec = 5UL * 24UL * 3600UL;
+        ecoDrainUnit = DRAIN_DAYS;
+        ctlParams.ecoDrainIntervalSec = 5UL * 24UL * 3600UL;
+    }
+}
+
+// Table : distances en 1/100 cm, volumes en centilitres (2 octets chacun)
+void saveCalibrationToEEPROM(const CalibrationTable& t) {
+  uint8_t sum = 0;
+  EEPROM.write(EEPROM_CAL_ADDR, EEPROM_CAL_MAGIC);
+  EEPROM.write(EEPROM_CAL_ADDR + 1, t.count());
+  for (uint8_t i = 0; i < CAL_MAX_POINTS; i++) {
+    uint16_t d = i < t.count() ? (uint16_t)round(t.point(i).distCm * 100.0f) : 0;
+    uint16_t l = i < t.count() ? (uint16_t)round(t.point(i).litres * 100.0f) : 0;
+    int a = EEPROM_CAL_ADDR + 2 + i * 4;
+    EEPROM.write(a + 0, d >> 8);
+    EEPROM.write(a + 1, d & 0xFF);
+    EEPROM.write(a + 2, l >> 8);
+    EEPROM.write(a + 3, l & 0xFF);
+    sum += (d >> 8) + (d & 0xFF) + (l >> 8) + (l & 0xFF);
+  }
+  EEPROM.write(EEPROM_CAL_ADDR + 2 + CAL_MAX_POINTS * 4, sum);
+  EEPROM.commit();
+}
+
+// false si absente/corrompue : la table prismatique par défaut reste en place
+bool loadCalibrationFromEEPROM(CalibrationTable& t) {
+  if (EEPROM.read(EEPROM_CAL_ADDR) != EEPROM_CAL_MAGIC) return false;
+  uint8_t n = EEPROM.read(EEPROM_CAL_ADDR + 1);
+  if (n < 2 || n > CAL_MAX_POINTS) return false;
+  CalibrationTable loaded;
+  uint8_t sum = 0;
+  for (uint8_t i = 0; i < CAL_MAX_POINTS; i++) {
+    int a = EEPROM_CAL_ADDR + 2 + i * 4;
+    uint8_t b0 = EEPROM.read(a), b1 = EEPROM.read(a + 1), b2 = EEPROM.read(a + 2), b3 = EEPROM.read(a + 3);
+    sum += b0 + b1 + b2 + b3;
+    if (i < n) loaded.add(((b0 << 8) | b1) / 100.0f, ((b2 << 8) | b3) / 100.0f);
+  }
+  if (sum != EEPROM.read(EEPROM_CAL_ADDR + 2 + CAL_MAX_POINTS * 4) || !loaded.valid()) return false;
+  t = loaded;
+  return true;
+}
+
+// Règles de programmation (emplacements libres compris, pour garder les index)
+void saveScheduleToEEPROM(const Scheduler& sc) {
+  uint8_t sum = 0;
+  EEPROM.write(EEPROM_SCHED_ADDR, EEPROM_SCHED_MAGIC);
+  for (uint8_t i = 0; i < SCHED_MAX_RULES; i++) {
+    const ScheduleRule& r = sc.rules[i];
+    uint8_t b[6] = {
+      (uint8_t)((r.used ? 1 : 0) | (r.enabled ? 2 : 0) | (r.action << 2)), r.days,
+      (uint8_t)(r.minute >> 8), (uint8_t)(r.minute & 0xFF),
+      (uint8_t)(r.durationMin >> 8), (uint8_t)(r.durationMin & 0xFF)
+    };
+    for (uint8_t k = 0; k < 6; k++) {
+      EEPROM.write(EEPROM_SCHED_ADDR + 1 + i * 6 + k, b[k]);
+      sum += b[k];
+    }
+  }
+  EEPROM.write(EEPROM_SCHED_ADDR + 1 + SCHED_MAX_RULES * 6, sum);
+  EEPROM.commit();
+}
+
+// false si absente/corrompue : aucune règle (intervalle éco seul)
+bool loadScheduleFromEEPROM(Scheduler& sc) {
+  if (EEPROM.read(EEPROM_SCHED_ADDR) != EEPROM_SCHED_MAGIC) return false;
+  ScheduleRule loaded[SCHED_MAX_RULES];
+  uint8_t sum = 0;
+  for (uint8_t i = 0; i < SCHED_MAX_RULES; i++) {
+    uint8_t b[6];
+    for (uint8_t k = 0; k < 6; k++) {
+      b[k] = EEPROM.read(EEPROM_SCHED_ADDR + 1 + i * 6 + k);
+      sum += b[k];
     }
+    ScheduleRule& r = loaded[i];
+    r.used = b[0] & 1;
+    r.enabled = b[0] & 2;
+    r.action = b[0] >> 2;
+    r.days = b[1];
+    r.minute = (b[2] << 8) | b[3];
+    r.durationMin = (b[4] << 8) | b[5];
+    if (r.used && !scheduleRuleValid(r)) return false;
+    if (!r.used) r = ScheduleRule();
+  }
+  if (sum != EEPROM.read(EEPROM_SCHED_ADDR + 1 + SCHED_MAX_RULES * 6)) return false;
+  memcpy(sc.rules, loaded, sizeof(loaded));
+  return true;
 }
 
 
@@ -509,17 +533,6 @@ int rssiToQuality(int rssiDbm) {
   return constrain(q, 0, 100);
 }
 
-// Retourne le pointeur vers l'icône à afficher (20x15px)
-const unsigned char* wifiIconForRSSI(int rssiDbm, bool connected) {
-  if (!connected) return wifi_none;
-  // Seuils typiques : ajustez si besoin
-  if (rssiDbm >= -55) return wifi_4;
-  if (rssiDbm >= -63) return wifi_3;
-  if (rssiDbm >= -70) return wifi_2;
-  if (rssiDbm >= -78) return wifi_1;
-  return wifi_0;
-}
-
 bool readPir() {
   if (!SIMULATION) return digitalRead(PIN_PIR) == HIGH;
   // --- PIR simulé en bursts ---
@@ -532,472 +545,797 @@ bool readPir() {
   return (long)pirSimUntilMs - (long)now > 0;
 }
 
-void readAHT20() {
-  if (!ahtOk) return;
-  
+// Nouvelle lecture AHT20 -> true (sinon les valeurs précédentes restent valables)
+bool readAHT20(float& tempC, float& humPct) {
+  if (!ahtOk) return false;
+  PERF_SCOPE(PERF_AHT);
+
   sensors_event_t humidity, temp;
-  if (aht.getEvent(&humidity, &temp)) {
-    temperatureC = temp.temperature;
-    humidityPct = humidity.relative_humidity;
+  bool ok;
+  {
+    I2cBus::Scope busy(i2c);
+    ok = aht.getEvent(&humidity, &temp);
   }
-}
-
-// Tri par insertion simple pour tableau de 5 éléments
-void sortFloat(float arr[], int n) {
-  for (int i = 1; i < n; i++) {
-    float key = arr[i];
-    int j = i - 1;
-    while (j >= 0 && arr[j] > key) {
-      arr[j + 1] = arr[j];
-      j--;
-    }
-    arr[j + 1] = key;
+  if (!ok) {
+    i2c.failed();
+    return false;
   }
+  tempC = temp.temperature;
+  humPct = humidity.relative_humidity;
+  return true;
 }
 
-float medianFilter(float samples[], int count) {
-  float sorted[count];
-  memcpy(sorted, samples, count * sizeof(float));
-  sortFloat(sorted, count);
-  return sorted[count / 2];  // Valeur médiane
-}
-
-float readUltrasonicCm() {
+// Échos bruts (µs, 0 = timeout) ; conversion et filtrage : rangeFromEchoes()
+uint8_t sampleUltrasonic(uint32_t echoUs[ECHO_MAX_SAMPLES]) {
+  PERF_SCOPE(PERF_RANGING);
   if (SIMULATION) {
     float waterHeight = (levelPct / 100.0f) * TANK_HEIGHT_CM;
     float dist = SENSOR_OFFSET_CM + (TANK_HEIGHT_CM - waterHeight);
     dist += (random(-5, 6)) * 0.05f;
     dist = constrain(dist, SENSOR_OFFSET_CM, SENSOR_OFFSET_CM + TANK_HEIGHT_CM);
-    return dist;
+    echoUs[0] = cmToEchoUs(dist, temperatureC);
+    return 1;
   }
   
-  // ===== LECTURES MULTIPLES FILTRÉES =====
-  const int NUM_SAMPLES = 5;
-  float samples[NUM_SAMPLES];
-  int validCount = 0;
-  
-  for (int i = 0; i < NUM_SAMPLES; i++) {
+  // ===== LECTURES MULTIPLES =====
+  for (int i = 0; i < ECHO_MAX_SAMPLES; i++) {
     digitalWrite(PIN_TRIG, LOW);
     delayMicroseconds(2);
     digitalWrite(PIN_TRIG, HIGH);
     delayMicroseconds(10);
     digitalWrite(PIN_TRIG, LOW);
     
-    unsigned long duration = pulseIn(PIN_ECHO, HIGH, 30000UL);
-    
-    if (duration > 0) {
-      // Compensation température
-      float speedSound = 331.3f + (0.606f * temperatureC);
-      float cm = (duration * speedSound / 20000.0f);
-      
-      // Rejet valeurs aberrantes (hors plage physique +10%)
-      float minValid = SENSOR_OFFSET_CM * 0.9f;
-      float maxValid = (SENSOR_OFFSET_CM + TANK_HEIGHT_CM) * 1.1f;
-      
-      if (cm >= minValid && cm <= maxValid) {
-        samples[validCount++] = cm;
-      }
-    }
+    echoUs[i] = pulseIn(PIN_ECHO, HIGH, ECHO_TIMEOUT_US);
     
     delay(30);  // Pause entre mesures (évite échos résiduels)
   }
-  
-  // ===== TRAITEMENT =====
-  if (validCount == 0) {
-    // Aucune mesure valide → garde ancienne valeur
-    Serial.println("WARN: Ultrason timeout");
-    return distanceCm;  // Retourne dernière mesure connue
-  }
-  
-  if (validCount < 3) {
-    // Peu de mesures → moyenne simple
-    float sum = 0;
-    for (int i = 0; i < validCount; i++) sum += samples[i];
-    return sum / validCount;
-  }
-  
-  // 3+ mesures → filtre médian (élimine extrêmes)
-  return medianFilter(samples, validCount);
+  return ECHO_MAX_SAMPLES;
+}
+
+// Aucune mesure valide → garde ancienne valeur (valid = 0, suivi par usHealth)
+float echoesToCm(const uint32_t* echoUs, uint8_t n, int& valid) {
+  return rangeFromEchoes(echoUs, n, temperatureC, SENSOR_OFFSET_CM, TANK_HEIGHT_CM, distanceCm, &valid);
+}
+
+// Volume (table de calibration) plutôt que hauteur : bassins évasés
+float cmToLitres(float cm) {
+  return calib.litresAt(cm);
 }
 
 int cmToPercent(float cm) {
-  float waterHeight = (SENSOR_OFFSET_CM + TANK_HEIGHT_CM) - cm;
-  waterHeight = constrain(waterHeight, 0.0f, TANK_HEIGHT_CM);
-  return (int)round((waterHeight / TANK_HEIGHT_CM) * 100.0f);
+  return calib.percentRounded(cm);
+}
+
+// Image clé de la trace : état courant, avant les lectures du tick
+TraceKeyframe traceKeyframe() {
+  TraceKeyframe k;
+  k.state = ctl;
+  k.params = ctlParams;
+  k.distanceCm = distanceCm;
+  k.tempC = temperatureC;
+  k.humPct = humidityPct;
+  k.calib = calib;
+  k.draft = calibDraft;
+  k.health = usHealth;
+  k.healthParams = ULTRASONIC_HEALTH;
+  return k;
+}
+
+// Vidange éco à intervalle fixe, comptée depuis la fin du dernier remplissage.
+// Une règle calendaire de vidange la remplace.
+void rearmIntervalDrain(uint32_t epoch) {
+  uint32_t at = 0;
+  if (ctl.mode == MODE_ECO_HYBRID && !scheduler.hasDrainRule()) {
+    uint32_t from = ctl.lastEV1OnTimestamp >= EPOCH_VALID_MIN ? ctl.lastEV1OnTimestamp : epoch;
+    at = from + ctlParams.ecoDrainIntervalSec;
+  }
+  scheduler.setIntervalDrain(at);
+}
+
+void onAnomaly(uint8_t raised, uint32_t epoch);
+
+// Changement d'état du capteur ultrason : une ligne par transition (plus un WARN par tick)
+void onSensorHealthChange(uint32_t epoch) {
+  static const uint8_t codes[] = { EVT_SENSOR_OK, EVT_SENSOR_DEGRADED, EVT_SENSOR_FAILED };
+  logEvent(epoch, codes[usHealth.level], usHealth.causes);
+  Serial.printf("%s: Ultrason %s (causes 0x%02X, timeouts %.0f%%)\n", usHealth.level ? "WARN" : "INFO",
+                healthLevelName(usHealth.level), usHealth.causes, usHealth.timeoutRatio * 100.0f);
+}
+
+// Rapport cyclique de la pompe, chaque tick (la rampe est menée par actuators.update())
+void updatePumpSpeed(float levelL, unsigned long dtMs) {
+  auto& pump = actuators.channel<ACT_PUMP>();
+  bool out = actuators.channel<ACT_OUT>().on();
+  bool regulate = pump.on() && out && ctl.mode == MODE_OPEN_CYCLE && !ctl.drainDue && !ctl.manualDrainActive;
+  float inflowLpm = actuators.channel<ACT_EV1>().on() ? usage.fillRateLps() * 60.0f : 0.0f;
+  float duty = pumpSpeed.update(regulate, levelPct, levelL, inflowLpm, dtMs / 1000.0f);
+  if (!pump.on()) return;   // allumage : request() seulement (usure)
+  if (!out) duty = PUMP_RECIRC_DUTY;
+  pump.setDuty((uint32_t)(duty * PumpDrive::DUTY_MAX + 0.5f), millis());
 }
 
 void runLogic(unsigned long dtMs) {
+  PERF_SCOPE(PERF_LOGIC);
   unsigned long now = millis();
 
-  // 1) PIR
-  bool pir = readPir();
-  pirState = pir;
-  if (pir) {
-    fillAllowedUntilMs = now + (unsigned long)MOTION_HOLD_SECONDS * 1000UL;
-    lastPirDetectMs = now;
-  }
-  bool fillAuthorized = (long)fillAllowedUntilMs - (long)now > 0;
+  // 1) Entrées brutes, enregistrées avant toute conversion
+  TraceTick raw;
+  raw.ms = now;
+  raw.epoch = (uint32_t)time(nullptr);
+  raw.pir = readPir();
+  raw.ahtValid = readAHT20(raw.tempC, raw.humPct);
+  raw.nEcho = sampleUltrasonic(raw.echoUs);
+  sensorTrace.recordTick(raw, traceKeyframe);
 
   // 2) Niveau
-  readAHT20();
-  distanceCm = readUltrasonicCm();
-  int levelNow = cmToPercent(distanceCm);
-  if (!SIMULATION) levelPct = levelNow;
-
-  // === AJOUTER ICI : Gestion vidange manuelle ===
-  if (manualDrainActive) {
-    valveOn = false;
-    pumpOn = true;
-    VoutOn = true;
-    
-    // Arrêt automatique si niveau très bas
-    if (levelNow <= 5) {
-      manualDrainActive = false;
-      pumpOn = false;
-      VoutOn = false;
-    }
-    
-    // Appliquer les relais et sortir (priorité sur les modes)
-    pulseEV1(valveOn);
-    setPump(pumpOn);
-    setEV_out(VoutOn);
-    return;  // Ne pas exécuter la logique des modes
+  if (raw.ahtValid) {
+    temperatureC = raw.tempC;
+    humidityPct = raw.humPct;
   }
+  healthUpdate(ahtHealth, AHT_HEALTH, now, raw.ahtValid ? 1 : 0, 1, raw.tempC);
+  int valid = 0;
+  distanceCm = echoesToCm(raw.echoUs, raw.nEcho, valid);
+  if (healthUpdate(usHealth, ULTRASONIC_HEALTH, now, valid, raw.nEcho, distanceCm)) onSensorHealthChange(raw.epoch);
+  float levelL = cmToLitres(distanceCm);  // unité des seuils de contrôle
+  levelLitres = levelL;
+  if (!SIMULATION) levelPct = cmToPercent(distanceCm);
+
+  // 3) Décisions (control.h, rejouables sur PC)
+  ControlInputs in = { (uint32_t)now, raw.epoch, raw.pir, levelL, healthTrusted(usHealth) };
+  uint8_t fx = controlStep(ctl, ctlParams, in);
+
+  // 4) Appliquer les décisions ; la suite (consommation, fuite, simulation)
+  // voit l'état réel des voies, qui peut retarder sur la décision (usure)
+  applyActuators(raw.epoch);
+  updatePumpSpeed(levelL, dtMs);
+  const bool valveOut = actuators.channel<ACT_EV1>().on();
+  const bool pumpOut = actuators.channel<ACT_PUMP>().on();
+  const bool voutOut = actuators.channel<ACT_OUT>().on();
+  if (fx & CTL_FX_SAVE_EV1_TIMESTAMP) {
+    saveEV1TimestampToEEPROM(ctl.lastEV1OnTimestamp);
+    rearmIntervalDrain(raw.epoch);
+  }
+  if (SIMULATION && (fx & CTL_FX_ECO_DRAIN_DONE)) levelPct = 10;
+  const float pumpDuty = (float)actuators.channel<ACT_PUMP>().duty() / PumpDrive::DUTY_MAX;
+  usage.update(raw.epoch, ctl.mode, valveOut, pumpOut, pumpDuty, voutOut, levelL, healthTrusted(usHealth), dtMs);
 
-  // 3) Décisions relais SELON LE MODE
-  bool prevValve = valveOn;
-  bool prevPump  = pumpOn;
-  bool prevVout  = VoutOn;
+  // 5) Fuite / arrivée d'eau parasite, selon les actionneurs de ce tick
+  // (pas en simulation : la pompe seule y vide le bassin)
+  if (!SIMULATION) {
+    uint8_t raised = anomaly.update((uint32_t)now, levelL, valveOut, pumpOut, voutOut);
+    if (raised) onAnomaly(raised, raw.epoch);
+  }
 
-  switch (currentMode) {
-    
-    case MODE_OPEN_CYCLE: // Mode actuel
-      if (levelNow >= PUMP_ON_ABOVE){       
-        pumpOn = true;
-        VoutOn = true;
-      }
-      else if (levelNow <= PUMP_OFF_BELOW){
-        pumpOn = false;
-        VoutOn = false;
-      }
-      
-      if (fillAuthorized && levelNow < LEVEL_TARGET_FILL) valveOn = true;
-      else valveOn = false;
-      
-      break;
+  // 6) Évolution simulation
+  if (SIMULATION) {
+    float dt = dtMs / 1000.0f;
+    if (valveOut) levelPct += SIM_FILL_RATE_PCT_S * dt;
+    if (pumpOut)  levelPct -= SIM_DRAIN_RATE_PCT_S * pumpDuty * dt;   // débit ~ vitesse
+    if (voutOut)  levelPct -= SIM_DRAIN_RATE_PCT_S * 2.0f * pumpDuty * dt;
+    levelPct -= SIM_LEAK_RATE_PCT_S * dt;
+    levelPct = constrain(levelPct, 0.0f, 100.0f);
+  }
+}
 
-    case MODE_CLOSED_CYCLE: // Fontaine classique
-      valveOn = false;
-      pumpOn = true;
-      VoutOn = false;
-      break;
 
-    case MODE_ECO_HYBRID:
-  // Phase 1 : Remplissage automatique jusqu'à 90% (sans PIR)
-    if (!ecoInClosedPhase) {
-      if (levelNow < LEVEL_TARGET_FILL) {
-        valveOn = true;
-      } else {
-        valveOn = false;
-        // Basculer en cycle fermé dès que 90% atteint
-        ecoInClosedPhase = true;
-        lastEV1OnTimestamp = (uint32_t)time(nullptr);
-        saveEV1TimestampToEEPROM(lastEV1OnTimestamp);
-      }
-      
-      pumpOn = false;
-      VoutOn = false;
-    }
-    // Phase 2 : Cycle fermé + vidange tous les 5 jours
-    else {
-      valveOn = false;
-      pumpOn = true;
-      VoutOn = false;
-      
-      // Vérifier si 5 jours écoulés depuis dernier remplissage
-      uint32_t currentTimestamp = (uint32_t)time(nullptr);
-      // Protection : NTP pas encore synchronisé (timestamp avant 2024)
-      if (currentTimestamp < 1704067200) {  // 1er janvier 2024 00:00:00 UTC
-          // Heure invalide, on reste en cycle fermé sans déclencher vidange
-          break;
-      }
-      uint32_t elapsedSec = currentTimestamp - lastEV1OnTimestamp;
-      
-      if (elapsedSec >= ecoDrainIntervalSec) {
-        // Vidange active
-        pumpOn = true;
-        VoutOn = true;
-        
-        // Condition de sortie : niveau bas (10%)
-        if (levelNow <= 10) {
-          pumpOn = false;
-          VoutOn = false;
-          ecoInClosedPhase = false;
-          lastEV1OnTimestamp = (uint32_t)time(nullptr);
-          saveEV1TimestampToEEPROM(lastEV1OnTimestamp);
-          if (SIMULATION) levelPct = 10;
-        }
+void sendOLED();
 
-      }
-    }
-    break;
+void drawOLED() {
+  PERF_SCOPE(PERF_OLED_DRAW);
+  OledView v;
+  v.wifiConnected = WiFi.isConnected();
+  v.rssi = v.wifiConnected ? WiFi.RSSI() : -100;
+
+  // Maintenance / OTA / alerte / capteur douteux : un seul bandeau, par priorité
+  char otaText[12];
+  v.banner = nullptr;
+  if (ota.busy()) {
+    snprintf(otaText, sizeof(otaText), "OTA %uk", (unsigned)(ota.received() / 1024));
+    v.banner = otaText;
+  } else if (maintenanceMode) {
+    v.banner = "maint.";
+  } else if (anomaly.alerts()) {
+    v.banner = anomaly.alerts() & ANOM_LEAK ? "FUITE" : "EV1!";
+  } else if (!healthTrusted(usHealth)) {
+    v.banner = usHealth.level == HEALTH_FAILED ? "capt HS" : "capt ?";
   }
+  v.mode = ctl.mode;
+  v.ecoInClosedPhase = ctl.ecoInClosedPhase;
+  v.levelPct = levelPct;
 
-    // Vidange manuelle : force pompe + Vout
-  if (manualDrainActive) {
-    pumpOn = true;
-    VoutOn = true;
-    // Arrêt si niveau ≤ 10%
-    if (levelNow <= 10) {
-      manualDrainActive = false;
-      if (SIMULATION) levelPct = 10;
-    }
-  }
+  renderOled(display, v);   // oled_view.h (mesuré sur PC par host/bench)
+  sendOLED();
+}
 
-  // 4) Appliquer les changements
-  if (valveOn != prevValve) {
-    if (valveOn) {
-      pulseEV1(true);
-      lastValveOnMs = now;
-    } else {
-      pulseEV1(false);
-    }
-  } else if (valveOn && lastValveOnMs == 0) {
-    lastValveOnMs = now;
+// Trame envoyée seulement si elle a changé : 1 Ko sur le bus (~25 ms à 400 kHz)
+void sendOLED() {
+  PERF_SCOPE(PERF_OLED_SEND);
+  uint32_t h = fnv1a(display.getBuffer(), SCREEN_WIDTH * SCREEN_HEIGHT / 8);
+  if (h == oledFrameHash) {
+    oledSkipped++;
+    return;
+  }
+  if (!i2c.probe(OLED_ADDR)) {
+    i2c.failed();
+    return;
   }
+  I2cBus::Scope busy(i2c);
+  display.display();
+  oledFrameHash = h;
+  oledFrames++;
+}
 
-  
-  // Pompe : appliquer si changement
-  if (pumpOn != prevPump) {
-    setPump(pumpOn);
-    if (pumpOn) lastPumpOnMs = now;
-  } else if (pumpOn && lastPumpOnMs == 0) {
-    // Pompe déjà ON mais jamais timestampée (démarrage/changement mode)
-    lastPumpOnMs = now;
+// Veille de l'écran : allumé sur présence ou s'il y a quelque chose à signaler
+void updateDisplayPower(uint32_t now) {
+  bool hold = ota.busy() || maintenanceMode || anomaly.alerts() || !healthTrusted(usHealth);
+  if (!displayPower.update(now, ctl.pirState, hold) || !oledOk) return;
+  I2cBus::Scope busy(i2c);
+  switch (displayPower.state()) {
+    case DISP_ON:
+      display.ssd1306_command(SSD1306_DISPLAYON);
+      display.dim(false);
+      break;
+    case DISP_DIM:
+      display.dim(true);
+      break;
+    case DISP_OFF:
+      display.ssd1306_command(SSD1306_DISPLAYOFF);
+      break;
   }
+}
+
 
-  // Vout : appliquer si changement
-  if (VoutOn != prevVout) {
-    setEV_out(VoutOn);
+// Chaînes à capacité fixe : rien sur le tas dans les chemins périodiques
+const char* drainUnitName(DrainUnit u) {
+  return u == DRAIN_HOURS ? "hours" : "days";
+}
+
+IpString ipStr() {
+  if (WiFi.isConnected()) return fmtIPv4((uint32_t)WiFi.localIP());
+  return IpString();
+}
+
+// /status, SSE, Sheets : construit par status_view.h (comme host/soak)
+StatusBuffer statusJson() {
+  ChannelStatus channels[Actuators::COUNT];
+  actuators.forEach([&](size_t i, const char* name, const auto& c) {
+    channels[i] = { name, c.kind(), c.on(), c.busy(), c.switches() };
+  });
+  StatusReadings r = {
+    (uint32_t)millis(), (uint32_t)time(nullptr),
+    levelPct, distanceCm, levelLitres, calib.fullLitres(), calibCustom,
+    temperatureC, humidityPct,
+    ecoDrainValue, drainUnitName(ecoDrainUnit)
+  };
+  return buildStatusJson(r, ctl, scheduler, anomaly, usHealth, usage, channels, (uint8_t)Actuators::COUNT);
+}
+
+void pushToGoogleSheet() {
+  if (WiFi.status() != WL_CONNECTED) return;
+
+  FixedString<192> url;
+  url.append(GSCRIPT_URL).append("?token=").append(GSCRIPT_TOKEN);
+  StatusBuffer payload = statusJson();
+
+  // Connexion et session TLS gardées entre deux envois ; la réponse 302
+  // d'Apps Script (page de résultat) n'est pas suivie : les données sont déjà écrites
+  PERF_SCOPE_ARG(trace, PERF_UPLOAD, 0);
+  int code = sheets.post(url.c_str(), "application/json", (const uint8_t*)payload.c_str(), payload.length());
+  trace.setArg(code > 0 ? code : 0);
+  //Serial.printf("Sheets %d\n", code);
+}
+
+
+
+// ===================== File de commandes =====================
+// Appelé depuis les handlers (tâche async_tcp) : ne bloque jamais.
+bool enqueueCommand(CommandType type, uint32_t value = 0, uint8_t unit = 0) {
+  Command cmd = { type, unit, value, (uint32_t)micros() };
+  if (maintenanceMode || cmdQueue == nullptr || xQueueSend(cmdQueue, &cmd, 0) != pdTRUE) {
+    cmdRejected++;
+    return false;
   }
+  return true;
+}
 
-  // 5) Évolution simulation
-  if (SIMULATION) {
-    float dt = dtMs / 1000.0f;
-    if (valveOn) levelPct += SIM_FILL_RATE_PCT_S * dt;
-    if (pumpOn)  levelPct -= SIM_DRAIN_RATE_PCT_S * dt;
-    if (VoutOn)  levelPct -= SIM_DRAIN_RATE_PCT_S * 2.0f * dt;
-    levelPct -= SIM_LEAK_RATE_PCT_S * dt;
-    levelPct = constrain(levelPct, 0.0f, 100.0f);
+// Commande MQTT (tâche MQTT) : même file que les handlers HTTP
+bool mqttCommand(const MqttCommand& c) {
+  return enqueueCommand(c.type, c.value, c.unit);
+}
+
+// Champs changés depuis la dernière publication -> file MQTT (envoyée par la tâche MQTT).
+// Jamais de valeur vide : sur un sujet conservé, elle effacerait l'état du courtier
+void publishMqttChanges() {
+  char v[MQTT_PAYLOAD_MAX];
+  auto num = [&](uint8_t f, float x, float deadband, uint8_t decimals) {
+    if (!mqttSent.changed(f, x, deadband)) return;
+    snprintf(v, sizeof(v), "%.*f", decimals, x);
+    mqtt.publish(f, v);
+  };
+  auto text = [&](uint8_t f, const char* s) {
+    if (mqttSent.changedText(f, s)) mqtt.publish(f, s);
+  };
+  auto onOff = [&](uint8_t f, bool on) { text(f, on ? "on" : "off"); };
+
+  num(MQ_LEVEL, levelPct, 1.0f, 0);
+  num(MQ_LITRES, levelLitres, 0.05f, 2);
+  if (ahtOk) {
+    num(MQ_TEMP, temperatureC, 0.2f, 1);
+    num(MQ_HUMIDITY, humidityPct, 1.0f, 0);
   }
+  text(MQ_MODE, mqttModeName(ctl.mode));
+  text(MQ_PHASE, ctl.mode != MODE_ECO_HYBRID ? "none" : ctl.ecoInClosedPhase ? "closed" : "fill");
+  onOff(MQ_VALVE, actuators.channel<ACT_EV1>().on());
+  onOff(MQ_PUMP, actuators.channel<ACT_PUMP>().on());
+  onOff(MQ_OUT, actuators.channel<ACT_OUT>().on());
+  onOff(MQ_DRAIN, ctl.manualDrainActive);
+  onOff(MQ_SAFE_STOP, ctl.safeStop);
+  text(MQ_ALERTS, anomaly.alerts() ? anomalyNames(anomaly.alerts()) : "none");
+  text(MQ_SENSOR, healthLevelName(usHealth.level));
+  if (WiFi.isConnected()) num(MQ_RSSI, WiFi.RSSI(), 5.0f, 0);
 }
 
+// epoch : heure murale enregistrée avec la commande dans la trace
+void applyCommand(const Command& cmd, uint32_t epoch) {
+  switch (cmd.type) {
+    case CMD_SET_MODE:
+      controlSetMode(ctl, (FountainMode)cmd.value, epoch);
+      // Sauvegarde en EEPROM
+      saveModeToEEPROM(ctl.mode);
+      if (ctl.mode == MODE_ECO_HYBRID) saveEV1TimestampToEEPROM(ctl.lastEV1OnTimestamp);
 
-void drawOLED() {
-  display.clearDisplay();
-
-  // --- Bandeau Wi-Fi (icône 20x15 + texte 8 px) ---
-  const bool connected = WiFi.isConnected();
-  const int  rssi = connected ? WiFi.RSSI() : -100;
-  const int  qual = rssiToQuality(rssi);
-  const unsigned char* icon = wifiIconForRSSI(rssi, connected);
-
-  // Icône 20x15 à (0,0) — respecte la contrainte "≤15 px"
-  display.drawBitmap(SCREEN_WIDTH - 20, 0, icon, 20, 15, SSD1306_WHITE);
-
-  // --- "eco" en petit en haut à gauche si mode ECO_HYBRID ---
-  if (currentMode == MODE_ECO_HYBRID) {
-    display.setTextSize(1);  // Petit texte (8px hauteur)
-    display.setCursor((SCREEN_WIDTH - 18) / 2, 0); //centré
-    display.print("eco");
+      // Forcer un état propre lors du changement de mode
+      actuators.allOff(millis());
+      rearmIntervalDrain(epoch);
+      break;
+
+    case CMD_SET_INTERVAL:
+      ecoDrainValue = cmd.value;
+      ecoDrainUnit = (DrainUnit)cmd.unit;
+      ctlParams.ecoDrainIntervalSec = drainIntervalSec(cmd.value, ecoDrainUnit == DRAIN_HOURS);
+      saveDrainIntervalToEEPROM();
+      rearmIntervalDrain(epoch);
+      break;
+
+    case CMD_DRAIN_START:
+      ctl.manualDrainActive = true;
+      break;
+
+    case CMD_DRAIN_STOP:
+      ctl.manualDrainActive = false;
+      break;
+
+    // ---- Assistant de calibration ----
+    case CMD_CAL_CAPTURE:
+      calibMsg = calibDraft.add(distanceCm, cmd.value / 100.0f) ? "point ajouté" : "table pleine";
+      break;
+
+    case CMD_CAL_SAVE:
+      if (!calibDraft.valid()) {
+        calibMsg = "table invalide (2 points min, volume décroissant avec la distance)";
+        break;
+      }
+      calib = calibDraft;
+      calibCustom = true;
+      saveCalibrationToEEPROM(calib);
+      controlUpdateThresholds(ctlParams, calib);
+      calibMsg = "table enregistrée";
+      break;
+
+    case CMD_CAL_CLEAR:
+      calibDraft.clear();
+      calibMsg = "brouillon effacé";
+      break;
+
+    case CMD_CAL_DEFAULT:
+      calib.setPrismatic(SENSOR_OFFSET_CM, TANK_HEIGHT_CM, TANK_CAPACITY_L);
+      calibCustom = false;
+      EEPROM.write(EEPROM_CAL_ADDR, 0);  // invalide la table stockée
+      EEPROM.commit();
+      controlUpdateThresholds(ctlParams, calib);
+      calibMsg = "table par défaut";
+      break;
+
+    // ---- Programmation ----
+    case CMD_SCHED_EVENT:
+      controlScheduledEvent(ctl, (uint8_t)cmd.value);
+      break;
+
+    case CMD_SCHED_ADD:
+      schedMsg = scheduler.addRule(scheduleUnpack(cmd.value), epoch) >= 0 ? "règle ajoutée" : "table pleine";
+      saveScheduleToEEPROM(scheduler);
+      rearmIntervalDrain(epoch);
+      break;
+
+    case CMD_SCHED_DELETE:
+      schedMsg = scheduler.deleteRule(cmd.unit, epoch) ? "règle supprimée" : "règle inconnue";
+      saveScheduleToEEPROM(scheduler);
+      rearmIntervalDrain(epoch);
+      break;
+
+    case CMD_SCHED_ENABLE:
+      schedMsg = scheduler.enableRule(cmd.unit, cmd.value != 0, epoch) ? "règle modifiée" : "règle inconnue";
+      saveScheduleToEEPROM(scheduler);
+      rearmIntervalDrain(epoch);
+      break;
+
+    // ---- Alertes (anomaly.h) ----
+    case CMD_SAFE_STOP:
+      ctl.safeStop = true;
+      setFill(false);   // EV1 bistable : nouvelle impulsion de fermeture si elle est restée ouverte
+      logEvent(epoch, EVT_SAFE_STOP, cmd.value);
+      break;
+
+    case CMD_ALERT_ACK:
+      ctl.safeStop = false;
+      anomaly.clear();
+      logEvent(epoch, EVT_ALERT_ACK);
+      break;
+
+    // ---- Visite attendue (visit_model.h) ----
+    case CMD_PREFILL:
+      controlPrefill(ctl, epoch, cmd.value);
+      break;
   }
+}
 
-  // --- Image 52x52 en bas à gauche selon le mode ---
-  const unsigned char* modeIcon;
-  if (currentMode == MODE_CLOSED_CYCLE) {
-    modeIcon = bac;  // Cycle fermé
-  } else if (currentMode == MODE_ECO_HYBRID) {
-    // Mode éco : afficher selon la phase
-    if (ecoInClosedPhase) {
-      modeIcon = bac;  // Phase fermée = bac
-    } else {
-      modeIcon = robinet;  // Phase remplissage = robinet
-    }
-  } else {
-    modeIcon = robinet;  // Cycle ouvert
+// Enregistrée dans la trace avant application : host/replay rejoue la même séquence
+void executeCommand(const Command& cmd) {
+  TraceCommand tc = { cmd.type, cmd.unit, cmd.value, (uint32_t)time(nullptr) };
+  sensorTrace.recordCommand(tc, traceKeyframe);
+  applyCommand(cmd, tc.epoch);
+}
+
+// Alerte nouvelle : journal, puis arrêt de sécurité (commande tracée, rejouée par host/replay)
+void onAnomaly(uint8_t raised, uint32_t epoch) {
+  float slope = anomaly.slopeLph();
+  if (raised & ANOM_LEAK)   logEvent(epoch, EVT_LEAK, slope);
+  if (raised & ANOM_INFLOW) logEvent(epoch, EVT_INFLOW, slope);
+  Serial.printf("ALERTE %s (pente %.3f L/h)\n", anomalyNames(raised), slope);
+  if (ANOMALY_SAFE_STATE && !ctl.safeStop) {
+    Command cmd = { CMD_SAFE_STOP, 0, raised, (uint32_t)micros() };
+    executeCommand(cmd);
   }
-  
-  // Position : bas gauche (y = 64 - 52 = 12)
-  display.drawBitmap(0, 12, modeIcon, 52, 52, SSD1306_WHITE);
+}
 
-  // --- Niveau d'eau en petit en bas à droite ---
-  display.setTextSize(2);  // Petit texte (8px hauteur)
-  
-  // Créer le texte du niveau
-  char levelText[8];
-  snprintf(levelText, sizeof(levelText), "%d%%", (int)round(levelPct));
-  
-  // Calculer largeur approximative du texte (6 pixels par caractère en taille 1)
-  int textWidth = strlen(levelText) * 12;
-  
-  // Position : à droite de l'image du mode
-  display.setCursor(SCREEN_WIDTH - textWidth - 20, SCREEN_HEIGHT - 20);
-  display.print(levelText);
+// Mesure périodique dans l'historique flash (/export?kind=samples)
+void recordHistorySample() {
+  uint32_t epoch = (uint32_t)time(nullptr);
+  if (epoch < EPOCH_VALID_MIN) return;  // export chronologique : pas d'heure, pas de mesure
+  PERF_SCOPE(PERF_HISTORY);
+  HistorySample s = { epoch, cmToLitres(distanceCm), distanceCm, temperatureC, humidityPct,
+                      (uint8_t)ctl.mode, ctl.valveOn, ctl.pumpOn, ctl.voutOn, usHealth.level };
+  history.append(s);
+}
 
-  display.display();
+// Petits fichiers d'état sur LittleFS : écrits à côté puis renommés (jamais à moitié)
+bool saveStateFile(const char* path, const uint8_t* data, size_t len) {
+  if (!history.ok()) return false;
+  char tmp[32];
+  snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+  File f = LittleFS.open(tmp, FILE_WRITE);
+  if (!f) return false;
+  bool ok = f.write(data, len) == len;
+  f.close();
+  return ok && LittleFS.rename(tmp, path);
 }
 
+// Octets lus (0 : absent ou LittleFS indisponible)
+size_t loadStateFile(const char* path, uint8_t* data, size_t size) {
+  if (!history.ok() || !LittleFS.exists(path)) return 0;
+  File f = LittleFS.open(path, FILE_READ);
+  if (!f) return 0;
+  int n = f.read(data, size);
+  f.close();
+  return n > 0 ? (size_t)n : 0;
+}
 
-String uptimeStr() {
-  uint32_t s = millis()/1000;
-  uint32_t h=s/3600, m=(s%3600)/60, sec=s%60;
-  char buf[16];
-  snprintf(buf, sizeof(buf), "%02u:%02u:%02u", h,m,sec);
-  return String(buf);
+// Compteurs d'usure de toutes les voies (image wear.h)
+void wearCounters(WearCounter* (&out)[Actuators::COUNT]) {
+  actuators.forEach([&](size_t i, const char*, auto& c) { out[i] = &c.wear(); });
+}
+
+// Visites apprises, consommation et usure, si elles ont changé
+void saveStateFiles() {
+  if (visits.dirty()) {
+    uint8_t img[VISIT_IMAGE_SIZE];
+    size_t n = visits.save(img);
+    if (!saveStateFile(VISIT_FILE, img, n)) Serial.println(F("ERREUR: " VISIT_FILE " non écrit"));
+  }
+  if (usage.dirty()) {
+    uint8_t img[CONSUMPTION_IMAGE_SIZE];
+    size_t n = usage.save(img);
+    if (!saveStateFile(USAGE_FILE, img, n)) Serial.println(F("ERREUR: " USAGE_FILE " non écrit"));
+  }
+  WearCounter* wear[Actuators::COUNT];
+  wearCounters(wear);
+  bool wearDirty = false;
+  for (WearCounter* w : wear) wearDirty |= w->dirty();
+  if (wearDirty) {
+    uint8_t img[WEAR_IMAGE_SIZE(Actuators::COUNT)];
+    size_t n = wearSaveImage(img, wear, Actuators::COUNT);
+    if (!saveStateFile(WEAR_FILE, img, n)) Serial.println(F("ERREUR: " WEAR_FILE " non écrit"));
+  }
 }
 
-String ipStr() {
-  if (WiFi.isConnected()) return WiFi.localIP().toString();
-  return String();
+// Visites apprises : PIR du tick précédent, puis annonce d'un créneau attendu.
+// Avant runLogic() : l'autorisation est une commande tracée, rejouée par host/replay
+void runVisitModel() {
+  uint32_t epoch = (uint32_t)time(nullptr);
+  if (epoch < EPOCH_VALID_MIN) return;   // créneaux en heure locale : NTP requis
+  if (ctl.pirState) visits.onDetect(epoch);
+  uint32_t holdSec = visits.update(epoch);
+  if (holdSec && ctl.mode == MODE_OPEN_CYCLE) {
+    Command cmd = { CMD_PREFILL, 0, holdSec, (uint32_t)micros() };
+    executeCommand(cmd);
+  }
 }
 
-String fmtHMS(uint32_t sec) {
-  uint32_t h = sec / 3600, m = (sec % 3600) / 60, s = sec % 60;
-  char buf[16]; snprintf(buf, sizeof(buf), "%02u:%02u:%02u", h, m, s);
-  return String(buf);
+// Échéances de la programmation : rien à faire tant que la seconde ne change pas
+void runSchedule() {
+  uint32_t epoch = (uint32_t)time(nullptr);
+  if (epoch < EPOCH_VALID_MIN) return;  // NTP pas encore synchronisé
+  if (!scheduler.started()) {
+    scheduler.start(epoch);
+    rearmIntervalDrain(epoch);
+  }
+  scheduler.advance(epoch, [](uint8_t ev) {
+    Command cmd = { CMD_SCHED_EVENT, 0, ev, (uint32_t)micros() };
+    executeCommand(cmd);
+  });
 }
 
-String agoFrom(unsigned long whenMs) {
-  if (whenMs == 0) return String("--:--:--");
-  uint32_t sec = (millis() - whenMs) / 1000;
-  return fmtHMS(sec);
+// Vide la file à chaque tick de logique, avant runLogic()
+void processCommands() {
+  PERF_SCOPE(PERF_COMMANDS);
+  Command cmd;
+  while (xQueueReceive(cmdQueue, &cmd, 0) == pdTRUE) {
+    executeCommand(cmd);
+    uint32_t latency = (uint32_t)micros() - cmd.queuedUs;
+    cmdLastLatencyUs = latency;
+    if (latency > cmdMaxLatencyUs) cmdMaxLatencyUs = latency;
+    cmdTotalLatencyUs += latency;
+    cmdProcessed++;
+  }
 }
 
-String statusJson() {
-  // JSON sans ArduinoJson pour rester léger
-  char buf[512];
-  bool fillAuth = (long)fillAllowedUntilMs - (long)millis() > 0;
-  
-  String sincePir = agoFrom(lastPirDetectMs);
-  String lastValveOnAgo = agoFrom(lastValveOnMs);
-  String lastPumpOnAgo  = agoFrom(lastPumpOnMs);
-String nextDrain = "--:--:--";
-  if (currentMode == MODE_ECO_HYBRID && lastEV1OnTimestamp > 0) {
-    uint32_t currentTime = (uint32_t)time(nullptr);
-    uint32_t elapsed = currentTime - lastEV1OnTimestamp;
-    
-    if (elapsed < ecoDrainIntervalSec) {
-      uint32_t remaining = ecoDrainIntervalSec - elapsed;
-      nextDrain = fmtHMS(remaining);
-    } else {
-      nextDrain = "00:00:00"; // Vidange due
-    }
+// État de l'assistant de calibration (/calib)
+typedef FixedString<768> CalibBuffer;
+
+void appendCalPoints(CalibBuffer& out, const CalibrationTable& t) {
+  out.append('[');
+  for (uint8_t i = 0; i < t.count(); i++) {
+    out.appendf("%s[%.2f,%.2f]", i ? "," : "", t.point(i).distCm, t.point(i).litres);
+  }
+  out.append(']');
+}
+
+CalibBuffer calibJson() {
+  CalibBuffer out;
+  out.appendf("{\"distance\":%.2f,\"litres\":%.2f,\"custom\":%s,\"msg\":\"%s\",\"active\":",
+              distanceCm, levelLitres, calibCustom ? "true" : "false", calibMsg);
+  appendCalPoints(out, calib);
+  out.append(",\"draft\":");
+  appendCalPoints(out, calibDraft);
+  out.append('}');
+  return out;
+}
+
+// État de la programmation (/schedule)
+typedef FixedString<1152> ScheduleBuffer;
+
+ScheduleBuffer scheduleJson() {
+  ScheduleBuffer out;
+  uint32_t interval = scheduler.intervalDrainAt();
+  out.appendf("{\"now\":%u,\"started\":%s,\"quiet\":%s,\"nextDrain\":%u,\"pending\":%u,"
+              "\"interval\":{\"active\":%s,\"next\":%u},\"msg\":\"%s\",\"rules\":[",
+              (unsigned)time(nullptr), scheduler.started() ? "true" : "false", ctl.quiet ? "true" : "false",
+              (unsigned)scheduler.nextDrainAt(), (unsigned)scheduler.pendingCount(),
+              interval ? "true" : "false", (unsigned)interval, schedMsg);
+  bool first = true;
+  for (uint8_t i = 0; i < SCHED_MAX_RULES; i++) {
+    const ScheduleRule& r = scheduler.rules[i];
+    if (!r.used) continue;
+    char days[28];
+    out.appendf("%s{\"id\":%u,\"type\":\"%s\",\"days\":\"%s\",\"time\":\"%02u:%02u\","
+                "\"duration\":%u,\"enabled\":%s,\"next\":%u}",
+                first ? "" : ",", i, scheduleActionName(r.action), scheduleFormatDays(r.days, days),
+                r.minute / 60, r.minute % 60, r.durationMin, r.enabled ? "true" : "false",
+                (unsigned)scheduler.nextAt(i));
+    first = false;
   }
+  out.append("]}");
+  return out;
+}
 
-  snprintf(buf, sizeof(buf),
+// Journal d'événements (/log) : [seq, epoch, ms, événement, valeur]
+typedef FixedString<1024> LogBuffer;
+
+LogBuffer logJson() {
+  LogBuffer out;
+  out.appendf("{\"total\":%u,\"events\":[", (unsigned)eventLog.total());
+  bool first = true;
+  eventLog.forEach([&](const LogEntry& e) {
+    out.appendf("%s[%u,%u,%u,\"%s\",%.3f]", first ? "" : ",", (unsigned)e.seq, (unsigned)e.epoch,
+                (unsigned)e.ms, eventCodeName(e.code), e.value);
+    first = false;
+  });
+  out.append("]}");
+  return out;
+}
+
+MetricsBuffer metricsJson() {
+  MetricsBuffer out;
+  uint32_t avgUs = cmdProcessed ? (uint32_t)(cmdTotalLatencyUs / cmdProcessed) : 0;
+  out.appendf(
     "{"
-      "\"level\":%d,"
-      "\"distance\":%.1f,"
-      "\"temp\":%.1f,"
-      "\"hum\":%.0f,"
-      "\"pir\":%d,"
-      "\"valve\":%d,"
-      "\"pump\":%d,"
-      "\"sincePir\":\"%s\","
-      "\"lastValveOnAgo\":\"%s\","
-      "\"lastPumpOnAgo\":\"%s\","
-      "\"uptime\":\"%s\","
-      "\"mode\":%d,"
-      "\"ecoInClosedPhase\":%d,"
-      "\"ecoDrainValue\":%u,"
-      "\"ecoDrainUnit\":\"%s\","
-      "\"nextDrain\":\"%s\","     // Virgule supprimée ici
-      "\"manualDrain\":%s" 
-    "}",
-    (int)round(levelPct), distanceCm, temperatureC, humidityPct, pirState?1:0, valveOn?1:0, pumpOn?1:0, sincePir.c_str(), lastValveOnAgo.c_str(), lastPumpOnAgo.c_str(), uptimeStr().c_str(), currentMode, ecoInClosedPhase?1:0, ecoDrainValue, ecoDrainUnit.c_str(), nextDrain.c_str(),(manualDrainActive ? "true" : "false")
+      "\"uptimeMs\":%u,"
+      "\"heap\":{\"free\":%u,\"min\":%u,\"maxBlock\":%u,\"minMaxBlock\":%u},"
+      "\"cmd\":{"
+        "\"depth\":%u,"
+        "\"capacity\":%u,"
+        "\"processed\":%u,"
+        "\"rejected\":%u,"
+        "\"invalid\":%u,"
+        "\"latencyUs\":%u,"
+        "\"latencyAvgUs\":%u,"
+        "\"latencyMaxUs\":%u"
+      "},",
+    (unsigned)millis(),
+    (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap(), (unsigned)ESP.getMaxAllocHeap(),
+    (unsigned)heapMinMaxBlock,
+    (unsigned)uxQueueMessagesWaiting(cmdQueue), (unsigned)CMD_QUEUE_DEPTH,
+    (unsigned)cmdProcessed, (unsigned)cmdRejected, (unsigned)cmdInvalid,
+    (unsigned)cmdLastLatencyUs, (unsigned)avgUs, (unsigned)cmdMaxLatencyUs
   );
-  return String(buf);
+  out.setLength(out.length() + events.printStats(out.data() + out.length(), out.remaining() + 1));
+  out.append(',');
+  out.setLength(out.length() + sensorTrace.printStats(out.data() + out.length(), out.remaining() + 1));
+  out.append(',');
+  out.setLength(out.length() + ota.printStats(out.data() + out.length(), out.remaining() + 1));
+  out.append(',');
+  appendModuleMetrics(out, millis(), anomaly, usHealth, ahtHealth, displayPower);   // comme host/soak
+  out.append(',');
+  out.setLength(out.length() + history.printStats(out.data() + out.length(), out.remaining() + 1));
+  out.appendf(",\"exportsActive\":%u,", (unsigned)exportsActive);
+  out.setLength(out.length() + i2c.printStats(out.data() + out.length(), out.remaining() + 1));
+  out.appendf(",\"oled\":{\"frames\":%u,\"skipped\":%u},", (unsigned)oledFrames, (unsigned)oledSkipped);
+  out.setLength(out.length() + sheets.printStats(out.data() + out.length(), out.remaining() + 1, "sheets"));
+  out.append(',');
+  out.setLength(out.length() + mqtt.printStats(out.data() + out.length(), out.remaining() + 1));
+  out.append(',');
+  out.setLength(out.length() + perf.printStats(out.data() + out.length(), out.remaining() + 1));
+  out.append('}');
+  return out;
 }
 
-void pushToGoogleSheet() {
-  if (WiFi.status() != WL_CONNECTED) return;
 
-  WiFiClientSecure client; 
-  client.setInsecure(); // (ou client.setCACert(ROOT_CA) si tu veux du TLS strict)
+// Route tracée (piste réseau de /trace), nommée par son URI
+void onTraced(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction handler) {
+  uint8_t id = perf.registerName(uri, PERF_GROUP_NET);
+  server.on(uri, method, [id, handler](AsyncWebServerRequest* req) {
+    PERF_SCOPE(id);
+    handler(req);
+  });
+}
 
-  HTTPClient https;
-  https.setConnectTimeout(8000);
 
-  const String url = String(GSCRIPT_URL) + "?token=" + GSCRIPT_TOKEN;
-  if (!https.begin(client, url)) return;
+// ===================== Setup & Loop =====================
+// ===================== Tâches de loop() =====================
+// Logique : instances manquées fusionnées, runLogic() intègre l'écart réel
+void jobLogic(const JobRun& r) {
+  if (r.missed) PERF_INSTANT(PERF_TICK_LATE, min(r.elapsedMs - LOGIC_INTERVAL_MS, (uint32_t)65535));
+  if (maintenanceMode) return;
+  runSchedule();
+  runVisitModel();
+  processCommands();
+  runLogic(r.elapsedMs);
+}
 
-  https.addHeader("Content-Type", "application/json");
-  String payload = statusJson();
+// Écran éteint : plus aucune trame, le bus reste à l'AHT20
+void jobOled(const JobRun&) {
+  if (displayPower.lit()) drawOLED();
+}
 
-  int code = https.POST(payload);
-  String resp = https.getString();
+void jobSse(const JobRun& r) {
+  uint32_t maxBlock = ESP.getMaxAllocHeap();
+  if (maxBlock < heapMinMaxBlock) heapMinMaxBlock = maxBlock;
+  events.publish("message", statusJson().c_str(), r.nowMs);
+}
 
-  // Si 302/301/303/307/308 -> on suit manuellement et on RE-POST
-  if (code == HTTP_CODE_FOUND || code == HTTP_CODE_MOVED_PERMANENTLY ||
-      code == HTTP_CODE_SEE_OTHER || code == HTTP_CODE_TEMPORARY_REDIRECT ||
-      code == HTTP_CODE_PERMANENT_REDIRECT) {
+// Historique : 16 octets ajoutés en flash (pas pendant une OTA, pas en maintenance)
+void jobHistory(const JobRun&) {
+  if (!ota.busy() && !maintenanceMode) recordHistorySample();
+}
 
-    String loc = https.getLocation(); // nouvelle URL
-    https.end();
+void jobStateSave(const JobRun&) {
+  if (!ota.busy()) saveStateFiles();
+}
 
-    if (loc.length() && https.begin(client, loc)) {
-      https.addHeader("Content-Type", "application/json");
-      code = https.POST(payload);     // <-- on POST à nouveau
-      resp = https.getString();
-      https.end();
-    }
-  } else {
-    https.end();
-  }
+// Pas d'envoi TLS pendant une OTA (tas et débit réservés au transfert)
+void jobSheets(const JobRun&) {
+  if (!ota.busy()) pushToGoogleSheet();
+}
 
-  //Serial.printf("Sheets %d %s\n", code, resp.c_str());
+void jobMqtt(const JobRun&) {
+  if (mqtt.enabled()) publishMqttChanges();
 }
 
+void jobPerfSync(const JobRun&) {
+  perf.sync();
+}
 
+// Tâches enregistrées à la fin de setup() ; Sheets vient d'être envoyé
+void registerLoopJobs() {
+  uint32_t now = millis();
+  loopJobs.every("logic", LOGIC_INTERVAL_MS, OVERRUN_COALESCE, jobLogic, now + LOGIC_INTERVAL_MS);
+  loopJobs.every("oled", OLED_INTERVAL_MS, OVERRUN_SKIP, jobOled, now + OLED_INTERVAL_MS);
+  loopJobs.every("sse", SSE_INTERVAL_MS, OVERRUN_SKIP, jobSse, now + SSE_INTERVAL_MS);
+  loopJobs.every("history", HISTORY_SAMPLE_MS, OVERRUN_SKIP, jobHistory, now + HISTORY_SAMPLE_MS);
+  loopJobs.every("state", STATE_SAVE_MS, OVERRUN_COALESCE, jobStateSave, now + STATE_SAVE_MS);
+  loopJobs.every("sheets", SHEET_INTERVAL_MS, OVERRUN_SKIP, jobSheets, now + SHEET_INTERVAL_MS);
+  loopJobs.every("mqtt", MQTT_SAMPLE_MS, OVERRUN_SKIP, jobMqtt, now + MQTT_SAMPLE_MS);
+  loopJobs.every("perfSync", PERF_SYNC_MS, OVERRUN_SKIP, jobPerfSync, now + PERF_SYNC_MS);
+}
 
-// ===================== Setup & Loop =====================
 void setup() {
   Serial.begin(115200);
+  if (!perf.begin(PERF_RECORDS_CORE0, PERF_RECORDS_CORE1)) Serial.println(F("ERREUR: chronologie /trace désactivée"));
 
   // ========== Initialisation EEPROM ==========
   EEPROM.begin(EEPROM_SIZE);
-  currentMode = loadModeFromEEPROM();
-  lastEV1OnTimestamp = loadEV1TimestampFromEEPROM();
+  ctl.mode = loadModeFromEEPROM();
+  ctl.lastEV1OnTimestamp = loadEV1TimestampFromEEPROM();
   loadDrainIntervalFromEEPROM();
+  calib.setPrismatic(SENSOR_OFFSET_CM, TANK_HEIGHT_CM, TANK_CAPACITY_L);
+  calibCustom = loadCalibrationFromEEPROM(calib);
+  controlUpdateThresholds(ctlParams, calib);
+  loadScheduleFromEEPROM(scheduler);
+  if (!history.begin()) Serial.println(F("ERREUR: LittleFS non monté, historique désactivé"));
+  {
+    uint8_t img[VISIT_IMAGE_SIZE];
+    size_t n = loadStateFile(VISIT_FILE, img, sizeof(img));
+    if (n && !visits.load(img, n)) Serial.println(F("ERREUR: " VISIT_FILE " invalide, apprentissage repris à zéro"));
+  }
+  {
+    uint8_t img[CONSUMPTION_IMAGE_SIZE];
+    size_t n = loadStateFile(USAGE_FILE, img, sizeof(img));
+    if (n && !usage.load(img, n)) Serial.println(F("ERREUR: " USAGE_FILE " invalide, compteurs remis à zéro"));
+  }
+  {
+    uint8_t img[WEAR_IMAGE_SIZE(Actuators::COUNT)];
+    WearCounter* wear[Actuators::COUNT];
+    wearCounters(wear);
+    size_t n = loadStateFile(WEAR_FILE, img, sizeof(img));
+    if (n && !wearLoadImage(img, n, wear, Actuators::COUNT)) Serial.println(F("ERREUR: " WEAR_FILE " invalide, cycles repris à zéro"));
+  }
+
+  // File de commandes HTTP -> boucle (avant le démarrage du serveur)
+  cmdQueue = xQueueCreate(CMD_QUEUE_DEPTH, sizeof(Command));
+  sensorTrace.begin(traceMem, sizeof(traceMem), SENSOR_OFFSET_CM, TANK_HEIGHT_CM, TANK_CAPACITY_L);
 
   // ========== Détection GPIO0 (bouton BOOT) ==========
   pinMode(0, INPUT_PULLUP);
   delay(100);
   
   if (digitalRead(0) == LOW) {  // Bouton BOOT enfoncé
-    Serial.println(F("MODE PROGRAMMATION (BOOT pressé)"));
-    while(true) { delay(1000); }  // Blocage
+    // Relais au repos, pas de logique : seul le serveur web (et /update) tourne
+    maintenanceMode = true;
+    Serial.println(F("MODE MAINTENANCE (BOOT pressé) : contrôle arrêté, OTA sur /update"));
+  } else {
+    Serial.println(F("MODE NORMAL : Fontaine active"));
   }
-  Serial.println(F("MODE NORMAL : Fontaine active"));
   // ===================================================
 
   // Baisser la fréquence CPU (80 MHz suffit pour ce projet)
   setCpuFrequencyMhz(80);
 
-  // GPIO
-  pinMode(PIN_VALVE, OUTPUT);
-  pinMode(PIN_PUMP,  OUTPUT);
-  pulseEV1(false);
-  setPump(false);
-  setEV_out(false);
-
-  // EV1 - Pont en H
-  pinMode(PIN_EV1_AIN1, OUTPUT);
-  pinMode(PIN_EV1_AIN2, OUTPUT);
-  pinMode(PIN_EV1_PWMA, OUTPUT);
-  digitalWrite(PIN_EV1_AIN1, LOW);
-  digitalWrite(PIN_EV1_AIN2, LOW);
-  digitalWrite(PIN_EV1_PWMA, LOW);
+  // GPIO : relais au repos, EV1/EV2 (pont en H) refermées
+  actuators.begin();
+  actuators.channel<ACT_EV1>().wear().configure(VALVE_WEAR);
+  actuators.channel<ACT_EV2>().wear().configure(VALVE_WEAR);
+  actuators.channel<ACT_PUMP>().wear().configure(PUMP_WEAR);
+  actuators.channel<ACT_OUT>().wear().configure(PUMP_WEAR);
 
   if (!SIMULATION) {
     pinMode(PIN_TRIG, OUTPUT);
@@ -1011,8 +1349,9 @@ void setup() {
   }
 
   // I2C + OLED
-  Wire.begin(21, 22); // SDA, SCL
-  if (!display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDR)) {
+  i2c.begin(21, 22, I2C_CLOCK_HZ); // SDA, SCL
+  oledOk = display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDR);
+  if (!oledOk) {
     Serial.println(F("SSD1306 non détecté !"));
   } else {
     // display.dim(true); //eteindre l'écran
@@ -1043,7 +1382,7 @@ void setup() {
   }
   Serial.println();
   if (WiFi.isConnected()) {
-    Serial.printf("IP:%s | GW:%s | DNS0:%s | DNS1:%s\n", WiFi.localIP().toString().c_str(), WiFi.gatewayIP().toString().c_str(), WiFi.dnsIP(0).toString().c_str(), WiFi.dnsIP(1).toString().c_str());
+    Serial.printf("IP:%s | GW:%s | DNS0:%s | DNS1:%s\n", ipStr().c_str(), fmtIPv4(WiFi.gatewayIP()).c_str(), fmtIPv4(WiFi.dnsIP(0)).c_str(), fmtIPv4(WiFi.dnsIP(1)).c_str());
   } else {
     Serial.println(F("WiFi non connecté."));
   }
@@ -1057,143 +1396,413 @@ void setup() {
     Serial.print(".");
     ntpRetry++;
   }
+  logEvent((uint32_t)time(nullptr), EVT_BOOT);
 
   // Pour réduire la temperature carte
   WiFi.setTxPower(WIFI_POWER_8_5dBm); // limiter le débit wifi
   WiFi.setSleep(true); // autoriser la veille wifi
 
   // Serveur web
-  events.onConnect([](AsyncEventSourceClient *client){
-    if(client->connected()){
-      client->send(statusJson().c_str(), "status", millis());
-    }
-  });
+  // SSE : un nouveau client reçoit directement la dernière trame publiée
+  events.begin();
   server.addHandler(&events);
-
-  server.on("/", HTTP_GET, [](AsyncWebServerRequest* request){
-    request->send(200, "text/html; charset=utf-8", FPSTR(index_html));
+  if (!ota.begin()) Serial.println(F("ERREUR: tâche OTA non créée"));
+  if (mqtt.enabled() && !mqtt.begin(mqttCommand)) Serial.println(F("ERREUR: tâche MQTT non créée"));
+
+  onTraced("/", HTTP_GET, [](AsyncWebServerRequest* request){
+    AsyncWebServerResponse* response =
+      request->beginResponse_P(200, "text/html; charset=utf-8", index_html_gz, index_html_gz_len);
+    response->addHeader("Content-Encoding", "gzip");
+    request->send(response);
   });
 
-  server.on("/status", HTTP_GET, [](AsyncWebServerRequest* request){
-    String js = statusJson();
-    request->send(200, "application/json", js);
+  onTraced("/status", HTTP_GET, [](AsyncWebServerRequest* request){
+    request->send(200, "application/json", statusJson().c_str());
   });
 
-  server.on("/setmode", HTTP_GET, [](AsyncWebServerRequest* request){
+  onTraced("/setmode", HTTP_GET, [](AsyncWebServerRequest* request){
   if (request->hasParam("mode")) {
     int m = request->getParam("mode")->value().toInt();
     if (m >= 0 && m <= 2) {
-      currentMode = (FountainMode)m;
-      // Sauvegarde en EEPROM
-        saveModeToEEPROM(currentMode);
-
-      // Réinitialiser les états du mode Eco si on change
-      if (currentMode != MODE_ECO_HYBRID) {
-        ecoInClosedPhase = false;
-      }
-      if (currentMode == MODE_ECO_HYBRID) {
-        // Réinitialiser le cycle Eco (nouveau départ)
-        ecoInClosedPhase = true;
-        lastEV1OnTimestamp = (uint32_t)time(nullptr);
-        saveEV1TimestampToEEPROM(lastEV1OnTimestamp);
+      if (enqueueCommand(CMD_SET_MODE, (uint16_t)m)) {
+        request->send(200, "text/plain", "Mode changé");
+      } else {
+        request->send(503, "text/plain", "Occupé, réessayer");
       }
-      
-      // NOUVEAU : Forcer un état propre lors du changement de mode
-      valveOn = false;
-      pumpOn = false;
-      VoutOn = false;
-      pulseEV1(false);
-      setPump(false);
-      setEV_out(false);
-      
-      request->send(200, "text/plain", "Mode changé");
     } else {
+      cmdInvalid++;
       request->send(400, "text/plain", "Mode invalide");
     }
   } else {
+    cmdInvalid++;
     request->send(400, "text/plain", "Paramètre manquant");
   }
 });
 
-server.on("/setinterval", HTTP_GET, [](AsyncWebServerRequest *req){
+onTraced("/setinterval", HTTP_GET, [](AsyncWebServerRequest *req){
     if (req->hasParam("value") && req->hasParam("unit")) {
       int value = req->getParam("value")->value().toInt();
-      String unit = req->getParam("unit")->value();
+      const String& unit = req->getParam("unit")->value();
       
       if (unit == "hours") {
         if (value >= 1 && value <= 720) {
-          ecoDrainIntervalSec = (uint32_t)value * 3600UL;
-          ecoDrainValue = value;
-          ecoDrainUnit = "hours";
-          saveDrainIntervalToEEPROM();
-          req->send(200, "text/plain", "OK");
+          if (enqueueCommand(CMD_SET_INTERVAL, (uint16_t)value, DRAIN_HOURS)) req->send(200, "text/plain", "OK");
+          else req->send(503, "text/plain", "Occupé, réessayer");
         } else {
+          cmdInvalid++;
           req->send(400, "text/plain", "heures entre 1-720");
         }
       } else if (unit == "days") {
         if (value >= 1 && value <= 30) {
-          ecoDrainIntervalSec = (uint32_t)value * 24UL * 3600UL;
-          ecoDrainValue = value;
-          ecoDrainUnit = "days";
-          saveDrainIntervalToEEPROM();
-          req->send(200, "text/plain", "OK");
+          if (enqueueCommand(CMD_SET_INTERVAL, (uint16_t)value, DRAIN_DAYS)) req->send(200, "text/plain", "OK");
+          else req->send(503, "text/plain", "Occupé, réessayer");
         } else {
+          cmdInvalid++;
           req->send(400, "text/plain", "jours entre 1-30");
         }
       } else {
+        cmdInvalid++;
         req->send(400, "text/plain", "unit invalide");
       }
     } else {
+      cmdInvalid++;
       req->send(400, "text/plain", "Params manquants");
     }
   });
 
   // Démarrer vidange manuelle
-  server.on("/drain", HTTP_GET, [](AsyncWebServerRequest *req){
-    manualDrainActive = true;
-    req->send(200, "text/plain", "Vidange démarrée");
+  onTraced("/drain", HTTP_GET, [](AsyncWebServerRequest *req){
+    if (enqueueCommand(CMD_DRAIN_START)) req->send(200, "text/plain", "Vidange démarrée");
+    else req->send(503, "text/plain", "Occupé, réessayer");
   });
 
   // Arrêter vidange manuelle
-  server.on("/stopdrain", HTTP_GET, [](AsyncWebServerRequest *req){
-    manualDrainActive = false;
-    req->send(200, "text/plain", "Vidange arrêtée");
+  onTraced("/stopdrain", HTTP_GET, [](AsyncWebServerRequest *req){
+    if (enqueueCommand(CMD_DRAIN_STOP)) req->send(200, "text/plain", "Vidange arrêtée");
+    else req->send(503, "text/plain", "Occupé, réessayer");
+  });
+
+  // Assistant de calibration : /calib (état) ou /calib?action=capture&litres=1.5|save|clear|default
+  onTraced("/calib", HTTP_GET, [](AsyncWebServerRequest *req){
+    if (!req->hasParam("action")) {
+      req->send(200, "application/json", calibJson().c_str());
+      return;
+    }
+    const String& action = req->getParam("action")->value();
+    bool queued;
+    if (action == "capture") {
+      float litres = req->hasParam("litres") ? req->getParam("litres")->value().toFloat() : -1.0f;
+      if (litres < 0.0f || litres > 600.0f) {
+        cmdInvalid++;
+        req->send(400, "text/plain", "litres entre 0-600");
+        return;
+      }
+      queued = enqueueCommand(CMD_CAL_CAPTURE, (uint32_t)round(litres * 100.0f));
+    } else if (action == "save") {
+      queued = enqueueCommand(CMD_CAL_SAVE);
+    } else if (action == "clear") {
+      queued = enqueueCommand(CMD_CAL_CLEAR);
+    } else if (action == "default") {
+      queued = enqueueCommand(CMD_CAL_DEFAULT);
+    } else {
+      cmdInvalid++;
+      req->send(400, "text/plain", "action invalide");
+      return;
+    }
+    if (queued) req->send(200, "text/plain", "OK");
+    else req->send(503, "text/plain", "Occupé, réessayer");
+  });
+
+  // Programmation : /schedule (état, prochaines échéances) ou
+  //   /schedule?action=add&type=drain|refill|quiet&days=sun,wed|all|week&time=03:00[&duration=480]
+  //   /schedule?action=delete&id=N   /schedule?action=enable&id=N&on=0|1
+  onTraced("/schedule", HTTP_GET, [](AsyncWebServerRequest *req){
+    if (!req->hasParam("action")) {
+      req->send(200, "application/json", scheduleJson().c_str());
+      return;
+    }
+    const String& action = req->getParam("action")->value();
+    bool queued;
+    if (action == "add") {
+      if (!req->hasParam("type") || !req->hasParam("days") || !req->hasParam("time")) {
+        cmdInvalid++;
+        req->send(400, "text/plain", "type, days, time requis");
+        return;
+      }
+      const String& type = req->getParam("type")->value();
+      ScheduleRule r = {};
+      r.action = type == "drain" ? SCHED_DRAIN : type == "refill" ? SCHED_REFILL : type == "quiet" ? SCHED_QUIET : 0xFF;
+      r.days = scheduleParseDays(req->getParam("days")->value().c_str());
+      int hh = -1, mm = -1;
+      sscanf(req->getParam("time")->value().c_str(), "%d:%d", &hh, &mm);
+      r.minute = (hh >= 0 && hh < 24 && mm >= 0 && mm < 60) ? hh * 60 + mm : 0xFFFF;
+      r.durationMin = req->hasParam("duration") ? req->getParam("duration")->value().toInt() : 0;
+      if (!scheduleRuleValid(r)) {
+        cmdInvalid++;
+        req->send(400, "text/plain", "règle invalide (durée 1-1440 min pour quiet)");
+        return;
+      }
+      queued = enqueueCommand(CMD_SCHED_ADD, schedulePack(r));
+    } else if (action == "delete" || action == "enable") {
+      int id = req->hasParam("id") ? req->getParam("id")->value().toInt() : -1;
+      if (id < 0 || id >= SCHED_MAX_RULES || !scheduler.rules[id].used) {
+        cmdInvalid++;
+        req->send(400, "text/plain", "id inconnu");
+        return;
+      }
+      if (action == "delete") {
+        queued = enqueueCommand(CMD_SCHED_DELETE, 0, (uint8_t)id);
+      } else {
+        bool on = !req->hasParam("on") || req->getParam("on")->value().toInt() != 0;
+        queued = enqueueCommand(CMD_SCHED_ENABLE, on ? 1 : 0, (uint8_t)id);
+      }
+    } else {
+      cmdInvalid++;
+      req->send(400, "text/plain", "action invalide");
+      return;
+    }
+    if (queued) req->send(200, "text/plain", "OK");
+    else req->send(503, "text/plain", "Occupé, réessayer");
+  });
+
+  // Journal d'événements : /log, /log?ack=1 (acquitte les alertes, lève l'arrêt de sécurité)
+  onTraced("/log", HTTP_GET, [](AsyncWebServerRequest *req){
+    if (req->hasParam("ack")) {
+      if (enqueueCommand(CMD_ALERT_ACK)) req->send(200, "text/plain", "Alertes acquittées");
+      else req->send(503, "text/plain", "Occupé, réessayer");
+      return;
+    }
+    req->send(200, "application/json", logJson().c_str());
+  });
+
+  // Trace capteurs binaire (host/replay) : /recording, /recording?clear=1
+  // Enregistrement suspendu pendant le téléchargement (longueur figée)
+  onTraced("/recording", HTTP_GET, [](AsyncWebServerRequest *req){
+    if (req->hasParam("clear")) {
+      sensorTrace.requestClear();
+      req->send(200, "text/plain", "Trace effacée");
+      return;
+    }
+    sensorTrace.freeze();
+    AsyncWebServerResponse* res = req->beginResponse("application/octet-stream", sensorTrace.exportSize(),
+      [](uint8_t* buf, size_t maxLen, size_t index) -> size_t {
+        return sensorTrace.exportRead(index, buf, maxLen);
+      });
+    res->addHeader("Content-Disposition", "attachment; filename=\"fontaine.trc\"");
+    req->onDisconnect([](){ sensorTrace.unfreeze(); });
+    req->send(res);
+  });
+
+  // Historique en flux, mémoire constante (pas de Content-Length, réponse chunked) :
+  //   /export?kind=samples|events&format=csv|ndjson&from=2026-07-01&to=2026-09-30
+  //   from / to : epoch ou date locale AAAA-MM-JJ[THH:MM], bornes incluses, facultatives
+  onTraced("/export", HTTP_GET, [](AsyncWebServerRequest *req){
+    const String kindArg = req->hasParam("kind") ? req->getParam("kind")->value() : String("samples");
+    const String formatArg = req->hasParam("format") ? req->getParam("format")->value() : String("csv");
+    if ((kindArg != "samples" && kindArg != "events") || (formatArg != "csv" && formatArg != "ndjson")) {
+      req->send(400, "text/plain", "kind=samples|events, format=csv|ndjson");
+      return;
+    }
+    uint8_t kind = kindArg == "events" ? HIST_EVENTS : HIST_SAMPLES;
+    uint8_t format = formatArg == "ndjson" ? HIST_NDJSON : HIST_CSV;
+    uint32_t from = req->hasParam("from") ? historyParseTime(req->getParam("from")->value().c_str(), false) : 0;
+    uint32_t to = req->hasParam("to") ? historyParseTime(req->getParam("to")->value().c_str(), true) : 0;
+    if (!history.ok()) {
+      req->send(503, "text/plain", "Historique indisponible");
+      return;
+    }
+    if (exportsActive >= HISTORY_EXPORT_MAX) {
+      req->send(503, "text/plain", "Export en cours, réessayer");
+      return;
+    }
+    // État de l'export (~500 octets + fichier ouvert) libéré avec la réponse, même si le client coupe
+    exportsActive++;
+    std::shared_ptr<HistoryExporter> exp(new HistoryExporter(HistoryStore::Source(history, kind), kind, format, from, to),
+                                         [](HistoryExporter* e) { delete e; exportsActive--; });
+    AsyncWebServerResponse* res = req->beginChunkedResponse(format == HIST_CSV ? "text/csv" : "application/x-ndjson",
+      [exp](uint8_t* buf, size_t maxLen, size_t index) -> size_t {
+        return exp->read(buf, maxLen);
+      });
+    char disposition[64];
+    snprintf(disposition, sizeof(disposition), "attachment; filename=\"fontaine-%s.%s\"",
+             historyKindName(kind), format == HIST_CSV ? "csv" : "ndjson");
+    res->addHeader("Content-Disposition", disposition);
+    req->send(res);
+  });
+
+  // Mise à jour OTA (image .bin ou .bin.gz, MD5 de l'image décompressée) :
+  //   curl -F "image=@firmware.bin.gz" "http://<ip>/update?md5=$(md5sum firmware.bin | cut -c1-32)"
+  // Les morceaux partent vers la tâche OTA (fenêtre TCP refermée tant que le
+  // tampon est plein) ; la réponse suit la vérification.
+  server.on("/update", HTTP_POST, [](AsyncWebServerRequest *req){
+    if (!req->hasParam("md5") || req->getParam("md5")->value().length() != 32) {
+      req->send(400, "text/plain", "md5 (32 hex) requis");
+      return;
+    }
+    if (ota.owner() != req) {
+      req->send(409, "text/plain", "Mise à jour déjà en cours");
+      return;
+    }
+    // Réponse immédiate (jamais d'attente dans async_tcp) : vérification
+    // encore en cours -> 202, suite dans /metrics "ota" (done, puis redémarrage)
+    FixedString<160> out;
+    out.append('{');
+    out.setLength(out.length() + ota.printStats(out.data() + out.length(), out.remaining() + 1));
+    out.append('}');
+    int code = ota.state() == OTA_DONE ? 200 : ota.state() == OTA_ERROR ? 500 : 202;
+    req->send(code, "application/json", out.c_str());
+  }, [](AsyncWebServerRequest *req, const String& filename, size_t index, uint8_t *data, size_t len, bool final){
+    if (index == 0) {
+      if (!req->hasParam("md5") || req->getParam("md5")->value().length() != 32) return;
+      if (!ota.start(req, req->getParam("md5")->value().c_str())) return;
+      req->onDisconnect([req](){ ota.abort(req); });
+      // Segments retenus (ackLater) : acquittés ici dès que la tâche a vidé le
+      // tampon, si le client ne peut plus rien envoyer (fenêtre fermée).
+      // Pas de réponse en cours pendant l'envoi : rien à relayer au poll du serveur
+      req->client()->onPoll([](void*, AsyncClient* c){ if (ota.hasRoom()) c->ack(SIZE_MAX); }, nullptr);
+    }
+    if (len && !ota.feed(req, data, len)) return;
+    // Contre-pression : jamais d'attente dans async_tcp
+    if (final || ota.hasRoom()) req->client()->ack(SIZE_MAX);   // y compris les segments retenus
+    else req->client()->ackLater();
+    if (final) ota.finish(req);
+  });
+
+  // Chronologie d'exécution (perf_trace.h), à convertir par host/trace2perfetto.py :
+  //   curl -o fontaine.ptr http://<ip>/trace    (/trace?enable=0|1 : arrêt / reprise)
+  onTraced("/trace", HTTP_GET, [](AsyncWebServerRequest *req){
+    if (req->hasParam("enable")) {
+      perf.enable(req->getParam("enable")->value() != "0");
+      req->send(200, "text/plain", req->getParam("enable")->value() != "0" ? "trace active" : "trace arrêtée");
+      return;
+    }
+    // Anneaux figés jusqu'à la libération de la réponse, même si le client coupe
+    std::shared_ptr<PerfTrace::Reader> rd(new PerfTrace::Reader(perf));
+    AsyncWebServerResponse* res = req->beginChunkedResponse("application/octet-stream",
+      [rd](uint8_t* buf, size_t maxLen, size_t index) -> size_t {
+        return rd->read(buf, maxLen);
+      });
+    res->addHeader("Content-Disposition", "attachment; filename=\"fontaine.ptr\"");
+    req->send(res);
+  });
+
+  // Visites apprises : créneaux attendus, taux de réussite (?clear=1 : tout oublier)
+  onTraced("/visits", HTTP_GET, [](AsyncWebServerRequest *req){
+    if (req->hasParam("clear")) {
+      visits.requestClear();
+      req->send(200, "text/plain", "Visites oubliées");
+      return;
+    }
+    FixedString<1792> out;
+    out.setLength(visits.printJson(out.data(), out.remaining() + 1));
+    req->send(200, "application/json", out.c_str());
+  });
+
+  // Usure des actionneurs : cycles, reports, vie restante (?reset=EV1 : voie remplacée)
+  onTraced("/wear", HTTP_GET, [](AsyncWebServerRequest *req){
+    if (req->hasParam("reset")) {
+      const String& name = req->getParam("reset")->value();
+      bool found = false;
+      actuators.forEach([&](size_t, const char* n, auto& c) {
+        if (name == n) {
+          c.wear().requestReset();
+          found = true;
+        }
+      });
+      req->send(found ? 200 : 404, "text/plain", found ? "Compteur remis à zéro" : "Voie inconnue");
+      return;
+    }
+    uint32_t epoch = (uint32_t)time(nullptr);
+    FixedString<1280> out;
+    out.append('[');
+    actuators.forEach([&](size_t i, const char* n, const auto& c) {
+      if (i) out.append(',');
+      out.setLength(out.length() + c.wear().printJson(out.data() + out.length(), out.remaining() + 1, n, epoch));
+    });
+    out.append(']');
+    req->send(200, "application/json", out.c_str());
+  });
+
+  // Vitesse de la pompe : ?hold=level&value=55 (%), ?hold=flow&value=1.5 (L/min), ?hold=none
+  onTraced("/pump", HTTP_GET, [](AsyncWebServerRequest *req){
+    if (req->hasParam("hold")) {
+      const String& h = req->getParam("hold")->value();
+      PumpHold hold = h == "level" ? PUMP_HOLD_LEVEL : h == "flow" ? PUMP_HOLD_FLOW : PUMP_HOLD_NONE;
+      if (hold == PUMP_HOLD_NONE && h != "none") {
+        req->send(400, "text/plain", "hold = level, flow ou none");
+        return;
+      }
+      float value = req->hasParam("value") ? req->getParam("value")->value().toFloat() : pumpSpeed.setpoint();
+      if (value < 0 || (hold == PUMP_HOLD_LEVEL && value > 100)) {
+        req->send(400, "text/plain", "Consigne hors plage");
+        return;
+      }
+      pumpSpeed.requestHold(hold, value);
+      req->send(200, "text/plain", "Consigne enregistrée");
+      return;
+    }
+    FixedString<256> out;
+    out.setLength(pumpSpeed.printJson(out.data(), out.remaining() + 1));
+    req->send(200, "application/json", out.c_str());
+  });
+
+  // Consommation par jour (7 derniers) et par mode (?clear=1 : remise à zéro)
+  onTraced("/usage", HTTP_GET, [](AsyncWebServerRequest *req){
+    if (req->hasParam("clear")) {
+      usage.requestClear();
+      req->send(200, "text/plain", "Compteurs remis à zéro");
+      return;
+    }
+    FixedString<2560> out;
+    usage.printJson(out);
+    req->send(200, "application/json", out.c_str());
+  });
+
+  // Tâches de loop() : période, politique de débordement, retard au démarrage
+  onTraced("/sched", HTTP_GET, [](AsyncWebServerRequest *req){
+    FixedString<1536> out;
+    out.setLength(loopJobs.printJson(out.data(), out.remaining() + 1));
+    req->send(200, "application/json", out.c_str());
+  });
+
+  // Compteurs internes (file de commandes...)
+  onTraced("/metrics", HTTP_GET, [](AsyncWebServerRequest *req){
+    req->send(200, "application/json", metricsJson().c_str());
   });
 
   server.begin();
 
-  lastLogicMs = lastOledMs = lastSseMs = millis();
   // ===== Lecture initiale =====
-  readAHT20();
+  readAHT20(temperatureC, humidityPct);
   delay(100);  // Stabilisation capteur
-  distanceCm = readUltrasonicCm();
+  uint32_t echoUs[ECHO_MAX_SAMPLES];
+  uint8_t nEcho = sampleUltrasonic(echoUs);
+  int valid = 0;
+  distanceCm = echoesToCm(echoUs, nEcho, valid);
   levelPct = cmToPercent(distanceCm);
+  events.publish("message", statusJson().c_str(), millis());
   // ===== Premier envoi =====
   pushToGoogleSheet();
 
+  registerLoopJobs();
 }
 
 void loop() {
   unsigned long now = millis();
-
-  if (now - lastLogicMs >= LOGIC_INTERVAL_MS) {
-    unsigned long dt = now - lastLogicMs;
-    lastLogicMs = now;
-    runLogic(dt);
+  actuators.update(now);   // fin des impulsions des vannes bistables
+
+  // Image OTA validée : relais au repos (EV1 bistable) puis redémarrage
+  if (ota.state() == OTA_DONE && now - ota.doneMs() >= OTA_REBOOT_DELAY_MS) {
+    actuators.allOff(now);
+    actuators.finish();   // impulsions de fermeture complètes avant le redémarrage
+    saveStateFiles();
+    ESP.restart();
   }
 
-  if (now - lastOledMs >= OLED_INTERVAL_MS) {
-    lastOledMs = now;
-    drawOLED();
-  }
-
-  if (now - lastSseMs >= SSE_INTERVAL_MS) {
-    lastSseMs = now;
-    events.send(statusJson().c_str(), "message", now);
-  }
+  updateDisplayPower(now);
+  i2c.tick(now);
+  sheets.idle(now);   // connexion fermée par le serveur : tampons TLS rendus
 
-  if (millis() - lastSheetMs >= SHEET_INTERVAL_MS) {
-  lastSheetMs = millis();
-  pushToGoogleSheet();
-  }
+  // Logique, écran, SSE, historique, Sheets... : la plus urgente d'abord
+  loopJobs.run();
 }
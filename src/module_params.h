@@ -0,0 +1,79 @@
+#pragma once
+/*
+  Paramètres des modules de contrôle et de diffusion, partagés par le
+  firmware (main.cpp) et l'endurance mémoire native (host/soak) : les deux
+  instancient les modules avec les mêmes valeurs
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include "display_power.h"
+#include "wear.h"
+#include "visit_model.h"
+#include "pump_control.h"
+#include "sensor_health.h"
+#include "anomaly.h"
+#include "status_view.h"
+
+// ---- Écran (display_power.h) ----
+const DisplayPowerParams DISPLAY_POWER = {
+  60000,   // ms sans présence : écran atténué
+  300000   // ms sans présence : écran éteint (réveil sur PIR)
+};
+
+// ---- Usure (wear.h, /wear) : court-cycle bloqué à la source ----
+// Aucune coupure retardée (durée ON min. nulle partout) : fin de vidange,
+// plancher de vidange manuelle et arrêt à sec de controlStep() restent
+// immédiats ; seuls les redémarrages sont espacés et limités par heure.
+// Pompe et EV_out (qui la suit) : mêmes limites, pour commuter ensemble.
+const WearLimits VALVE_WEAR = { 0, 5000, 60, 500000 };   // ms ON / ms OFF min, ON par heure, cycles nominaux
+const WearLimits PUMP_WEAR  = { 0, 10000, 30, 100000 };  // EV_out : relais ~100k cycles sous charge (pompe : MOSFET)
+
+// ---- Pré-remplissage appris (cycle ouvert, visit_model.h, /visits) ----
+const VisitModelParams VISIT_PARAMS = {
+  2,      // semaines observées avant la première annonce
+  40,     // % des semaines avec une visite dans le créneau de 15 min
+  20,     // min : remplissage lancé avant le créneau attendu
+  45      // min : durée de l'autorisation (fenêtre de réussite)
+};
+
+// ---- Consommation (consumption.h, /usage) ----
+const float PUMP_POWER_W = 6.0f;              // puissance de la pompe à pleine vitesse (énergie estimée)
+
+// ---- Vitesse de la pompe (pump_control.h, /pump) ----
+// Rejet du cycle ouvert régulé (niveau tenu entre les seuils ON / OFF) ;
+// vidanges à plein débit ; recirculation (cycle fermé, éco) à vitesse fixe
+const PumpSpeedParams PUMP_SPEED = {
+  0.35f, 1.0f,      // rapport cyclique min (calage) / max
+  0.03f, 0.002f,    // consigne de niveau : par % d'écart, par % x s
+  0.25f, 0.05f,     // consigne de débit : par L/min d'écart, par L/min x s
+  10.0f             // s : lissage de la pente du niveau (débit estimé)
+};
+const PumpHold PUMP_HOLD_DEFAULT = PUMP_HOLD_LEVEL;
+const float PUMP_HOLD_SETPOINT   = 55.0f;   // % (niveau) ou L/min (débit)
+
+// ---- Santé des capteurs (sensor_health.h) ----
+const SensorHealthParams ULTRASONIC_HEALTH = {
+  20,     // mesures : constante des moyennes glissantes
+  0.5f,   // part de timeouts tolérée
+  1.5f,   // cm : bruit (écart-type des variations successives)
+  60000,  // ms : valeur strictement identique = capteur figé
+  5000    // ms : sans écho valide = capteur HS
+};
+const SensorHealthParams AHT_HEALTH = { 20, 0.5f, 2.0f, 0, 30000 }; // °C, pas de test "figé"
+
+// ---- Détection de fuite (anomaly.h) ----
+const AnomalyParams ANOMALY_PARAMS = {
+  600,    // s : fenêtre de la régression de pente
+  10,     // s : lissage du niveau avant CUSUM
+  60,     // s : stabilisation après un changement d'actionneur
+  900,    // s : âge minimal du segment avant de juger la pente
+  0.02f,  // L/h : évaporation tolérée
+  0.10f,  // L/h : fuite (au-delà de l'évaporation)
+  0.10f,  // L/h : montée vanne fermée
+  0.10f   // L : volume cumulé hors tolérance (CUSUM)
+};
+
+// ---- SSE (sse_fanout.h) ----
+const uint8_t  SSE_MAX_CLIENTS  = 4; // tableaux de bord simultanés (au-delà : 503)
+const uint8_t  SSE_CLIENT_QUEUE = 4; // trames en attente par client (drop-oldest)
+const uint16_t SSE_FRAME_BYTES  = StatusBuffer::capacity() + 64;   // /status + "id: ..\nevent: ..\ndata: "
@@ -0,0 +1,206 @@
+#pragma once
+/*
+  Publication MQTT (courtier local, mosquitto) : sortie de télémétrie à côté de Sheets
+  - Un sujet par champ (<base>/<champ>, valeur seule), publié au changement
+    et conservé (retain) par le courtier : un abonné reçoit l'état courant
+  - <base>/status : "online" à la connexion, "offline" en testament (LWT)
+  - Commandes : <base>/cmd/mode|drain|interval (mqtt_telemetry.h) -> file
+    de commandes de la boucle, comme les handlers HTTP ; résultat sur
+    <base>/ack ("mode:ok", "interval:invalid", "drain:busy")
+  - Tâche dédiée (cœur 0, priorité basse) : connexion, reconnexion avec
+    attente doublée à chaque échec, envoi -> la boucle ne fait qu'empiler
+    dans la file (MqttOutbox), jamais bloquée par un courtier injoignable
+  - Courtier injoignable : messages gardés dans la file bornée, envoyés
+    dans l'ordre au retour ; profondeur, pertes et latence dans /metrics
+  QoS 0, sans TLS (réseau local) ; identifiants facultatifs.
+*/
+#include <Arduino.h>
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include "mqtt_telemetry.h"
+#include "fixed_string.h"
+
+#define MQTT_POLL_MS        50    // réveil de la tâche sans message à envoyer
+#define MQTT_BURST          16    // messages envoyés entre deux lectures du courtier
+#define MQTT_IO_TIMEOUT_S   5     // attente d'une réponse du courtier
+#define MQTT_TOPIC_MAX      64
+
+struct MqttConfig {
+  const char* host;                 // "" : désactivé
+  uint16_t port;
+  const char* clientId;
+  const char* user;                 // "" : sans authentification
+  const char* pass;
+  const char* base;                 // préfixe des sujets
+  uint16_t keepAliveS;
+  uint32_t retryMinMs, retryMaxMs;  // reconnexion : attente doublée à chaque échec
+};
+
+// Commande reçue -> file de la boucle ; false : file pleine (ou maintenance)
+typedef bool (*MqttCommandSink)(const MqttCommand& cmd);
+
+template<uint8_t QUEUE>
+class MqttLink {
+public:
+  // fields : nom du sujet de chaque champ (indices de publish())
+  MqttLink(const MqttConfig& cfg, const char* const* fields, uint8_t fieldCount)
+    : _cfg(cfg), _fields(fields), _fieldCount(fieldCount), _client(_net) {}
+
+  bool begin(MqttCommandSink sink) {
+    if (!enabled()) return false;
+    _sink = sink;
+    _retryMs = _cfg.retryMinMs;
+    _lock = xSemaphoreCreateMutex();
+    _client.setServer(_cfg.host, _cfg.port);
+    _client.setKeepAlive(_cfg.keepAliveS);
+    _client.setSocketTimeout(MQTT_IO_TIMEOUT_S);
+    _client.setCallback([this](char* topic, uint8_t* payload, unsigned int len) { onMessage(topic, payload, len); });
+    return _lock != nullptr && xTaskCreatePinnedToCore(taskEntry, "mqtt", 4096, this, 1, &_task, 0) == pdPASS;
+  }
+
+  bool enabled() const { return _cfg.host && _cfg.host[0]; }
+
+  // Boucle : nouvel état d'un champ (conservé par le courtier)
+  void publish(uint8_t field, const char* payload) {
+    if (_task == nullptr || field >= _fieldCount) return;
+    lock();
+    _outbox.push(field, payload, true, millis());
+    unlock();
+    xTaskNotifyGive(_task);
+  }
+
+  size_t printStats(char* buf, size_t size) {
+    size_t len = 0;
+    auto put = [&](int w) { if (w > 0) len = (len + w < size) ? len + w : size - 1; };
+    put(snprintf(buf, size,
+      "\"mqtt\":{\"enabled\":%s,\"connected\":%s,\"connects\":%u,\"connectFails\":%u,\"disconnects\":%u,"
+      "\"lastState\":%d,\"retryMs\":%u,\"publishFails\":%u,"
+      "\"commands\":{\"received\":%u,\"accepted\":%u,\"invalid\":%u,\"busy\":%u},",
+      enabled() ? "true" : "false", _connected ? "true" : "false", (unsigned)_connects,
+      (unsigned)_connectFails, (unsigned)_disconnects, _lastState, (unsigned)_retryMs,
+      (unsigned)_publishFails, (unsigned)_cmdReceived, (unsigned)_cmdAccepted,
+      (unsigned)_cmdInvalid, (unsigned)_cmdBusy));
+    if (_lock) lock();
+    put(_outbox.printStats(buf + len, size - len));
+    if (_lock) unlock();
+    put(snprintf(buf + len, size - len, "}"));
+    return len;
+  }
+
+private:
+  static void taskEntry(void* self) {
+    for (;;) {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MQTT_POLL_MS));
+      ((MqttLink*)self)->poll();
+    }
+  }
+
+  void poll() {
+    if (_connected && !_client.connected()) {
+      _connected = false;
+      _disconnects++;
+      _lastState = _client.state();
+    }
+    if (WiFi.status() != WL_CONNECTED) return;
+    if (!_connected && !connect()) return;
+    send();
+    _client.loop();   // commandes reçues (onMessage), keep-alive
+  }
+
+  bool connect() {
+    uint32_t now = millis();
+    if (_attempted && now - _attemptMs < _retryMs) return false;
+    _attempted = true;
+    _attemptMs = now;
+    FixedString<MQTT_TOPIC_MAX> status;
+    status.append(_cfg.base).append("/status");
+    bool auth = _cfg.user && _cfg.user[0];
+    if (!_client.connect(_cfg.clientId, auth ? _cfg.user : nullptr, auth ? _cfg.pass : nullptr,
+                         status.c_str(), 0, true, "offline")) {
+      _connectFails++;
+      _lastState = _client.state();
+      _retryMs = _retryMs * 2 < _cfg.retryMaxMs ? _retryMs * 2 : _cfg.retryMaxMs;
+      return false;
+    }
+    _connected = true;
+    _connects++;
+    _lastState = 0;
+    _retryMs = _cfg.retryMinMs;
+    _client.publish(status.c_str(), "online", true);
+    FixedString<MQTT_TOPIC_MAX> cmd;
+    cmd.append(_cfg.base).append("/cmd/+");
+    _client.subscribe(cmd.c_str());
+    return true;
+  }
+
+  // File -> courtier, dans l'ordre ; un échec d'écriture laisse le message en tête
+  void send() {
+    MqttMessage m;
+    for (uint8_t i = 0; i < MQTT_BURST; i++) {
+      lock();
+      bool any = _outbox.peek(m);
+      unlock();
+      if (!any) return;
+      FixedString<MQTT_TOPIC_MAX> topic;
+      topic.append(_cfg.base).append('/').append(m.topic == MQTT_TOPIC_ACK ? "ack" : _fields[m.topic]);
+      if (!_client.publish(topic.c_str(), m.payload, m.retained)) {
+        _publishFails++;
+        return;
+      }
+      lock();
+      _outbox.ack(m.seq, millis());
+      unlock();
+    }
+  }
+
+  // Dans _client.loop() (tâche MQTT)
+  void onMessage(char* topic, uint8_t* payload, unsigned int len) {
+    size_t baseLen = strlen(_cfg.base);
+    if (strncmp(topic, _cfg.base, baseLen) != 0 || strncmp(topic + baseLen, "/cmd/", 5) != 0) return;
+    const char* name = topic + baseLen + 5;
+    char value[MQTT_PAYLOAD_MAX];
+    if (len >= sizeof(value)) len = 0;   // trop long : refusé comme illisible
+    memcpy(value, payload, len);
+    value[len] = '\0';
+
+    _cmdReceived++;
+    MqttCommand cmd;
+    uint8_t r = mqttParseCommand(name, value, cmd);
+    const char* result;
+    if (r != MQTT_CMD_OK) {
+      _cmdInvalid++;
+      result = r == MQTT_CMD_UNKNOWN ? "unknown" : "invalid";
+    } else if (_sink(cmd)) {
+      _cmdAccepted++;
+      result = "ok";
+    } else {
+      _cmdBusy++;
+      result = "busy";
+    }
+    FixedString<MQTT_PAYLOAD_MAX> ack;
+    ack.appendf("%s:%s", name, result);
+    lock();
+    _outbox.push(MQTT_TOPIC_ACK, ack.c_str(), false, millis());
+    unlock();
+  }
+
+  void lock()   { xSemaphoreTake(_lock, portMAX_DELAY); }
+  void unlock() { xSemaphoreGive(_lock); }
+
+  MqttConfig _cfg;
+  const char* const* _fields;
+  uint8_t _fieldCount;
+  WiFiClient _net;
+  PubSubClient _client;
+  MqttCommandSink _sink = nullptr;
+  TaskHandle_t _task = nullptr;
+  SemaphoreHandle_t _lock = nullptr;
+  MqttOutbox<QUEUE> _outbox;   // sous _lock (boucle, tâche MQTT, /metrics)
+
+  volatile bool _connected = false;
+  bool _attempted = false;
+  uint32_t _attemptMs = 0, _retryMs = 0;
+  int _lastState = 0;   // PubSubClient::state() du dernier échec
+  uint32_t _connects = 0, _connectFails = 0, _disconnects = 0, _publishFails = 0;
+  uint32_t _cmdReceived = 0, _cmdAccepted = 0, _cmdInvalid = 0, _cmdBusy = 0;
+};
@@ -0,0 +1,213 @@
+#pragma once
+/*
+  Télémétrie MQTT : partie sans réseau (file d'envoi, détection des
+  changements, commandes reçues) ; la connexion est dans mqtt_link.h
+  - MqttOutbox : file bornée des messages en attente (courtier injoignable
+    ou pas encore vidée). Pleine : le message le plus ancien déjà dépassé
+    (même sujet plus récent dans la file) ou non conservé est retiré ; un
+    nouvel état remplace d'abord son propre prédécesseur -> l'historique
+    est gardé tant qu'il tient, le dernier état de chaque sujet jamais
+    perdu (capacité > nombre de sujets). Retrait par numéro de séquence
+    après publication : une entrée remplacée entre-temps n'est pas perdue
+  - Latence : de la mise en file à l'écriture sur la socket (QoS 0)
+  - MqttChangeFilter : un champ n'est publié que s'il a changé (écart
+    minimal pour les mesures, texte différent sinon)
+  - mqttParseCommand() : sujet <base>/cmd/<nom> -> Command de la file de
+    la boucle (mêmes bornes que /setmode, /setinterval, /drain)
+  Non protégé : l'appelant sérialise les accès (mqtt_link.h).
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "byte_codec.h"
+#include "control.h"
+
+#define MQTT_PAYLOAD_MAX  24     // valeur d'un champ ou résultat de commande, zéro final compris
+#define MQTT_TOPIC_ACK    0xFF   // <base>/ack : résultat d'une commande (non conservé)
+
+inline const char* mqttModeName(uint8_t m) {
+  static const char* const names[] = { "open", "closed", "eco" };
+  return m <= MODE_ECO_HYBRID ? names[m] : "?";
+}
+
+struct MqttMessage {
+  uint32_t seq;
+  uint32_t queuedMs;
+  uint8_t topic;     // champ (table de l'appelant) ou MQTT_TOPIC_ACK
+  bool retained;
+  char payload[MQTT_PAYLOAD_MAX];
+};
+
+template<uint8_t CAPACITY>
+class MqttOutbox {
+public:
+  void push(uint8_t topic, const char* payload, bool retained, uint32_t nowMs) {
+    if (_count == CAPACITY && !makeRoom(topic, retained)) {
+      _dropped++;   // file pleine de derniers états : capacité trop petite
+      return;
+    }
+    MqttMessage& m = _items[(_head + _count) % CAPACITY];
+    m.seq = ++_seq;
+    m.queuedMs = nowMs;
+    m.topic = topic;
+    m.retained = retained;
+    strncpy(m.payload, payload, MQTT_PAYLOAD_MAX - 1);
+    m.payload[MQTT_PAYLOAD_MAX - 1] = '\0';
+    _count++;
+    _queued++;
+    if (_count > _depthMax) _depthMax = _count;
+  }
+
+  // Copie du plus ancien ; false si vide
+  bool peek(MqttMessage& out) const {
+    if (_count == 0) return false;
+    out = _items[_head];
+    return true;
+  }
+
+  // Publié : retiré s'il est toujours en tête, latence comptée
+  void ack(uint32_t seq, uint32_t nowMs) {
+    if (_count == 0 || _items[_head].seq != seq) return;
+    uint32_t latency = nowMs - _items[_head].queuedMs;
+    _head = (_head + 1) % CAPACITY;
+    _count--;
+    _sent++;
+    _latencyLastMs = latency;
+    _latencySumMs += latency;
+    if (latency > _latencyMaxMs) _latencyMaxMs = latency;
+  }
+
+  uint8_t depth() const { return _count; }
+  uint32_t dropped() const { return _dropped; }
+
+  size_t printStats(char* buf, size_t size) const {
+    int n = snprintf(buf, size,
+      "\"queue\":{\"depth\":%u,\"capacity\":%u,\"depthMax\":%u,\"queued\":%u,\"sent\":%u,"
+      "\"coalesced\":%u,\"dropped\":%u,\"latencyMs\":%u,\"latencyAvgMs\":%u,\"latencyMaxMs\":%u}",
+      (unsigned)_count, (unsigned)CAPACITY, (unsigned)_depthMax, (unsigned)_queued, (unsigned)_sent,
+      (unsigned)_coalesced, (unsigned)_dropped, (unsigned)_latencyLastMs,
+      _sent ? (unsigned)(_latencySumMs / _sent) : 0u, (unsigned)_latencyMaxMs);
+    if (n < 0) return 0;
+    return (size_t)n < size ? (size_t)n : size - 1;
+  }
+
+private:
+  MqttMessage& at(uint8_t i) { return _items[(_head + i) % CAPACITY]; }
+
+  bool superseded(uint8_t i) {
+    for (uint8_t j = i + 1; j < _count; j++) {
+      if (at(j).topic == at(i).topic) return true;
+    }
+    return false;
+  }
+
+  void removeAt(uint8_t i) {
+    for (; i + 1 < _count; i++) at(i) = at(i + 1);
+    _count--;
+  }
+
+  bool makeRoom(uint8_t topic, bool retained) {
+    if (retained) {
+      for (uint8_t i = 0; i < _count; i++) {
+        if (at(i).topic == topic) {
+          removeAt(i);
+          _coalesced++;
+          return true;
+        }
+      }
+    }
+    for (uint8_t i = 0; i < _count; i++) {
+      if (!at(i).retained || superseded(i)) {
+        removeAt(i);
+        _dropped++;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  MqttMessage _items[CAPACITY];
+  uint8_t _head = 0, _count = 0, _depthMax = 0;
+  uint32_t _seq = 0;
+  uint32_t _queued = 0, _sent = 0, _coalesced = 0, _dropped = 0;
+  uint32_t _latencyLastMs = 0, _latencyMaxMs = 0;
+  uint64_t _latencySumMs = 0;
+};
+
+// Dernière valeur publiée par champ
+template<uint8_t N>
+class MqttChangeFilter {
+public:
+  // Mesure : publiée au premier passage, puis à chaque écart >= deadband
+  bool changed(uint8_t i, float v, float deadband) {
+    if (_seen[i] && (isnan(v) ? isnan(_last[i]) : fabsf(v - _last[i]) < deadband)) return false;
+    _seen[i] = true;
+    _last[i] = v;
+    return true;
+  }
+
+  // État discret (nom, booléen) : publié si le texte diffère
+  bool changedText(uint8_t i, const char* s) {
+    uint32_t h = fnv1a(s);
+    if (_seen[i] && _hash[i] == h) return false;
+    _seen[i] = true;
+    _hash[i] = h;
+    return true;
+  }
+
+private:
+  float _last[N] = {};
+  uint32_t _hash[N] = {};
+  bool _seen[N] = {};
+};
+
+enum MqttCmdResult : uint8_t {
+  MQTT_CMD_OK = 0,
+  MQTT_CMD_INVALID,    // valeur hors bornes ou illisible
+  MQTT_CMD_UNKNOWN     // sujet sans commande
+};
+
+struct MqttCommand {
+  CommandType type;
+  uint32_t value;
+  uint8_t unit;        // CMD_SET_INTERVAL : 0 = jours, 1 = heures (DrainUnit, main.cpp)
+};
+
+// <base>/cmd/mode      open | closed | eco | 0..2
+// <base>/cmd/drain     start | stop
+// <base>/cmd/interval  <n>h (1-720) | <n>d (1-30)
+inline uint8_t mqttParseCommand(const char* name, const char* payload, MqttCommand& out) {
+  out.value = 0;
+  out.unit = 0;
+  if (strcmp(name, "mode") == 0) {
+    out.type = CMD_SET_MODE;
+    for (uint8_t m = MODE_OPEN_CYCLE; m <= MODE_ECO_HYBRID; m++) {
+      if (strcmp(payload, mqttModeName(m)) == 0 || (payload[0] == '0' + m && payload[1] == '\0')) {
+        out.value = m;
+        return MQTT_CMD_OK;
+      }
+    }
+    return MQTT_CMD_INVALID;
+  }
+  if (strcmp(name, "drain") == 0) {
+    if (strcmp(payload, "start") == 0) out.type = CMD_DRAIN_START;
+    else if (strcmp(payload, "stop") == 0) out.type = CMD_DRAIN_STOP;
+    else return MQTT_CMD_INVALID;
+    return MQTT_CMD_OK;
+  }
+  if (strcmp(name, "interval") == 0) {
+    char* end;
+    long v = strtol(payload, &end, 10);
+    out.type = CMD_SET_INTERVAL;
+    if (end == payload || *end == '\0' || end[1] != '\0') return MQTT_CMD_INVALID;
+    if (*end == 'h' && v >= 1 && v <= 720) out.unit = 1;
+    else if (*end == 'd' && v >= 1 && v <= 30) out.unit = 0;
+    else return MQTT_CMD_INVALID;
+    out.value = (uint32_t)v;
+    return MQTT_CMD_OK;
+  }
+  return MQTT_CMD_UNKNOWN;
+}
@@ -0,0 +1,76 @@
+#pragma once
+/*
+  Rendu de l'écran OLED 128x64, séparé des lectures d'état et de l'envoi I2C
+  - OledView : ce que l'écran montre, rempli par drawOLED() (main.cpp)
+  - renderOled<Gfx>() : dessin seul, sur tout objet à l'interface Adafruit_GFX
+    (clearDisplay, setTextSize, setCursor, print, width, height) et au
+    tampon SSD1306 (getBuffer) -> l'afficheur sur la carte, un tampon
+    mémoire dans host/bench
+  - Icônes compressées (icons_rle.h) décodées directement dans ce tampon
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "icons_rle.h"
+#include "control.h"
+
+#define OLED_WHITE 1   // = SSD1306_WHITE
+
+struct OledView {
+  bool wifiConnected;
+  int  rssi;              // dBm
+  const char* banner;     // petit texte en haut à gauche (OTA, maintenance, alerte) ou nullptr
+  uint8_t mode;           // FountainMode
+  bool ecoInClosedPhase;
+  float levelPct;
+};
+
+// Retourne l'icône à afficher (20x15px)
+inline const RleIcon& wifiIconForRSSI(int rssiDbm, bool connected) {
+  if (!connected) return wifi_none;
+  // Seuils typiques : ajustez si besoin
+  if (rssiDbm >= -55) return wifi_4;
+  if (rssiDbm >= -63) return wifi_3;
+  if (rssiDbm >= -70) return wifi_2;
+  if (rssiDbm >= -78) return wifi_1;
+  return wifi_0;
+}
+
+template<class Gfx>
+void renderOled(Gfx& d, const OledView& v) {
+  const int w = d.width(), h = d.height();
+  uint8_t* fb = d.getBuffer();
+  d.clearDisplay();
+
+  // --- Bandeau Wi-Fi : icône 20x15 en haut à droite (contrainte "≤15 px") ---
+  rleBlit(fb, w, h, w - 20, 0, wifiIconForRSSI(v.rssi, v.wifiConnected));
+
+  // --- Maintenance / OTA / alerte : en petit en haut à gauche ---
+  if (v.banner != nullptr) {
+    d.setTextSize(1);
+    d.setCursor(0, 0);
+    d.print(v.banner);
+  }
+
+  // --- "eco" en petit, centré, si mode ECO_HYBRID ---
+  if (v.mode == MODE_ECO_HYBRID) {
+    d.setTextSize(1);  // Petit texte (8px hauteur)
+    d.setCursor((w - 18) / 2, 0);
+    d.print("eco");
+  }
+
+  // --- Image 52x52 en bas à gauche selon le mode (éco : selon la phase) ---
+  const RleIcon* modeIcon = &robinet;  // Cycle ouvert, phase de remplissage
+  if (v.mode == MODE_CLOSED_CYCLE || (v.mode == MODE_ECO_HYBRID && v.ecoInClosedPhase)) modeIcon = &bac;
+  rleBlit(fb, w, h, 0, h - modeIcon->h, *modeIcon);
+
+  // --- Niveau d'eau en bas à droite, à droite de l'image du mode ---
+  d.setTextSize(2);
+  char levelText[8];
+  snprintf(levelText, sizeof(levelText), "%d%%", (int)round(v.levelPct));
+  int textWidth = strlen(levelText) * 12;  // 6 px par caractère en taille 1
+  d.setCursor(w - textWidth - 20, h - 20);
+  d.print(levelText);
+}
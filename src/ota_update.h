@@ -0,0 +1,259 @@
+#pragma once
+/*
+  Mise à jour OTA en flux : POST /update (multipart) -> partition app inactive
+  - Handler (tâche async_tcp) : copie les morceaux reçus dans un StreamBuffer,
+    sans jamais attendre ; contre-pression côté TCP : tant que le tampon n'a
+    pas la place d'une fenêtre de réception, les segments ne sont pas
+    acquittés (AsyncClient::ackLater) -> la fenêtre se ferme, le client
+    ralentit, les autres connexions continuent d'être servies
+  - Tâche OTA (cœur 0, priorité basse) : décompression gzip éventuelle (tinfl
+    de la ROM, dictionnaire 32 Ko) puis Update.write() au fil de l'eau
+    -> ni l'image ni l'archive ne sont gardées en RAM, la boucle de contrôle
+       (cœur 1) continue pendant le transfert
+  - Avant bascule : CRC32 + longueur du gzip, MD5 de l'image (obligatoire),
+    vérification d'image de l'IDF (Update.end)
+*/
+#include <Arduino.h>
+#include <Update.h>
+#include <freertos/stream_buffer.h>
+#include <atomic>
+#include "esp32/rom/miniz.h"
+#include "esp32/rom/crc.h"
+#include "byte_codec.h"
+
+#define OTA_STREAM_BYTES     16384  // tampon handler -> tâche
+#define OTA_CHUNK_BYTES      1024   // lecture par la tâche
+// Place à garder libre pour acquitter : fenêtre TCP de lwIP (5744) + tampon
+// multipart du serveur (1460), déjà acquittés quand ils arrivent dans feed()
+#define OTA_RX_RESERVE       7424
+#define OTA_IDLE_TIMEOUT_MS  15000  // plus de données du client
+#define OTA_GZIP_HEAD_MAX    256    // en-tête gzip (nom de fichier compris)
+
+enum OtaState : uint8_t { OTA_IDLE, OTA_RECEIVING, OTA_VERIFYING, OTA_DONE, OTA_ERROR };
+
+// Longueur de l'en-tête gzip (RFC 1952) : 0 = incomplet, -1 = invalide
+inline int gzipHeaderLength(const uint8_t* p, size_t n) {
+  if (n < 10) return 0;
+  if (p[0] != 0x1F || p[1] != 0x8B || p[2] != 8) return -1;
+  uint8_t flg = p[3];
+  size_t i = 10;
+  if (flg & 0x04) {                       // FEXTRA
+    if (n < i + 2) return 0;
+    i += 2 + (p[i] | (p[i + 1] << 8));
+  }
+  for (uint8_t f = 0x08; f <= 0x10; f <<= 1) {  // FNAME, FCOMMENT
+    if (!(flg & f)) continue;
+    while (i < n && p[i]) i++;
+    if (i >= n) return 0;
+    i++;
+  }
+  if (flg & 0x02) i += 2;                 // FHCRC
+  return i <= n ? (int)i : 0;
+}
+
+class OtaUpdater {
+public:
+  bool begin() {
+    return xTaskCreatePinnedToCore(taskEntry, "ota", 6144, this, 1, &_task, 0) == pdPASS;
+  }
+
+  // ---- Côté handler (tâche async_tcp) ----
+  // owner : la requête qui pilote la session (une seule à la fois)
+  bool start(const void* owner, const char* md5) {
+    // Occupation prise atomiquement : une seule session, même entre deux requêtes
+    uint8_t s = _state.load();
+    do {
+      if (s == OTA_RECEIVING || s == OTA_VERIFYING) return false;
+    } while (!_state.compare_exchange_weak(s, OTA_RECEIVING));
+    _owner = owner;
+    if (_sb == nullptr) _sb = xStreamBufferCreate(OTA_STREAM_BYTES, 1);
+    if (_sb == nullptr) { fail("mémoire insuffisante"); return false; }
+    xStreamBufferReset(_sb);
+    strlcpy(_md5, md5, sizeof(_md5));
+    _error = "";
+    _received = _written = 0;
+    _gzip = false;
+    _inputDone = _abortReq = false;
+    _lastDataMs = millis();
+    xTaskNotifyGive(_task);
+    return true;
+  }
+
+  // Sans attente : la réserve (OTA_RX_RESERVE) garantit la place de tout ce
+  // qui a été acquitté ; un débordement est une erreur, pas une attente
+  bool feed(const void* owner, const uint8_t* data, size_t len) {
+    if (owner != _owner || _state != OTA_RECEIVING) return false;
+    size_t n = xStreamBufferSend(_sb, data, len, 0);
+    _received += n;
+    if (n < len) {
+      _abortWhy = "tampon OTA plein";
+      _abortReq = true;
+      return false;
+    }
+    _lastDataMs = millis();
+    return true;
+  }
+
+  // Acquitter les segments reçus ? (sinon ackLater : fenêtre TCP refermée)
+  bool hasRoom() const {
+    return _sb == nullptr || _state != OTA_RECEIVING || xStreamBufferSpacesAvailable(_sb) >= OTA_RX_RESERVE;
+  }
+
+  void finish(const void* owner) {
+    if (owner == _owner) _inputDone = true;
+  }
+
+  // Déconnexion du client : sans effet si le transfert était complet
+  void abort(const void* owner) {
+    if (owner == _owner && _state == OTA_RECEIVING && !_inputDone) {
+      _abortWhy = "transfert interrompu";
+      _abortReq = true;
+    }
+  }
+
+  // ---- État ----
+  bool busy() const { return _state == OTA_RECEIVING || _state == OTA_VERIFYING; }
+  OtaState state() const { return (OtaState)_state.load(); }
+  const void* owner() const { return _owner; }
+  const char* error() const { return _error; }
+  uint32_t doneMs() const { return _doneMs; }
+  uint32_t received() const { return _received; }
+
+  // "ota":{...} pour /metrics et la réponse de /update
+  size_t printStats(char* buf, size_t size) const {
+    static const char* names[] = { "idle", "receiving", "verifying", "done", "error" };
+    int w = snprintf(buf, size,
+      "\"ota\":{\"state\":\"%s\",\"received\":%u,\"written\":%u,\"gzip\":%s,\"error\":\"%s\"}",
+      names[_state], (unsigned)_received, (unsigned)_written, _gzip ? "true" : "false", _error);
+    if (w < 0) return 0;
+    return (size_t)w < size ? (size_t)w : size - 1;
+  }
+
+private:
+  static void taskEntry(void* self) {
+    for (;;) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      ((OtaUpdater*)self)->session();
+    }
+  }
+
+  void session() {
+    _hdrLen = 0;
+    _raw = false;
+    _inflating = _inflateDone = false;
+    _trailerLen = 0;
+    _crc = 0;
+    _dictOfs = 0;
+    if (!Update.begin(UPDATE_SIZE_UNKNOWN)) { fail(Update.errorString()); return; }
+    Update.setMD5(_md5);
+
+    uint8_t buf[OTA_CHUNK_BYTES];
+    for (;;) {
+      size_t n = xStreamBufferReceive(_sb, buf, sizeof(buf), pdMS_TO_TICKS(100));
+      if (_abortReq) { fail(_abortWhy); break; }
+      if (n > 0) {
+        if (!consume(buf, n)) break;
+        continue;
+      }
+      if (_inputDone && xStreamBufferIsEmpty(_sb)) { complete(); break; }
+      if (millis() - _lastDataMs > OTA_IDLE_TIMEOUT_MS) { fail("délai dépassé"); break; }
+    }
+    if (_state != OTA_DONE) Update.abort();
+    free(_inflator); _inflator = nullptr;
+    free(_dict); _dict = nullptr;
+  }
+
+  bool consume(const uint8_t* p, size_t n) {
+    if (_inflating) return inflate(p, n);
+    if (_raw) return writeOut(p, n);
+    // Premier octet : image brute (0xE9) ou gzip (0x1F)
+    if (_hdrLen == 0 && p[0] != 0x1F) {
+      _raw = true;
+      return writeOut(p, n);
+    }
+    _gzip = true;
+    // En-tête gzip accumulé jusqu'à être complet
+    size_t k = OTA_GZIP_HEAD_MAX - _hdrLen < n ? OTA_GZIP_HEAD_MAX - _hdrLen : n;
+    memcpy(_hdr + _hdrLen, p, k);
+    _hdrLen += k;
+    int h = gzipHeaderLength(_hdr, _hdrLen);
+    if (h < 0) return fail("gzip invalide");
+    if (h == 0) return _hdrLen < OTA_GZIP_HEAD_MAX || fail("en-tête gzip trop long");
+    _inflator = (tinfl_decompressor*)malloc(sizeof(tinfl_decompressor));
+    _dict = (uint8_t*)malloc(TINFL_LZ_DICT_SIZE);
+    if (!_inflator || !_dict) return fail("mémoire insuffisante");
+    tinfl_init(_inflator);
+    _inflating = true;
+    // Octets du tampon d'en-tête déjà compressés, puis le reste du morceau
+    return inflate(_hdr + h, _hdrLen - h) && inflate(p + k, n - k);
+  }
+
+  bool inflate(const uint8_t* p, size_t n) {
+    while (n > 0 && !_inflateDone) {
+      size_t inBytes = n, outBytes = TINFL_LZ_DICT_SIZE - _dictOfs;
+      tinfl_status st = tinfl_decompress(_inflator, p, &inBytes, _dict, _dict + _dictOfs, &outBytes,
+                                         TINFL_FLAG_HAS_MORE_INPUT);
+      if (inBytes == 0 && outBytes == 0 && st != TINFL_STATUS_DONE) return fail("gzip corrompu");
+      p += inBytes;
+      n -= inBytes;
+      if (outBytes) {
+        _crc = crc32_le(_crc, _dict + _dictOfs, outBytes);
+        if (!writeOut(_dict + _dictOfs, outBytes)) return false;
+        _dictOfs = (_dictOfs + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+      }
+      if (st == TINFL_STATUS_DONE) _inflateDone = true;
+      else if (st < TINFL_STATUS_DONE) return fail("gzip corrompu");
+    }
+    // Après le flux deflate : CRC32 + taille (8 octets)
+    while (_inflateDone && n > 0 && _trailerLen < 8) { _trailer[_trailerLen++] = *p++; n--; }
+    return true;
+  }
+
+  bool writeOut(const uint8_t* p, size_t n) {
+    if (Update.write((uint8_t*)p, n) != n) return fail(Update.errorString());
+    _written += n;
+    return true;
+  }
+
+  void complete() {
+    _state = OTA_VERIFYING;
+    if (_gzip) {
+      uint32_t crc = leGet(_trailer);
+      uint32_t isize = leGet(_trailer + 4);
+      if (!_inflateDone || _trailerLen < 8) { fail("gzip tronqué"); return; }
+      if (crc != _crc || isize != _written) { fail("CRC gzip incorrect"); return; }
+    }
+    // MD5 + en-tête/empreinte de l'image, puis partition de démarrage
+    if (!Update.end(true)) { fail(Update.errorString()); return; }
+    _doneMs = millis();
+    _state = OTA_DONE;
+  }
+
+  bool fail(const char* why) {
+    _error = why;
+    _state = OTA_ERROR;
+    return false;
+  }
+
+  TaskHandle_t _task = nullptr;
+  StreamBufferHandle_t _sb = nullptr;
+  std::atomic<uint8_t> _state{OTA_IDLE};   // OtaState
+  const void* volatile _owner = nullptr;
+  const char* volatile _error = "";
+  const char* volatile _abortWhy = "";
+  char _md5[33] = "";
+  volatile bool _inputDone = false, _abortReq = false;
+  volatile uint32_t _received = 0, _written = 0, _lastDataMs = 0, _doneMs = 0;
+  bool _gzip = false;
+
+  // Décompression (tâche OTA uniquement)
+  uint8_t _hdr[OTA_GZIP_HEAD_MAX];
+  size_t _hdrLen = 0;
+  bool _raw = false, _inflating = false, _inflateDone = false;
+  tinfl_decompressor* _inflator = nullptr;
+  uint8_t* _dict = nullptr;
+  size_t _dictOfs = 0;
+  uint32_t _crc = 0;
+  uint8_t _trailer[8];
+  uint8_t _trailerLen = 0;
+};
@@ -0,0 +1,288 @@
+#pragma once
+/*
+  Chronologie d'exécution (profilage) : anneaux d'événements par cœur, exportés par /trace
+  - Début / fin d'étape (PERF_SCOPE), instantané (PERF_INSTANT), intervalle
+    asynchrone (impulsion de vanne, PERF_ASYNC_BEGIN/END : ouvert et fermé
+    dans deux tours de boucle différents)
+  - Enregistrement de 8 octets : compteur de cycles du cœur, identifiant,
+    phase, argument. Un anneau par cœur, sans verrou : réservation de la case
+    par fetch_add, pas de section critique ni d'appel système (~15 cycles
+    actif, un test et un saut inactif ; PERF_TRACE 0 supprime tout)
+  - Cycles -> temps : sync() écrit (cycles, µs esp_timer, MHz) une fois par
+    seconde sur chaque cœur (boucle sur le cœur 1, esp_timer sur le cœur 0) ;
+    le compteur de cycles (32 bits, 18 s à 240 MHz) ne boucle jamais entre
+    deux repères, et les deux cœurs se recalent sur la même horloge
+  - /trace fige les anneaux pendant la copie (perte de quelques dizaines de
+    ms d'événements) ; host/trace2perfetto.py -> JSON Chrome / Perfetto
+  Noms : identifiants fixes (PerfEvent) + noms enregistrés au démarrage
+  (routes HTTP), groupés par piste (boucle, réseau) dans la conversion.
+*/
+#include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
+#include "hal/cpu_hal.h"
+
+#ifndef PERF_TRACE
+#define PERF_TRACE 1
+#endif
+
+#define PERF_MAX_NAMES 48
+#define PERF_CORES     2
+#define PERF_MAGIC     "PTR1"
+
+enum PerfPhase : uint8_t { PERF_PH_BEGIN = 0, PERF_PH_END, PERF_PH_INSTANT, PERF_PH_ASYNC_BEGIN, PERF_PH_ASYNC_END };
+
+// Pistes de la conversion (sans effet sur la carte)
+enum PerfGroup : char { PERF_GROUP_LOOP = 'L', PERF_GROUP_NET = 'N', PERF_GROUP_ACT = 'A', PERF_GROUP_SYNC = 'S' };
+
+enum PerfEvent : uint8_t {
+  PERF_SYNC = 0,     // arg = MHz ; l'enregistrement suivant (PERF_SYNC_US) porte les µs
+  PERF_SYNC_US,
+  PERF_LOGIC,        // runLogic()
+  PERF_RANGING,      // sampleUltrasonic()
+  PERF_AHT,          // readAHT20()
+  PERF_COMMANDS,     // processCommands()
+  PERF_TICK_LATE,    // instantané : tick de logique en retard, arg = ms de retard
+  PERF_VALVE_PULSE,  // asynchrone, arg = broche IN1 de la vanne
+  PERF_OLED_DRAW,
+  PERF_OLED_SEND,    // trame I2C (ou écartée : inchangée)
+  PERF_SSE_PUBLISH,
+  PERF_SSE_SEND,     // arg = client
+  PERF_HISTORY,      // enregistrement en flash
+  PERF_UPLOAD,       // envoi Sheets, arg = code HTTP
+  PERF_FIXED_COUNT
+};
+
+struct PerfRecord {
+  uint32_t cycles;
+  uint8_t id;
+  uint8_t phase;
+  uint16_t arg;
+};
+
+class PerfTrace {
+public:
+  PerfTrace() {
+    static const char* const names[PERF_FIXED_COUNT] = {
+      "sync", "syncUs", "runLogic", "ranging", "aht20", "commands", "tickLate",
+      "valvePulse", "oledDraw", "oledSend", "ssePublish", "sseSend", "history", "upload"
+    };
+    static const char groups[PERF_FIXED_COUNT] = {
+      PERF_GROUP_SYNC, PERF_GROUP_SYNC, PERF_GROUP_LOOP, PERF_GROUP_LOOP, PERF_GROUP_LOOP,
+      PERF_GROUP_LOOP, PERF_GROUP_LOOP, PERF_GROUP_ACT, PERF_GROUP_LOOP, PERF_GROUP_LOOP, PERF_GROUP_LOOP,
+      PERF_GROUP_NET, PERF_GROUP_LOOP, PERF_GROUP_LOOP
+    };
+    for (uint8_t i = 0; i < PERF_FIXED_COUNT; i++) { _names[i] = names[i]; _groups[i] = groups[i]; }
+    _nameCount = PERF_FIXED_COUNT;
+  }
+
+  // Anneaux (puissances de 2) ; repère de temps du cœur 0 par esp_timer
+  bool begin(uint16_t recordsCore0, uint16_t recordsCore1) {
+    const uint16_t n[PERF_CORES] = { recordsCore0, recordsCore1 };
+    for (uint8_t c = 0; c < PERF_CORES; c++) {
+      if (n[c] == 0 || (n[c] & (n[c] - 1))) return false;
+      _rings[c].buf = (PerfRecord*)calloc(n[c], sizeof(PerfRecord));
+      if (_rings[c].buf == nullptr) return false;
+      _rings[c].mask = n[c] - 1;
+    }
+    esp_timer_create_args_t args = {};
+    args.callback = [](void* self) { ((PerfTrace*)self)->sync(); };
+    args.arg = this;
+    args.name = "perfSync";
+    if (esp_timer_create(&args, &_syncTimer) != ESP_OK) return false;
+    esp_timer_start_periodic(_syncTimer, 1000000);
+    _on = true;
+    return true;
+  }
+
+  // Nom supplémentaire (route HTTP...) : au démarrage, chaîne gardée par pointeur
+  uint8_t registerName(const char* name, char group) {
+    if (_nameCount >= PERF_MAX_NAMES) return PERF_SYNC;   // ignoré à la conversion
+    _names[_nameCount] = name;
+    _groups[_nameCount] = group;
+    return _nameCount++;
+  }
+
+  void enable(bool on) {
+    on = on && _rings[0].buf != nullptr;
+    if (_readers > 0) _resumeOn = on;   // export en cours : appliqué à la fin
+    else _on = on;
+  }
+  bool enabled() const { return _on; }
+
+  inline void emit(uint8_t id, uint8_t phase, uint16_t arg) {
+    if (!_on) return;
+    Ring& r = _rings[xPortGetCoreID()];
+    PerfRecord& rec = r.buf[r.head.fetch_add(1, std::memory_order_relaxed) & r.mask];
+    rec.cycles = cpu_hal_get_cycle_count();
+    rec.id = id;
+    rec.phase = phase;
+    rec.arg = arg;
+  }
+
+  // Repère cycles <-> µs du cœur appelant (deux cases consécutives)
+  void sync() {
+    if (!_on) return;
+    Ring& r = _rings[xPortGetCoreID()];
+    uint32_t i = r.head.fetch_add(2, std::memory_order_relaxed);
+    PerfRecord& a = r.buf[i & r.mask];
+    PerfRecord& b = r.buf[(i + 1) & r.mask];
+    b.cycles = (uint32_t)esp_timer_get_time();
+    a.cycles = cpu_hal_get_cycle_count();
+    a.id = PERF_SYNC;
+    a.phase = PERF_PH_INSTANT;
+    a.arg = (uint16_t)getCpuFrequencyMhz();
+    b.id = PERF_SYNC_US;
+    b.phase = PERF_PH_INSTANT;
+    b.arg = 0;
+  }
+
+  // ---- Export binaire (/trace), lu par morceaux depuis la tâche async_tcp ----
+  // En-tête : "PTR1", version, cœurs, taille d'enregistrement, nombre de noms,
+  // puis les noms (groupe + nom, terminés par 0), puis par cœur : nombre
+  // d'enregistrements (u32) et les enregistrements, du plus ancien au plus récent
+  class Reader {
+  public:
+    explicit Reader(PerfTrace& t) : _t(t) {
+      if (t._readers++ == 0) {   // anneaux figés pendant la copie
+        t._resumeOn = t._on;
+        t._on = false;
+      }
+      for (uint8_t c = 0; c < PERF_CORES; c++) {
+        const Ring& r = t._rings[c];
+        uint32_t head = r.head.load();
+        uint32_t size = r.buf ? r.mask + 1 : 0;
+        _first[c] = head > size ? head - size : 0;
+        _count[c] = head - _first[c];
+      }
+      _len = buildHeader();
+    }
+    ~Reader() {
+      if (--_t._readers == 0) _t._on = _t._resumeOn;
+    }
+
+    // Prochain morceau (0 = fin)
+    size_t read(uint8_t* out, size_t maxLen) {
+      size_t n = 0;
+      while (n < maxLen) {
+        if (_part == 0) {                               // en-tête
+          size_t k = min(maxLen - n, _len - _pos);
+          memcpy(out + n, _head + _pos, k);
+          n += k;
+          _pos += k;
+          if (_pos == _len) { _part = 1; _pos = 0; }
+          continue;
+        }
+        uint8_t c = (_part - 1) / 2;
+        if (c >= PERF_CORES) break;
+        if ((_part - 1) % 2 == 0) {                     // nombre d'enregistrements du cœur
+          uint8_t cnt[4];
+          memcpy(cnt, &_count[c], 4);
+          size_t k = min(maxLen - n, (size_t)4 - _pos);
+          memcpy(out + n, cnt + _pos, k);
+          n += k;
+          _pos += k;
+          if (_pos == 4) { _part++; _pos = 0; }
+          continue;
+        }
+        const Ring& r = _t._rings[c];                   // enregistrements
+        size_t total = (size_t)_count[c] * sizeof(PerfRecord);
+        while (n < maxLen && _pos < total) {
+          uint32_t idx = _first[c] + _pos / sizeof(PerfRecord);
+          size_t off = _pos % sizeof(PerfRecord);
+          size_t k = min(maxLen - n, sizeof(PerfRecord) - off);
+          memcpy(out + n, (const uint8_t*)&r.buf[idx & r.mask] + off, k);
+          n += k;
+          _pos += k;
+        }
+        if (_pos == total) { _part++; _pos = 0; }
+      }
+      return n;
+    }
+
+  private:
+    size_t buildHeader() {
+      size_t n = 0;
+      memcpy(_head, PERF_MAGIC, 4);
+      n = 4;
+      _head[n++] = 1;                       // version
+      _head[n++] = PERF_CORES;
+      _head[n++] = sizeof(PerfRecord);
+      _head[n++] = _t._nameCount;
+      for (uint8_t i = 0; i < _t._nameCount; i++) {
+        if (n + 2 > sizeof(_head)) break;
+        size_t l = strlen(_t._names[i]);
+        if (n + l + 2 > sizeof(_head)) l = sizeof(_head) - n - 2;
+        _head[n++] = _t._groups[i];
+        memcpy(_head + n, _t._names[i], l);
+        n += l;
+        _head[n++] = 0;
+      }
+      return n;
+    }
+
+    PerfTrace& _t;
+    uint32_t _first[PERF_CORES], _count[PERF_CORES];
+    uint8_t _head[8 + PERF_MAX_NAMES * 24];
+    size_t _len = 0, _pos = 0;
+    uint8_t _part = 0;
+  };
+
+  // "perf":{...} pour /metrics
+  size_t printStats(char* buf, size_t size) const {
+    int w = snprintf(buf, size,
+      "\"perf\":{\"enabled\":%s,\"names\":%u,\"core0\":{\"records\":%u,\"capacity\":%u},"
+      "\"core1\":{\"records\":%u,\"capacity\":%u}}",
+      _on ? "true" : "false", (unsigned)_nameCount,
+      (unsigned)_rings[0].head.load(), _rings[0].buf ? (unsigned)_rings[0].mask + 1 : 0u,
+      (unsigned)_rings[1].head.load(), _rings[1].buf ? (unsigned)_rings[1].mask + 1 : 0u);
+    if (w < 0) return 0;
+    return (size_t)w < size ? (size_t)w : size - 1;
+  }
+
+  // Étape délimitée par la portée
+  class Scope {
+  public:
+    Scope(PerfTrace& t, uint8_t id, uint16_t arg = 0) : _t(t), _id(id), _arg(arg) { t.emit(id, PERF_PH_BEGIN, arg); }
+    ~Scope() { _t.emit(_id, PERF_PH_END, _arg); }
+    void setArg(uint16_t arg) { _arg = arg; }   // résultat connu à la fin (code HTTP...)
+  private:
+    PerfTrace& _t;
+    uint8_t _id;
+    uint16_t _arg;
+  };
+
+private:
+  struct Ring {
+    PerfRecord* buf = nullptr;
+    uint32_t mask = 0;
+    std::atomic<uint32_t> head{0};   // enregistrements écrits depuis le démarrage
+  };
+
+  Ring _rings[PERF_CORES];
+  volatile bool _on = false;
+  bool _resumeOn = false;          // état rétabli après le dernier export
+  std::atomic<int> _readers{0};
+  const char* _names[PERF_MAX_NAMES];
+  char _groups[PERF_MAX_NAMES];
+  uint8_t _nameCount = 0;
+  esp_timer_handle_t _syncTimer = nullptr;
+};
+
+extern PerfTrace perf;
+
+#if PERF_TRACE
+#define PERF_CAT2(a, b) a##b
+#define PERF_CAT(a, b) PERF_CAT2(a, b)
+#define PERF_SCOPE(id)                 PerfTrace::Scope PERF_CAT(_perfScope, __LINE__)(perf, (id))
+#define PERF_SCOPE_ARG(var, id, arg)   PerfTrace::Scope var(perf, (id), (arg))
+#define PERF_INSTANT(id, arg)          perf.emit((id), PERF_PH_INSTANT, (arg))
+#define PERF_ASYNC_BEGIN(id, arg)      perf.emit((id), PERF_PH_ASYNC_BEGIN, (arg))
+#define PERF_ASYNC_END(id, arg)        perf.emit((id), PERF_PH_ASYNC_END, (arg))
+#else
+#define PERF_SCOPE(id)                 do {} while (0)
+#define PERF_SCOPE_ARG(var, id, arg)   [[maybe_unused]] struct { void setArg(uint16_t) {} } var
+#define PERF_INSTANT(id, arg)          do {} while (0)
+#define PERF_ASYNC_BEGIN(id, arg)      do {} while (0)
+#define PERF_ASYNC_END(id, arg)        do {} while (0)
+#endif
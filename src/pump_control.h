@@ -0,0 +1,132 @@
+#pragma once
+/*
+  Vitesse de la pompe (sortie PWM) : régulateur PI sur le niveau ou le débit rejeté
+  - PUMP_HOLD_LEVEL : la pompe accélère quand le niveau dépasse la consigne (%) ;
+    en cycle ouvert le bassin se stabilise à la consigne pendant le
+    remplissage au lieu d'osciller entre les seuils ON / OFF de controlStep()
+  - PUMP_HOLD_FLOW : consigne de débit rejeté (L/min), estimé par le bilan du
+    bassin : arrivée d'eau (débit appris) moins la pente lissée du niveau
+  - PUMP_HOLD_NONE : plein débit (comportement tout-ou-rien d'origine)
+  - Sortie bornée à [minDuty, maxDuty] : l'arrêt reste la décision de
+    controlStep(), le régulateur ne coupe jamais la pompe lui-même
+  - Intégrale gelée quand la sortie sature (pas d'emballement)
+  - La rampe de démarrage est celle de la sortie (PwmOutput, actuators.h)
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+
+enum PumpHold : uint8_t {
+  PUMP_HOLD_NONE = 0,
+  PUMP_HOLD_LEVEL,
+  PUMP_HOLD_FLOW
+};
+
+inline const char* pumpHoldName(uint8_t h) {
+  static const char* const names[] = { "none", "level", "flow" };
+  return h <= PUMP_HOLD_FLOW ? names[h] : "?";
+}
+
+struct PumpSpeedParams {
+  float minDuty;          // fraction : en dessous, la pompe cale
+  float maxDuty;
+  float kpLevel, kiLevel; // rapport cyclique par % d'écart (et par % x s)
+  float kpFlow, kiFlow;   // par L/min d'écart (et par L/min x s)
+  float slopeTauS;        // lissage de la pente du niveau (estimation du débit)
+};
+
+class PumpSpeedController {
+public:
+  PumpSpeedController(const PumpSpeedParams& p, PumpHold hold, float setpoint)
+    : _p(p), _hold(hold), _setpoint(setpoint) {}
+
+  // Depuis un handler HTTP : appliqué par update() dans la boucle
+  void requestHold(PumpHold hold, float setpoint) {
+    _reqHold = hold;
+    _reqSetpoint = setpoint;
+    _holdRequested = true;
+  }
+
+  // Un tick de logique. levelPct pour la consigne de niveau, levelL et
+  // inflowLpm (arrivée d'eau en cours) pour l'estimation du débit, tenue à
+  // jour même hors régulation. Retourne le rapport cyclique (0..1) :
+  // maxDuty hors régulation (vidange, pompe arrêtée, PUMP_HOLD_NONE).
+  float update(bool regulate, float levelPct, float levelL, float inflowLpm, float dtS) {
+    if (_holdRequested.exchange(false)) {
+      _hold = (PumpHold)_reqHold;
+      _setpoint = _reqSetpoint;
+      _integral = 0;
+    }
+    estimateFlow(levelL, inflowLpm, dtS);
+
+    _regulating = regulate && _hold != PUMP_HOLD_NONE;
+    if (!_regulating) {
+      _integral = 0;
+      _duty = _p.maxDuty;
+      return _duty;
+    }
+    // Écart positif = accélérer : niveau au-dessus de la consigne, débit en dessous
+    float err, kp, ki;
+    if (_hold == PUMP_HOLD_LEVEL) {
+      err = levelPct - _setpoint;
+      kp = _p.kpLevel;
+      ki = _p.kiLevel;
+    } else {
+      err = _setpoint - _flowLpm;
+      kp = _p.kpFlow;
+      ki = _p.kiFlow;
+    }
+    float out = _p.minDuty + kp * err + _integral;
+    bool saturated = (out >= _p.maxDuty && err > 0) || (out <= _p.minDuty && err < 0);
+    if (!saturated) {
+      _integral += ki * err * dtS;
+      out = _p.minDuty + kp * err + _integral;
+    }
+    _duty = out < _p.minDuty ? _p.minDuty : out > _p.maxDuty ? _p.maxDuty : out;
+    return _duty;
+  }
+
+  PumpHold hold() const { return _hold; }
+  float setpoint() const { return _setpoint; }
+  float duty() const { return _duty; }
+  float flowLpm() const { return _flowLpm; }
+  bool regulating() const { return _regulating; }
+
+  // /pump
+  size_t printJson(char* buf, size_t size) const {
+    int n = snprintf(buf, size,
+      "{\"hold\":\"%s\",\"setpoint\":%.2f,\"unit\":\"%s\",\"regulating\":%s,\"duty\":%.3f,"
+      "\"integral\":%.3f,\"flowLpm\":%.3f,\"minDuty\":%.2f,\"maxDuty\":%.2f}",
+      pumpHoldName(_hold), _setpoint, _hold == PUMP_HOLD_FLOW ? "L/min" : "%",
+      _regulating ? "true" : "false", _duty, _integral, _flowLpm, _p.minDuty, _p.maxDuty);
+    if (n < 0) return 0;
+    return (size_t)n < size ? (size_t)n : size - 1;
+  }
+
+private:
+  // Niveau lissé, puis pente lissée : débit rejeté = arrivée - variation du volume
+  void estimateFlow(float levelL, float inflowLpm, float dtS) {
+    if (dtS <= 0) return;
+    if (!_primed) {
+      _levelEma = levelL;
+      _primed = true;
+    }
+    float a = dtS / (_p.slopeTauS + dtS);
+    float prev = _levelEma;
+    _levelEma += a * (levelL - _levelEma);
+    _slopeLpm += a * ((_levelEma - prev) / dtS * 60.0f - _slopeLpm);
+    float flow = inflowLpm - _slopeLpm;
+    _flowLpm = flow > 0 ? flow : 0;
+  }
+
+  PumpSpeedParams _p;
+  PumpHold _hold;
+  float _setpoint;
+  float _integral = 0, _duty = 0;
+  float _levelEma = 0, _slopeLpm = 0, _flowLpm = 0;
+  bool _primed = false, _regulating = false;
+  uint8_t _reqHold = PUMP_HOLD_NONE;
+  float _reqSetpoint = 0;
+  std::atomic<bool> _holdRequested{false};
+};
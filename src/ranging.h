@@ -0,0 +1,75 @@
+#pragma once
+/*
+  Télémétrie ultrason HC-SR04 : durées d'écho brutes -> distance filtrée
+  - Compensation température de la vitesse du son
+  - Rejet hors plage physique, moyenne (< 3 échos) ou médiane (3+)
+  Sans dépendance Arduino : host/replay refait exactement le même calcul.
+*/
+#include <stdint.h>
+#include <string.h>
+
+#define ECHO_MAX_SAMPLES 5   // échos par mesure
+#define ECHO_TIMEOUT_US  30000UL
+
+// Durée aller-retour (µs) -> distance (cm)
+inline float echoToCm(uint32_t durationUs, float tempC) {
+  float speedSound = 331.3f + (0.606f * tempC);
+  return durationUs * speedSound / 20000.0f;
+}
+
+// Inverse, pour le simulateur (échos synthétiques)
+inline uint32_t cmToEchoUs(float cm, float tempC) {
+  float speedSound = 331.3f + (0.606f * tempC);
+  return (uint32_t)(cm * 20000.0f / speedSound + 0.5f);
+}
+
+// Tri par insertion simple pour tableau de 5 éléments
+inline void sortFloat(float arr[], int n) {
+  for (int i = 1; i < n; i++) {
+    float key = arr[i];
+    int j = i - 1;
+    while (j >= 0 && arr[j] > key) {
+      arr[j + 1] = arr[j];
+      j--;
+    }
+    arr[j + 1] = key;
+  }
+}
+
+inline float medianFilter(const float samples[], int count) {
+  float sorted[ECHO_MAX_SAMPLES];
+  memcpy(sorted, samples, count * sizeof(float));
+  sortFloat(sorted, count);
+  return sorted[count / 2];  // Valeur médiane
+}
+
+// Combine les échos d'une mesure (0 = timeout). Aucun écho valide : fallbackCm
+// (dernière mesure connue). validOut reçoit le nombre d'échos retenus.
+inline float rangeFromEchoes(const uint32_t* echoUs, int n, float tempC,
+                             float offsetCm, float heightCm, float fallbackCm,
+                             int* validOut = nullptr) {
+  float samples[ECHO_MAX_SAMPLES];
+  int validCount = 0;
+  // Rejet valeurs aberrantes (hors plage physique +10%)
+  const float minValid = offsetCm * 0.9f;
+  const float maxValid = (offsetCm + heightCm) * 1.1f;
+
+  for (int i = 0; i < n && i < ECHO_MAX_SAMPLES; i++) {
+    if (echoUs[i] == 0) continue;
+    float cm = echoToCm(echoUs[i], tempC);
+    if (cm >= minValid && cm <= maxValid) samples[validCount++] = cm;
+  }
+  if (validOut) *validOut = validCount;
+
+  if (validCount == 0) return fallbackCm;
+
+  if (validCount < 3) {
+    // Peu de mesures → moyenne simple
+    float sum = 0;
+    for (int i = 0; i < validCount; i++) sum += samples[i];
+    return sum / validCount;
+  }
+
+  // 3+ mesures → filtre médian (élimine extrêmes)
+  return medianFilter(samples, validCount);
+}
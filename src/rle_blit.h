@@ -0,0 +1,71 @@
+#pragma once
+/*
+  Icônes compressées (icons_rle.h, générées par host/icons_pack.py) et leur
+  décodage direct dans le tampon de l'afficheur SSD1306
+  - Données au format de page SSD1306 : 1 octet = 8 pixels verticaux (bit 0
+    en haut), bandes de 8 lignes de haut en bas, colonnes de gauche à droite
+  - Codage par plages d'octets :
+      0nnnnnnn     n+1 octets littéraux suivent
+      10nnnnnn     n+1 octets nuls : simplement sautés
+      11nnnnnn v   n+2 fois l'octet v
+  - rleBlit() : chaque octet décodé est combiné (OU) à une page du tampon,
+    ou à deux si y n'est pas multiple de 8 ; rien n'est décompressé
+    ailleurs. Pixels allumés seulement, comme drawBitmap(..., WHITE)
+  - Tampon au format Adafruit_SSD1306::getBuffer(), sans rotation
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_byte
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#endif
+#endif
+
+struct RleIcon {
+  uint8_t w, h;          // pixels
+  uint16_t size;         // octets codés
+  const uint8_t* data;   // PROGMEM
+};
+
+// Dessine l'icône en (x, y) dans un tampon de fbW x fbH pixels ; découpée aux bords
+inline void rleBlit(uint8_t* fb, int fbW, int fbH, int x, int y, const RleIcon& icon) {
+  const int pages = fbH / 8;
+  int col = 0, row = y;   // position courante : colonne de l'icône, ligne du haut de la bande
+  auto advance = [&](int n) {
+    col += n;
+    while (col >= icon.w) {
+      col -= icon.w;
+      row += 8;
+    }
+  };
+  auto put = [&](uint8_t b) {
+    int px = x + col;
+    if (b && px >= 0 && px < fbW) {
+      int shift = row & 7;
+      int page = (row - shift) / 8;
+      if (page >= 0 && page < pages) fb[page * fbW + px] |= b << shift;
+      if (shift && page + 1 >= 0 && page + 1 < pages) fb[(page + 1) * fbW + px] |= b >> (8 - shift);
+    }
+    advance(1);
+  };
+
+  const uint8_t* p = icon.data;
+  const uint8_t* end = p + icon.size;
+  while (p < end) {
+    uint8_t c = pgm_read_byte(p++);
+    if (c < 0x80) {
+      for (int n = c + 1; n > 0 && p < end; n--) put(pgm_read_byte(p++));
+    } else if (c < 0xC0) {
+      advance((c & 0x3F) + 1);
+    } else {
+      if (p >= end) break;
+      uint8_t v = pgm_read_byte(p++);
+      for (int n = (c & 0x3F) + 2; n > 0; n--) put(v);
+    }
+  }
+}
@@ -0,0 +1,273 @@
+#pragma once
+/*
+  Programmation : règles calendaires + vidange à intervalle fixe
+  - Règles "jours x heure locale" : vidange, remplissage, heures calmes (durée)
+    ex. vidange le dimanche à 03:00, calme 22:00 -> 07:00 tous les jours
+  - Prochaines échéances dans une roue de temporisation (timer_wheel.h) :
+    le tick ne fait qu'avancer la roue, l'occurrence suivante d'une règle
+    n'est calculée (mktime) qu'au déclenchement ou à la modification
+  - Les événements sont remis à la logique (controlScheduledEvent) par
+    l'appelant, qui les enregistre dans la trace comme des commandes
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "timer_wheel.h"
+
+#define SCHED_MAX_RULES     8
+#define SCHED_MAX_DURATION  1440  // min : heures calmes jusqu'à 24 h
+#define SCHED_ALL_DAYS      0x7F
+
+enum ScheduleAction : uint8_t { SCHED_DRAIN = 0, SCHED_REFILL = 1, SCHED_QUIET = 2 };
+
+// Événements remis à la logique (valeur de CMD_SCHED_EVENT dans les traces)
+enum ScheduleEvent : uint8_t {
+  SCHED_EV_DRAIN = 0,
+  SCHED_EV_REFILL,
+  SCHED_EV_QUIET_ON,
+  SCHED_EV_QUIET_OFF
+};
+
+struct ScheduleRule {
+  bool used;
+  bool enabled;
+  uint8_t action;        // ScheduleAction
+  uint8_t days;          // bit 0 = dimanche ... bit 6 = samedi (tm_wday)
+  uint16_t minute;       // minute du jour, heure locale (0-1439)
+  uint16_t durationMin;  // SCHED_QUIET uniquement
+};
+
+inline const char* scheduleActionName(uint8_t a) {
+  return a == SCHED_DRAIN ? "drain" : a == SCHED_REFILL ? "refill" : "quiet";
+}
+
+inline bool scheduleRuleValid(const ScheduleRule& r) {
+  if (r.action > SCHED_QUIET || (r.days & SCHED_ALL_DAYS) == 0 || r.minute >= 1440) return false;
+  if (r.action == SCHED_QUIET) return r.durationMin >= 1 && r.durationMin <= SCHED_MAX_DURATION;
+  return true;
+}
+
+// Règle <-> valeur 32 bits (commande CMD_SCHED_ADD) :
+// action 2 bits | jours 7 bits | minute 11 bits | durée 12 bits
+inline uint32_t schedulePack(const ScheduleRule& r) {
+  return (uint32_t)(r.action & 3) | (uint32_t)(r.days & SCHED_ALL_DAYS) << 2 |
+         (uint32_t)(r.minute & 0x7FF) << 9 | (uint32_t)(r.durationMin & 0xFFF) << 20;
+}
+
+inline ScheduleRule scheduleUnpack(uint32_t v) {
+  ScheduleRule r;
+  r.used = true;
+  r.enabled = true;
+  r.action = v & 3;
+  r.days = (v >> 2) & SCHED_ALL_DAYS;
+  r.minute = (v >> 9) & 0x7FF;
+  r.durationMin = (v >> 20) & 0xFFF;
+  return r;
+}
+
+// Jours : "sun,wed,sat", "all" (tous) ou "week" (lun-ven) -> masque, 0 si invalide
+inline uint8_t scheduleParseDays(const char* s) {
+  static const char* names[] = { "sun", "mon", "tue", "wed", "thu", "fri", "sat" };
+  if (strcmp(s, "all") == 0) return SCHED_ALL_DAYS;
+  if (strcmp(s, "week") == 0) return 0x3E;
+  uint8_t mask = 0;
+  while (*s) {
+    uint8_t d = 0;
+    while (d < 7 && strncmp(s, names[d], 3) != 0) d++;
+    if (d == 7 || (s[3] != ',' && s[3] != '\0')) return 0;
+    mask |= 1 << d;
+    s += s[3] == ',' ? 4 : 3;
+  }
+  return mask;
+}
+
+// Masque -> "sun,wed,sat" (buf : 28 octets)
+inline const char* scheduleFormatDays(uint8_t mask, char* buf) {
+  static const char* names[] = { "sun", "mon", "tue", "wed", "thu", "fri", "sat" };
+  char* p = buf;
+  for (uint8_t d = 0; d < 7; d++) {
+    if (!((mask >> d) & 1)) continue;
+    if (p != buf) *p++ = ',';
+    memcpy(p, names[d], 3);
+    p += 3;
+  }
+  *p = '\0';
+  return buf;
+}
+
+// Première occurrence strictement postérieure à after (0 : aucun jour coché).
+// Heure locale (fuseau de configTime), changements d'heure compris.
+inline uint32_t scheduleNextOccurrence(const ScheduleRule& r, uint32_t after) {
+  if ((r.days & SCHED_ALL_DAYS) == 0) return 0;
+  time_t t = (time_t)after;
+  struct tm base;
+  localtime_r(&t, &base);
+  for (int d = 0; d <= 7; d++) {
+    struct tm tm = base;
+    tm.tm_mday += d;
+    tm.tm_hour = r.minute / 60;
+    tm.tm_min = r.minute % 60;
+    tm.tm_sec = 0;
+    tm.tm_isdst = -1;
+    time_t at = mktime(&tm);   // normalise la date et renseigne tm_wday
+    if (at == (time_t)-1) continue;
+    if ((r.days >> tm.tm_wday) & 1 && (uint32_t)at > after) return (uint32_t)at;
+  }
+  return 0;
+}
+
+class Scheduler {
+public:
+  ScheduleRule rules[SCHED_MAX_RULES] = {};
+
+  // Heure valide (NTP) : arme toutes les règles. Aussi appelé après une
+  // modification de règle (rare) : la roue est reconstruite entièrement.
+  void start(uint32_t now) {
+    _wheel.reset(now);
+    _quietDepth = 0;
+    for (uint8_t i = 0; i < SCHED_MAX_RULES; i++) {
+      _handle[i] = NONE;
+      if (!rules[i].used || !rules[i].enabled) continue;
+      arm(i, now);
+      // Fenêtre calme déjà commencée : sa fin seule est programmée
+      if (rules[i].action == SCHED_QUIET) {
+        uint32_t begin = scheduleNextOccurrence(rules[i], now - rules[i].durationMin * 60UL);
+        if (begin != 0 && begin <= now) addQuietEnd(begin + rules[i].durationMin * 60UL, i);
+      }
+    }
+    _interval = _intervalAt ? _wheel.add(_intervalAt, K_INTERVAL, 0) : NONE;
+    _started = true;
+  }
+
+  bool started() const { return _started; }
+  bool quiet() const { return _quietDepth > 0; }
+  uint8_t pendingCount() const { return _wheel.count(); }
+
+  // Vidange à intervalle fixe (mode éco) : at = 0 la désactive
+  void setIntervalDrain(uint32_t at) {
+    if (_interval != NONE) _wheel.cancel(_interval);
+    _interval = NONE;
+    _intervalAt = at;
+    if (_started && at) _interval = _wheel.add(at, K_INTERVAL, 0);
+  }
+  uint32_t intervalDrainAt() const { return _intervalAt; }
+
+  // Une règle de vidange active remplace l'intervalle fixe
+  bool hasDrainRule() const {
+    for (uint8_t i = 0; i < SCHED_MAX_RULES; i++)
+      if (rules[i].used && rules[i].enabled && rules[i].action == SCHED_DRAIN) return true;
+    return false;
+  }
+
+  // Prochaine occurrence armée de la règle (0 = aucune)
+  uint32_t nextAt(uint8_t id) const {
+    return _started && id < SCHED_MAX_RULES && _wheel.pending(_handle[id]) ? _wheel.timer(_handle[id]).at : 0;
+  }
+
+  // Prochaine vidange programmée, règle ou intervalle (0 = aucune)
+  uint32_t nextDrainAt() const {
+    uint32_t best = 0;
+    _wheel.forEach([&](uint8_t, const Timer& t) {
+      bool drain = t.kind == K_INTERVAL || (t.kind == K_RULE && rules[t.arg].action == SCHED_DRAIN);
+      if (drain && (best == 0 || (int32_t)(t.at - best) < 0)) best = t.at;
+    });
+    return best;
+  }
+
+  // ---- Édition (boucle de contrôle) : index de la règle ou -1 ----
+  int addRule(const ScheduleRule& r, uint32_t now) {
+    if (!scheduleRuleValid(r)) return -1;
+    for (uint8_t i = 0; i < SCHED_MAX_RULES; i++) {
+      if (rules[i].used) continue;
+      rules[i] = r;
+      rules[i].used = true;
+      if (_started) start(now);
+      return i;
+    }
+    return -1;
+  }
+
+  bool deleteRule(uint8_t id, uint32_t now) {
+    if (id >= SCHED_MAX_RULES || !rules[id].used) return false;
+    rules[id] = ScheduleRule();
+    if (_started) start(now);
+    return true;
+  }
+
+  bool enableRule(uint8_t id, bool on, uint32_t now) {
+    if (id >= SCHED_MAX_RULES || !rules[id].used) return false;
+    rules[id].enabled = on;
+    if (_started) start(now);
+    return true;
+  }
+
+  // À chaque tick (heure murale) : emit(ScheduleEvent) par échéance atteinte.
+  // Hors changement de seconde : une comparaison, aucun parcours d'événements.
+  // Heures calmes : un seul QUIET_ON/OFF par changement effectif (fenêtres
+  // chevauchantes, reconstruction après édition).
+  template<class F>
+  void advance(uint32_t now, F emit) {
+    if (!_started) return;
+    _wheel.advance(now, [&](const Timer& t) {
+      switch (t.kind) {
+        case K_INTERVAL:
+          _interval = NONE;
+          _intervalAt = 0;   // réarmée par l'appelant à la fin du cycle
+          emit(SCHED_EV_DRAIN);
+          break;
+        case K_RULE: {
+          const ScheduleRule& r = rules[t.arg];
+          arm(t.arg, t.at);
+          if (r.action == SCHED_DRAIN) emit(SCHED_EV_DRAIN);
+          else if (r.action == SCHED_REFILL) emit(SCHED_EV_REFILL);
+          else addQuietEnd(t.at + r.durationMin * 60UL, t.arg);
+          break;
+        }
+        case K_QUIET_END:
+          if (_quietDepth > 0) _quietDepth--;
+          break;
+      }
+    });
+    if (quiet() != _toldQuiet) {
+      _toldQuiet = quiet();
+      emit(_toldQuiet ? SCHED_EV_QUIET_ON : SCHED_EV_QUIET_OFF);
+    }
+  }
+
+  // Parcours des échéances armées (/schedule) : fn(kind, epoch, règle)
+  // kind : "rule", "interval", "quietEnd"
+  template<class F>
+  void forEachPending(F fn) const {
+    _wheel.forEach([&](uint8_t, const Timer& t) {
+      fn(t.kind == K_RULE ? "rule" : t.kind == K_INTERVAL ? "interval" : "quietEnd",
+         t.at, t.kind == K_INTERVAL ? -1 : (int)t.arg);
+    });
+  }
+
+private:
+  // Règles + leurs fins de calme + intervalle. Deux fins par règle : une
+  // fenêtre de 24 h se rouvre à l'instant où la précédente se ferme
+  typedef TimerWheel<3 * SCHED_MAX_RULES + 1> Wheel;
+  typedef Wheel::Timer Timer;
+  static const Wheel::Handle NONE = Wheel::NONE;
+  enum : uint8_t { K_RULE, K_INTERVAL, K_QUIET_END };
+
+  void arm(uint8_t id, uint32_t after) {
+    uint32_t at = scheduleNextOccurrence(rules[id], after);
+    _handle[id] = at ? _wheel.add(at, K_RULE, id) : NONE;
+  }
+
+  // Fenêtre calme ouverte seulement si sa fin est armée : jamais de calme sans fin
+  void addQuietEnd(uint32_t at, uint8_t id) {
+    if (_wheel.add(at, K_QUIET_END, id) != NONE) _quietDepth++;
+  }
+
+  Wheel _wheel;
+  Wheel::Handle _handle[SCHED_MAX_RULES];
+  Wheel::Handle _interval = NONE;
+  uint32_t _intervalAt = 0;
+  uint8_t _quietDepth = 0;
+  bool _toldQuiet = false;   // dernier état calme remis à la logique
+  bool _started = false;
+};
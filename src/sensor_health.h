@@ -0,0 +1,111 @@
+#pragma once
+/*
+  Santé d'un capteur : la mesure est-elle encore digne de confiance ?
+  - Taux de timeouts (moyenne glissante des lectures invalides)
+  - Bruit : écart-type des variations successives (insensible à la pente
+    d'un remplissage ou d'une vidange)
+  - Valeur figée : mesure valide strictement identique trop longtemps
+  - Silence : plus aucune lecture valide depuis failMs -> capteur HS
+  Hystérésis sur le retour à l'état normal (moitié des seuils).
+  Fonctions pures sur un état (comme control.h) : host/replay le recalcule
+  à partir des échos bruts de la trace.
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+enum HealthLevel : uint8_t { HEALTH_OK = 0, HEALTH_DEGRADED = 1, HEALTH_FAILED = 2 };
+
+// Causes (bits), pour l'affichage et le journal
+enum : uint8_t {
+  HEALTH_TIMEOUTS = 1 << 0,
+  HEALTH_NOISY    = 1 << 1,
+  HEALTH_STUCK    = 1 << 2,
+  HEALTH_SILENT   = 1 << 3
+};
+
+struct SensorHealthParams {
+  float windowSamples;     // constante des moyennes glissantes (mesures)
+  float timeoutRatioMax;   // part de lectures invalides tolérée
+  float noiseStdMax;       // écart-type des variations (unité du capteur)
+  uint32_t stuckMs;        // valeur identique plus longtemps = figée (0 : pas de test)
+  uint32_t failMs;         // sans lecture valide plus longtemps = HS
+};
+
+struct SensorHealthState {
+  uint8_t level;           // HealthLevel
+  uint8_t causes;
+  float timeoutRatio;
+  float diffVar;           // variance des variations successives / 2
+  float lastValue;
+  bool haveValue;
+  uint32_t lastGoodMs;     // dernière lecture valide
+  uint32_t lastChangeMs;   // dernière valeur différente de la précédente
+  uint32_t samples, timeouts;
+};
+
+inline const char* healthLevelName(uint8_t l) {
+  return l == HEALTH_OK ? "ok" : l == HEALTH_DEGRADED ? "degraded" : "failed";
+}
+
+// Une mesure : nValid lectures valides sur nTotal, value = valeur retenue.
+// Retourne true si le niveau de santé a changé.
+inline bool healthUpdate(SensorHealthState& h, const SensorHealthParams& p, uint32_t nowMs,
+                         int nValid, int nTotal, float value) {
+  const float a = 1.0f / p.windowSamples;
+  if (h.samples == 0) {
+    h.lastGoodMs = h.lastChangeMs = nowMs;   // délai de grâce au démarrage
+  }
+  h.samples++;
+  if (nTotal > 0) {
+    float invalid = (float)(nTotal - nValid) / nTotal;
+    h.timeoutRatio += a * (invalid - h.timeoutRatio);
+    if (nValid == 0) h.timeouts++;
+  }
+  if (nValid > 0) {
+    if (h.haveValue) {
+      float d = value - h.lastValue;
+      h.diffVar += a * (0.5f * d * d - h.diffVar);
+      if (value != h.lastValue) h.lastChangeMs = nowMs;
+    } else {
+      h.lastChangeMs = nowMs;
+    }
+    h.lastValue = value;
+    h.haveValue = true;
+    h.lastGoodMs = nowMs;
+  }
+
+  // Causes avec hystérésis : entrée au seuil, sortie à la moitié
+  uint8_t c = h.causes;
+  auto hyst = [&](uint8_t bit, float x, float limit) {
+    if (x > limit) c |= bit;
+    else if (x < 0.5f * limit) c &= ~bit;
+  };
+  hyst(HEALTH_TIMEOUTS, h.timeoutRatio, p.timeoutRatioMax);
+  hyst(HEALTH_NOISY, sqrtf(h.diffVar), p.noiseStdMax);
+  if (p.stuckMs && h.haveValue && nowMs - h.lastChangeMs > p.stuckMs) c |= HEALTH_STUCK;
+  else c &= ~HEALTH_STUCK;
+  if (nowMs - h.lastGoodMs > p.failMs) c |= HEALTH_SILENT;
+  else c &= ~HEALTH_SILENT;
+  h.causes = c;
+
+  uint8_t level = (c & HEALTH_SILENT) ? HEALTH_FAILED : c ? HEALTH_DEGRADED : HEALTH_OK;
+  bool changed = level != h.level;
+  h.level = level;
+  return changed;
+}
+
+inline bool healthTrusted(const SensorHealthState& h) { return h.level == HEALTH_OK; }
+
+// "name":{...} pour /metrics
+inline size_t healthPrintStats(char* buf, size_t size, const char* name, const SensorHealthState& h, uint32_t nowMs) {
+  int w = snprintf(buf, size,
+    "\"%s\":{\"state\":\"%s\",\"causes\":%u,\"timeoutRatio\":%.3f,\"noiseStd\":%.3f,"
+    "\"unchangedMs\":%u,\"lastGoodAgoMs\":%u,\"samples\":%u,\"timeouts\":%u}",
+    name, healthLevelName(h.level), h.causes, h.timeoutRatio, sqrtf(h.diffVar),
+    (unsigned)(nowMs - h.lastChangeMs), (unsigned)(nowMs - h.lastGoodMs),
+    (unsigned)h.samples, (unsigned)h.timeouts);
+  if (w < 0) return 0;
+  return (size_t)w < size ? (size_t)w : size - 1;
+}
@@ -0,0 +1,506 @@
+#pragma once
+/*
+  Enregistreur de traces capteurs, rejouables par host/replay
+  - Par tick de logique : durées d'écho brutes, PIR, AHT20, heure murale
+  - Commandes appliquées entre deux ticks (même ordre que la boucle)
+  - Anneau de blocs en RAM : chaque bloc commence par une image clé (état de
+    contrôle, seuils, tables de calibration) ; plein -> le plus ancien est écrasé
+  - Export figé pendant le téléchargement (les ticks sont alors ignorés et le
+    bloc suivant est marqué "rupture")
+
+  Format exporté (petit-boutiste) :
+    en-tête  "FTRC", u8 version, u8 échos max, u16 taille bloc, u16 nb blocs,
+             u16 réservé, f32 offsetCm, f32 heightCm, f32 capacityL
+    bloc     u16 octets utiles, puis enregistrements :
+    'K'      image clé (encodeKey)
+    'T'      varint dMs, u8 drapeaux (b0 PIR, b1 AHT, b2 heure, b4-7 nb échos),
+             [f32 temp, f32 hum], [zigzag dEpoch], zigzag(écho - écho précédent) x nb
+    'C'      u8 type, u8 unit, varint value, zigzag dEpoch
+  Sans dépendance Arduino.
+*/
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "control.h"
+#include "ranging.h"
+#include "sensor_health.h"
+
+#define TRACE_VERSION      4     // 2 : programmation, 3 : santé du capteur ultrason, 4 : pré-remplissage
+#define TRACE_BLOCK_SIZE   2048
+#define TRACE_HEADER_SIZE  24
+#define TRACE_TICK_MAX     48    // 1 + 5 + 1 + 8 + 5 + 5 x 5
+#define TRACE_CMD_MAX      16
+#define TRACE_REC_KEY      'K'
+#define TRACE_REC_TICK     'T'
+#define TRACE_REC_CMD      'C'
+
+struct TraceTick {
+  uint32_t ms;
+  uint32_t epoch;
+  bool pir;
+  bool ahtValid;          // nouvelle lecture AHT20 (sinon valeurs précédentes)
+  float tempC, humPct;
+  uint8_t nEcho;
+  uint32_t echoUs[ECHO_MAX_SAMPLES];  // 0 = timeout
+};
+
+struct TraceCommand {
+  uint8_t type;           // CommandType
+  uint8_t unit;
+  uint32_t value;
+  uint32_t epoch;         // heure murale vue par la commande
+};
+
+struct TraceKeyframe {
+  uint32_t ms, epoch;     // renseignés par l'enregistreur
+  bool gap;               // continuité rompue (effacement, gel) : l'état fait foi
+  ControlState state;     // état AVANT l'enregistrement qui suit
+  ControlParams params;
+  float distanceCm, tempC, humPct;
+  CalibrationTable calib, draft;
+  SensorHealthState health;  // capteur ultrason
+  SensorHealthParams healthParams;
+};
+
+// ---- Encodage ----
+struct TraceBuf {
+  uint8_t* p;
+  size_t cap, len;
+  TraceBuf(uint8_t* buf, size_t size) : p(buf), cap(size), len(0) {}
+  void put8(uint8_t v) { if (len < cap) p[len] = v; len++; }
+  void put16(uint16_t v) { put8(v & 0xFF); put8(v >> 8); }
+  void put32(uint32_t v) { put16(v & 0xFFFF); put16(v >> 16); }
+  void putF(float f) { uint32_t v; memcpy(&v, &f, 4); put32(v); }
+  void putVar(uint32_t v) { while (v >= 0x80) { put8((v & 0x7F) | 0x80); v >>= 7; } put8(v); }
+  void putZig(int32_t v) { putVar(((uint32_t)v << 1) ^ (uint32_t)(v >> 31)); }
+};
+
+struct TraceCursor {
+  const uint8_t* p;
+  size_t len, pos;
+  bool ok;
+  TraceCursor(const uint8_t* buf, size_t size) : p(buf), len(size), pos(0), ok(true) {}
+  uint8_t get8() { if (pos >= len) { ok = false; return 0; } return p[pos++]; }
+  uint16_t get16() { uint16_t lo = get8(); return lo | (uint16_t)get8() << 8; }
+  uint32_t get32() { uint32_t lo = get16(); return lo | (uint32_t)get16() << 16; }
+  float getF() { uint32_t v = get32(); float f; memcpy(&f, &v, 4); return f; }
+  uint32_t getVar() {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      uint8_t b = get8();
+      v |= (uint32_t)(b & 0x7F) << shift;
+      if (!(b & 0x80)) return v;
+    }
+    ok = false;
+    return v;
+  }
+  int32_t getZig() { uint32_t v = getVar(); return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+};
+
+inline void traceEncodeTable(TraceBuf& b, const CalibrationTable& t) {
+  b.put8(t.count());
+  for (uint8_t i = 0; i < t.count(); i++) { b.putF(t.point(i).distCm); b.putF(t.point(i).litres); }
+}
+
+inline void traceDecodeTable(TraceCursor& c, CalibrationTable& t) {
+  uint8_t n = c.get8();
+  t.clear();
+  if (n > CAL_MAX_POINTS) { c.ok = false; return; }
+  for (uint8_t i = 0; i < n; i++) { float d = c.getF(); t.add(d, c.getF()); }
+}
+
+// Image clé : ~140 octets + 8 par point de calibration (active + brouillon)
+inline void traceEncodeKey(TraceBuf& b, const TraceKeyframe& k) {
+  const ControlState& s = k.state;
+  const ControlParams& p = k.params;
+  b.put8(TRACE_REC_KEY);
+  b.put32(k.ms);
+  b.put32(k.epoch);
+  b.put8(k.gap ? 1 : 0);
+  b.put8((uint8_t)s.mode);
+  b.put16((s.valveOn ? 1 : 0) | (s.pumpOn ? 2 : 0) | (s.voutOn ? 4 : 0) | (s.ecoInClosedPhase ? 8 : 0) |
+          (s.manualDrainActive ? 16 : 0) | (s.pirState ? 32 : 0) | (s.drainDue ? 64 : 0) |
+          (s.refillActive ? 128 : 0) | (s.quiet ? 256 : 0) | (s.safeStop ? 512 : 0) |
+          (s.degraded ? 1024 : 0) | (s.valveCapped ? 2048 : 0) | (s.pumpCapped ? 4096 : 0));
+  b.put32(s.lastEV1OnTimestamp);
+  b.put32(s.fillAllowedUntilMs);
+  b.put32(s.lastPirDetectMs);
+  b.put32(s.lastValveOnMs);
+  b.put32(s.lastPumpOnMs);
+  b.put32(s.degradedSinceMs);
+  b.put32(s.prefillUntilEpoch);
+  b.put8(p.fillTargetPct); b.put8(p.pumpOnAbovePct); b.put8(p.pumpOffBelowPct);
+  b.put8(p.drainStopPct);  b.put8(p.manualFloorPct);
+  b.putF(p.fillTargetL); b.putF(p.pumpOnAboveL); b.putF(p.pumpOffBelowL);
+  b.putF(p.drainStopL);  b.putF(p.manualFloorL);
+  b.put32(p.motionHoldMs);
+  b.put32(p.ecoDrainIntervalSec);
+  b.put32(p.degradedValveMaxMs);
+  b.put32(p.degradedPumpMaxMs);
+  b.putF(k.distanceCm);
+  b.putF(k.tempC);
+  b.putF(k.humPct);
+  traceEncodeTable(b, k.calib);
+  traceEncodeTable(b, k.draft);
+  const SensorHealthState& h = k.health;
+  b.put8(h.level | h.causes << 2 | (h.haveValue ? 0x80 : 0));
+  b.putF(h.timeoutRatio);
+  b.putF(h.diffVar);
+  b.putF(h.lastValue);
+  b.put32(h.lastGoodMs);
+  b.put32(h.lastChangeMs);
+  b.put32(h.samples);
+  b.put32(h.timeouts);
+  const SensorHealthParams& hp = k.healthParams;
+  b.putF(hp.windowSamples);
+  b.putF(hp.timeoutRatioMax);
+  b.putF(hp.noiseStdMax);
+  b.put32(hp.stuckMs);
+  b.put32(hp.failMs);
+}
+
+// Après l'octet 'K'
+inline void traceDecodeKey(TraceCursor& c, TraceKeyframe& k) {
+  ControlState& s = k.state;
+  ControlParams& p = k.params;
+  k.ms = c.get32();
+  k.epoch = c.get32();
+  k.gap = c.get8() & 1;
+  s.mode = (FountainMode)c.get8();
+  uint16_t f = c.get16();
+  s.valveOn = f & 1; s.pumpOn = f & 2; s.voutOn = f & 4; s.ecoInClosedPhase = f & 8;
+  s.manualDrainActive = f & 16; s.pirState = f & 32; s.drainDue = f & 64;
+  s.refillActive = f & 128; s.quiet = f & 256; s.safeStop = f & 512;
+  s.degraded = f & 1024; s.valveCapped = f & 2048; s.pumpCapped = f & 4096;
+  s.lastEV1OnTimestamp = c.get32();
+  s.fillAllowedUntilMs = c.get32();
+  s.lastPirDetectMs = c.get32();
+  s.lastValveOnMs = c.get32();
+  s.lastPumpOnMs = c.get32();
+  s.degradedSinceMs = c.get32();
+  s.prefillUntilEpoch = c.get32();
+  p.fillTargetPct = c.get8(); p.pumpOnAbovePct = c.get8(); p.pumpOffBelowPct = c.get8();
+  p.drainStopPct = c.get8();  p.manualFloorPct = c.get8();
+  p.fillTargetL = c.getF(); p.pumpOnAboveL = c.getF(); p.pumpOffBelowL = c.getF();
+  p.drainStopL = c.getF();  p.manualFloorL = c.getF();
+  p.motionHoldMs = c.get32();
+  p.ecoDrainIntervalSec = c.get32();
+  p.degradedValveMaxMs = c.get32();
+  p.degradedPumpMaxMs = c.get32();
+  k.distanceCm = c.getF();
+  k.tempC = c.getF();
+  k.humPct = c.getF();
+  traceDecodeTable(c, k.calib);
+  traceDecodeTable(c, k.draft);
+  SensorHealthState& h = k.health;
+  uint8_t hf = c.get8();
+  h.level = hf & 3;
+  h.causes = (hf >> 2) & 0x0F;
+  h.haveValue = hf & 0x80;
+  h.timeoutRatio = c.getF();
+  h.diffVar = c.getF();
+  h.lastValue = c.getF();
+  h.lastGoodMs = c.get32();
+  h.lastChangeMs = c.get32();
+  h.samples = c.get32();
+  h.timeouts = c.get32();
+  SensorHealthParams& hp = k.healthParams;
+  hp.windowSamples = c.getF();
+  hp.timeoutRatioMax = c.getF();
+  hp.noiseStdMax = c.getF();
+  hp.stuckMs = c.get32();
+  hp.failMs = c.get32();
+}
+
+// ===================== Enregistreur (firmware) =====================
+// Écriture depuis la seule boucle de contrôle ; gel/export depuis la tâche web.
+class SensorTrace {
+public:
+  void begin(uint8_t* mem, size_t size, float offsetCm, float heightCm, float capacityL) {
+    _mem = mem;
+    _nBlocks = (uint16_t)(size / TRACE_BLOCK_SIZE);
+    _offsetCm = offsetCm;
+    _heightCm = heightCm;
+    _capacityL = capacityL;
+    reset();
+  }
+
+  // makeKey() : image clé de l'état courant, appelée seulement en début de bloc
+  template<class KeyFn>
+  void recordTick(const TraceTick& t, KeyFn makeKey) {
+    if (!enter()) return;
+    uint8_t n = t.nEcho < ECHO_MAX_SAMPLES ? t.nEcho : ECHO_MAX_SAMPLES;
+    if (ensureSpace(TRACE_TICK_MAX, makeKey, t.ms, t.epoch)) {
+      bool aht = t.ahtValid && (t.tempC != _temp || t.humPct != _hum);
+      bool wall = t.epoch != _lastEpoch;
+      TraceBuf b(blockData() + _used, TRACE_TICK_MAX);
+      b.put8(TRACE_REC_TICK);
+      b.putVar(t.ms - _lastMs);
+      b.put8((t.pir ? 1 : 0) | (aht ? 2 : 0) | (wall ? 4 : 0) | (n << 4));
+      if (aht) { b.putF(t.tempC); b.putF(t.humPct); _temp = t.tempC; _hum = t.humPct; }
+      if (wall) b.putZig((int32_t)(t.epoch - _lastEpoch));
+      for (uint8_t i = 0; i < n; i++) {
+        b.putZig((int32_t)(t.echoUs[i] - _prevEcho[i]));
+        _prevEcho[i] = t.echoUs[i];
+      }
+      _lastMs = t.ms;
+      _lastEpoch = t.epoch;
+      commit(b.len);
+      _ticks++;
+    }
+    leave();
+  }
+
+  template<class KeyFn>
+  void recordCommand(const TraceCommand& c, KeyFn makeKey) {
+    if (!enter()) return;
+    if (ensureSpace(TRACE_CMD_MAX, makeKey, _lastMs, c.epoch)) {
+      TraceBuf b(blockData() + _used, TRACE_CMD_MAX);
+      b.put8(TRACE_REC_CMD);
+      b.put8(c.type);
+      b.put8(c.unit);
+      b.putVar(c.value);
+      b.putZig((int32_t)(c.epoch - _lastEpoch));
+      _lastEpoch = c.epoch;
+      commit(b.len);
+      _commands++;
+    }
+    leave();
+  }
+
+  // Depuis une autre tâche : effacé au prochain enregistrement
+  void requestClear() { _clearReq.store(true); }
+
+  // Gel pour l'export : attend la fin d'un enregistrement en cours. Attente
+  // par pas de 1 ms (vTaskDelay sur la carte) : la tâche appelante (async_tcp,
+  // priorité 3) rend la main à la boucle (priorité 1) qui termine l'écriture
+  void freeze() {
+    _frozen.fetch_add(1);
+    while (_writing.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  void unfreeze() {
+    if (_frozen.fetch_sub(1) == 1) _resync.store(true);
+  }
+
+  // ---- Export (figé) : en-tête + blocs du plus ancien au plus récent ----
+  size_t exportSize() const {
+    size_t total = TRACE_HEADER_SIZE;
+    for (uint16_t i = 0; i < _count; i++) total += 2 + blockUsed(blockAt(i));
+    return total;
+  }
+
+  size_t exportRead(size_t offset, uint8_t* out, size_t n) const {
+    size_t written = 0;
+    if (offset < TRACE_HEADER_SIZE) {
+      uint8_t head[TRACE_HEADER_SIZE];
+      TraceBuf b(head, sizeof(head));
+      b.put8('F'); b.put8('T'); b.put8('R'); b.put8('C');
+      b.put8(TRACE_VERSION);
+      b.put8(ECHO_MAX_SAMPLES);
+      b.put16(TRACE_BLOCK_SIZE);
+      b.put16(_count);
+      b.put16(0);
+      b.putF(_offsetCm);
+      b.putF(_heightCm);
+      b.putF(_capacityL);
+      size_t k = TRACE_HEADER_SIZE - offset < n ? TRACE_HEADER_SIZE - offset : n;
+      memcpy(out, head + offset, k);
+      written += k;
+    }
+    size_t base = TRACE_HEADER_SIZE;
+    for (uint16_t i = 0; i < _count && written < n; i++) {
+      const uint8_t* blk = _mem + (size_t)blockAt(i) * TRACE_BLOCK_SIZE;
+      size_t len = 2 + blockUsed(blockAt(i));
+      size_t pos = offset + written;
+      if (pos < base + len) {
+        size_t from = pos - base;
+        size_t k = len - from < n - written ? len - from : n - written;
+        memcpy(out + written, blk + from, k);
+        written += k;
+      }
+      base += len;
+    }
+    return written;
+  }
+
+  // "trace":{...} pour /metrics
+  size_t printStats(char* buf, size_t size) const {
+    uint32_t spanMs = 0;
+    if (_count) {
+      const uint8_t* first = _mem + (size_t)blockAt(0) * TRACE_BLOCK_SIZE + 2;
+      TraceCursor c(first + 1, 4);
+      spanMs = _lastMs - c.get32();
+    }
+    int w = snprintf(buf, size,
+      "\"trace\":{\"bytes\":%u,\"capacity\":%u,\"blocks\":%u,\"ticks\":%u,\"commands\":%u,"
+      "\"overwritten\":%u,\"spanMs\":%u,\"frozen\":%s}",
+      (unsigned)(_count ? exportSize() : 0), (unsigned)_nBlocks * TRACE_BLOCK_SIZE, (unsigned)_count,
+      (unsigned)_ticks, (unsigned)_commands, (unsigned)_overwritten, (unsigned)spanMs,
+      _frozen.load() ? "true" : "false");
+    if (w < 0) return 0;
+    return (size_t)w < size ? (size_t)w : size - 1;
+  }
+
+private:
+  void reset() {
+    _head = 0;
+    _count = 0;
+    _used = 0;
+    _gap = true;
+    _lastMs = 0;
+    _lastEpoch = 0;
+  }
+
+  bool enter() {
+    _writing.store(true);
+    if (_frozen.load()) { _writing.store(false); return false; }
+    if (_clearReq.exchange(false)) reset();
+    if (_resync.exchange(false)) { _gap = true; _used = TRACE_BLOCK_SIZE; }  // nouveau bloc
+    if (_nBlocks == 0) { _writing.store(false); return false; }   // pas de mémoire : rien à écrire
+    return true;
+  }
+  void leave() { _writing.store(false); }
+
+  // Ouvre un bloc (image clé) si l'enregistrement ne tient pas dans le courant
+  template<class KeyFn>
+  bool ensureSpace(size_t need, KeyFn& makeKey, uint32_t ms, uint32_t epoch) {
+    if (_count > 0 && _used + need <= TRACE_BLOCK_SIZE - 2) return true;
+    if (_count == 0) _head = 0;
+    else _head = (uint16_t)((_head + 1) % _nBlocks);
+    if (_count < _nBlocks) _count++;
+    else _overwritten++;
+    setBlockUsed(_head, 0);
+    _used = 0;
+
+    TraceKeyframe k = makeKey();
+    k.ms = ms;
+    k.epoch = epoch;
+    k.gap = _gap;
+    TraceBuf b(blockData(), TRACE_BLOCK_SIZE - 2);
+    traceEncodeKey(b, k);
+    if (b.len > b.cap) return false;
+    _gap = false;
+    _lastMs = ms;
+    _lastEpoch = epoch;
+    _temp = k.tempC;
+    _hum = k.humPct;
+    memset(_prevEcho, 0, sizeof(_prevEcho));
+    commit(b.len);
+    return _used + need <= TRACE_BLOCK_SIZE - 2;
+  }
+
+  uint8_t* blockData() { return _mem + (size_t)_head * TRACE_BLOCK_SIZE + 2; }
+  uint16_t blockAt(uint16_t i) const { return (uint16_t)((_head + _nBlocks - _count + 1 + i) % _nBlocks); }
+  uint16_t blockUsed(uint16_t blk) const {
+    const uint8_t* p = _mem + (size_t)blk * TRACE_BLOCK_SIZE;
+    return p[0] | (uint16_t)p[1] << 8;
+  }
+  void setBlockUsed(uint16_t blk, uint16_t used) {
+    uint8_t* p = _mem + (size_t)blk * TRACE_BLOCK_SIZE;
+    p[0] = used & 0xFF;
+    p[1] = used >> 8;
+  }
+  // Longueur publiée après les octets : un export voit toujours des enregistrements entiers
+  void commit(size_t len) {
+    _used += len;
+    setBlockUsed(_head, (uint16_t)_used);
+  }
+
+  uint8_t* _mem = nullptr;
+  uint16_t _nBlocks = 0, _head = 0, _count = 0;
+  size_t _used = 0;
+  float _offsetCm = 0, _heightCm = 0, _capacityL = 0;
+  bool _gap = true;
+  uint32_t _lastMs = 0, _lastEpoch = 0;
+  float _temp = 0, _hum = 0;
+  uint32_t _prevEcho[ECHO_MAX_SAMPLES] = {};
+  uint32_t _ticks = 0, _commands = 0, _overwritten = 0;
+  std::atomic<bool> _writing{false}, _clearReq{false}, _resync{false};
+  std::atomic<int> _frozen{0};
+};
+
+// ===================== Lecteur (host/replay) =====================
+class TraceReader {
+public:
+  float offsetCm = 0, heightCm = 0, capacityL = 0;
+  uint16_t blockCount = 0;
+
+  // Dernier enregistrement lu par next()
+  TraceKeyframe key;
+  TraceTick tick;
+  TraceCommand cmd;
+
+  bool open(const uint8_t* data, size_t len) {
+    _data = data;
+    _len = len;
+    if (len < TRACE_HEADER_SIZE || memcmp(data, "FTRC", 4) != 0) return false;
+    TraceCursor c(data + 4, TRACE_HEADER_SIZE - 4);
+    if (c.get8() != TRACE_VERSION || c.get8() != ECHO_MAX_SAMPLES) return false;
+    c.get16();
+    blockCount = c.get16();
+    c.get16();
+    offsetCm = c.getF();
+    heightCm = c.getF();
+    capacityL = c.getF();
+    _pos = TRACE_HEADER_SIZE;
+    _blockEnd = _pos;
+    return c.ok;
+  }
+
+  // TRACE_REC_KEY / TICK / CMD, 0 en fin de trace, '!' si corrompue
+  char next() {
+    if (_pos >= _blockEnd) {
+      if (_pos + 2 > _len) return 0;
+      uint16_t used = _data[_pos] | (uint16_t)_data[_pos + 1] << 8;
+      _pos += 2;
+      _blockEnd = _pos + used;
+      if (_blockEnd > _len) return '!';
+      if (used == 0) return next();
+    }
+    TraceCursor c(_data + _pos, _blockEnd - _pos);
+    char kind = (char)c.get8();
+    if (kind == TRACE_REC_KEY) {
+      traceDecodeKey(c, key);
+      _lastMs = key.ms;
+      _lastEpoch = key.epoch;
+      tick.tempC = key.tempC;
+      tick.humPct = key.humPct;
+      memset(_prevEcho, 0, sizeof(_prevEcho));
+    } else if (kind == TRACE_REC_TICK) {
+      tick.ms = _lastMs + c.getVar();
+      uint8_t f = c.get8();
+      tick.pir = f & 1;
+      tick.ahtValid = f & 2;
+      if (tick.ahtValid) { tick.tempC = c.getF(); tick.humPct = c.getF(); }
+      tick.epoch = _lastEpoch + ((f & 4) ? (uint32_t)c.getZig() : 0);
+      tick.nEcho = f >> 4;
+      if (tick.nEcho > ECHO_MAX_SAMPLES) return '!';
+      for (uint8_t i = 0; i < tick.nEcho; i++) {
+        _prevEcho[i] += (uint32_t)c.getZig();
+        tick.echoUs[i] = _prevEcho[i];
+      }
+      _lastMs = tick.ms;
+      _lastEpoch = tick.epoch;
+    } else if (kind == TRACE_REC_CMD) {
+      cmd.type = c.get8();
+      cmd.unit = c.get8();
+      cmd.value = c.getVar();
+      cmd.epoch = _lastEpoch + (uint32_t)c.getZig();
+      _lastEpoch = cmd.epoch;
+    } else {
+      return '!';
+    }
+    if (!c.ok) return '!';
+    _pos += c.pos;
+    return kind;
+  }
+
+private:
+  const uint8_t* _data = nullptr;
+  size_t _len = 0, _pos = 0, _blockEnd = 0;
+  uint32_t _lastMs = 0, _lastEpoch = 0;
+  uint32_t _prevEcho[ECHO_MAX_SAMPLES] = {};
+};
@@ -0,0 +1,162 @@
+#pragma once
+/*
+  Diffusion SSE partagée (remplace AsyncEventSource)
+  - Trames, files par client et statistiques : SseQueue (sse_queue.h, partagé
+    avec host/soak) ; ici le gestionnaire /events, le mutex et les rappels TCP.
+  - Nombre de clients borné (MAX_CLIENTS) : au-delà, /events répond 503.
+  - Sérialisation hors mutex : seules la prise d'une trame libre et la
+    distribution se font sous verrou.
+  - Tracé (perf_trace.h) : publication, puis envoi par client (arg = case).
+*/
+#include <Arduino.h>
+#include <AsyncTCP.h>
+#include <ESPAsyncWebServer.h>
+#include "perf_trace.h"
+#include "sse_queue.h"
+
+template<uint8_t MAX_CLIENTS, uint8_t QUEUE_DEPTH, uint16_t FRAME_BYTES>
+class SseFanout : public AsyncWebHandler {
+public:
+  explicit SseFanout(const char* url) : _url(url) {}
+
+  void begin() { _lock = xSemaphoreCreateMutex(); }
+
+  // Sérialise une fois et distribue à tous les clients connectés
+  void publish(const char* event, const char* payload, uint32_t id) {
+    PERF_SCOPE(PERF_SSE_PUBLISH);
+    lock();
+    SseFrame* f = _q.acquire();
+    unlock();
+    if (f == nullptr) return;
+    bool ok = Queue::fill(f, event, payload, id, millis());
+
+    lock();
+    if (ok) {
+      _q.distribute(f);
+      pumpAll();
+    } else {
+      _q.reject(f);
+    }
+    unlock();
+  }
+
+  uint8_t clientCount() const { return _q.clientCount(); }
+
+  // Fragment JSON pour /metrics : "sse":{...}
+  size_t printStats(char* out, size_t size) {
+    lock();
+    size_t len = _q.printStats(out, size, millis());
+    unlock();
+    return len;
+  }
+
+  // ---- AsyncWebHandler ----
+  bool canHandle(AsyncWebServerRequest* request) override {
+    return request->method() == HTTP_GET && request->url().equals(_url);
+  }
+
+  bool isRequestHandlerTrivial() override { return false; }
+
+  void handleRequest(AsyncWebServerRequest* request) override {
+    lock();
+    int slot = _q.reserve();
+    unlock();
+    if (slot < 0) {
+      request->send(503, "text/plain", "Trop de clients");
+      return;
+    }
+    request->send(new Response(this, (uint8_t)slot));
+  }
+
+private:
+  typedef SseQueue<MAX_CLIENTS, QUEUE_DEPTH, FRAME_BYTES, AsyncClient> Queue;
+
+  // En-tête HTTP, puis rattachement du socket au premier ACK (comme AsyncEventSource)
+  class Response : public AsyncWebServerResponse {
+  public:
+    Response(SseFanout* owner, uint8_t slot) : _owner(owner), _slot(slot) {
+      _code = 200;
+      _contentType = "text/event-stream";
+      _sendContentLength = false;
+      addHeader("Cache-Control", "no-cache");
+      addHeader("Connection", "keep-alive");
+    }
+    ~Response() {
+      if (!_attached) _owner->unreserve(_slot);  // requête avortée avant l'ACK
+    }
+    void _respond(AsyncWebServerRequest* request) override {
+      String head = _assembleHead(request->version());
+      request->client()->write(head.c_str(), _headLength);
+      _state = RESPONSE_WAIT_ACK;
+    }
+    size_t _ack(AsyncWebServerRequest* request, size_t len, uint32_t time) override {
+      (void)time;
+      if (len) {
+        _attached = true;
+        _owner->attach(_slot, request);  // détruit request (et donc cette réponse)
+      }
+      return 0;
+    }
+    bool _sourceValid() const override { return true; }
+  private:
+    SseFanout* _owner;
+    uint8_t _slot;
+    bool _attached = false;
+  };
+
+  void lock()   { xSemaphoreTake(_lock, portMAX_DELAY); }
+  void unlock() { xSemaphoreGive(_lock); }
+
+  void unreserve(uint8_t i) {
+    lock();
+    _q.unreserve(i);
+    unlock();
+  }
+
+  void attach(uint8_t i, AsyncWebServerRequest* request) {
+    AsyncClient* c = request->client();
+    c->setRxTimeout(0);
+    c->onError(NULL, NULL);
+    c->onData(NULL, NULL);
+    c->onAck([](void* arg, AsyncClient*, size_t, uint32_t) { ((SseFanout*)arg)->service(); }, this);
+    c->onPoll([](void* arg, AsyncClient*) { ((SseFanout*)arg)->service(); }, this);
+    c->onTimeout([](void*, AsyncClient* tcp, uint32_t) { tcp->close(true); }, nullptr);
+    c->onDisconnect([](void* arg, AsyncClient* tcp) {
+      ((SseFanout*)arg)->detach(tcp);
+      delete tcp;
+    }, this);
+
+    lock();
+    _q.attach(i, c);
+    pumpAll();
+    unlock();
+    delete request;
+  }
+
+  void detach(AsyncClient* tcp) {
+    lock();
+    _q.detach(tcp);
+    unlock();
+  }
+
+  // ACK/poll TCP : continuer à remplir les fenêtres d'envoi
+  void service() {
+    lock();
+    pumpAll();
+    unlock();
+  }
+
+  // Mutex pris
+  void pumpAll() {
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+      if (!_q.pending(i)) continue;
+      PERF_SCOPE_ARG(trace, PERF_SSE_SEND, i);
+      _q.pump(i, now);
+    }
+  }
+
+  const char* _url;
+  SemaphoreHandle_t _lock = nullptr;
+  Queue _q;
+};
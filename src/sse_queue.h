@@ -0,0 +1,225 @@
+#pragma once
+/*
+  Files de diffusion SSE (cœur de sse_fanout.h, sans serveur ni verrou)
+  - Le message est sérialisé UNE fois dans une trame immuable à compteur de
+    références ; chaque client ne garde que des pointeurs vers ces trames.
+  - Trames de taille fixe (FRAME_BYTES) recyclées par une liste libre : le tas
+    ne sert qu'à la montée en charge (trames vivantes au plus : dernière,
+    files des clients, trame en cours d'écriture), plus aucune allocation par
+    publication ensuite ; message plus long que la trame : refusé (tooLarge).
+  - Client lent : file de QUEUE_DEPTH trames, la plus ancienne est abandonnée.
+  - Statistiques par client : trames en attente, abandons, retard (publication
+    -> remise complète à TCP).
+  Tcp : space(), add(data, n), send(), connected() (AsyncClient sur la carte).
+  L'appelant sérialise les appels (mutex de SseFanout) ; seul fill() se passe
+  de verrou. Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+struct SseFrame {
+  uint16_t refs;         // protégé par le verrou de l'appelant
+  uint16_t len;
+  uint32_t publishedMs;
+  SseFrame* next;        // liste libre
+  char data[];           // "id: ..\nevent: ..\ndata: ..\n\n"
+};
+
+template<uint8_t MAX_CLIENTS, uint8_t QUEUE_DEPTH, uint16_t FRAME_BYTES, class Tcp>
+class SseQueue {
+  static_assert(QUEUE_DEPTH >= 2, "une trame en cours d'envoi ne doit pas être abandonnée");
+public:
+  // ---- Publication : acquire() -> fill() -> distribute() (ou reject()) ----
+  SseFrame* acquire() {
+    SseFrame* f = _free;
+    if (f) {
+      _free = f->next;
+      return f;
+    }
+    f = (SseFrame*)malloc(sizeof(SseFrame) + FRAME_BYTES);
+    if (f == nullptr) { _allocFailures++; return nullptr; }
+    _frames++;
+    return f;
+  }
+
+  // Sans verrou : la trame n'est encore partagée avec personne
+  static bool fill(SseFrame* f, const char* event, const char* payload, uint32_t id, uint32_t nowMs) {
+    int n = snprintf(f->data, FRAME_BYTES, "id: %u\nevent: %s\ndata: %s\n\n", (unsigned)id, event, payload);
+    if (n <= 0 || n >= FRAME_BYTES) return false;
+    f->len = (uint16_t)n;
+    f->refs = 1;  // référence "dernière trame"
+    f->publishedMs = nowMs;
+    return true;
+  }
+
+  void reject(SseFrame* f) {
+    _tooLarge++;
+    recycle(f);
+  }
+
+  // Devient la dernière trame et entre dans la file de chaque client actif
+  void distribute(SseFrame* f) {
+    if (_latest) release(_latest);
+    _latest = f;
+    _published++;
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+      if (_slots[i].state == SLOT_ACTIVE) push(_slots[i], f);
+    }
+  }
+
+  // Tout en un (appelant unique, sans contention : host/)
+  bool publish(const char* event, const char* payload, uint32_t id, uint32_t nowMs) {
+    SseFrame* f = acquire();
+    if (f == nullptr) return false;
+    if (!fill(f, event, payload, id, nowMs)) { reject(f); return false; }
+    distribute(f);
+    return true;
+  }
+
+  // ---- Clients : reserve() à la requête, attach() au socket, detach() ----
+  int reserve() {
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+      if (_slots[i].state == SLOT_FREE) { _slots[i].state = SLOT_PENDING; return i; }
+    }
+    _rejected++;
+    return -1;
+  }
+
+  void unreserve(uint8_t i) {
+    if (_slots[i].state == SLOT_PENDING) _slots[i].state = SLOT_FREE;
+  }
+
+  // État courant immédiat, sans re-sérialiser (envoyé par pump())
+  void attach(uint8_t i, Tcp* tcp) {
+    Slot& s = _slots[i];
+    s.tcp = tcp;
+    s.head = s.count = 0;
+    s.offset = 0;
+    s.sent = s.dropped = s.lagMs = s.maxLagMs = 0;
+    s.state = SLOT_ACTIVE;
+    if (_latest) push(s, _latest);
+  }
+
+  void detach(Tcp* tcp) {
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+      Slot& s = _slots[i];
+      if (s.state != SLOT_ACTIVE || s.tcp != tcp) continue;
+      while (s.count) pop(s);
+      s.tcp = nullptr;
+      s.state = SLOT_FREE;
+    }
+  }
+
+  // Trames en attente pour la case i (client actif)
+  bool pending(uint8_t i) const { return _slots[i].state == SLOT_ACTIVE && _slots[i].count; }
+
+  // Remplit la fenêtre d'envoi TCP de la case i
+  void pump(uint8_t i, uint32_t nowMs) {
+    Slot& s = _slots[i];
+    bool wrote = false;
+    while (s.count && s.tcp && s.tcp->connected()) {
+      SseFrame* f = s.queue[s.head];
+      size_t room = s.tcp->space();
+      if (room == 0) break;
+      size_t n = f->len - s.offset;
+      if (n > room) n = room;
+      size_t w = s.tcp->add(f->data + s.offset, n);
+      if (w == 0) break;
+      wrote = true;
+      s.offset += w;
+      if (s.offset < f->len) break;  // fenêtre TCP pleine
+      s.lagMs = nowMs - f->publishedMs;
+      if (s.lagMs > s.maxLagMs) s.maxLagMs = s.lagMs;
+      s.sent++;
+      pop(s);
+    }
+    if (wrote) s.tcp->send();
+  }
+
+  uint8_t clientCount() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) if (_slots[i].state == SLOT_ACTIVE) n++;
+    return n;
+  }
+
+  // Fragment JSON pour /metrics : "sse":{...}
+  size_t printStats(char* out, size_t size, uint32_t nowMs) const {
+    size_t len = 0;
+    auto put = [&](int w) { if (w > 0) len = (len + w < size) ? len + w : size - 1; };
+    put(snprintf(out, size,
+      "\"sse\":{\"clients\":%u,\"max\":%u,\"queue\":%u,\"published\":%u,\"rejected\":%u,\"allocFail\":%u,"
+      "\"tooLarge\":%u,\"frames\":%u,\"frameBytes\":%u,\"c\":[",
+      clientCount(), MAX_CLIENTS, QUEUE_DEPTH, (unsigned)_published, (unsigned)_rejected,
+      (unsigned)_allocFailures, (unsigned)_tooLarge, (unsigned)_frames, _latest ? _latest->len : 0));
+    bool first = true;
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+      const Slot& s = _slots[i];
+      if (s.state != SLOT_ACTIVE) continue;
+      uint32_t ageMs = s.count ? nowMs - s.queue[s.head]->publishedMs : 0;
+      put(snprintf(out + len, size - len,
+        "%s{\"q\":%u,\"sent\":%u,\"dropped\":%u,\"lagMs\":%u,\"maxLagMs\":%u,\"pendingMs\":%u}",
+        first ? "" : ",", s.count, (unsigned)s.sent, (unsigned)s.dropped,
+        (unsigned)s.lagMs, (unsigned)s.maxLagMs, (unsigned)ageMs));
+      first = false;
+    }
+    put(snprintf(out + len, size - len, "]}"));
+    return len;
+  }
+
+private:
+  enum SlotState : uint8_t { SLOT_FREE = 0, SLOT_PENDING, SLOT_ACTIVE };
+
+  struct Slot {
+    SlotState state = SLOT_FREE;
+    Tcp* tcp = nullptr;
+    SseFrame* queue[QUEUE_DEPTH];
+    uint8_t head = 0, count = 0;
+    uint16_t offset = 0;            // octets de queue[head] déjà remis à TCP
+    uint32_t sent = 0, dropped = 0;
+    uint32_t lagMs = 0, maxLagMs = 0;
+  };
+
+  void recycle(SseFrame* f) {
+    f->next = _free;
+    _free = f;
+  }
+
+  void release(SseFrame* f) {
+    if (--f->refs == 0) recycle(f);
+  }
+
+  void pop(Slot& s) {
+    release(s.queue[s.head]);
+    s.head = (s.head + 1) % QUEUE_DEPTH;
+    s.count--;
+    s.offset = 0;
+  }
+
+  void push(Slot& s, SseFrame* f) {
+    if (s.count == QUEUE_DEPTH) {
+      // Abandon de la plus ancienne ; si elle est en cours d'envoi, la suivante
+      uint8_t victim = (s.offset > 0 && QUEUE_DEPTH > 1) ? (s.head + 1) % QUEUE_DEPTH : s.head;
+      if (victim == s.head) {
+        pop(s);
+      } else {
+        release(s.queue[victim]);
+        for (uint8_t k = 1; k + 1 < s.count; k++) {
+          uint8_t a = (s.head + k) % QUEUE_DEPTH, b = (s.head + k + 1) % QUEUE_DEPTH;
+          s.queue[a] = s.queue[b];
+        }
+        s.count--;
+      }
+      s.dropped++;
+    }
+    f->refs++;
+    s.queue[(s.head + s.count) % QUEUE_DEPTH] = f;
+    s.count++;
+  }
+
+  Slot _slots[MAX_CLIENTS];
+  SseFrame* _latest = nullptr;
+  SseFrame* _free = nullptr;
+  uint32_t _published = 0, _rejected = 0, _allocFailures = 0, _tooLarge = 0;
+  uint16_t _frames = 0;             // trames allouées (liste libre comprise)
+};
@@ -0,0 +1,99 @@
+#pragma once
+/*
+  Sérialisation JSON de l'état (/status, SSE, Google Sheets)
+  Sans dépendance Arduino : partagée avec le stand-in natif de host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+// Une voie de la couche actionneurs (actuators.h)
+struct ChannelStatus {
+  const char* name;
+  const char* kind;     // "latched", "relay", "pwm"
+  bool on;
+  bool busy;            // impulsion en cours (vanne bistable)
+  uint32_t switches;
+};
+
+// Photographie de l'état au moment de la sérialisation
+struct StatusSnapshot {
+  int   level;          // % du volume utile
+  float distance;
+  float litres;
+  float capacity;       // litres au niveau "plein" de la table
+  bool  calibrated;     // table issue de l'assistant (sinon prismatique)
+  float temp;
+  float hum;
+  bool  pir;
+  bool  valve;
+  bool  pump;
+  const char* sincePir;        // "hh:mm:ss" ou "--:--:--"
+  const char* lastValveOnAgo;
+  const char* lastPumpOnAgo;
+  const char* uptime;
+  int   mode;
+  bool  ecoInClosedPhase;
+  uint32_t ecoDrainValue;
+  const char* ecoDrainUnit;    // "hours" ou "days"
+  const char* nextDrain;
+  bool  manualDrain;
+  const char* alerts;   // "", "leak", "inflow", "leak,inflow"
+  float slopeLph;       // pente du niveau, actionneurs fermés (0 si non jugée)
+  bool  safeStop;
+  const char* sensor;         // santé du capteur ultrason : "ok", "degraded", "failed"
+  const char* lastEchoAgo;    // depuis le dernier écho valide
+  const char* usage;          // objets de consommation "today":{...},... (consumption.h), "" si aucun
+  const ChannelStatus* channels;
+  uint8_t channelCount;
+};
+
+// Retourne la longueur écrite (tronquée à size-1 comme snprintf)
+inline int formatStatusJson(char* buf, size_t size, const StatusSnapshot& s) {
+  // JSON sans ArduinoJson pour rester léger
+  int n = snprintf(buf, size,
+    "{"
+      "\"level\":%d,"
+      "\"distance\":%.1f,"
+      "\"litres\":%.2f,"
+      "\"capacity\":%.2f,"
+      "\"calibrated\":%d,"
+      "\"temp\":%.1f,"
+      "\"hum\":%.0f,"
+      "\"pir\":%d,"
+      "\"valve\":%d,"
+      "\"pump\":%d,"
+      "\"sincePir\":\"%s\","
+      "\"lastValveOnAgo\":\"%s\","
+      "\"lastPumpOnAgo\":\"%s\","
+      "\"uptime\":\"%s\","
+      "\"mode\":%d,"
+      "\"ecoInClosedPhase\":%d,"
+      "\"ecoDrainValue\":%u,"
+      "\"ecoDrainUnit\":\"%s\","
+      "\"nextDrain\":\"%s\","
+      "\"manualDrain\":%s,"
+      "\"alerts\":\"%s\","
+      "\"slopeLph\":%.3f,"
+      "\"safeStop\":%s,"
+      "\"sensor\":\"%s\","
+      "\"lastEchoAgo\":\"%s\","
+      "\"usage\":{%s},"
+      "\"actuators\":[",
+    s.level, s.distance, s.litres, s.capacity, s.calibrated ? 1 : 0, s.temp, s.hum, s.pir ? 1 : 0, s.valve ? 1 : 0, s.pump ? 1 : 0,
+    s.sincePir, s.lastValveOnAgo, s.lastPumpOnAgo, s.uptime, s.mode,
+    s.ecoInClosedPhase ? 1 : 0, (unsigned)s.ecoDrainValue, s.ecoDrainUnit, s.nextDrain,
+    s.manualDrain ? "true" : "false", s.alerts, s.slopeLph, s.safeStop ? "true" : "false",
+    s.sensor, s.lastEchoAgo, s.usage
+  );
+  // Voies : [{"name":"EV1","kind":"latched","on":1,"busy":0,"switches":12},...]
+  for (uint8_t i = 0; i < s.channelCount && n >= 0; i++) {
+    const ChannelStatus& c = s.channels[i];
+    size_t used = (size_t)n < size ? (size_t)n : size;
+    n += snprintf(buf + used, size - used, "%s{\"name\":\"%s\",\"kind\":\"%s\",\"on\":%d,\"busy\":%d,\"switches\":%u}",
+                  i ? "," : "", c.name, c.kind, c.on ? 1 : 0, c.busy ? 1 : 0, (unsigned)c.switches);
+  }
+  if (n < 0) return n;
+  size_t used = (size_t)n < size ? (size_t)n : size;
+  return n + snprintf(buf + used, size - used, "]}");
+}
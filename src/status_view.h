@@ -0,0 +1,103 @@
+#pragma once
+/*
+  Réponses /status (et SSE, Sheets) et partie modules de /metrics
+  - Temps écoulés "hh:mm:ss" sur des FixedString (fmtHMS) : rien sur le tas
+  - buildStatusJson() : consommation, durées depuis les derniers événements,
+    prochaine vidange, puis formatStatusJson() (status_json.h)
+  - appendModuleMetrics() : fragments printStats des modules de contrôle
+  Le firmware (main.cpp) fournit les mesures, l'heure et les voies ; host/soak
+  appelle les mêmes fonctions. Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <math.h>
+#include "fixed_string.h"
+#include "status_json.h"
+#include "control.h"
+#include "schedule.h"
+#include "anomaly.h"
+#include "sensor_health.h"
+#include "display_power.h"
+#include "consumption.h"
+
+typedef FixedString<1536> StatusBuffer;
+typedef FixedString<3328> MetricsBuffer;
+
+inline HmsString uptimeStr(uint32_t nowMs) {
+  return fmtHMS(nowMs / 1000);
+}
+
+// Depuis whenMs (0 : jamais)
+inline HmsString agoFrom(uint32_t nowMs, uint32_t whenMs) {
+  if (whenMs == 0) return HmsString("--:--:--");
+  return fmtHMS((nowMs - whenMs) / 1000);
+}
+
+// Mesures et réglages hors modules, relevés par l'appelant
+struct StatusReadings {
+  uint32_t nowMs;
+  uint32_t epoch;            // heure courante (time())
+  float levelPct;
+  float distanceCm;
+  float levelLitres;
+  float fullLitres;          // calibration : litres au niveau "plein"
+  bool  calibCustom;
+  float temperatureC;
+  float humidityPct;
+  uint32_t ecoDrainValue;
+  const char* ecoDrainUnit;  // "hours" ou "days"
+};
+
+inline StatusBuffer buildStatusJson(const StatusReadings& r, const ControlState& ctl, const Scheduler& scheduler,
+                                    const AnomalyDetector& anomaly, const SensorHealthState& usHealth,
+                                    const ConsumptionMeter& usage, const ChannelStatus* channels, uint8_t channelCount) {
+  HmsString sincePir = agoFrom(r.nowMs, ctl.lastPirDetectMs);
+  HmsString lastValveOnAgo = agoFrom(r.nowMs, ctl.lastValveOnMs);
+  HmsString lastPumpOnAgo  = agoFrom(r.nowMs, ctl.lastPumpOnMs);
+  HmsString nextDrain("--:--:--");
+  if (ctl.drainDue) {
+    nextDrain.assign("00:00:00"); // Vidange due (ou différée par les heures calmes)
+  } else if (ctl.mode != MODE_OPEN_CYCLE) {
+    uint32_t at = scheduler.nextDrainAt();   // intervalle éco ou règle calendaire
+    if (at > r.epoch) nextDrain = fmtHMS(at - r.epoch);
+  }
+
+  HmsString uptime = uptimeStr(r.nowMs);
+  HmsString lastEchoAgo = agoFrom(r.nowMs, usHealth.lastGoodMs);
+  // Consommation : jour en cours en détail, modes en bref (comparaison éco / cycle ouvert)
+  FixedString<448> usageJson;
+  usageJson.setLength(usage.printTotals(usageJson.data(), usageJson.remaining() + 1, "today", usage.today()));
+  for (uint8_t m = 0; m < CONSUMPTION_MODES; m++) {
+    usageJson.append(',');
+    usageJson.setLength(usageJson.length() + usage.printTotals(usageJson.data() + usageJson.length(),
+                                                               usageJson.remaining() + 1, consumptionModeName(m), usage.mode(m), true));
+  }
+  StatusSnapshot snap = {
+    (int)lroundf(r.levelPct), r.distanceCm, r.levelLitres, r.fullLitres, r.calibCustom,
+    r.temperatureC, r.humidityPct,
+    ctl.pirState, ctl.valveOn, ctl.pumpOn,
+    sincePir.c_str(), lastValveOnAgo.c_str(), lastPumpOnAgo.c_str(), uptime.c_str(),
+    (int)ctl.mode, ctl.ecoInClosedPhase, r.ecoDrainValue, r.ecoDrainUnit,
+    nextDrain.c_str(), ctl.manualDrainActive,
+    anomalyNames(anomaly.alerts()), anomaly.slopeLph(), ctl.safeStop,
+    healthLevelName(usHealth.level), lastEchoAgo.c_str(), usageJson.c_str(),
+    channels, channelCount
+  };
+  StatusBuffer out;
+  int n = formatStatusJson(out.data(), StatusBuffer::capacity() + 1, snap);
+  out.setLength(n > 0 ? (size_t)n : 0);
+  return out;
+}
+
+// "anomaly":{..},"ultrasonic":{..},"aht":{..},"display":{..} (sans virgule finale)
+template<size_t N>
+void appendModuleMetrics(FixedString<N>& out, uint32_t nowMs, const AnomalyDetector& anomaly,
+                         const SensorHealthState& usHealth, const SensorHealthState& ahtHealth,
+                         const DisplayPower& displayPower) {
+  out.setLength(out.length() + anomaly.printStats(out.data() + out.length(), out.remaining() + 1));
+  out.append(',');
+  out.setLength(out.length() + healthPrintStats(out.data() + out.length(), out.remaining() + 1, "ultrasonic", usHealth, nowMs));
+  out.append(',');
+  out.setLength(out.length() + healthPrintStats(out.data() + out.length(), out.remaining() + 1, "aht", ahtHealth, nowMs));
+  out.append(',');
+  out.setLength(out.length() + displayPower.printStats(out.data() + out.length(), out.remaining() + 1, nowMs));
+}
@@ -0,0 +1,174 @@
+#pragma once
+/*
+  Roue de temporisation hiérarchique (résolution 1 s, heure murale epoch)
+  - 4 niveaux x 64 cases : échéances jusqu'à 2^24 s (~194 jours), au-delà
+    liste de débordement reclassée tous les 2^24 s
+  - Insertion / annulation O(1) ; avance O(1) par seconde écoulée, rien à
+    faire tant que la seconde ne change pas (appel à chaque tick possible)
+  - Nœuds en pool statique (pas de tas) ; saut d'horloge (NTP, réglage) :
+    reclassement complet autour de la nouvelle heure
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+
+template<uint8_t CAPACITY>
+class TimerWheel {
+  static_assert(CAPACITY < 255, "index 8 bits");
+public:
+  typedef uint8_t Handle;
+  static const Handle NONE = 0xFF;
+
+  struct Timer {
+    uint32_t at;     // epoch d'échéance
+    uint8_t kind;    // libre pour l'appelant
+    uint8_t arg;
+  };
+
+  TimerWheel() { reset(0); }
+
+  void reset(uint32_t now) {
+    _now = now;
+    for (uint8_t l = 0; l < LEVELS; l++)
+      for (uint8_t i = 0; i < SLOTS; i++) _slots[l][i] = NONE;
+    _overflow = _expired = NONE;
+    _free = NONE;
+    for (uint8_t i = CAPACITY; i-- > 0;) { _nodes[i].next = _free; _free = i; }
+    _count = 0;
+  }
+
+  // Échéance passée ou présente : déclenchée au prochain advance()
+  Handle add(uint32_t at, uint8_t kind, uint8_t arg) {
+    if (_free == NONE) return NONE;
+    Handle h = _free;
+    _free = _nodes[h].next;
+    _nodes[h].t = { at, kind, arg };
+    _nodes[h].list = nullptr;
+    place(h, false);
+    _count++;
+    return h;
+  }
+
+  bool cancel(Handle h) {
+    if (h >= CAPACITY || _nodes[h].list == nullptr) return false;
+    unlink(h);
+    _nodes[h].next = _free;
+    _free = h;
+    _count--;
+    return true;
+  }
+
+  bool pending(Handle h) const { return h < CAPACITY && _nodes[h].list != nullptr; }
+  const Timer& timer(Handle h) const { return _nodes[h].t; }
+  uint8_t count() const { return _count; }
+  uint32_t now() const { return _now; }
+
+  // fire(const Timer&) pour chaque échéance atteinte ; le minuteur est libéré
+  // avant l'appel (fire peut en ajouter d'autres)
+  template<class F>
+  void advance(uint32_t now, F fire) {
+    if ((int32_t)(now - _now) < 0 || now - _now > JUMP_MAX) rebase(now);
+    drain(_expired, fire);
+    while (_now != now) {
+      _now++;
+      uint8_t idx = _now & MASK;
+      if (idx == 0) cascade(1);
+      drain(_slots[0][idx], fire);
+    }
+  }
+
+  // Parcours des minuteurs actifs (inspection, /schedule)
+  template<class F>
+  void forEach(F fn) const {
+    for (uint8_t i = 0; i < CAPACITY; i++)
+      if (_nodes[i].list != nullptr) fn(i, _nodes[i].t);
+  }
+
+private:
+  static const uint8_t LEVELS = 4, BITS = 6, SLOTS = 1 << BITS, MASK = SLOTS - 1;
+  static const uint32_t JUMP_MAX = 4 * SLOTS;  // au-delà : reclassement plutôt que pas à pas
+
+  struct Node {
+    Timer t;
+    Handle next, prev;
+    Handle* list;    // tête de la liste contenant le nœud (nullptr = libre)
+  };
+
+  void push(Handle* list, Handle h) {
+    _nodes[h].list = list;
+    _nodes[h].prev = NONE;
+    _nodes[h].next = *list;
+    if (*list != NONE) _nodes[*list].prev = h;
+    *list = h;
+  }
+
+  void unlink(Handle h) {
+    Node& n = _nodes[h];
+    if (n.prev != NONE) _nodes[n.prev].next = n.next;
+    else *n.list = n.next;
+    if (n.next != NONE) _nodes[n.next].prev = n.prev;
+    n.list = nullptr;
+  }
+
+  // inAdvance : la case courante n'a pas encore été traitée (cascade)
+  void place(Handle h, bool inAdvance) {
+    uint32_t at = _nodes[h].t.at;
+    int32_t delta = (int32_t)(at - _now);
+    if (delta < 0 || (delta == 0 && !inAdvance)) { push(&_expired, h); return; }
+    uint32_t d = (uint32_t)delta;
+    for (uint8_t l = 0; l < LEVELS; l++) {
+      if (d < (1UL << (BITS * (l + 1)))) {
+        push(&_slots[l][(at >> (BITS * l)) & MASK], h);
+        return;
+      }
+    }
+    push(&_overflow, h);
+  }
+
+  // Redescend la case courante du niveau l (et au-dessus si elle revient à 0)
+  void cascade(uint8_t l) {
+    if (l >= LEVELS) {
+      relist(_overflow, true);
+      return;
+    }
+    uint8_t idx = (_now >> (BITS * l)) & MASK;
+    if (idx == 0) cascade(l + 1);
+    relist(_slots[l][idx], true);
+  }
+
+  void relist(Handle& list, bool inAdvance) {
+    Handle h = list;
+    list = NONE;
+    while (h != NONE) {
+      Handle next = _nodes[h].next;
+      _nodes[h].list = nullptr;
+      place(h, inAdvance);
+      h = next;
+    }
+  }
+
+  template<class F>
+  void drain(Handle& list, F& fire) {
+    while (list != NONE) {
+      Handle h = list;
+      Timer t = _nodes[h].t;
+      unlink(h);
+      _nodes[h].next = _free;
+      _free = h;
+      _count--;
+      fire(t);
+    }
+  }
+
+  void rebase(uint32_t now) {
+    _now = now;
+    for (uint8_t l = 0; l < LEVELS; l++)
+      for (uint8_t i = 0; i < SLOTS; i++) relist(_slots[l][i], false);
+    relist(_overflow, false);
+  }
+
+  Node _nodes[CAPACITY];
+  Handle _slots[LEVELS][SLOTS];
+  Handle _overflow, _expired, _free;
+  uint32_t _now;
+  uint8_t _count;
+};
@@ -0,0 +1,385 @@
+#pragma once
+/*
+  POST HTTPS avec connexion et session TLS conservées (envoi Google Sheets)
+  - mbedTLS directement : WiFiClientSecure + HTTPClient refaisaient une
+    poignée de main complète (échange de clés + chaîne de certificats, plusieurs
+    secondes à 80 MHz) à chaque envoi, et une seconde pour la redirection
+  - Keep-alive HTTP/1.1 : la connexion reste ouverte keepAliveMs après un
+    envoi ; fermée dès que le serveur la coupe (idle() le détecte) pour
+    rendre les ~20 Ko de tampons TLS au tas
+  - Reconnexion : reprise de session (ticket ou identifiant) -> poignée de
+    main abrégée, sans certificat ni calcul de clé publique
+  - Redirections : 301/308 mémorisées, les envois suivants vont directement
+    à la cible ; 307 suivie une fois. 302/303 : le POST a déjà été traité
+    (Apps Script répond 302 vers une page de résultat à usage unique), pas
+    de second envoi ni de mise en cache
+  - Statistiques : poignées de main (complètes / reprises, durée), octets
+    sur le fil (TLS compris) par envoi
+  Certificat serveur non vérifié (équivalent du setInsecure() précédent).
+*/
+#include <Arduino.h>
+#include "mbedtls/net_sockets.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/ssl_internal.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "fixed_string.h"
+
+#define TLS_IO_TIMEOUT_MS   8000   // connexion, poignée de main, lecture
+#define TLS_HOST_MAX        64
+#define TLS_URL_MAX         384
+
+class TlsUploader {
+public:
+  explicit TlsUploader(uint32_t keepAliveMs) : _keepAliveMs(keepAliveMs) {}
+  TlsUploader(const TlsUploader&) = delete;
+  TlsUploader& operator=(const TlsUploader&) = delete;
+
+  // Instances temporaires (banc de mesure) : connexion et contextes libérés
+  ~TlsUploader() {
+    close();
+    release();
+  }
+
+  // POST de body vers url (https://hôte[:port]/chemin?requête).
+  // Retourne le code HTTP final, ou < 0 (connexion / TLS / réponse invalide).
+  int post(const char* url, const char* contentType, const uint8_t* body, size_t len) {
+    if (!setup()) return -1;
+    uint32_t t0 = millis();
+    _lastTx = _lastRx = 0;
+    bool cached = _permanent.length() > 0;
+    int code = postOnce(cached ? _permanent.c_str() : url, contentType, body, len);
+    for (uint8_t hop = 0; hop < 2 && (code == 301 || code == 307 || code == 308) && _location.length(); hop++) {
+      FixedString<TLS_URL_MAX> next(_location.c_str());
+      if (code != 307) _permanent = next;   // permanente : les envois suivants y vont directement
+      code = postOnce(next.c_str(), contentType, body, len);
+    }
+    // Cible mémorisée qui ne répond plus : retour à l'URL configurée au prochain envoi
+    if (cached && (code < 0 || code >= 400)) _permanent.clear();
+    _uploads++;
+    if (code < 200 || code >= 400) _errors++;
+    _lastCode = code;
+    _lastUploadMs = millis() - t0;
+    _totalTx += _lastTx;
+    _totalRx += _lastRx;
+    return code;
+  }
+
+  // À chaque tour de boucle : ferme la connexion inactive (délai dépassé,
+  // ou coupée par le serveur : FIN / close_notify en attente de lecture)
+  void idle(uint32_t nowMs) {
+    if (!_open || nowMs - _lastPollMs < 1000) return;
+    _lastPollMs = nowMs;
+    if (nowMs - _lastUseMs >= _keepAliveMs || mbedtls_net_poll(&_net, MBEDTLS_NET_POLL_READ, 0) > 0) {
+      close();
+      _serverClosed++;
+    }
+  }
+
+  bool connected() const { return _open; }
+
+  // "<name>":{...} pour /metrics
+  size_t printStats(char* buf, size_t size, const char* name) const {
+    unsigned avgFull = _fullHandshakes ? (unsigned)(_fullMs / _fullHandshakes) : 0;
+    unsigned avgResumed = _resumedHandshakes ? (unsigned)(_resumedMs / _resumedHandshakes) : 0;
+    int w = snprintf(buf, size,
+      "\"%s\":{\"uploads\":%u,\"errors\":%u,\"lastCode\":%d,\"lastUploadMs\":%u,\"open\":%s,"
+      "\"reused\":%u,\"fullHandshakes\":%u,\"resumedHandshakes\":%u,\"lastHandshakeMs\":%u,"
+      "\"avgFullMs\":%u,\"avgResumedMs\":%u,\"lastTxBytes\":%u,\"lastRxBytes\":%u,"
+      "\"totalTxBytes\":%u,\"totalRxBytes\":%u,\"serverClosed\":%u,\"redirectCached\":%s}",
+      name, (unsigned)_uploads, (unsigned)_errors, _lastCode, (unsigned)_lastUploadMs, _open ? "true" : "false",
+      (unsigned)_reused, (unsigned)_fullHandshakes, (unsigned)_resumedHandshakes, (unsigned)_lastHandshakeMs,
+      avgFull, avgResumed, (unsigned)_lastTx, (unsigned)_lastRx,
+      (unsigned)_totalTx, (unsigned)_totalRx, (unsigned)_serverClosed, _permanent.length() ? "true" : "false");
+    if (w < 0) return 0;
+    return (size_t)w < size ? (size_t)w : size - 1;
+  }
+
+private:
+  struct Url {
+    char host[TLS_HOST_MAX];
+    char port[6];
+    const char* path;   // dans la chaîne d'origine
+  };
+
+  static bool parseUrl(const char* url, Url& u) {
+    if (strncmp(url, "https://", 8) != 0) return false;
+    const char* h = url + 8;
+    const char* end = h + strcspn(h, ":/?");
+    size_t n = end - h;
+    if (n == 0 || n >= sizeof(u.host)) return false;
+    memcpy(u.host, h, n);
+    u.host[n] = '\0';
+    strcpy(u.port, "443");
+    if (*end == ':') {
+      size_t p = strspn(end + 1, "0123456789");
+      if (p == 0 || p >= sizeof(u.port)) return false;
+      memcpy(u.port, end + 1, p);
+      u.port[p] = '\0';
+      end += 1 + p;
+    }
+    u.path = *end == '/' ? end : "/";
+    if (*end == '?') u.path = end;   // "https://hôte?x" : requête sans chemin (rare)
+    return true;
+  }
+
+  // Contexte commun (RNG, configuration) : une fois, gardé ensuite
+  bool setup() {
+    if (_ready) return true;
+    _initialized = true;
+    mbedtls_entropy_init(&_entropy);
+    mbedtls_ctr_drbg_init(&_drbg);
+    mbedtls_ssl_config_init(&_conf);
+    mbedtls_ssl_session_init(&_session);
+    if (mbedtls_ctr_drbg_seed(&_drbg, mbedtls_entropy_func, &_entropy, nullptr, 0) != 0 ||
+        mbedtls_ssl_config_defaults(&_conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                    MBEDTLS_SSL_PRESET_DEFAULT) != 0) {
+      release();   // nouvel essai au prochain envoi
+      return false;
+    }
+    mbedtls_ssl_conf_authmode(&_conf, MBEDTLS_SSL_VERIFY_NONE);
+    mbedtls_ssl_conf_rng(&_conf, mbedtls_ctr_drbg_random, &_drbg);
+    mbedtls_ssl_conf_read_timeout(&_conf, TLS_IO_TIMEOUT_MS);
+    mbedtls_ssl_conf_session_tickets(&_conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+    _ready = true;
+    return true;
+  }
+
+  void release() {
+    if (!_initialized) return;
+    mbedtls_ssl_session_free(&_session);
+    mbedtls_ssl_config_free(&_conf);
+    mbedtls_ctr_drbg_free(&_drbg);
+    mbedtls_entropy_free(&_entropy);
+    _initialized = _ready = _haveSession = false;
+  }
+
+  int postOnce(const char* url, const char* contentType, const uint8_t* body, size_t len) {
+    Url u;
+    if (!parseUrl(url, u)) return -2;
+    // Connexion ouverte vers le même hôte : réutilisée (une nouvelle tentative si le
+    // serveur l'a fermée entre-temps sans qu'idle() l'ait encore vu)
+    for (uint8_t attempt = 0; attempt < 2; attempt++) {
+      bool reuse = _open && strcmp(_host, u.host) == 0 && strcmp(_port, u.port) == 0 &&
+                   mbedtls_net_poll(&_net, MBEDTLS_NET_POLL_READ, 0) == 0;
+      if (!reuse) {
+        close();
+        if (!open(u)) return -3;
+      } else {
+        _reused++;
+      }
+      FixedString<TLS_URL_MAX + 192> head;
+      head.appendf("POST %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: Fontaine\r\nContent-Type: %s\r\n"
+                   "Content-Length: %u\r\nConnection: keep-alive\r\n\r\n",
+                   u.path, u.host, contentType, (unsigned)len);
+      if (head.truncated()) return -2;
+      if (!writeAll((const uint8_t*)head.c_str(), head.length()) || !writeAll(body, len)) {
+        close();
+        if (reuse) continue;   // connexion morte : rien n'a été reçu, on renvoie
+        return -4;
+      }
+      _rxPos = _rxLen = 0;
+      _gotBytes = false;
+      int code = readResponse();
+      if (code < 0) {
+        close();
+        if (reuse && !_gotBytes) continue;
+        return code;
+      }
+      _lastUseMs = millis();
+      return code;
+    }
+    return -3;
+  }
+
+  bool open(const Url& u) {
+    mbedtls_net_init(&_net);
+    if (mbedtls_net_connect(&_net, u.host, u.port, MBEDTLS_NET_PROTO_TCP) != 0) {
+      mbedtls_net_free(&_net);
+      return false;
+    }
+    mbedtls_ssl_init(&_ssl);
+    if (mbedtls_ssl_setup(&_ssl, &_conf) != 0 || mbedtls_ssl_set_hostname(&_ssl, u.host) != 0) {
+      mbedtls_ssl_free(&_ssl);
+      mbedtls_net_free(&_net);
+      return false;
+    }
+    mbedtls_ssl_set_bio(&_ssl, this, sendCb, nullptr, recvCb);
+    bool offered = _haveSession && strcmp(_sessionHost, u.host) == 0;
+    if (offered) mbedtls_ssl_set_session(&_ssl, &_session);
+
+    // Pas à pas pour savoir si le serveur a accepté la reprise (drapeau
+    // interne, libéré avec la structure de poignée de main à la fin)
+    uint32_t t0 = millis();
+    bool resumed = false;
+    while (_ssl.state != MBEDTLS_SSL_HANDSHAKE_OVER) {
+      int r = mbedtls_ssl_handshake_step(&_ssl);
+      if (_ssl.handshake != nullptr) resumed = _ssl.handshake->resume != 0;
+      if (r == MBEDTLS_ERR_SSL_WANT_READ || r == MBEDTLS_ERR_SSL_WANT_WRITE) r = 0;
+      if (r != 0 || millis() - t0 > TLS_IO_TIMEOUT_MS) {
+        mbedtls_ssl_free(&_ssl);
+        mbedtls_net_free(&_net);
+        if (offered) _haveSession = false;   // session refusée ou corrompue : repartir de zéro
+        return false;
+      }
+    }
+    _lastHandshakeMs = millis() - t0;
+    if (resumed) { _resumedHandshakes++; _resumedMs += _lastHandshakeMs; }
+    else         { _fullHandshakes++;    _fullMs += _lastHandshakeMs; }
+
+    // Session (et ticket éventuel) gardée pour la prochaine connexion
+    mbedtls_ssl_session_free(&_session);
+    mbedtls_ssl_session_init(&_session);
+    _haveSession = mbedtls_ssl_get_session(&_ssl, &_session) == 0;
+    strcpy(_sessionHost, u.host);
+    strcpy(_host, u.host);
+    strcpy(_port, u.port);
+    _open = true;
+    _lastUseMs = _lastPollMs = millis();
+    return true;
+  }
+
+  void close() {
+    if (!_open) return;
+    mbedtls_ssl_close_notify(&_ssl);
+    mbedtls_ssl_free(&_ssl);
+    mbedtls_net_free(&_net);
+    _open = false;
+  }
+
+  // ---- E/S : octets comptés au niveau socket (enregistrements TLS compris) ----
+  static int sendCb(void* ctx, const unsigned char* buf, size_t len) {
+    TlsUploader* self = (TlsUploader*)ctx;
+    int r = mbedtls_net_send(&self->_net, buf, len);
+    if (r > 0) self->_lastTx += r;
+    return r;
+  }
+
+  static int recvCb(void* ctx, unsigned char* buf, size_t len, uint32_t timeoutMs) {
+    TlsUploader* self = (TlsUploader*)ctx;
+    int r = mbedtls_net_recv_timeout(&self->_net, buf, len, timeoutMs);
+    if (r > 0) self->_lastRx += r;
+    return r;
+  }
+
+  bool writeAll(const uint8_t* p, size_t n) {
+    while (n > 0) {
+      int r = mbedtls_ssl_write(&_ssl, p, n);
+      if (r == MBEDTLS_ERR_SSL_WANT_READ || r == MBEDTLS_ERR_SSL_WANT_WRITE) continue;
+      if (r <= 0) return false;
+      p += r;
+      n -= r;
+    }
+    return true;
+  }
+
+  // Octet suivant de la réponse (-1 : fin ou erreur)
+  int readByte() {
+    if (_rxPos == _rxLen) {
+      int r;
+      do r = mbedtls_ssl_read(&_ssl, _rx, sizeof(_rx));
+      while (r == MBEDTLS_ERR_SSL_WANT_READ || r == MBEDTLS_ERR_SSL_WANT_WRITE);
+      if (r <= 0) return -1;
+      _gotBytes = true;
+      _rxPos = 0;
+      _rxLen = r;
+    }
+    return _rx[_rxPos++];
+  }
+
+  // Ligne sans CRLF, tronquée à size-1 ; false : connexion fermée
+  bool readLine(char* buf, size_t size) {
+    size_t n = 0;
+    for (;;) {
+      int c = readByte();
+      if (c < 0) return false;
+      if (c == '\n') break;
+      if (c != '\r' && n + 1 < size) buf[n++] = (char)c;
+    }
+    buf[n] = '\0';
+    return true;
+  }
+
+  bool skip(uint32_t n) {
+    while (n--) if (readByte() < 0) return false;
+    return true;
+  }
+
+  // Statut + en-têtes ; corps lu et jeté (la connexion doit être vidée pour resservir)
+  int readResponse() {
+    char line[TLS_URL_MAX + 16];
+    int code = 0;
+    if (!readLine(line, sizeof(line)) || sscanf(line, "HTTP/%*d.%*d %d", &code) != 1) return -5;
+    int32_t length = -1;
+    bool chunked = false, keepAlive = true;
+    _location.clear();
+    for (;;) {
+      if (!readLine(line, sizeof(line))) return -5;
+      if (line[0] == '\0') break;
+      const char* v = strchr(line, ':');
+      if (v == nullptr) continue;
+      v++;
+      while (*v == ' ') v++;
+      if (strncasecmp(line, "Content-Length:", 15) == 0) length = atol(v);
+      else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0) chunked = strcasestr(v, "chunked") != nullptr;
+      else if (strncasecmp(line, "Connection:", 11) == 0) keepAlive = strcasestr(v, "close") == nullptr;
+      else if (strncasecmp(line, "Location:", 9) == 0 && strncmp(v, "https://", 8) == 0) _location.assign(v);
+    }
+    if (_location.truncated()) _location.clear();   // URL trop longue : on ne la suit pas
+
+    bool complete;
+    if (code == 204 || code == 304 || (code >= 100 && code < 200)) {
+      complete = true;
+    } else if (chunked) {
+      complete = false;
+      for (;;) {
+        if (!readLine(line, sizeof(line))) break;
+        uint32_t n = strtoul(line, nullptr, 16);
+        if (n == 0) {
+          while (readLine(line, sizeof(line)) && line[0] != '\0') {}   // en-têtes de fin
+          complete = true;
+          break;
+        }
+        if (!skip(n) || !readLine(line, sizeof(line))) break;
+      }
+    } else if (length >= 0) {
+      complete = skip(length);
+    } else {
+      while (readByte() >= 0) {}   // corps jusqu'à la fermeture
+      complete = false;
+    }
+    if (!complete || !keepAlive) close();
+    return code;
+  }
+
+  // Configuration / contexte
+  uint32_t _keepAliveMs;
+  bool _initialized = false, _ready = false;
+  mbedtls_entropy_context _entropy;
+  mbedtls_ctr_drbg_context _drbg;
+  mbedtls_ssl_config _conf;
+  mbedtls_ssl_session _session;
+  bool _haveSession = false;
+  char _sessionHost[TLS_HOST_MAX] = "";
+
+  // Connexion
+  mbedtls_net_context _net;
+  mbedtls_ssl_context _ssl;
+  bool _open = false;
+  char _host[TLS_HOST_MAX] = "", _port[6] = "";
+  uint32_t _lastUseMs = 0, _lastPollMs = 0;
+  uint8_t _rx[256];
+  size_t _rxPos = 0, _rxLen = 0;
+  bool _gotBytes = false;
+  FixedString<TLS_URL_MAX> _location;    // Location de la dernière réponse
+  FixedString<TLS_URL_MAX> _permanent;   // cible d'une redirection permanente
+
+  // Statistiques
+  uint32_t _uploads = 0, _errors = 0, _reused = 0, _serverClosed = 0;
+  int _lastCode = 0;
+  uint32_t _lastUploadMs = 0, _lastHandshakeMs = 0;
+  uint32_t _fullHandshakes = 0, _resumedHandshakes = 0;
+  uint64_t _fullMs = 0, _resumedMs = 0;
+  uint32_t _lastTx = 0, _lastRx = 0;
+  uint64_t _totalTx = 0, _totalRx = 0;
+};
@@ -0,0 +1,197 @@
+#pragma once
+/*
+  Visites apprises (PIR) : pré-remplissage du cycle ouvert avant les heures de passage
+  - Histogramme hebdomadaire de 7 x 96 créneaux de 15 min (heure locale) :
+    nombre de semaines où le créneau a vu au moins une détection (672 octets)
+  - Oubli progressif : au-delà de VISIT_MAX_WEEKS semaines, compteurs et
+    semaines divisés par deux (les habitudes qui changent prennent le dessus)
+  - Créneau attendu : visité dans au moins minPct % des semaines observées
+    (après minWeeks semaines). update() annonce un créneau attendu leadMin à
+    l'avance ; l'appelant en fait une autorisation de remplissage (CMD_PREFILL)
+  - Réussite : une visite pendant la fenêtre annoncée (holdMin) ; les visites
+    hors créneau attendu sont comptées à part
+  - Image persistante de VISIT_IMAGE_SIZE octets (save / load, somme de contrôle)
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include "byte_codec.h"
+
+#define VISIT_SLOT_MIN       15
+#define VISIT_SLOTS_PER_DAY  (1440 / VISIT_SLOT_MIN)
+#define VISIT_SLOTS          (7 * VISIT_SLOTS_PER_DAY)
+#define VISIT_MAX_WEEKS      8
+#define VISIT_MAGIC          0x31534956u   // "VIS1"
+#define VISIT_IMAGE_SIZE     (4 + 2 + 2 + 4 * 4 + VISIT_SLOTS + 4)
+#define VISIT_JSON_RANGES    32            // plages listées par /visits
+
+struct VisitModelParams {
+  uint8_t minWeeks;    // semaines observées avant la première annonce
+  uint8_t minPct;      // % des semaines avec une visite dans le créneau
+  uint16_t leadMin;    // avance de l'annonce sur le créneau
+  uint16_t holdMin;    // durée de l'autorisation (et de la fenêtre de réussite)
+};
+
+class VisitModel {
+public:
+  explicit VisitModel(const VisitModelParams& p) : _p(p) { clear(); }
+
+  void clear() {
+    memset(_counts, 0, sizeof(_counts));
+    _weeks = 0;
+    _curSlot = -1;
+    _countedAbs = _announcedAbs = 0;
+    _windowEnd = 0;
+    _windowHit = false;
+    _visits = _announced = _hits = _unexpected = 0;
+    _dirty = true;
+  }
+
+  // Depuis un handler HTTP : appliqué par update() dans la boucle
+  void requestClear() { _clearRequested = true; }
+
+  // Créneau (0 = dimanche 00:00) d'une heure murale, heure locale
+  static int slotOf(uint32_t epoch) {
+    time_t t = epoch;
+    struct tm tm;
+    localtime_r(&t, &tm);
+    return tm.tm_wday * VISIT_SLOTS_PER_DAY + (tm.tm_hour * 60 + tm.tm_min) / VISIT_SLOT_MIN;
+  }
+
+  bool expected(int slot) const {
+    return _weeks >= _p.minWeeks && _counts[slot] * 100u >= (unsigned)_p.minPct * _weeks;
+  }
+
+  // Détection PIR (chaque tick où il est actif) : une visite par créneau
+  void onDetect(uint32_t epoch) {
+    uint32_t abs = epoch / (VISIT_SLOT_MIN * 60);
+    if (abs == _countedAbs) return;
+    _countedAbs = abs;
+    int slot = slotOf(epoch);
+    _visits++;
+    if (_counts[slot] < 255) _counts[slot]++;
+    _dirty = true;
+    if (_windowEnd && (int32_t)(_windowEnd - epoch) > 0) {
+      if (!_windowHit) _hits++;
+      _windowHit = true;
+    } else if (!expected(slot)) {
+      _unexpected++;
+    }
+  }
+
+  // Une fois par tick (heure valide) ; secondes d'autorisation à accorder, 0 sinon.
+  // Créneaux attendus consécutifs : la fenêtre est prolongée, une seule annonce comptée.
+  uint32_t update(uint32_t epoch) {
+    if (_clearRequested.exchange(false)) clear();
+    int slot = slotOf(epoch);
+    if (_curSlot >= 0 && _curSlot - slot > VISIT_SLOTS / 2) newWeek();   // samedi -> dimanche
+    _curSlot = slot;
+    if (_windowEnd && (int32_t)(epoch - _windowEnd) >= 0) _windowEnd = 0;
+
+    uint32_t ahead = epoch + _p.leadMin * 60u;
+    uint32_t abs = ahead / (VISIT_SLOT_MIN * 60);
+    if (abs == _announcedAbs) return 0;
+    _announcedAbs = abs;
+    if (!expected(slotOf(ahead))) return 0;
+    if (_windowEnd == 0) {
+      _announced++;
+      _windowHit = false;
+      _dirty = true;
+    }
+    uint32_t holdSec = _p.holdMin * 60u;
+    _windowEnd = epoch + holdSec;
+    return holdSec;
+  }
+
+  bool dirty() const { return _dirty; }
+  uint16_t weeks() const { return _weeks; }
+  uint8_t count(int slot) const { return _counts[slot]; }
+
+  // Image : magic, semaines, créneau courant, visites, annonces, réussites,
+  // hors créneau, compteurs, somme des octets précédents
+  size_t save(uint8_t* out) {
+    size_t n = 0;
+    leAppend(out, n, VISIT_MAGIC, 4);
+    leAppend(out, n, _weeks, 2);
+    leAppend(out, n, (uint16_t)_curSlot, 2);
+    leAppend(out, n, _visits, 4);
+    leAppend(out, n, _announced, 4);
+    leAppend(out, n, _hits, 4);
+    leAppend(out, n, _unexpected, 4);
+    memcpy(out + n, _counts, VISIT_SLOTS);
+    n += VISIT_SLOTS;
+    leAppend(out, n, fnv1a(out, n), 4);
+    _dirty = false;
+    return n;
+  }
+
+  bool load(const uint8_t* in, size_t len) {
+    if (len != VISIT_IMAGE_SIZE || leGet(in, 4) != VISIT_MAGIC) return false;
+    if (leGet(in + len - 4, 4) != fnv1a(in, len - 4)) return false;
+    _weeks = leGet(in + 4, 2);
+    _curSlot = (int16_t)leGet(in + 6, 2);
+    if (_curSlot >= VISIT_SLOTS) _curSlot = -1;
+    _visits = leGet(in + 8, 4);
+    _announced = leGet(in + 12, 4);
+    _hits = leGet(in + 16, 4);
+    _unexpected = leGet(in + 20, 4);
+    memcpy(_counts, in + 24, VISIT_SLOTS);
+    _dirty = false;
+    return true;
+  }
+
+  // /visits : compteurs et créneaux attendus, en plages par jour
+  size_t printJson(char* buf, size_t size) const {
+    static const char* const days[] = { "sun", "mon", "tue", "wed", "thu", "fri", "sat" };
+    int n = snprintf(buf, size,
+      "{\"weeks\":%u,\"ready\":%s,\"visits\":%u,\"announced\":%u,\"hits\":%u,\"hitRate\":%.2f,"
+      "\"unexpected\":%u,\"window\":%s,\"expected\":[",
+      (unsigned)_weeks, _weeks >= _p.minWeeks ? "true" : "false", (unsigned)_visits,
+      (unsigned)_announced, (unsigned)_hits, _announced ? (float)_hits / _announced : 0.0f,
+      (unsigned)_unexpected, _windowEnd ? "true" : "false");
+    uint8_t ranges = 0;
+    bool truncated = false;
+    for (int d = 0; d < 7 && n >= 0; d++) {
+      for (int s = 0; s < VISIT_SLOTS_PER_DAY; s++) {
+        int base = d * VISIT_SLOTS_PER_DAY;
+        if (!expected(base + s) || (s > 0 && expected(base + s - 1))) continue;
+        int e = s;
+        while (e + 1 < VISIT_SLOTS_PER_DAY && expected(base + e + 1)) e++;
+        if (ranges == VISIT_JSON_RANGES) { truncated = true; break; }
+        int from = s * VISIT_SLOT_MIN, to = (e + 1) * VISIT_SLOT_MIN;
+        size_t used = (size_t)n < size ? (size_t)n : size;
+        n += snprintf(buf + used, size - used, "%s{\"day\":\"%s\",\"from\":\"%02d:%02d\",\"to\":\"%02d:%02d\"}",
+                      ranges ? "," : "", days[d], from / 60, from % 60, to / 60, to % 60);
+        ranges++;
+      }
+    }
+    if (n < 0) return 0;
+    size_t used = (size_t)n < size ? (size_t)n : size;
+    n += snprintf(buf + used, size - used, "],\"truncated\":%s}", truncated ? "true" : "false");
+    return (size_t)n < size ? (size_t)n : size - 1;
+  }
+
+private:
+  void newWeek() {
+    _weeks++;
+    if (_weeks > VISIT_MAX_WEEKS) {
+      for (int i = 0; i < VISIT_SLOTS; i++) _counts[i] /= 2;
+      _weeks /= 2;
+    }
+    _dirty = true;
+  }
+
+  VisitModelParams _p;
+  uint8_t _counts[VISIT_SLOTS];
+  uint16_t _weeks;
+  int16_t _curSlot;
+  uint32_t _countedAbs, _announcedAbs;   // créneaux absolus (epoch / 900) déjà traités
+  uint32_t _windowEnd;                   // fin de la fenêtre annoncée (epoch), 0 = aucune
+  bool _windowHit;
+  uint32_t _visits, _announced, _hits, _unexpected;
+  bool _dirty;
+  std::atomic<bool> _clearRequested{false};
+};
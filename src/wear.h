@@ -0,0 +1,177 @@
+#pragma once
+/*
+  Usure des actionneurs : compteurs de cycles persistants et anti-court-cycle
+  - Cycle = passage à ON (relais, pompe, ouverture de vanne bistable)
+  - Durées minimales ON / OFF : une commutation trop rapprochée est différée
+    (l'appelant la redemande au tick suivant), jamais perdue
+  - Commutations par heure : seau à jetons de maxPerHour jetons, un jeton
+    rendu toutes les 3600 / maxPerHour s ; seuls les passages à ON en
+    consomment (couper reste toujours possible)
+  - Vie restante : cycles nominaux moins cycles comptés, au rythme moyen
+    observé depuis le premier comptage (heure murale)
+  - Image persistante : magic, N x (cycles, différées, premier epoch), somme
+  Sans dépendance Arduino : utilisable dans host/.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include "byte_codec.h"
+
+#define WEAR_MAGIC        0x31524557u   // "WER1"
+#define WEAR_RECORD_SIZE  12
+#define WEAR_IMAGE_SIZE(n) (4 + 1 + (size_t)(n) * WEAR_RECORD_SIZE + 4)
+#define WEAR_EPOCH_MIN    1704067200u   // heure murale valide (NTP)
+
+struct WearLimits {
+  uint32_t minOnMs;      // ON au moins ce temps avant de couper (0 : coupure immédiate)
+  uint32_t minOffMs;     // OFF au moins ce temps avant de rallumer
+  uint16_t maxPerHour;   // passages à ON par heure (0 : sans limite)
+  uint32_t ratedCycles;  // durée de vie nominale (fiche technique)
+};
+
+enum WearBlock : uint8_t {
+  WEAR_OK = 0,
+  WEAR_MIN_ON,
+  WEAR_MIN_OFF,
+  WEAR_RATE
+};
+
+inline const char* wearBlockName(uint8_t b) {
+  static const char* const names[] = { "", "minOn", "minOff", "rate" };
+  return b <= WEAR_RATE ? names[b] : "?";
+}
+
+class WearCounter {
+public:
+  void configure(const WearLimits& l) {
+    _l = l;
+    _tokensMs = bucketMs();
+  }
+
+  // Depuis un handler HTTP (matériel remplacé) : appliqué par stamp() dans la boucle
+  void requestReset() { _resetRequested = true; }
+
+  // Chaque tick : heure murale du premier comptage, remise à zéro demandée
+  void stamp(uint32_t epoch) {
+    if (_resetRequested.exchange(false)) {
+      _cycles = _deferred = 0;
+      _firstEpoch = 0;
+      _dirty = true;
+    }
+    if (_firstEpoch == 0 && epoch >= WEAR_EPOCH_MIN) {
+      _firstEpoch = epoch;
+      _dirty = true;
+    }
+  }
+
+  // Commutation vers `on` autorisée maintenant ? Sinon la cause ; un report
+  // n'est compté qu'une fois jusqu'à la commutation ou l'abandon
+  uint8_t check(bool on, uint32_t nowMs) {
+    refill(nowMs);
+    uint8_t why = WEAR_OK;
+    uint32_t held = nowMs - _changedMs;
+    if (!on && held < _l.minOnMs) why = WEAR_MIN_ON;
+    else if (on && _switched && held < _l.minOffMs) why = WEAR_MIN_OFF;
+    else if (on && _l.maxPerHour && _tokensMs < costMs()) why = WEAR_RATE;
+    if (why && !_block) {
+      _deferred++;
+      _dirty = true;
+    }
+    _block = why;
+    return why;
+  }
+
+  // La voie rejoint déjà la décision : plus de report en cours
+  void settle() { _block = WEAR_OK; }
+
+  // Commutation effective de la voie
+  void record(bool on, uint32_t nowMs) {
+    refill(nowMs);
+    _changedMs = nowMs;
+    _switched = true;
+    _block = WEAR_OK;
+    if (!on) return;
+    _cycles++;
+    _dirty = true;
+    if (_l.maxPerHour) _tokensMs = _tokensMs > costMs() ? _tokensMs - costMs() : 0;
+  }
+
+  uint32_t cycles() const { return _cycles; }
+  uint32_t deferred() const { return _deferred; }
+  uint8_t blocking() const { return _block; }
+  bool dirty() const { return _dirty; }
+
+  // Cycles par jour depuis le premier comptage ; < 0 avant une journée d'observation
+  float cyclesPerDay(uint32_t epoch) const {
+    if (_firstEpoch == 0 || epoch < _firstEpoch + 86400u) return -1;
+    return _cycles * 86400.0f / (epoch - _firstEpoch);
+  }
+
+  // Jours de vie restants au rythme observé ; < 0 : inconnu (pas de rythme)
+  float daysLeft(uint32_t epoch) const {
+    float perDay = cyclesPerDay(epoch);
+    if (perDay <= 0) return -1;
+    return _cycles >= _l.ratedCycles ? 0 : (_l.ratedCycles - _cycles) / perDay;
+  }
+
+  size_t printJson(char* buf, size_t size, const char* name, uint32_t epoch) const {
+    int n = snprintf(buf, size,
+      "{\"name\":\"%s\",\"cycles\":%u,\"rated\":%u,\"usedPct\":%.2f,\"perDay\":%.1f,\"daysLeft\":%.0f,"
+      "\"deferred\":%u,\"blocking\":\"%s\",\"minOnS\":%.1f,\"minOffS\":%.1f,\"maxPerHour\":%u}",
+      name, (unsigned)_cycles, (unsigned)_l.ratedCycles,
+      _l.ratedCycles ? 100.0f * _cycles / _l.ratedCycles : 0.0f,
+      cyclesPerDay(epoch), daysLeft(epoch), (unsigned)_deferred, wearBlockName(_block),
+      _l.minOnMs / 1000.0f, _l.minOffMs / 1000.0f, (unsigned)_l.maxPerHour);
+    if (n < 0) return 0;
+    return (size_t)n < size ? (size_t)n : size - 1;
+  }
+
+  // Enregistrement de WEAR_RECORD_SIZE octets (petit-boutiste)
+  void save(uint8_t* out) {
+    lePut(out, _cycles);
+    lePut(out + 4, _deferred);
+    lePut(out + 8, _firstEpoch);
+    _dirty = false;
+  }
+  void load(const uint8_t* in) {
+    _cycles = leGet(in);
+    _deferred = leGet(in + 4);
+    _firstEpoch = leGet(in + 8);
+    _dirty = false;
+  }
+
+private:
+  uint32_t costMs() const { return 3600000UL / _l.maxPerHour; }
+  uint32_t bucketMs() const { return _l.maxPerHour ? 3600000UL : 0; }
+
+  void refill(uint32_t nowMs) {
+    uint32_t dt = nowMs - _refillMs;
+    _refillMs = nowMs;
+    _tokensMs = bucketMs() - _tokensMs > dt ? _tokensMs + dt : bucketMs();
+  }
+
+  WearLimits _l = { 0, 0, 0, 100000 };
+  uint32_t _cycles = 0, _deferred = 0, _firstEpoch = 0;
+  uint32_t _changedMs = 0, _refillMs = 0, _tokensMs = 0;
+  bool _switched = false;   // pas de durée OFF minimale avant la première commutation
+  uint8_t _block = WEAR_OK;
+  bool _dirty = false;
+  std::atomic<bool> _resetRequested{false};
+};
+
+// Image de toutes les voies, somme FNV-1a ; longueur écrite
+inline size_t wearSaveImage(uint8_t* out, WearCounter* const* c, uint8_t count) {
+  lePut(out, WEAR_MAGIC);
+  out[4] = count;
+  size_t n = 5;
+  for (uint8_t i = 0; i < count; i++, n += WEAR_RECORD_SIZE) c[i]->save(out + n);
+  lePut(out + n, fnv1a(out, n));
+  return n + 4;
+}
+
+inline bool wearLoadImage(const uint8_t* in, size_t len, WearCounter* const* c, uint8_t count) {
+  if (len != WEAR_IMAGE_SIZE(count) || leGet(in) != WEAR_MAGIC || in[4] != count) return false;
+  if (leGet(in + len - 4) != fnv1a(in, len - 4)) return false;
+  for (uint8_t i = 0; i < count; i++) c[i]->load(in + 5 + i * WEAR_RECORD_SIZE);
+  return true;
+}
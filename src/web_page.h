@@ -0,0 +1,294 @@
+#pragma once
+// Page web servie sur "/" (partagée avec le stand-in natif de host/)
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+// Page web minimaliste (SSE) — tout-en-un
+static const char index_html[] PROGMEM = R"HTML(
+<!doctype html><html lang="fr"><meta charset="utf-8">
+<meta name="viewport" content="width=device-width,initial-scale=1">
+<title>Fontaine</title>
+<style>
+  :root{font:14px system-ui,Segoe UI,Roboto,Ubuntu,Arial}
+  body{margin:0;background:#0b1220;color:#e8eefc}
+  header{padding:12px 16px;background:#0f172a;position:sticky;top:0}
+  main{padding:16px;max-width:900px;margin:auto}
+  .grid{display:grid;gap:12px;grid-template-columns:repeat(auto-fit,minmax(220px,1fr))}
+  .card{background:#111827;border:1px solid #1f2937;border-radius:12px;padding:14px}
+  .title{opacity:.8;font-size:12px;margin-bottom:6px}
+  .big{font-size:36px;margin:4px 0 10px}
+  .row{display:flex;gap:8px;align-items:center}
+  .pill{padding:3px 8px;border-radius:999px;background:#1f2937;font-size:12px}
+  progress{width:100%;height:10px}
+  code{background:#0a0f1a;padding:2px 6px;border-radius:6px}
+  .btn{padding:8px 16px;border:none;border-radius:6px;cursor:pointer;font-size:13px;font-weight:500}
+  .btn-primary{background:#3b82f6;color:#fff}
+  .btn-primary:hover{background:#2563eb}
+  .btn-secondary{background:#6b7280;color:#fff}
+  .btn-secondary:hover{background:#4b5563}
+  .btn.active{background:#10b981;color:#000}
+  .btn-danger{background:#dc2626;color:#fff}
+  .btn-danger:hover{background:#b91c1c}
+  .mode-selector{display:flex;gap:8px;margin-top:8px}
+  input[type=number]{background:#1f2937;color:#fff;border:1px solid #374151;padding:6px;border-radius:6px;width:60px}
+</style>
+<header>
+  <div class="row"><strong>Fontaine</strong> (<span id="lastUpdate">--</span>)</div>
+</header>
+<main class="grid">
+  <div class="card">
+    <div class="title">Mode de fonctionnement</div>
+    <div id="currentMode" class="big" style="display:none" >Cycle Ouvert</div>
+    <div class="mode-selector">
+      <button class="btn btn-primary" onclick="setMode(0)">Cycle Ouvert</button>
+      <button class="btn btn-secondary" onclick="setMode(1)">Cycle Fermé</button>
+      <button class="btn btn-secondary" onclick="setMode(2)">Eco/Hybride</button>
+    </div>
+    <div id="ecoInfo" style="margin-top:8px;font-size:11px;opacity:0.7"></div>
+    <div id="ecoConfig" style="display:none;margin-top:12px">
+      <div class="row">
+        <span>Vidange tous les</span>
+        <input type="number" id="ecoValue" min="1" max="720" value="5">
+        <select id="ecoUnit" style="background:#1f2937;color:#fff;border:1px solid #374151;padding:6px;border-radius:6px">
+          <option value="hours">heures</option>
+          <option value="days" selected>jours</option>
+        </select>
+        <button class="btn btn-secondary" onclick="setDrainInterval()">OK</button>
+      </div>
+    </div>
+
+  </div>
+
+  <div class="card">
+    <div class="title">Niveau de remplissage du réservoir</div>
+    <div class="big"><span id="level">–</span>%</div>
+    <progress id="lvlbar" max="100" value="0"></progress>
+    <div class="row"><span>Distance mesurée:</span><code id="dist">–</code><span>cm</span></div>
+    <div class="row"><span>Volume:</span><code id="litres">–</code><span>L /</span><code id="capacity">–</code><span>L</span></div>
+  </div>
+  
+  <div class="card">
+    <div class="title">État</div>
+    <div class="row">PIR: <strong id="pir">–</strong></div>
+    <div class="row">Électrovanne: <strong id="valve">–</strong></div>
+    <div class="row">Pompe: <strong id="pump">–</strong></div>
+    <div class="row">Capteur niveau: <strong id="sensor">–</strong></div>
+    <div class="row">Sorties: <strong id="actuators">–</strong></div>
+    <div class="row">Alerte: <strong id="alerts">–</strong>
+      <button class="btn btn-secondary" onclick="ackAlerts()">Acquitter</button></div>
+  </div>
+  
+  <div class="card">
+    <div class="title">Climat</div>
+    <div class="row"><span>Température:</span><code id="temp">–</code><span>°C</span></div>
+    <div class="row"><span>Humidité:</span><code id="hum">–</code><span>%</span></div>
+  </div>
+
+  <div class="card">
+    <div class="title">Historique</div>
+    <div class="row">Depuis dernière détection PIR: <strong id="sincePir">–:–:–</strong></div>
+    <div class="row">Dernier allumage électrovanne: <strong id="lastValveOnAgo">–:–:–</strong></div>
+    <div class="row">Dernier allumage pompe: <strong id="lastPumpOnAgo">–:–:–</strong></div>
+    <div class="row">Prochaine vidange: <strong id="nextDrain">–:–:–</strong></div> 
+  </div>
+  
+  <div class="card">
+    <div class="title">Vidange manuelle</div>
+    <div class="row" style="gap:12px">
+      <button class="btn btn-danger" onclick="startDrain()">Démarrer vidange</button>
+      <button class="btn btn-secondary" onclick="stopDrain()">Arrêter</button>
+    </div>
+    <div id="drainStatus" style="margin-top:8px;font-size:12px"></div>
+  </div>
+
+  <div class="card">
+    <div class="title">Calibration du bassin</div>
+    <div style="font-size:11px;opacity:0.7">Verser un volume connu, saisir le volume total présent, Capturer ; répéter à plusieurs niveaux puis Enregistrer.</div>
+    <div class="row" style="margin-top:8px"><span>Distance actuelle:</span><code id="calDist">–</code><span>cm</span></div>
+    <div class="row" style="margin-top:8px">
+      <input type="number" id="calLitres" min="0" step="0.01" value="0" style="width:80px">
+      <span>L</span>
+      <button class="btn btn-secondary" onclick="calib('capture')">Capturer</button>
+    </div>
+    <div class="row" style="gap:8px;margin-top:8px">
+      <button class="btn btn-primary" onclick="calib('save')">Enregistrer</button>
+      <button class="btn btn-secondary" onclick="calib('clear')">Effacer</button>
+      <button class="btn btn-secondary" onclick="calib('default')">Par défaut</button>
+    </div>
+    <div id="calTable" style="margin-top:8px;font-size:12px"></div>
+  </div>
+</main>
+<script>
+const modeNames = ['Cycle Ouvert', 'Cycle Fermé', 'Eco/Hybride'];
+
+function setMode(m) {
+  fetch('/setmode?mode=' + m)
+    .then(r => r.text())
+    .then(() => {
+      document.querySelectorAll('.mode-selector .btn').forEach((btn, i) => {
+        btn.className = 'btn ' + (i === m ? 'btn-primary active' : 'btn-secondary');
+      });
+    });
+}
+
+function setDrainInterval() {
+  const value = document.getElementById('ecoValue').value;
+  const unit = document.getElementById('ecoUnit').value;
+  fetch('/setinterval?value=' + value + '&unit=' + unit)
+    .then(r => r.text())
+    .then(txt => alert(txt === 'OK' ? 'Intervalle modifié' : txt));
+}
+
+
+function startDrain() {
+  if (confirm('Démarrer la vidange ?')) {
+    fetch('/drain').then(() => alert('Vidange démarrée'));
+  }
+}
+
+function stopDrain() {
+  fetch('/stopdrain').then(() => alert('Vidange arrêtée'));
+}
+
+function ackAlerts() {
+  fetch('/log?ack=1');
+}
+
+function calib(action) {
+  let q = '/calib?action=' + action;
+  if (action === 'capture') q += '&litres=' + document.getElementById('calLitres').value;
+  fetch(q).then(r => r.text()).then(() => setTimeout(loadCalib, 200));
+}
+
+function loadCalib() {
+  fetch('/calib').then(r => r.json()).then(c => {
+    const rows = p => p.map(x => x[0].toFixed(2) + ' cm → ' + x[1].toFixed(2) + ' L').join('<br>');
+    document.getElementById('calDist').textContent = c.distance.toFixed(2);
+    document.getElementById('calTable').innerHTML =
+      '<b>Brouillon</b><br>' + (rows(c.draft) || '–') +
+      '<br><b>Table active' + (c.custom ? '' : ' (par défaut)') + '</b><br>' + rows(c.active) +
+      (c.msg ? '<br><i>' + c.msg + '</i>' : '');
+  });
+}
+loadCalib();
+
+const es = new EventSource('/events');
+es.onmessage = e => {
+  try{
+    const d = JSON.parse(e.data);
+    const $ = id => document.getElementById(id);
+    
+    const now = new Date();
+    const timeStr = now.toLocaleTimeString('fr-FR');
+    const dateStr = now.toLocaleDateString('fr-FR');
+    $('lastUpdate').textContent = `${dateStr} ${timeStr}`;
+
+    // Mode
+    const mode = d.mode ?? 0;
+    $('currentMode').textContent = modeNames[mode];
+    document.querySelectorAll('.mode-selector .btn').forEach((btn, i) => {
+      btn.className = 'btn ' + (i === mode ? 'btn-primary active' : 'btn-secondary');
+    });
+    
+    // Config Eco visible uniquement en mode 2
+    const ecoConfig = $('ecoConfig');
+    if (mode === 2) {
+      ecoConfig.style.display = 'block';
+      $('ecoValue').value = d.ecoDrainValue || 5;
+      $('ecoUnit').value = d.ecoDrainUnit || 'days';
+    } else {
+      ecoConfig.style.display = 'none';
+    }
+
+    
+    // Info Eco
+    if (mode === 2 && d.ecoInClosedPhase) {
+      $('ecoInfo').textContent = 'Phase fermée active (' + (d.ecoDrainDays || 5) + ' jours)';
+    } else {
+      $('ecoInfo').textContent = '';
+    }
+
+    // Statut vidange
+    if (d.manualDrain) {
+      $('drainStatus').textContent = '⚠️ Vidange en cours...';
+      $('drainStatus').style.color = '#f59e0b';
+    } else {
+      $('drainStatus').textContent = '';
+    }
+    
+    $('level').textContent = d.level;
+    $('lvlbar').value = d.level;
+    $('dist').textContent = d.distance.toFixed(1);
+    $('litres').textContent = d.litres?.toFixed(2);
+    $('capacity').textContent = d.capacity?.toFixed(2);
+    $('temp').textContent = d.temp?.toFixed(1);
+    
+    const temp = d.temp ?? 20;
+    const tempEl = $('temp');
+    if (temp > 30) {
+      tempEl.style.background = '#dc2626';
+      tempEl.style.color = '#fff';
+      tempEl.style.padding = '2px 6px';
+      tempEl.style.borderRadius = '4px';
+      tempEl.style.fontWeight = 'bold';
+    } else if (temp > 25) {
+      tempEl.style.background = '#f59e0b';
+      tempEl.style.color = '#000';
+      tempEl.style.padding = '2px 6px';
+      tempEl.style.borderRadius = '4px';
+      tempEl.style.fontWeight = 'bold';
+    } else if (temp < 15) {
+      tempEl.style.background = '#3b82f6';
+      tempEl.style.color = '#fff';
+      tempEl.style.padding = '2px 6px';
+      tempEl.style.borderRadius = '4px';
+      tempEl.style.fontWeight = 'bold';
+    } else {
+      tempEl.style.background = '';
+      tempEl.style.color = '';
+      tempEl.style.padding = '';
+      tempEl.style.fontWeight = '';
+    }
+    
+    $('hum').textContent = d.humidity?.toFixed(1);
+    $('pir').textContent = d.pir ? 'Détecté' : 'Aucun';
+    $('valve').textContent = d.valve ? 'Ouverte' : 'Fermée';
+    $('pump').textContent = d.pump ? 'Active' : 'Arrêtée';
+    
+    const sincePir = d.sincePir || '--:--:--';
+    $('sincePir').textContent = sincePir;
+    const sincePirEl = $('sincePir');
+    if (sincePir !== '--:--:--') {
+      const [h,m,s] = sincePir.split(':').map(Number);
+      const totalSec = h*3600 + m*60 + s;
+      if (totalSec > 3600) {
+        sincePirEl.style.background = '#dc2626';
+        sincePirEl.style.color = '#fff';
+        sincePirEl.style.padding = '2px 6px';
+        sincePirEl.style.borderRadius = '4px';
+        sincePirEl.style.fontWeight = 'bold';
+      } else {
+        sincePirEl.style.background = '';
+        sincePirEl.style.color = '';
+        sincePirEl.style.padding = '';
+        sincePirEl.style.fontWeight = '';
+      }
+    }
+    
+    $('lastValveOnAgo').textContent = d.lastValveOnAgo || '--:--:--';
+    $('lastPumpOnAgo').textContent  = d.lastPumpOnAgo  || '--:--:--';
+    $('nextDrain').textContent = d.nextDrain || '--:--:--';
+    const alertsEl = $('alerts');
+    alertsEl.textContent = d.alerts ? d.alerts + (d.safeStop ? ' (arrêt de sécurité)' : '') : 'aucune';
+    alertsEl.style.color = d.alerts ? '#dc2626' : '';
+    const sensorEl = $('sensor');
+    const sensorNames = { ok: 'OK', degraded: 'douteux', failed: 'HS' };
+    sensorEl.textContent = (sensorNames[d.sensor] || '–') + (d.sensor && d.sensor !== 'ok' ? ' (écho valide il y a ' + d.lastEchoAgo + ')' : '');
+    sensorEl.style.color = d.sensor && d.sensor !== 'ok' ? '#dc2626' : '';
+    $('actuators').textContent = (d.actuators || []).map(c => c.name + ' ' + (c.busy ? '…' : c.on ? 'ON' : 'OFF')).join(' · ') || '–';
+  }catch(_){}
+};
+</script>
+</html>
+)HTML";
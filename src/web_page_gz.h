@@ -0,0 +1,243 @@
+#pragma once
+// Généré par host/icons_pack.py depuis web_page.h : ne pas modifier à la main
+// index_html compressé (gzip), à servir avec l'en-tête Content-Encoding: gzip
+// 3637 octets (page brute : 11875)
+#include <stdint.h>
+#include <stddef.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#elif !defined(PROGMEM)
+#define PROGMEM
+#endif
+
+static const uint8_t index_html_gz[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0xd5,0x1a,0xcd,0x6e,0xdb,0xc8,
+  0xf9,0xee,0xa7,0x98,0x55,0xb2,0xa1,0xb4,0xb1,0x64,0x4a,0x8e,0x1d,0x5b,0x7f,0x86,
+  0xd7,0x4e,0x90,0x74,0xb3,0x49,0x10,0x27,0xe9,0xc1,0x08,0xba,0x23,0x72,0x24,0x4d,
+  0x42,0x72,0x98,0xe1,0xd0,0xb1,0xaa,0x35,0xb0,0xa7,0x02,0x7b,0x2a,0xd0,0xde,0x7a,
+  0xda,0x53,0x51,0xf7,0xd4,0x5b,0x7b,0x5e,0xbf,0x49,0x5e,0xa0,0xaf,0xd0,0xef,0x9b,
+  0x21,0x29,0x52,0xa4,0x6d,0x39,0x49,0x81,0x16,0xd8,0x8d,0xc9,0x99,0xef,0xff,0x7f,
+  0x86,0x5a,0xeb,0x7f,0xe5,0x0a,0x47,0xcd,0x42,0x46,0xa6,0xca,0xf7,0x86,0x7d,0xfc,
+  0x97,0x78,0x34,0x98,0x0c,0x6a,0x63,0x59,0x1b,0xf6,0x7d,0xa6,0x28,0x71,0xa6,0x54,
+  0x46,0x4c,0x0d,0x6a,0xb1,0x1a,0x37,0x77,0x6a,0xc3,0x35,0xb3,0x1c,0x50,0x9f,0x0d,
+  0x6a,0x27,0x9c,0x7d,0x08,0x85,0x54,0x35,0xe2,0x88,0x40,0xb1,0x00,0xc0,0x3e,0x70,
+  0x57,0x4d,0x07,0x2e,0x3b,0xe1,0x0e,0x6b,0xea,0x97,0x75,0x1e,0x70,0xc5,0xa9,0xd7,
+  0x8c,0x1c,0xea,0xb1,0x41,0x1b,0x69,0x28,0xae,0x3c,0x36,0x7c,0x08,0x48,0x94,0x07,
+  0xac,0xbf,0x61,0xde,0xd7,0xfa,0x91,0x9a,0xe1,0x5f,0x42,0xba,0x52,0x08,0x35,0x1f,
+  0x03,0x40,0xb7,0x7d,0x2f,0x3c,0x25,0xd1,0x2c,0x52,0xcc,0x6f,0xc6,0x7c,0xfd,0x88,
+  0x4d,0x04,0x23,0xaf,0x1e,0xaf,0xbf,0x10,0x23,0xa1,0xc4,0xfa,0xab,0x51,0x1c,0xa8,
+  0x78,0x7d,0x5f,0x02,0x8b,0x33,0xc0,0x1c,0x09,0x77,0x36,0xf7,0xa9,0x9c,0xf0,0xa0,
+  0x6b,0xf7,0x46,0xd4,0x79,0x37,0x91,0x22,0x0e,0xdc,0xee,0x2d,0x7b,0xd4,0xee,0x74,
+  0xec,0x9e,0x23,0x3c,0x21,0xbb,0xb7,0xd8,0x0e,0x63,0x63,0x07,0x31,0xa6,0x8c,0xba,
+  0x4c,0xce,0x43,0xea,0xba,0x3c,0x98,0x74,0xdb,0x1d,0xe0,0xd7,0xde,0x0e,0x4f,0x8b,
+  0xc8,0xe3,0xf6,0xfd,0x0e,0xed,0x85,0x22,0x02,0x65,0x44,0xd0,0x8d,0x14,0x77,0xde,
+  0xcd,0x7a,0x4a,0x84,0x5d,0x1b,0x89,0xf8,0xa0,0xc8,0x82,0x04,0x62,0xfb,0xf4,0xd4,
+  0x18,0xa0,0xbb,0x6b,0xdb,0xfa,0x5d,0xcb,0x44,0x63,0x25,0x10,0xa1,0x35,0x91,0xdc,
+  0x9d,0xbb,0x3c,0x0a,0x3d,0x3a,0xeb,0xe2,0x4b,0x6f,0x42,0x43,0xcd,0xbd,0x87,0x6f,
+  0x4d,0xd0,0x17,0xb6,0x14,0x6b,0x82,0xc0,0xb1,0x1f,0x44,0x5d,0xc9,0x42,0x46,0x55,
+  0x1d,0x09,0x34,0xc7,0x5c,0xad,0xfb,0x3c,0x00,0x1e,0x75,0xd0,0x29,0x3c,0x5d,0x6f,
+  0x8f,0x65,0xa3,0xa1,0xe9,0x3a,0x54,0xba,0xf3,0xbc,0xe8,0xed,0x76,0x7b,0xa7,0x73,
+  0xbf,0x37,0x12,0x12,0xd4,0xec,0xb6,0xd1,0x9a,0xc2,0xe3,0x2e,0xb9,0xd5,0x1e,0x77,
+  0x76,0x37,0xd3,0x8d,0xa6,0xa4,0x2e,0x8f,0x23,0x23,0x40,0xa6,0x08,0xd8,0x5e,0x13,
+  0xd5,0x0e,0x9a,0x8b,0x90,0x3a,0x5c,0xcd,0xba,0xad,0x9d,0x1e,0xba,0xa6,0x19,0xf1,
+  0xdf,0x33,0x83,0x60,0x94,0x6b,0x82,0x47,0x94,0xf0,0xbb,0xdb,0x09,0xd6,0x88,0x4f,
+  0xe6,0x0b,0xc0,0xcd,0xed,0x85,0x15,0xd0,0xa7,0x36,0x69,0xdb,0x09,0xa0,0x14,0x1f,
+  0x32,0x53,0x8c,0x3d,0x76,0xaa,0x4d,0xb1,0x03,0xe0,0xd4,0xe3,0x93,0xa0,0xc9,0xc1,
+  0x16,0x51,0xd7,0x81,0x00,0x63,0x52,0xc3,0x87,0xdc,0xf3,0x32,0x6b,0x6f,0x02,0x2d,
+  0x84,0x2d,0xea,0xb1,0xbb,0xbb,0xbb,0xe4,0xc2,0x44,0xdd,0xa2,0xe4,0x48,0x2e,0x94,
+  0x62,0x22,0x59,0x14,0xcd,0x8d,0xbb,0xda,0xb6,0xfd,0x75,0x6f,0xca,0xf8,0x64,0x0a,
+  0xc1,0x97,0x48,0xe8,0x08,0x97,0x15,0x8c,0x6a,0x53,0x88,0x08,0x9a,0x19,0x0a,0x63,
+  0x66,0xbb,0x24,0x43,0x66,0x07,0xb5,0x88,0x8d,0x9d,0x2c,0xba,0x8c,0x3f,0x02,0x11,
+  0xb0,0x32,0x5a,0xcf,0x89,0x65,0x04,0x61,0x1a,0x0a,0x8e,0x4a,0xe7,0x85,0x06,0x75,
+  0xcd,0xeb,0x07,0x23,0xe2,0x96,0x6d,0xa7,0x4c,0x9a,0xa1,0xe4,0x60,0xe0,0x59,0x41,
+  0xd2,0xcd,0xd1,0x4e,0x67,0xbc,0x9d,0x86,0xfd,0x78,0x3c,0x5e,0x86,0xee,0x4e,0xc5,
+  0x09,0xc4,0x7f,0x1e,0xa7,0xb3,0xb5,0xbd,0xc9,0x46,0x19,0x60,0xc4,0x20,0xbf,0xdd,
+  0x65,0xc2,0xdb,0xa3,0xfb,0x9d,0x1d,0xbb,0x8a,0x70,0x06,0x5f,0x41,0xfa,0xde,0x68,
+  0x0b,0x88,0xa7,0xa0,0x2d,0xea,0x28,0x7e,0x52,0x34,0x6d,0xdb,0x1e,0xed,0xee,0xb4,
+  0x53,0xba,0x76,0x4e,0x3d,0x17,0x8a,0xd3,0x12,0x39,0xd7,0xe9,0x6c,0x77,0x2a,0xb5,
+  0x33,0xc0,0x15,0x12,0x8c,0x76,0xdb,0x4e,0x5b,0x67,0x7e,0xcb,0x07,0xb7,0x82,0xb4,
+  0x1e,0x73,0x94,0x90,0xd5,0x11,0x98,0x44,0x36,0x26,0xfa,0x8e,0x71,0x27,0x0f,0xc2,
+  0x58,0x1d,0x63,0xe1,0x1c,0x04,0xb1,0x3f,0x62,0xf2,0xcd,0xbc,0x22,0xcc,0x16,0x12,
+  0x55,0x64,0xde,0xe6,0xfd,0x7b,0xed,0xad,0x76,0x16,0x3d,0x95,0x91,0xd3,0x33,0xd1,
+  0xb8,0xad,0x23,0xb0,0xbf,0x91,0x94,0xc6,0xbe,0xa9,0x56,0x58,0x23,0xfb,0x2e,0x3f,
+  0x21,0x8e,0x47,0xa3,0x68,0x50,0x83,0x04,0x82,0x8a,0x1d,0x29,0x29,0x82,0x49,0xae,
+  0xae,0x26,0x0b,0xa4,0xde,0x8f,0x42,0x1a,0x10,0xee,0x0e,0x6a,0x00,0xaf,0x5e,0x85,
+  0x2e,0x14,0x96,0xda,0xb0,0xd9,0x04,0x10,0xd8,0x18,0x36,0xfa,0x1b,0x40,0x0c,0xa8,
+  0x6f,0xa4,0xe4,0xfb,0x58,0xd0,0x52,0xea,0x58,0x8f,0x6a,0xcb,0x2c,0xb1,0xce,0xe8,
+  0xc5,0xe2,0xb2,0xae,0x14,0xb5,0xe1,0xf7,0x60,0x59,0x02,0xff,0x41,0xa4,0x3a,0x58,
+  0x30,0x03,0xe6,0x43,0xfa,0x26,0x6c,0x32,0x1c,0x14,0x08,0x22,0x5d,0xc2,0x16,0x22,
+  0xd4,0x52,0x22,0x50,0x38,0x6a,0x44,0x6b,0x3c,0xa8,0xa5,0x5e,0xc1,0x44,0xa9,0x91,
+  0xe1,0xc1,0xcc,0xf1,0x18,0x79,0x16,0x83,0x57,0x4b,0xe4,0x12,0xec,0x82,0x57,0x13,
+  0x11,0x01,0x62,0x14,0x43,0x71,0xca,0x74,0x82,0x10,0x21,0xb9,0x24,0xa8,0x11,0x10,
+  0xd4,0x83,0x9a,0x3e,0xa8,0x41,0xbb,0x43,0x61,0xea,0x76,0xa3,0xb6,0xc4,0xcd,0x50,
+  0xb8,0x86,0x60,0x16,0xfc,0x15,0x24,0xdb,0x19,0xc9,0x87,0x4c,0xfa,0x17,0xe7,0x5f,
+  0x80,0x64,0x07,0x48,0x3e,0x70,0xc4,0xc6,0xa3,0xd9,0x08,0xbc,0xc4,0x8a,0x14,0xab,
+  0xec,0x0d,0xb4,0x1e,0x07,0x63,0x91,0xd9,0xb7,0x18,0xe0,0xf9,0x4a,0x03,0x01,0xdb,
+  0x4b,0x4b,0xbe,0xdd,0xba,0x0f,0x01,0x56,0x4d,0xee,0x40,0x04,0xe3,0x4b,0x1c,0x96,
+  0x4f,0x1f,0x2c,0xb7,0x0b,0x6f,0x2c,0x07,0x6f,0xb2,0x0e,0x3b,0x3a,0x22,0x5f,0x73,
+  0x9d,0xbf,0x44,0x89,0x38,0x22,0x1e,0x8b,0x92,0x40,0x5d,0x40,0xe9,0x2c,0x24,0x3a,
+  0x0b,0x6b,0x26,0x0d,0x6b,0xa9,0x3c,0xaf,0xa9,0x17,0x43,0xa8,0x40,0x7f,0x1c,0xd4,
+  0xda,0xf0,0x97,0x9e,0x0e,0x6a,0xf7,0x3b,0x76,0x8d,0x9c,0xe0,0xc6,0xa0,0xb6,0x55,
+  0xe0,0xa6,0xe3,0x24,0x45,0x7d,0x05,0xb3,0x4a,0xa6,0xc8,0x7f,0x23,0xab,0x73,0xac,
+  0x81,0xb9,0x08,0x31,0x37,0x52,0xb9,0xa6,0x02,0x8a,0x7e,0x6d,0x38,0x65,0xb1,0x44,
+  0x85,0xcd,0xe6,0x15,0xf0,0x2e,0x9d,0x45,0x20,0xac,0x56,0x80,0xb9,0xc3,0xb7,0x88,
+  0x5e,0x46,0x03,0xcb,0x69,0x88,0xdc,0xca,0x8d,0xa2,0xec,0x50,0x42,0x25,0x78,0x8c,
+  0x5d,0x08,0xd8,0xd6,0x21,0xda,0x9e,0x7d,0x57,0x0a,0xdb,0x5c,0x5c,0x98,0xc7,0xb5,
+  0xc2,0xd3,0xca,0x55,0xe3,0x29,0xf4,0x02,0x1a,0x63,0xdd,0x90,0x38,0xfd,0xf0,0x28,
+  0xa2,0x10,0x03,0x6e,0x4c,0xe4,0xc5,0x79,0x04,0x02,0x08,0x2e,0x2f,0xc9,0x79,0xac,
+  0x18,0xc3,0x5c,0x95,0x63,0x27,0xcc,0xab,0x0d,0x3f,0xfe,0xf4,0xe7,0x24,0x70,0xbe,
+  0xce,0xe3,0xa5,0x0d,0xdf,0x80,0x9e,0x78,0x23,0x2a,0x93,0x30,0x81,0xde,0x9f,0x85,
+  0x89,0x8d,0x01,0x9f,0x82,0x96,0x39,0x26,0x25,0x17,0x89,0x1f,0xf2,0x48,0xd1,0xc0,
+  0x61,0xc4,0x67,0x51,0x0c,0xa2,0xb2,0x6e,0xc2,0xb5,0x8f,0x73,0x83,0xe6,0x02,0x49,
+  0xa1,0x12,0x79,0x70,0x2d,0x41,0x74,0xfc,0x14,0xb0,0x5a,0xab,0x1c,0x8f,0xd7,0x38,
+  0x05,0x56,0x10,0xf6,0xb8,0x02,0xf9,0xca,0xa4,0x9f,0x90,0x8d,0x12,0xac,0x43,0x4d,
+  0x36,0x57,0x40,0x2f,0xcb,0x91,0x3d,0xdc,0xc8,0x7f,0x17,0x3f,0x2b,0xaa,0xae,0xd2,
+  0xe5,0xf9,0xe3,0x17,0x5d,0x92,0xf4,0x29,0x2d,0x52,0xc8,0x65,0xea,0x26,0xd3,0xab,
+  0xae,0xc2,0xbe,0xf8,0x19,0x03,0x59,0x8a,0x13,0x0a,0xfd,0xa4,0x48,0x07,0x7c,0x76,
+  0xc2,0x56,0xa7,0xf4,0x5c,0xf8,0xe1,0x12,0x85,0x30,0xf6,0xc3,0xd5,0x09,0x1c,0xd0,
+  0x50,0x41,0x9e,0x92,0x40,0x47,0x6c,0x91,0x52,0xc4,0x82,0x48,0xdc,0x40,0xad,0x23,
+  0x38,0x42,0x71,0x16,0x15,0x89,0xc0,0x60,0x14,0x53,0xe8,0x5f,0xd1,0xea,0x74,0xf6,
+  0x3d,0xe8,0x52,0x4b,0x5a,0x51,0x5c,0x5b,0xa2,0x71,0xf3,0x66,0x03,0x85,0x50,0x13,
+  0x8f,0x30,0xff,0xf7,0x9d,0xf7,0x31,0x57,0x50,0x0f,0xb2,0x32,0xf0,0x99,0x51,0x73,
+  0xe0,0x41,0x0b,0x56,0xd7,0xa7,0xc0,0x4b,0xa8,0x09,0x17,0xe7,0x92,0x2a,0xa8,0x8f,
+  0xe5,0x44,0xc0,0xf3,0x52,0x39,0xb0,0x7f,0xfd,0xc7,0xc1,0xca,0x29,0xf6,0x28,0xf6,
+  0xb9,0xcb,0xd5,0xc5,0x79,0x99,0xf8,0x34,0xf6,0xcb,0xb4,0xbf,0xbe,0x24,0x69,0x6e,
+  0xa4,0xfc,0x23,0x28,0x0c,0x42,0xf2,0xf7,0x31,0xbb,0x4a,0xc0,0x43,0x16,0xc6,0x3c,
+  0x82,0xc2,0x28,0x03,0x7e,0xf1,0x37,0x09,0x35,0xf1,0xe2,0x5c,0x31,0x3d,0x59,0x91,
+  0x52,0x4e,0x45,0x1c,0x6a,0xd1,0xf3,0x24,0xb1,0xba,0xc9,0xff,0x2b,0x45,0xd0,0x21,
+  0xd2,0x67,0x92,0x50,0x0f,0x8a,0x0d,0x96,0xde,0x8b,0xf3,0x4b,0x33,0x0e,0x07,0xc9,
+  0xd7,0x98,0x75,0xcf,0x82,0xfd,0x89,0xf8,0x02,0xbc,0xc2,0x72,0x4e,0x22,0x8f,0xe7,
+  0x90,0x97,0x9f,0xc8,0xe2,0xb9,0x14,0xce,0x14,0x27,0x61,0x72,0x62,0xc6,0x89,0x22,
+  0xf5,0x80,0x9d,0x9a,0xee,0x76,0x15,0x65,0xf2,0xc9,0x61,0x9d,0x8e,0x30,0x3e,0x0d,
+  0x62,0xe6,0x79,0x57,0xf9,0x37,0x9d,0x38,0xd2,0x1b,0x80,0xeb,0x86,0x56,0x73,0xb6,
+  0xc9,0xf7,0x69,0x45,0xa5,0xd1,0x05,0x33,0xf4,0xf0,0xe2,0x1c,0xe6,0x2e,0x09,0xc6,
+  0x4d,0xf4,0xfe,0x9c,0x39,0x13,0x46,0xb7,0x8c,0xf0,0xbe,0x94,0x17,0x7f,0xcf,0x67,
+  0xfe,0xa5,0x53,0xa6,0x8b,0x28,0x47,0xd0,0x0d,0xe2,0x68,0x85,0x49,0x53,0xab,0xfc,
+  0x59,0x69,0x74,0x40,0x3d,0x3e,0x82,0xd2,0x80,0x09,0x01,0xf3,0xc2,0x08,0xf6,0x78,
+  0xb0,0x2c,0x58,0x22,0xc7,0x55,0x23,0xee,0x6b,0x26,0x61,0xd0,0x20,0x31,0x0c,0x59,
+  0xba,0xe1,0xe2,0xcd,0x56,0x10,0xaf,0x93,0x88,0xf2,0x88,0x4b,0x98,0x44,0xd3,0x75,
+  0x25,0x14,0xf5,0x48,0xa8,0x07,0x93,0x40,0xad,0x13,0x6c,0x08,0x31,0x9a,0xbc,0x87,
+  0xc3,0x4a,0x88,0xe9,0x29,0xc9,0xc5,0x2f,0x24,0xf4,0xe2,0x88,0x43,0xa7,0x88,0x92,
+  0x56,0x71,0x4a,0x74,0x26,0x3f,0x08,0x24,0x9b,0x40,0xea,0x03,0x46,0x6b,0x85,0xc0,
+  0x28,0x9a,0xae,0x34,0x77,0x60,0xb3,0xc0,0x10,0xeb,0x56,0xb4,0x7c,0xef,0xf0,0x93,
+  0x47,0x8f,0xcb,0xb8,0xaf,0x5d,0x33,0x83,0x03,0xd3,0x27,0x66,0x2c,0x31,0x43,0xb8,
+  0x8d,0x94,0x58,0x08,0x0f,0x2d,0xbb,0x9d,0x9b,0xaf,0x52,0xfa,0xe6,0xa4,0xbb,0x63,
+  0xe7,0x69,0x17,0xc6,0x92,0x9b,0x87,0xad,0x83,0xf1,0x50,0xb7,0x1c,0xe3,0x15,0xab,
+  0x61,0x3a,0x36,0x3a,0xe8,0xea,0xd8,0xbd,0x24,0x29,0xcb,0x37,0x01,0x37,0x3f,0x57,
+  0x26,0x22,0x45,0xf4,0x44,0xcb,0x93,0x8b,0x80,0xcf,0x48,0xcf,0x54,0x4f,0x8f,0x51,
+  0xa9,0xa9,0x8e,0xc7,0xd4,0xf9,0x12,0x14,0x5d,0x36,0xa6,0xb1,0xa7,0x90,0xe6,0x73,
+  0x2a,0xb1,0xdf,0xc0,0xbb,0xba,0x3e,0xf1,0x01,0xfd,0x25,0x1d,0x41,0x4a,0x7e,0x62,
+  0xd6,0xf7,0x37,0xf0,0xe6,0x01,0xef,0x82,0x1d,0xc9,0x43,0x38,0xb5,0x80,0x84,0x91,
+  0x22,0x78,0xa6,0x7f,0x4a,0x61,0xbe,0x26,0x03,0x72,0x6c,0xe5,0x8f,0xe5,0xd6,0x3a,
+  0xb1,0xf2,0x67,0x6a,0x7c,0xcf,0x1d,0x88,0xad,0x37,0xbd,0xb5,0xb5,0x71,0x6c,0x6e,
+  0x21,0x48,0x7a,0x6a,0xf6,0x1b,0x64,0x0e,0x3c,0xc7,0x4c,0x39,0xd3,0xba,0x05,0x27,
+  0x24,0x85,0x0c,0xf6,0xf0,0x9f,0x81,0x45,0xee,0x12,0xbf,0xa1,0xb5,0x6a,0xa9,0x29,
+  0x0b,0xea,0x92,0x0c,0x86,0x44,0xb6,0x14,0xb4,0x8b,0x7a,0x23,0xbf,0x51,0x6f,0xe0,
+  0xce,0x3c,0xb1,0xb1,0x2b,0x9c,0x18,0x2f,0x39,0x5a,0xd0,0xcb,0xe5,0xec,0x28,0xb9,
+  0x7f,0xd8,0xf7,0xbc,0xba,0x55,0xbc,0x68,0xd2,0xf7,0x53,0x56,0xa3,0x35,0x16,0xf2,
+  0x01,0x05,0xfe,0x75,0x78,0x5d,0x27,0xbc,0x40,0x8c,0xa0,0x7f,0x5a,0xda,0x5d,0xa8,
+  0x36,0x68,0x6d,0xa1,0xd3,0x50,0xb6,0x3a,0x27,0x83,0xc1,0x80,0xf8,0x64,0x4f,0xaf,
+  0xa5,0x91,0x46,0xcc,0x55,0x9a,0x45,0xba,0x66,0x39,0xf3,0xad,0xd5,0xe8,0x25,0x44,
+  0xcf,0x92,0x27,0xfc,0x7b,0x56,0xb4,0xca,0xd2,0x29,0x4f,0xcb,0x61,0x2c,0xaf,0xb3,
+  0x15,0xf8,0x67,0xea,0x4d,0x98,0x7a,0xe0,0xe9,0xeb,0x9c,0x6f,0x67,0x8f,0xdd,0xba,
+  0x95,0x9e,0xb8,0x41,0x23,0x0d,0xdb,0xcb,0x50,0x63,0x38,0x4d,0x5f,0x83,0x89,0x07,
+  0xee,0x3c,0x62,0xce,0x23,0x3c,0x91,0x66,0xcf,0xd4,0x0b,0x54,0xdd,0xc8,0x72,0x97,
+  0x58,0x77,0x90,0xb4,0x5e,0xc2,0x87,0x95,0x9c,0xa5,0x4e,0x15,0x6e,0xe9,0x81,0xd8,
+  0xbc,0x80,0x11,0xad,0x67,0xdf,0x59,0x68,0xc7,0x54,0x73,0x88,0x22,0x70,0x15,0x1f,
+  0x73,0x88,0x23,0x30,0x24,0x80,0x35,0x8c,0xad,0x72,0xc6,0xca,0xb5,0x5a,0x6d,0x26,
+  0x3e,0x26,0x75,0x07,0xaf,0x40,0xa4,0x5f,0xb7,0x16,0xad,0xd7,0xa3,0x69,0xf7,0x25,
+  0x7b,0x56,0xa3,0x91,0x78,0x36,0xd5,0x4f,0xf7,0x47,0x50,0x3c,0x17,0x47,0x46,0x32,
+  0x2b,0x1d,0x1b,0x5c,0x43,0x09,0x4e,0x93,0x56,0x43,0xfb,0xed,0xac,0xe8,0xb3,0x45,
+  0x5f,0x2e,0x86,0x32,0xac,0x5f,0x4f,0x9c,0xea,0x46,0x9e,0xd2,0xce,0xd3,0xcd,0x8d,
+  0xfa,0x05,0xba,0x9e,0x98,0xec,0xc1,0xde,0xa0,0x6d,0x2d,0x21,0x98,0x7a,0x41,0xf5,
+  0x8b,0x41,0xf1,0x98,0x22,0xef,0x31,0x62,0x37,0xf4,0xde,0x9e,0xd9,0xd3,0xde,0x32,
+  0x8f,0xbd,0xc4,0x6a,0xe6,0xcd,0x38,0x22,0xab,0xd4,0x80,0x7a,0x17,0xde,0xef,0x98,
+  0x83,0xad,0xc6,0xba,0x34,0x80,0xb2,0x46,0x53,0x0e,0xa1,0xf7,0x8d,0xaa,0x78,0xc8,
+  0x9b,0x04,0x42,0xec,0x25,0xf7,0x99,0x88,0x55,0xdd,0x13,0xd4,0xd5,0x13,0xc4,0x3a,
+  0xe9,0xd8,0xf6,0xb2,0x49,0xb2,0xdd,0x25,0x93,0x68,0xed,0xac,0x22,0x9f,0xb7,0x91,
+  0x08,0x32,0x3e,0xce,0x22,0xa3,0x4d,0x42,0x40,0x5b,0xc1,0x02,0x16,0xe2,0x7a,0xd8,
+  0xf2,0x69,0x58,0x3f,0xc5,0xc7,0xd3,0x63,0xfb,0x4d,0x4b,0x89,0x87,0xfc,0x94,0xb9,
+  0xf5,0x4e,0x03,0x03,0x9c,0x38,0x3e,0xf9,0xf8,0x87,0x3f,0xe9,0x84,0x3f,0x3d,0x6e,
+  0x97,0xb6,0x9f,0x00,0xdf,0xb7,0x02,0xbc,0x6f,0xf5,0x47,0x72,0x98,0xa6,0xf8,0x55,
+  0x86,0xc2,0x31,0x00,0x85,0x05,0x43,0x1c,0x98,0xaf,0x75,0x20,0x89,0xd3,0x72,0x93,
+  0x19,0x22,0xc7,0xe0,0x7a,0x5a,0xba,0xc2,0x03,0x31,0x0e,0xa7,0x02,0xf9,0xe8,0xe5,
+  0xf7,0x4f,0xc8,0x20,0x29,0x31,0x20,0xce,0xf0,0x5b,0x29,0x62,0xee,0x79,0x02,0xe6,
+  0xaf,0xd1,0x50,0x8b,0x87,0x55,0x0b,0x75,0xaf,0x03,0x3f,0x49,0xc7,0xaa,0x41,0x7e,
+  0xfc,0x91,0x58,0x30,0x92,0x80,0xbb,0xef,0x2e,0x30,0x25,0x40,0x0f,0x35,0xed,0xac,
+  0x98,0x01,0xa2,0xd3,0x72,0x62,0x88,0x6a,0x5d,0xef,0x74,0x75,0x23,0xf5,0x70,0xd1,
+  0x91,0x1a,0x96,0x36,0x48,0x9e,0x55,0xc2,0xc9,0x90,0x58,0x30,0x80,0x25,0x3f,0x9a,
+  0x20,0x15,0xcd,0x89,0x6b,0x58,0xb3,0xa6,0x09,0xe0,0x02,0x50,0x37,0xb6,0x34,0x25,
+  0x32,0xe7,0x79,0xe8,0x22,0xc6,0x87,0xba,0x05,0x05,0xec,0x03,0x79,0x70,0x02,0x26,
+  0x39,0x12,0xb1,0x74,0x18,0x04,0x03,0xc3,0xb7,0x08,0x91,0x59,0xd4,0x12,0x01,0x74,
+  0x2a,0x7d,0x77,0x35,0x20,0x2c,0x0d,0x02,0x25,0x67,0xf9,0x58,0x70,0x61,0xef,0x37,
+  0x47,0xcf,0x9e,0xb6,0x42,0xfc,0xc2,0x5a,0x67,0x2d,0x97,0x2a,0x9a,0xd8,0xde,0x40,
+  0xdc,0x06,0x08,0xee,0x22,0xfa,0x65,0xbe,0xe0,0x6e,0x82,0x90,0xc3,0x0a,0xc4,0x87,
+  0x44,0xc0,0x43,0xaa,0x58,0xbd,0x40,0x51,0x41,0xbc,0x1f,0x29,0x89,0xfb,0xe2,0x03,
+  0x78,0xfc,0x89,0xc0,0x6f,0xb2,0x2f,0xcd,0x2a,0x0f,0x26,0x75,0x6b,0x2c,0x9b,0x0f,
+  0x5f,0x58,0x05,0x24,0xfc,0x56,0x50,0x46,0x3a,0x34,0xab,0x65,0xa4,0xdb,0x75,0x6b,
+  0xf1,0x8d,0xa1,0x14,0x70,0x3f,0xdc,0x9e,0x27,0xf4,0xce,0xc8,0xed,0x79,0x22,0xcf,
+  0xd9,0x0f,0xbd,0x35,0x8d,0xbb,0xb1,0x41,0xb0,0x3d,0xe7,0x98,0x63,0xe3,0xc4,0x16,
+  0xa2,0x3b,0x28,0xd9,0xdb,0x23,0x76,0xc6,0x25,0xf7,0xe1,0xa0,0xc4,0x26,0x1b,0x17,
+  0x8e,0xf1,0xe9,0xcd,0x52,0x44,0x7f,0x89,0x06,0x7d,0x6d,0x7b,0xd6,0xf2,0xde,0xac,
+  0x43,0x9f,0xe5,0xbd,0x09,0xb6,0x30,0x17,0xeb,0x04,0xa6,0x19,0x68,0x25,0x11,0xc7,
+  0xbc,0x80,0x76,0x07,0xd2,0xa3,0x16,0x84,0x05,0x86,0x49,0x27,0x67,0xae,0xec,0x36,
+  0x1e,0x24,0xba,0xad,0x1b,0xac,0x79,0x4d,0x39,0x60,0xd5,0x35,0x26,0x05,0x11,0x3b,
+  0x8d,0x4c,0x9b,0x0c,0xb0,0xa5,0xa7,0xb6,0x56,0x72,0x87,0xaf,0xf5,0xf2,0x84,0xf3,
+  0xce,0x4a,0x47,0x88,0xdb,0xe5,0x7e,0xaf,0xdd,0x03,0x8b,0xba,0x1b,0xe9,0x1d,0xcc,
+  0xee,0xad,0x22,0x46,0xbe,0xcf,0x17,0x10,0x70,0x43,0x57,0x03,0xbc,0xcd,0x4e,0xd8,
+  0x9c,0x11,0xe6,0x45,0x6c,0x15,0xe1,0xf0,0x1b,0x43,0x8a,0xb4,0x56,0xb0,0x1d,0x7e,
+  0xe3,0x40,0xcb,0x55,0xa8,0x4d,0xee,0xdc,0x31,0x02,0x3c,0x0e,0x0e,0x3c,0x11,0x31,
+  0xf7,0xf9,0x94,0x46,0x6c,0x61,0x0c,0x23,0x31,0x12,0x28,0xc5,0x95,0xa5,0x41,0xa1,
+  0x03,0xe0,0xa4,0x99,0x56,0x29,0x52,0xd7,0x7e,0x5f,0xe8,0x74,0x08,0xaa,0x68,0x1b,
+  0x98,0x5a,0xad,0x2f,0xe6,0x1b,0xd5,0xba,0x5d,0xc5,0xab,0xa8,0x18,0xe8,0xa4,0xcf,
+  0xd3,0x2a,0x1d,0x2b,0x32,0xcd,0x20,0x39,0x68,0x10,0x43,0x85,0x47,0xde,0x05,0x35,
+  0x72,0xa7,0xf0,0x32,0xf9,0x8f,0x7f,0xf9,0xe5,0xdf,0xff,0xfa,0x23,0x49,0x47,0x02,
+  0x08,0x27,0x07,0x05,0x6d,0xb5,0x5a,0x79,0x6f,0x17,0x49,0x18,0x07,0xe8,0xaf,0x20,
+  0x48,0xe2,0xd6,0x78,0x6b,0x97,0xd9,0xa3,0x4b,0x55,0xbb,0x92,0x7f,0xa6,0x5e,0xe6,
+  0x36,0x2c,0x1d,0x78,0x71,0x5f,0x82,0x75,0x5b,0x7a,0x7d,0x51,0x60,0xf4,0x9d,0x7d,
+  0x21,0x9e,0x8a,0x00,0x6e,0x55,0xb3,0x73,0xcb,0xcd,0xae,0x9d,0x2b,0x5a,0xe9,0x20,
+  0x51,0x62,0xad,0x37,0xf6,0x4a,0x0d,0xf2,0xb6,0x3e,0x5e,0xea,0xbb,0x83,0x0a,0xac,
+  0x74,0xab,0x12,0x0f,0xef,0x2a,0x2b,0x70,0x70,0x79,0xaf,0x24,0x5b,0xbe,0x7e,0x03,
+  0x40,0x06,0x89,0xd5,0xb0,0x63,0xf7,0x96,0xb6,0x1f,0x78,0x26,0xf5,0x0d,0x8b,0x45,
+  0xd6,0x6b,0x8c,0x21,0xd9,0xb4,0x17,0x01,0x62,0xc0,0x13,0x9f,0x2e,0x3e,0x76,0x69,
+  0xc7,0x9a,0xef,0xea,0x59,0x20,0x14,0x40,0x73,0xee,0x1f,0x8f,0xab,0x41,0x92,0x6f,
+  0x60,0x08,0x94,0xfc,0x34,0xa2,0x1a,0xce,0x7c,0x1f,0x7b,0xa1,0x3f,0x8f,0x21,0xf0,
+  0xbd,0xcb,0x00,0xf1,0xd8,0xf8,0x5b,0xfd,0x83,0x07,0x5d,0x93,0x84,0xe7,0x16,0x83,
+  0x2e,0xa7,0x62,0x67,0x6b,0x35,0x15,0x0b,0xb1,0x7b,0xa9,0x8a,0xb6,0x6d,0xff,0xaf,
+  0xa9,0xd8,0x27,0xed,0x15,0x55,0x34,0xbf,0xfd,0xf8,0xff,0xf1,0xe2,0x0a,0x3a,0x5d,
+  0xa3,0xcc,0xb5,0x8a,0xac,0x22,0x58,0x65,0x65,0x9a,0xc6,0x7e,0x45,0xca,0x4e,0xcd,
+  0x37,0x83,0xd9,0x5e,0x55,0x49,0x09,0xb9,0xac,0x40,0x81,0x55,0x1c,0x0c,0x0e,0xcd,
+  0x0d,0xbe,0x39,0x68,0x5a,0xfb,0xb1,0x13,0x07,0x56,0x86,0xa9,0x3f,0x67,0x55,0xe0,
+  0xea,0x75,0xc4,0x36,0x77,0x1f,0x66,0x96,0x30,0xf7,0x1e,0x6c,0x81,0x8d,0x9f,0xb2,
+  0xaa,0x18,0xc7,0x58,0x34,0x80,0xd7,0x62,0x0c,0xd9,0xcf,0xce,0x81,0xa5,0x5a,0x93,
+  0x7e,0x45,0xd0,0xa8,0xd9,0x0b,0x76,0xea,0x66,0xb3,0xab,0xff,0x5b,0x30,0x4c,0xb7,
+  0x4b,0x4c,0xd3,0x8d,0x5e,0x05,0xe1,0xb4,0x52,0x2d,0x90,0x17,0xd5,0x2a,0xe3,0xf7,
+  0x15,0x9e,0x0d,0x33,0x86,0x8b,0xa8,0x37,0xa4,0x8e,0xa7,0xeb,0xfe,0x7a,0xf4,0x26,
+  0xc7,0xa8,0x05,0xa3,0x01,0x87,0x83,0x6e,0x17,0x44,0xc1,0xf3,0xd5,0x53,0x7d,0x2d,
+  0x99,0xdd,0x80,0x24,0x75,0x12,0xef,0x6e,0x8f,0x18,0x1c,0xcf,0xc8,0xf4,0x9b,0xcd,
+  0x6d,0xdb,0xc6,0x1b,0x9f,0x6f,0xb6,0xf1,0x4f,0x94,0x42,0xea,0x6c,0x4b,0xe1,0xa0,
+  0x6e,0x02,0x54,0x23,0x77,0x3b,0xb3,0x50,0x62,0xa5,0xfa,0x59,0x81,0x50,0x9d,0x7f,
+  0x15,0x80,0x57,0x64,0x61,0x95,0x1c,0x57,0xe4,0x62,0x05,0xf8,0xa5,0x19,0x59,0xca,
+  0xc9,0x6b,0x75,0x5e,0x49,0xd9,0x15,0x15,0x5d,0x5d,0xe4,0x85,0xb8,0x55,0xd3,0x44,
+  0xe1,0x1b,0x55,0x55,0x6f,0x2f,0x00,0x5c,0x12,0xdd,0x85,0xaf,0x50,0x4b,0x44,0x32,
+  0x2a,0x19,0x00,0xb9,0x84,0x4a,0xf6,0xb5,0xa9,0x42,0x8c,0x6c,0xaf,0x0a,0xd7,0xc4,
+  0xac,0xf9,0x90,0x9b,0xe6,0x8c,0x79,0x4b,0x33,0x26,0xdd,0x2b,0xd1,0x35,0x1b,0x90,
+  0xf3,0xd9,0xa3,0x9e,0x53,0x23,0x3a,0x86,0x63,0x97,0xd0,0xc5,0x80,0xd4,0xcd,0x5d,
+  0x10,0xfe,0xe8,0x22,0xba,0x38,0x87,0x43,0x15,0x7e,0x01,0x6d,0x24,0x47,0x61,0xfc,
+  0x97,0x62,0x69,0x4a,0x0b,0x44,0xc6,0xaa,0xe8,0xd7,0x1c,0xab,0x2c,0xf6,0x35,0x85,
+  0x42,0xe2,0xeb,0xef,0xe2,0x59,0xda,0xeb,0xb7,0xe2,0x51,0xd3,0xac,0xa5,0xf7,0xbc,
+  0x73,0x22,0xde,0x75,0xf5,0x15,0xdd,0x3a,0x48,0x37,0x91,0xd4,0x65,0x2e,0xbc,0xbb,
+  0x22,0x56,0x2c,0x3e,0x85,0xc5,0x31,0xe5,0x9e,0x5e,0x7a,0x74,0x64,0x91,0x33,0x43,
+  0x28,0x65,0xb2,0x64,0x8b,0x7a,0x8e,0xf4,0x31,0x58,0x40,0xbf,0xbd,0xc9,0x5f,0x43,
+  0x68,0xc3,0xe8,0x65,0x73,0x3e,0x48,0x9e,0x75,0x01,0x12,0xef,0x2c,0x63,0x2b,0x30,
+  0xd0,0x54,0xe0,0x35,0x24,0xc7,0xef,0x2b,0x1e,0x81,0x33,0x9d,0x3e,0xf4,0x99,0x18,
+  0x78,0x00,0x9b,0x18,0x01,0x30,0xf4,0x37,0x72,0x77,0x09,0x39,0xa1,0x96,0xad,0x76,
+  0x0d,0xc3,0x0a,0x53,0xa2,0xf3,0xd3,0x9f,0x06,0x94,0x22,0x09,0x54,0xc8,0x36,0x51,
+  0xb7,0xe3,0x37,0xa6,0x0a,0xea,0x8b,0x28,0xa7,0x85,0xbf,0xda,0xd6,0x27,0x92,0xe4,
+  0x5e,0x65,0x14,0x47,0x33,0x64,0xf3,0xf1,0xa7,0xbf,0x22,0x0b,0xa7,0x25,0x02,0xdd,
+  0x5b,0x9e,0x6a,0x86,0xcf,0x1e,0x3e,0xb4,0x1a,0xe9,0x2d,0x13,0xf9,0xf5,0x9f,0xa0,
+  0x54,0x66,0x2f,0x7d,0x45,0xe2,0x50,0xbc,0x07,0xfb,0x5d,0x63,0x7e,0xb6,0x06,0xc6,
+  0xef,0x6f,0xa4,0x37,0xf6,0xfd,0x0d,0xfd,0x83,0xf2,0xb5,0xff,0x00,0x4b,0x1c,0x5e,
+  0x47,0x62,0x2e,0x00,0x00,
+};
+static const size_t index_html_gz_len = sizeof(index_html_gz);